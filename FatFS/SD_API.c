@@ -125,6 +125,8 @@ BRTOS_Mutex * SDCard_ResourceInit(INT8U priority)
 {
   // Cria um mutex informando que o recurso est disponvel
   // Prioridade mxima a acessar o recurso = priority
+  // With BRTOS_MUTEX_INHERITANCE_EN, priority = MUTEX_PRIORITY_INHERITANCE shares the
+  // card between tasks of any priority without raising the owner when nobody waits
 #if (SD_FAT_MUTEX_EN == 1)
   OSMutexCreate(&SDCardResource,priority);
 #else
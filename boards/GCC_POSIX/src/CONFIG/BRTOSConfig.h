@@ -0,0 +1,279 @@
+///////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+/////                                                     /////
+/////                   OS User Defines                   /////
+/////                                                     /////
+/////             !User configuration defines!            /////
+/////                                                     /////
+///////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+
+/// Define the platform for BRTOS + Contiki
+#define BOARD_NONE				 	 0
+#define BOARD_POSIX				 	 4
+
+#define BRTOS_PLATFORM 			BOARD_POSIX
+
+/// Define MCU endianess
+#define BRTOS_ENDIAN			BRTOS_LITTLE_ENDIAN
+
+/// Define if simulation or DEBUG
+#define DEBUG 					1
+
+/// Host stack of each task, in bytes (POSIX simulation port)
+#define POSIX_TASK_STACK_SIZE	(64*1024)
+
+/// Define if verbose info is available
+#define VERBOSE 				0
+
+/// Define if error check is available
+#define ERROR_CHECK 			0
+
+/// Define if whatchdog is active
+#define WATCHDOG 				0
+
+/// Define if compute cpu load is active
+#define COMPUTES_CPU_LOAD 		0
+
+/// Define if the processor time, context switches and longest blocking time of each task are measured
+/// Set by the trace variant of make check
+#ifndef OS_TASK_RUNTIME_EN
+#define OS_TASK_RUNTIME_EN 		0
+#endif
+
+/// Define if the task stacks are painted at install to measure their peak usage.
+/// The host contexts do not run on the BRTOS virtual stacks, so it has no use in this port
+#define OS_STACK_WATERMARK_EN 	0
+
+// The Nesting define must be set in the file HAL.h
+// Example:
+/// Define if nesting interrupt is active
+//#define NESTING_INT 0
+
+/// Define Number of Priorities (8, 16, 32 or 64)
+#define NUMBER_OF_PRIORITIES 	64
+
+/// Define the scheduler implementation
+/// SCHEDULER_DEFAULT  - HAL optimized scheduler if available, otherwise the portable one
+/// SCHEDULER_PORTABLE - portable successive approximation scheduler
+/// SCHEDULER_CLZ      - count leading zeros scheduler (GCC __builtin_clz)
+/// Set by the clz variant of make check
+#ifndef SCHEDULER_TYPE
+#define SCHEDULER_TYPE 			SCHEDULER_DEFAULT
+#endif
+
+/// Enable or disable the shared priorities
+/// Several tasks may be installed at the same priority, they run in FIFO order
+/// and share the processor in time slices of RR_TIME_SLICE ticks (0 disables the slices).
+/// The task count is not limited by the TaskAlloc bits anymore.
+/// Set by the shared variant of make check
+#ifndef BRTOS_SHARED_PRIORITY_EN
+#define BRTOS_SHARED_PRIORITY_EN 	0
+#endif
+#ifndef RR_TIME_SLICE
+#define RR_TIME_SLICE 			10
+#endif
+
+/// Define the maximum number of Tasks to be Installed
+/// must always be equal or higher to NumberOfInstalledTasks
+/// The shared variant installs more tasks than the 64 TaskAlloc bits
+#if (BRTOS_SHARED_PRIORITY_EN == 1)
+#define NUMBER_OF_TASKS 		(INT8U)80
+#else
+#define NUMBER_OF_TASKS 		(INT8U)48
+#endif
+
+/// Enable or disable the dynamic task install and uninstall
+#define BRTOS_DYNAMIC_TASKS_ENABLED 1
+
+/// Defines the memory allocation and deallocation function to the dynamic queues
+#include "umm_malloc.h"
+#define BRTOS_ALLOC   umm_malloc
+#define BRTOS_DEALLOC umm_free
+
+#define configMAX_TASK_NAME_LEN 32
+
+/// Define if OS Trace is active
+/// Records the kernel events in a ring, drained with OSTraceRead or OSTraceSendSLIP
+/// and decoded on the host by tools/brtos-trace-decode.py
+/// Set by the trace variant of make check
+#ifndef OSTRACE
+#define OSTRACE 0
+#endif
+
+/// Number of records of the trace ring (8 bytes each), must be a power of 2
+#define OS_TRACE_SIZE 256
+
+/// Records the tick interrupt entry and exit
+#define OS_TRACE_TICK_EN 0
+
+/// Define if TimerHook function is active
+/// The kernel checks post a semaphore from the hook, racing with a task pend
+#define TIMER_HOOK_EN 1
+
+/// Define if IdleHook function is active
+#define IDLE_HOOK_EN 0
+
+/// Enable or disable the tickless idle mode
+/// The HAL must provide OSTicklessSleep() or OS_TICKLESS_SLEEP(ticks) must be defined here
+/// If TimerHook is active, BRTOS_TimerHookNextEvent() must also be provided
+/// Set by the tickless variant of make check
+#ifndef TICKLESS_IDLE_EN
+#define TICKLESS_IDLE_EN 0
+#endif
+
+/// Minimum idle time, in ticks, to suppress the tick timer
+#define TICKLESS_MIN_IDLE_TICKS 2
+
+/// Enable or disable timers service
+#define BRTOS_TMR_EN           1
+
+/// Max number of soft timers (up to 65534, stop and restart are O(log n))
+#define BRTOS_MAX_TIMER        64
+
+/// Enable or disable the immediate soft timers, whose callbacks run from the tick interrupt
+#define BRTOS_TMR_IMMEDIATE_EN 1
+
+/// Enable or disable the soft timers callback latency histograms
+#define BRTOS_TMR_LATENCY_EN   0
+
+/// Enable or disable semaphore controls
+#define BRTOS_SEM_EN           1
+
+/// Enable or disable binary semaphore controls
+#define BRTOS_BINARY_SEM_EN	   1
+
+/// Enable or disable the lock free semaphore pend and post when nobody waits
+/// Needs OS_CPU_CAS16 from the HAL (GCC Cortex-M3/M4 and POSIX ports), ignored otherwise
+/// BRTOS.h turns it off in the trace variant of make check, keep that on a second include
+#ifndef BRTOS_SEM_FAST_EN
+#define BRTOS_SEM_FAST_EN      1
+#endif
+
+/// Enable or disable mutex controls
+#define BRTOS_MUTEX_EN         1
+
+/// Enable or disable the priority inheritance mutexes, created with MUTEX_PRIORITY_INHERITANCE
+/// instead of a ceiling priority. The owner only runs at the priority of the tasks blocked on the mutex
+/// Set by the objects variant of make check
+#ifndef BRTOS_MUTEX_INHERITANCE_EN
+#define BRTOS_MUTEX_INHERITANCE_EN 0
+#endif
+
+/// Enable or disable the mutex contention counter and hold time measurement (OSMutexQuery)
+/// Set by the objects variant of make check
+#ifndef BRTOS_MUTEX_STATS_EN
+#define BRTOS_MUTEX_STATS_EN   0
+#endif
+
+/// Enable or disable mailbox controls
+#define BRTOS_MBOX_EN          1
+
+/// Enable or disable the multi-slot mailboxes (OSMboxCreateMulti) and the broadcast post (OSMboxPostAll)
+#define BRTOS_MBOX_MULTI_EN    1
+
+/// Defines the maximum number of messages kept by a multi-slot mailbox
+#define BRTOS_MBOX_MAX_SLOTS   4
+
+/// Enable or disable queue controls
+#define BRTOS_QUEUE_EN         1
+
+/// Enable or disable event groups and the wait for multiple semaphores, mailboxes and queues
+/// Set by the objects variant of make check
+#ifndef BRTOS_EVENT_GROUP_EN
+#define BRTOS_EVENT_GROUP_EN   0
+#endif
+
+/// Enable or disable dynamic queue controls
+#define BRTOS_DYNAMIC_QUEUE_ENABLED	1
+
+/// Enable or disable the pools of fixed size memory blocks
+/// The pools added with OSMemHeapAdd can back the dynamic tasks and queues by defining
+/// BRTOS_ALLOC as OSMemAlloc and BRTOS_DEALLOC as OSMemFree
+/// Set by the objects variant of make check
+#ifndef BRTOS_MEMPOOL_EN
+#define BRTOS_MEMPOOL_EN       0
+#endif
+
+/// Enable or disable the message queues (pool allocated messages passed by reference)
+/// Needs the dynamic queue controls and the memory pools
+/// Set by the objects variant of make check
+#ifndef BRTOS_MSG_QUEUE_EN
+#define BRTOS_MSG_QUEUE_EN     0
+#endif
+
+/// Enable or disable the work queue, a worker task that runs the functions queued by the interrupts
+/// Installed by OSWorkQueueInit, holds BRTOS_WORKQ_SIZE work items (default 16)
+/// Set by the objects variant of make check
+#ifndef BRTOS_WORKQ_EN
+#define BRTOS_WORKQ_EN         0
+#endif
+
+/// Enable or disable the single producer / single consumer queue
+/// Needs the binary semaphores and the BRTOS memory allocation method
+#ifndef BRTOS_SPSC_QUEUE_EN
+#define BRTOS_SPSC_QUEUE_EN    0
+#endif
+
+/// Enable or disable queue 16 bits controls
+#define BRTOS_QUEUE_16_EN      0
+
+/// Enable or disable queue 32 bits controls
+#define BRTOS_QUEUE_32_EN      0
+
+/// Defines the maximum number of semaphores\n
+/// Limits the memory allocation for semaphores
+#define BRTOS_MAX_SEM          20
+
+/// Defines the maximum number of mutexes\n
+/// Limits the memory allocation for mutex
+#define BRTOS_MAX_MUTEX        4
+
+/// Defines the maximum number of mailboxes\n
+/// Limits the memory allocation mailboxes
+#define BRTOS_MAX_MBOX         5
+
+/// Defines the maximum number of queues\n
+/// Limits the memory allocation for queues
+#define BRTOS_MAX_QUEUE        20
+
+/// Defines the maximum number of event groups\n
+/// Limits the memory allocation for event groups
+#define BRTOS_MAX_EVENT_GROUP  4
+
+/// Defines the maximum number of memory pools\n
+/// Each message pool uses one memory pool
+#define BRTOS_MAX_MEMPOOL      4
+
+
+/// TickTimer Defines
+#define configCPU_CLOCK_HZ          	(INT32U)168000000   ///< CPU clock in Hertz
+
+#if (THREAD_METRIC == 1)
+	#define configTICK_RATE_HZ          (INT32U)100         ///< Tick timer rate in Hertz
+#else
+	#define configTICK_RATE_HZ          (INT32U)1000        ///< Tick timer rate in Hertz
+#endif
+
+#define configTIMER_PRE_SCALER      0                   ///< Informs if there is a timer prescaler
+#define configRTC_CRISTAL_HZ        (INT32U)1000
+#define configRTC_PRE_SCALER        10
+#define OSRTCEN                     0
+
+
+
+// Stack Size of the Idle Task
+#define IDLE_STACK_SIZE             (INT16U)512
+
+
+/// Stack Defines
+/// Not used with the dynamic tasks
+#define HEAP_SIZE 8*128
+
+// Queue heap defines
+#define QUEUE_HEAP_SIZE 8*128
+
+// Dynamic head define. To be used by DynamicInstallTask and Dynamic Queues
+// The tasks run on host stacks, only the BRTOS side of the stacks is allocated here
+#define DYNAMIC_HEAP_SIZE		32*1024
+
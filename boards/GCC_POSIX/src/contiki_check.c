@@ -0,0 +1,534 @@
+/**
+* \file contiki_check.c
+* \brief Checks of the Contiki platform glue on the POSIX simulation port
+*
+* Runs the MRF24J40 driver on the emulated radio of mrf24j40_emu.c and checks that a
+* frame is moved to or from a FIFO in one SPI transaction, without framing errors and
+* with the SPI counters of the driver matching the transactions seen by the radio.
+*
+* The transmissions are completed by an air task after a number of ticks, or never, to
+* check that the sending task blocks on tx_sem while a lower priority task runs, that
+* TXSTAT is mapped to the radio result, that the TXNIF timeout ends a transmission and
+* that the late completion of a timed out transmission does not end the next one.
+*
+* Frames are received with the driver process held back to check that the frames past
+* the RX ring size are counted as overruns and flushed from the radio, and then in
+* batches of many times the ring size to check that the ring indices wrap, with every
+* frame handed to the RDC in order.
+*
+* A chain of rtimers, each one scheduled from the callback of the previous one, checks
+* that the timerfd backend never fires early and measures how late it fires.
+*
+* The processes run in two partitions, partition 0 in a task of priority 12 and
+* partition 1 in the task of priority 8 of contiki-partition.c. A poll of partition 0
+* must be dispatched while a long handler of partition 1 runs, and the handler must find
+* its own process context when it resumes.
+*
+* The program exits with an error if a check fails, which make check uses.
+*
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "BRTOS.h"
+#include "contiki.h"
+#include "net/packetbuf.h"
+#include "net/netstack.h"
+#include "dev/radio.h"
+#include "sys/rtimer.h"
+#include "mrf24j40.h"
+#include "mrf24j40_emu.h"
+
+#define CHECK_TASK_PRIO       10
+#define CHECK_AIR_PRIO        20
+#define CHECK_SPIN_PRIO       5
+#define CHECK_FRAME_LEN       MRF24J40_MAX_PAYLOAD
+
+// Airtime of a delayed completion and TXNIF timeout of the driver, in ticks
+#define CHECK_AIR_TICKS       5
+#define CHECK_TX_TIMEOUT      50
+
+// TXSTAT flags
+#define TXSTAT_TXNSTAT        0x01
+#define TXSTAT_CCAFAIL        0x20
+
+// Frames of the RX ring wrap check
+#define CHECK_RX_SLOTS        MRF24J40_CONF_RX_SLOTS
+#define CHECK_RX_FRAMES       300
+
+// rtimer chain of the jitter check, the period is about 1 ms
+#define CHECK_RTIMER_COUNT    200
+#define CHECK_RTIMER_PERIOD   (RTIMER_ARCH_SECOND / 1000 + 1)
+#define CHECK_RTIMER_MAX_LATE (RTIMER_ARCH_SECOND / 100)
+
+// Tasks of the partitions, 8 is CONTIKI_CONF_PARTITION_PRIORITIES of the Makefile
+#define CHECK_CONTIKI_PRIO    12
+#define CHECK_SLOW_TICKS      20
+
+// How the radio completes a transmission
+enum
+{
+  TX_NOW,                   // from the TXNTRIG write
+  TX_LATER,                 // from the air task after CHECK_AIR_TICKS
+  TX_NEVER                  // TXNIF is lost
+};
+
+static int failures;
+
+BRTOS_Sem *Contiki_Sem;
+
+static uint8_t air_frame[128];
+static uint8_t air_len;
+static volatile uint8_t air_mode = TX_NOW;
+static volatile uint8_t air_txstat;
+static BRTOS_Sem *air_sem;
+static volatile uint32_t spin_count;
+static uint32_t rdc_frames;
+static uint32_t rdc_errors;
+static uint8_t rdc_next_seq;
+static struct rtimer chain_rtimer;
+static BRTOS_Sem *rtimer_sem;
+static volatile rtimer_clock_t rtimer_due;
+static volatile uint16_t rtimer_fired;
+static volatile uint16_t rtimer_early;
+static volatile rtimer_clock_t rtimer_max_late;
+static BRTOS_Sem *slow_sem;
+static volatile uint8_t slow_running;
+static volatile uint8_t slow_context;
+static volatile uint8_t fast_polls;
+static volatile uint8_t fast_preempted;
+
+PROCESS(slow_process, "slow");
+PROCESS(fast_process, "fast");
+
+/* Length of the frame of a sequence number */
+#define RX_FRAME_LEN(seq)     ((uint8_t)(10 + ((seq) % 100)))
+
+/*
+ * The RDC of the harness, it takes the frames handed by the driver process.
+ * Replaces the null RDC of the POSIX board configuration.
+ */
+static void rdc_input(void)
+{
+  const uint8_t *data = packetbuf_dataptr();
+
+  // the first byte of a frame is its sequence number
+  if ((data[0] != rdc_next_seq) || (packetbuf_datalen() != RX_FRAME_LEN(rdc_next_seq)))
+  {
+    rdc_errors++;
+  }
+  rdc_next_seq = (uint8_t)(data[0] + 1);
+  rdc_frames++;
+}
+
+const struct rdc_driver nullrdc_driver = {
+  .name  = "check",
+  .input = rdc_input,
+};
+
+static void check(int ok, const char *name)
+{
+  printf("%-36s %s\n", name, ok ? "ok" : "FAILED");
+  if (!ok) failures++;
+}
+
+/* Copies the frame of each transmission and completes it as told by air_mode */
+static void radio_tx_hook(const uint8_t *frame, uint8_t len)
+{
+  memcpy(air_frame, frame, len);
+  air_len = len;
+  switch (air_mode)
+  {
+    case TX_NOW:
+      mrf24j40_emu_tx_done(air_txstat);
+      break;
+    case TX_LATER:
+      (void)OSSemPost(air_sem);
+      break;
+    default:
+      break;
+  }
+}
+
+/* Completes a delayed transmission after its airtime */
+static void air_task(void *param)
+{
+  (void)param;
+
+  for (;;)
+  {
+    (void)OSSemPend(air_sem, 0);
+    (void)DelayTask(CHECK_AIR_TICKS);
+    mrf24j40_emu_tx_done(air_txstat);
+  }
+}
+
+/* Runs only while the higher priority tasks are blocked */
+static void spin_task(void *param)
+{
+  (void)param;
+
+  for (;;)
+  {
+    spin_count++;
+  }
+}
+
+static INT16U ticks_since(INT16U start)
+{
+  INT16U now = OSGetTickCount();
+
+  return (now >= start) ? (INT16U)(now - start) : (INT16U)(TICK_COUNT_OVERFLOW - start + now);
+}
+
+/* Sends a frame, returning the radio result, the ticks it took and whether the spin task ran */
+static int send_frame(uint8_t mode, uint8_t txstat, INT16U *ticks, int *spun)
+{
+  static uint8_t frame[16];
+  uint32_t spin;
+  INT16U start;
+  int ret;
+
+  air_mode = mode;
+  air_txstat = txstat;
+  (void)mrf24j40_driver.prepare(frame, sizeof(frame));
+
+  spin = spin_count;
+  start = OSGetTickCount();
+  ret = mrf24j40_driver.transmit(sizeof(frame));
+  *ticks = ticks_since(start);
+  *spun = spin_count != spin;
+
+  air_mode = TX_NOW;
+  air_txstat = 0;
+  return ret;
+}
+
+static void fill_frame(uint8_t *frame, uint8_t len, uint8_t seq)
+{
+  uint8_t i;
+
+  for (i = 0; i < len; i++)
+  {
+    frame[i] = (uint8_t)(seq + i * 7);
+  }
+}
+
+/* A whole frame is one SPI transaction, and the driver counts what the radio sees */
+static void check_burst(void)
+{
+  MRF24J40_EMU_STATS emu;
+  uint8_t frame[CHECK_FRAME_LEN];
+  uint8_t buf[CHECK_FRAME_LEN];
+  uint32_t transactions, bytes;
+  int len;
+
+  fill_frame(frame, CHECK_FRAME_LEN, 1);
+
+  // header length, frame length and the frame after the two address bytes
+  mrf24j40_emu_stats(&emu, 1);
+  mrf24j40_get_spi_stats(&transactions, &bytes, 1);
+  (void)mrf24j40_set_txfifo(frame, CHECK_FRAME_LEN);
+  mrf24j40_emu_stats(&emu, 0);
+  mrf24j40_get_spi_stats(&transactions, &bytes, 0);
+  check((emu.transactions == 1) && (emu.bytes == (4 + CHECK_FRAME_LEN)) && (emu.errors == 0),
+        "TX FIFO burst write");
+  check((transactions == emu.transactions) && (bytes == emu.bytes), "TX FIFO SPI counters");
+
+  air_len = 0;
+  (void)mrf24j40_driver.transmit(CHECK_FRAME_LEN);
+  check((air_len == CHECK_FRAME_LEN) && (memcmp(air_frame, frame, CHECK_FRAME_LEN) == 0),
+        "TX FIFO contents");
+
+  // the interrupt reads INTSTAT, stops the reception, reads the frame in one burst
+  // with the FCS, the LQI and the RSSI, and restarts the reception
+  fill_frame(frame, CHECK_FRAME_LEN, 2);
+  mrf24j40_emu_stats(&emu, 1);
+  mrf24j40_get_spi_stats(&transactions, &bytes, 1);
+  (void)mrf24j40_emu_receive(frame, CHECK_FRAME_LEN, 0x55, 0x66);
+  mrf24j40_emu_stats(&emu, 0);
+  mrf24j40_get_spi_stats(&transactions, &bytes, 0);
+  check((emu.transactions == 4) && (emu.bytes == (2 + 2 + 7 + CHECK_FRAME_LEN + 2)) && (emu.errors == 0),
+        "RX FIFO burst read");
+  check((transactions == emu.transactions) && (bytes == emu.bytes), "RX FIFO SPI counters");
+
+  len = mrf24j40_driver.read(buf, sizeof(buf));
+  check((len == CHECK_FRAME_LEN) && (memcmp(buf, frame, CHECK_FRAME_LEN) == 0) &&
+        (mrf24j40_get_last_lqi() == 0x55) && (mrf24j40_get_last_rssi() == 0x66), "RX FIFO contents");
+
+  // the driver process finds the ring empty
+  while (process_run() > 0)
+  {
+  }
+}
+
+/* The sending task blocks on tx_sem until TXNIF, with a timeout */
+static void check_tx_sem(void)
+{
+  INT16U ticks;
+  int spun;
+  int ret;
+
+  ret = send_frame(TX_LATER, 0, &ticks, &spun);
+  check((ret == RADIO_TX_OK) && (ticks >= CHECK_AIR_TICKS) && (ticks < CHECK_TX_TIMEOUT) && spun,
+        "TX blocks until TXNIF");
+
+  ret = send_frame(TX_NOW, TXSTAT_TXNSTAT | TXSTAT_CCAFAIL, &ticks, &spun);
+  check(ret == RADIO_TX_COLLISION, "TX channel busy status");
+  ret = send_frame(TX_NOW, TXSTAT_TXNSTAT, &ticks, &spun);
+  check(ret == RADIO_TX_NOACK, "TX no acknowledgement status");
+
+  ret = send_frame(TX_NEVER, 0, &ticks, &spun);
+  check((ret == RADIO_TX_ERR) && (ticks >= CHECK_TX_TIMEOUT) && spun, "TX TXNIF timeout");
+
+  // the completion of the timed out transmission posts tx_sem, the next
+  // transmission must drop it and still wait for its own TXNIF
+  mrf24j40_emu_tx_done(0);
+  ret = send_frame(TX_LATER, 0, &ticks, &spun);
+  check((ret == RADIO_TX_OK) && (ticks >= CHECK_AIR_TICKS) && spun, "TX late completion dropped");
+}
+
+static void receive_frame(uint8_t seq)
+{
+  uint8_t frame[CHECK_FRAME_LEN];
+
+  fill_frame(frame, RX_FRAME_LEN(seq), seq);
+  (void)mrf24j40_emu_receive(frame, RX_FRAME_LEN(seq), 0, 0);
+}
+
+/* The RX ring keeps the oldest frames when full, and its indices wrap */
+static void check_rx_ring(void)
+{
+  struct mrf24j40_rx_stats stats;
+  MRF24J40_EMU_STATS emu;
+  uint8_t batch, j;
+  uint8_t seq = 0;
+  uint16_t i;
+
+  mrf24j40_get_rx_stats(&stats, 1);
+  mrf24j40_emu_stats(&emu, 1);
+  rdc_frames = 0;
+  rdc_errors = 0;
+  rdc_next_seq = seq;
+
+  // the process does not run, the last two frames find the ring full
+  for (i = 0; i < (CHECK_RX_SLOTS + 2); i++)
+  {
+    receive_frame(seq++);
+  }
+  mrf24j40_get_rx_stats(&stats, 0);
+  mrf24j40_emu_stats(&emu, 0);
+  check((stats.frames == CHECK_RX_SLOTS) && (stats.overruns == 2) && (stats.max_used == CHECK_RX_SLOTS) &&
+        (emu.flushes == 2), "RX ring overrun");
+
+  while (process_run() > 0)
+  {
+  }
+  check((rdc_frames == CHECK_RX_SLOTS) && (rdc_errors == 0), "RX ring oldest frames kept");
+
+  // the frames lost to the overrun are skipped
+  mrf24j40_get_rx_stats(&stats, 1);
+  rdc_frames = 0;
+  rdc_next_seq = seq;
+
+  for (i = 0; i < CHECK_RX_FRAMES; i += batch)
+  {
+    batch = (CHECK_RX_SLOTS > 1) ? (CHECK_RX_SLOTS - 1) : 1;
+    if (batch > (CHECK_RX_FRAMES - i)) batch = (uint8_t)(CHECK_RX_FRAMES - i);
+
+    for (j = 0; j < batch; j++)
+    {
+      receive_frame(seq++);
+    }
+    while (process_run() > 0)
+    {
+    }
+  }
+  mrf24j40_get_rx_stats(&stats, 0);
+  check((rdc_frames == CHECK_RX_FRAMES) && (rdc_errors == 0) && (stats.frames == CHECK_RX_FRAMES) &&
+        (stats.overruns == 0) && (stats.drops == 0), "RX ring index wrap");
+}
+
+/* Measures the lateness of the rtimer and schedules the next one of the chain */
+static void rtimer_callback(struct rtimer *t, void *ptr)
+{
+  const rtimer_clock_t now = RTIMER_NOW();
+  rtimer_clock_t late;
+
+  (void)ptr;
+
+  if (RTIMER_CLOCK_LT(now, rtimer_due))
+  {
+    rtimer_early++;
+  }
+  else
+  {
+    late = (rtimer_clock_t)(now - rtimer_due);
+    if (late > rtimer_max_late) rtimer_max_late = late;
+  }
+
+  if (++rtimer_fired < CHECK_RTIMER_COUNT)
+  {
+    rtimer_due = (rtimer_clock_t)(now + CHECK_RTIMER_PERIOD);
+    (void)rtimer_set(t, rtimer_due, 1, rtimer_callback, NULL);
+  }
+  else
+  {
+    (void)OSSemPost(rtimer_sem);
+  }
+}
+
+/* The rtimer fires in interrupt context, never before its time */
+static void check_rtimer(void)
+{
+  rtimer_fired = 0;
+  rtimer_early = 0;
+  rtimer_max_late = 0;
+
+  rtimer_due = (rtimer_clock_t)(RTIMER_NOW() + CHECK_RTIMER_PERIOD);
+  (void)rtimer_set(&chain_rtimer, rtimer_due, 1, rtimer_callback, NULL);
+
+  // the whole chain takes about CHECK_RTIMER_COUNT ms
+  (void)OSSemPend(rtimer_sem, 10 * CHECK_RTIMER_COUNT);
+
+  printf("rtimer fire jitter: %u fired, %u late ticks at most\n", rtimer_fired, rtimer_max_late);
+  check(rtimer_fired == CHECK_RTIMER_COUNT, "rtimer chain fired");
+  check((rtimer_early == 0) && (rtimer_max_late <= CHECK_RTIMER_MAX_LATE), "rtimer fire jitter");
+}
+
+/* A handler of partition 1 that keeps the CPU for CHECK_SLOW_TICKS */
+PROCESS_THREAD(slow_process, ev, data)
+{
+  INT16U start;
+
+  PROCESS_BEGIN();
+
+  for (;;)
+  {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    slow_running = 1;
+    start = OSGetTickCount();
+    while (ticks_since(start) < CHECK_SLOW_TICKS)
+    {
+    }
+    slow_context = (PROCESS_CURRENT() == &slow_process);
+    slow_running = 0;
+
+    (void)OSSemPost(slow_sem);
+  }
+
+  PROCESS_END();
+}
+
+/* A handler of partition 0, telling whether it preempted the slow one */
+PROCESS_THREAD(fast_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  for (;;)
+  {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    fast_preempted = slow_running;
+    fast_polls++;
+  }
+
+  PROCESS_END();
+}
+
+/* Runs partition 0, as the contiki_main task does */
+static void contiki_task(void *param)
+{
+  (void)param;
+
+  for (;;)
+  {
+    while (process_run_partition(0) > 0)
+    {
+    }
+
+    (void)OSSemPend(Contiki_Sem, 0);
+  }
+}
+
+/* A poll of partition 0 does not wait for a handler of partition 1 */
+static void check_partitions(void)
+{
+  struct process_partition_stats stats0, stats1;
+
+  process_set_partition(&slow_process, 1);
+  process_start(&slow_process, NULL);
+  process_start(&fast_process, NULL);
+
+  contiki_partitions_start();
+  if (InstallTask(&contiki_task, "Contiki", 512, CHECK_CONTIKI_PRIO, NULL, NULL) != OK) exit(1);
+  (void)DelayTask(1);
+
+  process_partition_stats(0, &stats0, 1);
+  process_partition_stats(1, &stats1, 1);
+
+  // partition 1 enters its slow handler while this task sleeps
+  process_poll(&slow_process);
+  (void)DelayTask(2);
+
+  process_poll(&fast_process);
+  (void)OSSemPend(slow_sem, 10 * CHECK_SLOW_TICKS);
+
+  process_partition_stats(0, &stats0, 0);
+  process_partition_stats(1, &stats1, 0);
+
+  printf("partition dispatch latency: %lu ticks in partition 0, %lu in partition 1\n",
+         stats0.max_latency, stats1.max_latency);
+  check((fast_polls == 1) && fast_preempted && (stats0.polls == 1) && (stats0.max_latency <= 1),
+        "partition preempts a lower handler");
+  check((stats1.polls == 1) && slow_context && !slow_running, "process context after preemption");
+}
+
+static void check_task(void *param)
+{
+  MRF24J40_EMU_STATS emu;
+
+  (void)param;
+
+  mrf24j40_emu_set_tx_hook(radio_tx_hook);
+  (void)mrf24j40_driver.init();
+
+  mrf24j40_emu_stats(&emu, 0);
+  check(emu.errors == 0, "radio init SPI framing");
+
+  check_burst();
+  check_tx_sem();
+  check_rx_ring();
+  check_rtimer();
+  check_partitions();
+
+  if (failures) printf("%d checks FAILED\n", failures);
+  exit(failures ? 1 : 0);
+}
+
+int main(void)
+{
+  BRTOS_Init();
+
+  if (OSSemCreate(0, &Contiki_Sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &air_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &rtimer_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &slow_sem) != ALLOC_EVENT_OK) exit(1);
+
+  clock_init();
+  process_init();
+  contiki_partitions_init();
+  rtimer_init();
+
+  if (InstallTask(&check_task, "Check", 512, CHECK_TASK_PRIO, NULL, NULL) != OK) exit(1);
+  if (InstallTask(&air_task, "Air", 256, CHECK_AIR_PRIO, NULL, NULL) != OK) exit(1);
+  if (InstallTask(&spin_task, "Spin", 256, CHECK_SPIN_PRIO, NULL, NULL) != OK) exit(1);
+
+  // Start Task Scheduler
+  if (BRTOSStart() != OK) exit(1);
+
+  return 0;
+}
@@ -0,0 +1,1433 @@
+/**
+* \file main.c
+* \brief BRTOS kernel benchmarks on the POSIX simulation port
+*
+* Measures the cost of the scheduler, SAScheduler on a set of ready lists and OSSchedule,
+* for the SCHEDULER_TYPE of the build (the clz variant of make check uses SCHEDULER_CLZ),
+* the cost of the tick handler with 4, 16 and 32 tasks in the delay list, the start,
+* stop and expiration of the soft timers among BENCH_TIMERS running timers,
+* the context switch through a semaphore ping-pong and its latency, from the post to
+* the woken task, the queue
+* throughput, byte by byte and in bulk, and the fan out of a message to several
+* tasks, by one mailbox per task or by a broadcast. The results are printed in host time,
+* so the program can be profiled with perf:
+*
+*   make && perf record ./brtos-posix 200000 && perf report
+*
+* Before the benchmarks, the kernel checks verify that the delays and the soft timers
+* expire on their tick, also with the tick suppressed by the tickless idle, that a
+* bulk queue read times out on time when its wake ups are taken by a higher priority task,
+* that no count is lost or taken twice when the tick hook posts a semaphore while a task
+* pends on it, and that the entries of a dynamic queue are copied whole through the buffer
+* wrap around.
+* The spsc variant posts to the single producer / single consumer queue from a virtual
+* interrupt, raised by a host thread, and checks that the consumer reads every post in
+* order. The objects variant enables the event groups and checks that the flag of a
+* linked semaphore stays set while it keeps a count, and that a mutex can be linked.
+* It also checks that the blocks of a memory pool do not overlap and that a put wakes the
+* task waiting for a block.
+* It checks that the messages left in a deleted message queue return to their pool.
+* It builds umm_malloc with the segregated fit policy and checks the heap integrity.
+* It checks that the work submitted by an interrupt runs in order in the worker task.
+* It checks that the owner of an inheritance mutex is not kept from running by a middle
+* priority task.
+* The trace variant checks that the trace ring keeps the events of a task in order and
+* counts the records lost.
+* It also checks that the processor time of a spinning task is measured.
+* The program exits with an error if a check fails, which make check uses on every
+* kernel variant.
+* The shared variant also checks the FIFO order and the time slices of the tasks of a
+* priority, also with a task of the priority timing out on another semaphore, and runs the latency benchmark with BENCH_SHARED_TASKS tasks at the priority
+* of the woken task, to compare with the unique priorities of the default build.
+*
+**/
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "BRTOS.h"
+#if (BRTOS_TMR_EN == 1)
+#include "stimer.h"
+#endif
+
+#define BENCH_DEFAULT_LOOPS   100000
+#define BENCH_BLOCK_SIZE      64
+#define BENCH_FAN_OUT         4
+#define BENCH_SCHED_LISTS     64
+#define BENCH_TICK_TASKS      32
+#define BENCH_TICKS           10000
+#define BENCH_TICK_TIMEOUT    30000
+#define BENCH_TIMERS          32
+#define BENCH_TIMER_BATCHES   20
+#define CHECK_LATE_MS         20.0
+#define CHECK_TRIES           3
+#define BENCH_LATENCY_PRIO    18
+#define BENCH_SHARED_TASKS    24
+#define CHECK_FIFO_TASKS      3
+#define CHECK_FIFO_PRIO       17
+#define CHECK_SLICE_TASKS     2
+#define CHECK_SLICE_PRIO      9
+#define CHECK_SLICE_TICKS     40
+#define CHECK_PEND_PRIO       7
+#define CHECK_PEND_TICKS      30
+#define CHECK_PEND_STEALS     5
+#define CHECK_HOOK_TICKS      200
+#define CHECK_HOOK_POSTS      4
+#define CHECK_SPSC_PRIO       6
+#define CHECK_SPSC_LENGTH     8
+#define CHECK_SPSC_ITEMS      20000
+#define CHECK_SPSC_TICKS      2
+#define CHECK_SPSC_IRQ        1
+#define CHECK_MUTEX_PRIO      15
+#define CHECK_POOL_BLOCKS     4
+#define CHECK_POOL_SMALL      16
+#define CHECK_POOL_LARGE      64
+#define CHECK_POOL_TICKS      3
+#define CHECK_MSG_BLOCKS      4
+#define CHECK_WORKQ_PRIO      16
+#define CHECK_WORKQ_IRQ       2
+#define CHECK_WORK_ITEMS      (BRTOS_WORKQ_SIZE + 4)
+#define CHECK_PI_LOW_PRIO     2
+#define CHECK_PI_MID_PRIO     5
+#define CHECK_PI_TICKS        20
+#define CHECK_RUNTIME_PRIO    3
+#define CHECK_RUNTIME_TICKS   20
+
+static unsigned long loops = BENCH_DEFAULT_LOOPS;
+static int failures;
+
+static BRTOS_Sem   *ping_sem;
+static BRTOS_Sem   *pong_sem;
+static BRTOS_Sem   *done_sem;
+static BRTOS_Queue *bench_queue;
+static BRTOS_Sem   *tick_start_sem;
+static BRTOS_Sem   *tick_hold_sem;
+static BRTOS_Sem   *latency_sem;
+static volatile double switch_start;
+static BRTOS_Queue *pend_queue;
+static BRTOS_Sem   *pend_start_sem;
+static BRTOS_Sem   *pend_done_sem;
+static INT8U pend_result;
+static INT32U pend_ticks;
+static BRTOS_Mutex *check_mutex;
+static BRTOS_Sem   *hook_sem;
+static volatile INT16U hook_ticks_left;
+static volatile unsigned long hook_posts;
+#if (BRTOS_SPSC_QUEUE_EN == 1)
+static BRTOS_SPSC_Queue *spsc_queue;
+static BRTOS_Sem   *spsc_start_sem;
+static BRTOS_Sem   *spsc_done_sem;
+static volatile int spsc_stop;
+static INT32U spsc_next;
+static unsigned long spsc_full;
+static unsigned long spsc_errors;
+static unsigned long spsc_timeouts;
+#endif
+#if (BRTOS_MEMPOOL_EN == 1)
+static OS_MEM_POOL_DECLARE(small_pool_mem, CHECK_POOL_BLOCKS, CHECK_POOL_SMALL);
+static OS_MEM_POOL_DECLARE(large_pool_mem, CHECK_POOL_BLOCKS, CHECK_POOL_LARGE);
+static BRTOS_MemPool *small_pool;
+static BRTOS_MemPool *large_pool;
+static void *pool_block;
+#endif
+#if (BRTOS_WORKQ_EN == 1)
+static int work_order[CHECK_WORK_ITEMS];
+static int work_done;
+static int work_refused;
+#endif
+#if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+static BRTOS_Mutex *pi_mutex;
+static BRTOS_Sem   *pi_low_sem;
+static BRTOS_Sem   *pi_mid_sem;
+static volatile int pi_stop;
+#endif
+#if (OS_TASK_RUNTIME_EN == 1)
+static BRTOS_Sem   *runtime_sem;
+static BRTOS_TH    runtime_th;
+static volatile int runtime_stop;
+#endif
+static double switch_latency;
+#if (BRTOS_SHARED_PRIORITY_EN == 1)
+static BRTOS_Sem   *peer_sem;
+static BRTOS_Sem   *fifo_sem;
+static BRTOS_Sem   *fifo_other_sem;
+static BRTOS_Sem   *slice_sem;
+static int fifo_order[2 * CHECK_FIFO_TASKS];
+static int fifo_woken;
+static volatile int fifo_other_stop;
+static int fifo_other_posts;
+static int fifo_other_timeouts;
+static volatile int slice_stop;
+static volatile unsigned long slice_count[CHECK_SLICE_TASKS];
+#endif
+#if (BRTOS_MBOX_MULTI_EN == 1)
+static BRTOS_Mbox  *fan_mbox[BENCH_FAN_OUT];
+static BRTOS_Mbox  *broadcast_mbox;
+static unsigned long fan_sample;
+static unsigned long fan_received;
+#endif
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void report(const char *name, double ns, unsigned long n, const char *unit)
+{
+  printf("%-28s %10.1f ns/%s  %12.0f %s/s\n", name, ns / (double)n, unit, (double)n * 1e9 / ns, unit);
+}
+
+static void check(int ok, const char *name)
+{
+  printf("%-28s %s\n", name, ok ? "ok" : "FAILED");
+  if (!ok) failures++;
+}
+
+
+#if (BRTOS_TMR_EN == 1)
+static volatile INT32U timer_fired;
+static volatile double timer_fired_ns;
+
+static TIMER_CNT timer_cb(void)
+{
+  timer_fired = OSGetMonotonicCount();
+  timer_fired_ns = now_ns();
+  return 0;
+}
+
+static volatile unsigned long timer_batch;
+static volatile double timer_first_ns;
+static volatile double timer_last_ns;
+
+/* Callback of the timer benchmark, times the first and the last callback of a batch */
+static TIMER_CNT bench_timer_cb(void)
+{
+  double t = now_ns();
+
+  if (timer_batch == 0) timer_first_ns = t;
+  timer_last_ns = t;
+  timer_batch++;
+  return 0;
+}
+
+/* Soft timer of the given class, started at a tick boundary and left to expire in the idle */
+static void check_timer(INT8U immediate, INT16U ticks)
+{
+  BRTOS_TIMER timer;
+  char name[32];
+  INT32U start;
+  double t;
+  int tries, ok;
+
+  // a tick signal delayed by the host adds a tick, then the measure is taken again
+  for (tries = 0, ok = FALSE; !ok && (tries < CHECK_TRIES); tries++)
+  {
+    (void)DelayTask(1);
+    timer_fired = 0;
+    start = OSGetMonotonicCount();
+    t = now_ns();
+    #if (BRTOS_TMR_IMMEDIATE_EN == 1)
+    if (immediate)
+    {
+      (void)OSTimerSetImmediate(&timer, timer_cb, ticks);
+    }
+    else
+    #endif
+    {
+      (void)OSTimerSet(&timer, timer_cb, ticks);
+    }
+    (void)DelayTask((INT16U)(ticks + 2));
+    t = (timer_fired_ns - t) / 1e6;
+    ok = (timer_fired == (start + ticks)) && (t > (double)(ticks - 1)) && (t < ((double)ticks + CHECK_LATE_MS));
+    (void)OSTimerStop(timer, 1);
+  }
+
+  snprintf(name, sizeof(name), "%s timer of %u ticks", immediate ? "immediate" : "deferred", ticks);
+  check(ok, name);
+}
+#endif
+
+/* The delays and the soft timers must expire on their tick, with or without the tick suppressed */
+static void check_ticks(void)
+{
+  static const INT16U delays[] = {1, 2, 5, 20, 100};
+  char name[32];
+  INT32U start;
+  INT32U signals;
+  INT32U ticks;
+  unsigned int i;
+  int tries, ok;
+  double t;
+
+  for (i = 0; i < sizeof(delays) / sizeof(delays[0]); i++)
+  {
+    // a tick signal delayed by the host adds a tick, then the measure is taken again
+    for (tries = 0, ok = FALSE; !ok && (tries < CHECK_TRIES); tries++)
+    {
+      // starts right after a tick, so the delay is counted from this tick
+      (void)DelayTask(1);
+      start = OSGetMonotonicCount();
+      signals = OSPosixTickSignals;
+      t = now_ns();
+      (void)DelayTask(delays[i]);
+      t = (now_ns() - t) / 1e6;
+      ticks = OSGetMonotonicCount() - start;
+      signals = OSPosixTickSignals - signals;
+      ok = (ticks == delays[i]) && (t > (double)(delays[i] - 1)) && (t < ((double)delays[i] + CHECK_LATE_MS));
+    }
+
+    snprintf(name, sizeof(name), "delay of %u ticks", delays[i]);
+    check(ok, name);
+  }
+
+  // the last delay was idle, the tick must have been suppressed
+  #if (TICKLESS_IDLE_EN == 1)
+  printf("  %u tick signals in %u ticks\n", (unsigned int)signals, (unsigned int)ticks);
+  check(signals < (ticks / 4), "tick suppressed in idle");
+  #endif
+
+  #if (BRTOS_TMR_EN == 1)
+  check_timer(FALSE, 3);
+  check_timer(FALSE, 50);
+  #if (BRTOS_TMR_IMMEDIATE_EN == 1)
+  check_timer(TRUE, 3);
+  check_timer(TRUE, 50);
+  #endif
+  #endif
+}
+
+
+/* Selects the highest priority of BENCH_SCHED_LISTS ready lists, then runs the whole OSSchedule */
+static void bench_schedule(void)
+{
+  OS_SR_SAVE_VAR
+  PriorityType lists[BENCH_SCHED_LISTS];
+  INT32U seed = 12345;
+  unsigned long n;
+  volatile INT8U sink = 0;
+  int i, j;
+  double t;
+
+  // the idle task is always ready, plus one to four random priorities
+  for (i = 0; i < BENCH_SCHED_LISTS; i++)
+  {
+    lists[i] = PriorityMask[0];
+    for (j = 0; j <= (i & 3); j++)
+    {
+      seed = seed * 1103515245u + 12345u;
+      lists[i] |= PriorityMask[(seed >> 16) % NUMBER_OF_PRIORITIES];
+    }
+  }
+
+  OSEnterCritical();
+  t = now_ns();
+  for (n = 0; n < loops; n++)
+  {
+    for (i = 0; i < BENCH_SCHED_LISTS; i++)
+    {
+      sink = SAScheduler(lists[i]);
+    }
+  }
+  t = now_ns() - t;
+  OSExitCritical();
+  report("SAScheduler", t, loops * BENCH_SCHED_LISTS, "call");
+
+  // the bench task is selected again, no context switch
+  OSEnterCritical();
+  t = now_ns();
+  for (n = 0; n < loops; n++)
+  {
+    sink = OSSchedule();
+  }
+  t = now_ns() - t;
+  OSExitCritical();
+  report("OSSchedule", t, loops, "call");
+  (void)sink;
+}
+
+/* Higher priority tasks kept in the delay list during the tick benchmark */
+static void tick_task(void *param)
+{
+  INT16U timeout = (INT16U)(BENCH_TICK_TIMEOUT + (INT32U)(OS_CPU_TYPE)param);
+
+  for (;;)
+  {
+    (void)OSSemPend(tick_start_sem, 0);
+    // a distinct wake up time for each task, none of them expires during the benchmark
+    (void)OSSemPend(tick_hold_sem, timeout);
+  }
+}
+
+/* Runs the tick interrupt handler as the tick timer would, with ntasks delayed tasks */
+static void bench_tick(int ntasks)
+{
+  OS_SR_SAVE_VAR
+  char name[32];
+  int i;
+  double t;
+
+  for (i = 0; i < ntasks; i++)
+  {
+    (void)OSSemPost(tick_start_sem);
+  }
+
+  OSEnterCritical();
+  t = now_ns();
+  for (i = 0; i < BENCH_TICKS; i++)
+  {
+    iNesting++;
+    OSIncCounter();
+    OS_TICK_HANDLER();
+    iNesting--;
+  }
+  t = now_ns() - t;
+  OSExitCritical();
+
+  snprintf(name, sizeof(name), "tick handler, %d delayed", ntasks);
+  report(name, t, BENCH_TICKS, "tick");
+
+  for (i = 0; i < ntasks; i++)
+  {
+    (void)OSSemPost(tick_hold_sem);
+  }
+}
+
+#if (BRTOS_TMR_EN == 1)
+/* Starts and stops a timer among BENCH_TIMERS running timers, then expires batches of BENCH_TIMERS timers */
+static void bench_timers(void)
+{
+  BRTOS_TIMER timers[BENCH_TIMERS];
+  unsigned long i, expired;
+  double t;
+  int k, b;
+
+  // the other timers keep a heap of BENCH_TIMERS, none of them expires during the loop
+  for (k = 0; k < BENCH_TIMERS; k++)
+  {
+    if (OSTimerSet(&timers[k], bench_timer_cb, (TIMER_CNT)(BENCH_TICK_TIMEOUT + k)) != OK)
+    {
+      printf("  no soft timer available\n");
+      return;
+    }
+  }
+
+  // a different deadline on each loop, so the timer moves through the heap
+  t = now_ns();
+  for (i = 0; i < loops; i++)
+  {
+    (void)OSTimerStart(timers[0], (TIMER_CNT)(1000 + (i & 1023)));
+    (void)OSTimerStop(timers[0], 0);
+  }
+  report("timer start+stop", now_ns() - t, loops, "op");
+
+  // the timer task runs the callbacks of the timers expired at the same tick in one batch
+  t = 0;
+  expired = 0;
+  for (b = 0; b < BENCH_TIMER_BATCHES; b++)
+  {
+    (void)DelayTask(1);
+    timer_batch = 0;
+    for (k = 0; k < BENCH_TIMERS; k++)
+    {
+      (void)OSTimerStart(timers[k], 2);
+    }
+    (void)DelayTask(4);
+    if (timer_batch > 1)
+    {
+      t += timer_last_ns - timer_first_ns;
+      expired += timer_batch - 1;
+    }
+  }
+  if (expired) report("timer expire+callback", t, expired, "timer");
+
+  for (k = 0; k < BENCH_TIMERS; k++)
+  {
+    (void)OSTimerStop(timers[k], 1);
+  }
+}
+#endif
+
+/* Higher priority side of the ping-pong, one switch in and one out per loop */
+static void pong_task(void *param)
+{
+  (void)param;
+  for (;;)
+  {
+    (void)OSSemPend(ping_sem, 0);
+    (void)OSSemPost(pong_sem);
+  }
+}
+
+/* Higher priority queue consumer */
+static void consumer_task(void *param)
+{
+  INT8U data;
+  INT8U block[BENCH_BLOCK_SIZE];
+  INT16U read;
+  unsigned long received;
+
+  (void)param;
+  for (;;)
+  {
+    // byte by byte, each post wakes this task
+    for (received = 0; received < loops; received++)
+    {
+      (void)OSQueuePend(bench_queue, &data, 0);
+    }
+    (void)OSSemPost(done_sem);
+
+    // in blocks
+    for (received = 0; received < (loops * BENCH_BLOCK_SIZE); received += read)
+    {
+      (void)OSQueuePendMany(bench_queue, block, BENCH_BLOCK_SIZE, &read, 0);
+    }
+    (void)OSSemPost(done_sem);
+  }
+}
+
+#if (BRTOS_MBOX_MULTI_EN == 1)
+/* Higher priority consumers of a sample, by their own mailbox then by the broadcast */
+static void fan_task(void *param)
+{
+  BRTOS_Mbox *own = fan_mbox[(INT32U)(OS_CPU_TYPE)param];
+  void *msg;
+  unsigned long i;
+
+  for (;;)
+  {
+    for (i = 0; i < loops; i++)
+    {
+      if ((OSMboxPend(own, &msg, 0) == OK) && (*(unsigned long *)msg == i)) fan_received++;
+    }
+    for (i = 0; i < loops; i++)
+    {
+      if ((OSMboxPend(broadcast_mbox, &msg, 0) == OK) && (*(unsigned long *)msg == i)) fan_received++;
+    }
+  }
+}
+#endif
+
+/* Woken by the bench task, measures the time from the post to the woken task */
+static void latency_task(void *param)
+{
+  (void)param;
+  for (;;)
+  {
+    (void)OSSemPend(latency_sem, 0);
+    switch_latency += now_ns() - switch_start;
+  }
+}
+
+/* Lower priority reader, its wake ups are taken by the bench task before it runs */
+static void pend_task(void *param)
+{
+  INT8U block[4];
+  INT16U read;
+  INT32U start;
+
+  (void)param;
+  for (;;)
+  {
+    (void)OSSemPend(pend_start_sem, 0);
+    start = OSGetMonotonicCount();
+    pend_result = OSQueuePendMany(pend_queue, block, sizeof(block), &read, CHECK_PEND_TICKS);
+    pend_ticks = OSGetMonotonicCount() - start;
+    (void)OSSemPost(pend_done_sem);
+  }
+}
+
+/* The timeout of a bulk read covers every retry after a wake up without data */
+static void check_pend_many(void)
+{
+  INT8U data = 0;
+  INT16U n;
+  int i, tries, ok;
+
+  // a tick signal delayed by the host adds ticks, then the measure is taken again
+  for (tries = 0, ok = FALSE; !ok && (tries < CHECK_TRIES); tries++)
+  {
+    (void)OSSemPost(pend_start_sem);
+    (void)DelayTask(1);
+    for (i = 0; i < CHECK_PEND_STEALS; i++)
+    {
+      (void)OSQueuePostMany(pend_queue, &data, 1, &n);
+      (void)OSQueuePendMany(pend_queue, &data, 1, &n, NO_TIMEOUT);
+      (void)DelayTask(CHECK_PEND_TICKS / CHECK_PEND_STEALS);
+    }
+    (void)OSSemPend(pend_done_sem, 0);
+    ok = (pend_result == TIMEOUT) && (pend_ticks <= (CHECK_PEND_TICKS + 1));
+  }
+  check(ok, "queue read many timeout");
+}
+
+/* Posts from the tick interrupt, CHECK_HOOK_POSTS per tick while a check runs */
+void BRTOS_TimerHook(void)
+{
+  int i;
+
+  if (hook_ticks_left != 0)
+  {
+    hook_ticks_left--;
+    for (i = 0; i < CHECK_HOOK_POSTS; i++)
+    {
+      if (OSSemPost(hook_sem) == OK) hook_posts++;
+    }
+  }
+}
+
+#if (TICKLESS_IDLE_EN == 1)
+/* The tick can only be suppressed when no check posts from the hook */
+INT16U BRTOS_TimerHookNextEvent(void)
+{
+  return (hook_ticks_left != 0) ? 1 : (INT16U)(TICK_COUNT_OVERFLOW - 1);
+}
+#endif
+
+/* The tick hook posts race with the task pends, on the fast path if enabled,
+   no count may be lost or taken twice */
+static void check_hook_post(void)
+{
+  unsigned long taken = 0;
+  unsigned long i = 0;
+
+  hook_posts = 0;
+  hook_ticks_left = CHECK_HOOK_TICKS;
+  while (hook_ticks_left != 0)
+  {
+    // mostly polls, so the tick comes in the middle of a pend, and blocks now and then
+    if (OSSemPend(hook_sem, ((++i % 64) == 0) ? 2 : NO_TIMEOUT) == OK) taken++;
+  }
+  while (OSSemPend(hook_sem, NO_TIMEOUT) == OK) taken++;
+
+  check((hook_posts == (CHECK_HOOK_TICKS * CHECK_HOOK_POSTS)) && (taken == hook_posts), "tick hook post vs task pend");
+}
+
+#if (BRTOS_DYNAMIC_QUEUE_ENABLED == 1)
+/* Entries of an odd size, read and written through the buffer wrap around */
+static void check_dqueue(void)
+{
+  BRTOS_Queue *queue;
+  INT8U in[3], out[3];
+  int i, ok;
+
+  if (OSDQueueCreate(4, sizeof(in), &queue) != ALLOC_EVENT_OK)
+  {
+    check(FALSE, "dynamic queue");
+    return;
+  }
+  ok = TRUE;
+  for (i = 0; ok && (i < 10); i++)
+  {
+    in[0] = (INT8U)i; in[1] = (INT8U)(i + 1); in[2] = (INT8U)(i + 2);
+    ok = (OSDQueuePost(queue, in) == WRITE_BUFFER_OK) && (OSDQueuePost(queue, in) == WRITE_BUFFER_OK);
+    ok = ok && (OSDQueuePend(queue, out, NO_TIMEOUT) == READ_BUFFER_OK) && (out[0] == in[0]) && (out[2] == in[2]);
+    ok = ok && (OSDQueuePend(queue, out, NO_TIMEOUT) == READ_BUFFER_OK) && (out[1] == in[1]);
+  }
+  ok = ok && (OSDQueuePend(queue, out, NO_TIMEOUT) == EXIT_BY_NO_ENTRY_AVAILABLE);
+  (void)OSDQueueDelete(&queue);
+  check(ok, "dynamic queue");
+}
+#endif
+
+#if (BRTOS_EVENT_GROUP_EN == 1)
+/* The flag of an object linked to an event group stays set while the object keeps data */
+static void check_event_group(void)
+{
+  BRTOS_EventGroup *group;
+  BRTOS_Sem *sem;
+  INT32U fired;
+  int ok;
+
+  if ((OSEventGroupCreate(0, &group) != ALLOC_EVENT_OK) || (OSSemCreate(0, &sem) != ALLOC_EVENT_OK))
+  {
+    check(FALSE, "event group");
+    return;
+  }
+  check(OSEventWaitAny(group, &fired, NO_TIMEOUT) == INVALID_PARAMETERS, "event group without objects");
+
+  (void)OSEventGroupLink(group, 0x1, SEMAPHORE, sem);
+  (void)OSEventGroupLink(group, 0x2, MUTEX, check_mutex);
+
+  // the first pend leaves a count, so the flag consumed by the wait is set again
+  (void)OSSemPost(sem);
+  (void)OSSemPost(sem);
+  ok = (OSEventWaitAny(group, &fired, 10) == OK) && (fired == 0x1) && (OSSemPend(sem, NO_TIMEOUT) == OK);
+  ok = ok && (OSEventWaitAny(group, &fired, 10) == OK) && (fired == 0x1) && (OSSemPend(sem, NO_TIMEOUT) == OK);
+  ok = ok && (OSEventWaitAny(group, &fired, NO_TIMEOUT) == EXIT_BY_NO_ENTRY_AVAILABLE);
+  check(ok, "event group semaphore count");
+
+  // a release that leaves the mutex available sets its flag
+  ok = (OSMutexAcquire(check_mutex, 0) == OK) && (OSMutexRelease(check_mutex) == OK);
+  ok = ok && (OSEventWaitAny(group, &fired, NO_TIMEOUT) == OK) && (fired == 0x2);
+  ok = ok && (OSMutexAcquire(check_mutex, NO_TIMEOUT) == OK) && (OSMutexRelease(check_mutex) == OK);
+  check(ok, "event group mutex");
+
+  (void)OSEventGroupLink(NULL, 0x1, SEMAPHORE, sem);
+  (void)OSEventGroupLink(NULL, 0x2, MUTEX, check_mutex);
+  (void)OSSemDelete(&sem);
+  (void)OSEventGroupDelete(&group);
+}
+#endif
+
+#if (BRTOS_MEMPOOL_EN == 1)
+#if (BRTOS_TMR_EN == 1)
+/* Returns the block kept by the memory pool check, from the timer task */
+static TIMER_CNT pool_put_cb(void)
+{
+  (void)OSMemPut(small_pool, pool_block);
+  return 0;
+}
+#endif
+
+/* Blocks of a pool do not overlap, a put goes to the task waiting for a block and
+   OSMemAlloc takes the smallest class with a free block */
+static void check_mempool(void)
+{
+  OS_MEM_POOL_STATS stats, large;
+  void *blocks[CHECK_POOL_BLOCKS];
+  void *block;
+  int i, ok;
+  #if (BRTOS_TMR_EN == 1)
+  BRTOS_TIMER timer;
+  INT32U start, ticks;
+  #endif
+
+  if ((OSMemPoolCreate(small_pool_mem, CHECK_POOL_BLOCKS, CHECK_POOL_SMALL, &small_pool) != ALLOC_EVENT_OK) ||
+      (OSMemPoolCreate(large_pool_mem, CHECK_POOL_BLOCKS, CHECK_POOL_LARGE, &large_pool) != ALLOC_EVENT_OK))
+  {
+    check(FALSE, "memory pool");
+    return;
+  }
+
+  // every block once, each one filled with its index to find overlaps
+  ok = TRUE;
+  for (i = 0; i < CHECK_POOL_BLOCKS; i++)
+  {
+    blocks[i] = OSMemGet(small_pool);
+    if (blocks[i] == NULL)
+    {
+      check(FALSE, "memory pool blocks");
+      return;
+    }
+    memset(blocks[i], i, CHECK_POOL_SMALL);
+  }
+  ok = (OSMemGet(small_pool) == NULL) && (OSMemPend(small_pool, &block, NO_TIMEOUT) == EXIT_BY_NO_RESOURCE_AVAILABLE);
+  for (i = 0; ok && (i < CHECK_POOL_BLOCKS); i++)
+  {
+    ok = (((INT8U *)blocks[i])[0] == i) && (((INT8U *)blocks[i])[CHECK_POOL_SMALL - 1] == i);
+  }
+  ok = ok && (OSMemPoolDelete(&small_pool) == BUSY_RESOURCE);
+  check(ok, "memory pool blocks");
+
+  #if (BRTOS_TMR_EN == 1)
+  // the block put by the timer task is handed to the waiting task
+  pool_block = blocks[0];
+  start = OSGetMonotonicCount();
+  (void)OSTimerSet(&timer, pool_put_cb, CHECK_POOL_TICKS);
+  ok = (OSMemPend(small_pool, &block, 4 * CHECK_POOL_TICKS) == OK) && (block == blocks[0]);
+  ticks = OSGetMonotonicCount() - start;
+  ok = ok && (ticks >= CHECK_POOL_TICKS) && (ticks < (4 * CHECK_POOL_TICKS));
+  ok = ok && (OSMemPend(small_pool, &block, CHECK_POOL_TICKS) == TIMEOUT);
+  (void)OSTimerStop(timer, 1);
+  check(ok, "memory pool pend");
+  #endif
+
+  for (i = 0; i < CHECK_POOL_BLOCKS; i++)
+  {
+    (void)OSMemPut(small_pool, blocks[i]);
+  }
+  (void)OSMemPoolQuery(small_pool, &stats);
+  check((stats.FreeBlocks == CHECK_POOL_BLOCKS) && (stats.MinFreeBlocks == 0) && (stats.TasksWaiting == 0) &&
+        (stats.Gets >= CHECK_POOL_BLOCKS) && (stats.Fails >= 2), "memory pool statistics");
+
+  // the small class first, then the large one when the small blocks are exhausted
+  ok = (OSMemHeapAdd(small_pool) == OK) && (OSMemHeapAdd(large_pool) == OK);
+  for (i = 0; i < CHECK_POOL_BLOCKS; i++)
+  {
+    blocks[i] = OSMemAlloc(1);
+  }
+  block = OSMemAlloc(1);
+  (void)OSMemPoolQuery(small_pool, &stats);
+  (void)OSMemPoolQuery(large_pool, &large);
+  ok = ok && (block != NULL) && (stats.FreeBlocks == 0) && (large.FreeBlocks == (CHECK_POOL_BLOCKS - 1));
+  ok = ok && (OSMemAlloc(CHECK_POOL_LARGE + 1) == NULL);
+  OSMemFree(block);
+  for (i = 0; i < CHECK_POOL_BLOCKS; i++)
+  {
+    OSMemFree(blocks[i]);
+  }
+  ok = ok && (OSMemPoolDelete(&small_pool) == DELETE_EVENT_OK) && (OSMemPoolDelete(&large_pool) == DELETE_EVENT_OK);
+  check(ok, "memory pool heap classes");
+}
+#endif
+
+#if (BRTOS_MSG_QUEUE_EN == 1)
+/* Messages are passed by reference, the ones left in a deleted queue return to their pool */
+static void check_msg_queue(void)
+{
+  BRTOS_MsgPool *pool;
+  BRTOS_Queue *queue;
+  void *msg[CHECK_MSG_BLOCKS];
+  void *received;
+  int i, ok;
+
+  if ((OSMsgPoolCreate(CHECK_MSG_BLOCKS, 24, &pool) != ALLOC_EVENT_OK) ||
+      (OSMsgQueueCreate(CHECK_MSG_BLOCKS, &queue) != ALLOC_EVENT_OK))
+  {
+    check(FALSE, "message queue");
+    return;
+  }
+
+  ok = TRUE;
+  for (i = 0; ok && (i < CHECK_MSG_BLOCKS); i++)
+  {
+    msg[i] = OSMsgAlloc(pool);
+    ok = (msg[i] != NULL) && (OSMsgQueuePost(queue, msg[i]) == WRITE_BUFFER_OK);
+  }
+  ok = ok && (OSMsgAlloc(pool) == NULL);
+
+  // the same blocks, in the post order
+  for (i = 0; ok && (i < (CHECK_MSG_BLOCKS / 2)); i++)
+  {
+    ok = (OSMsgQueuePend(queue, &received, NO_TIMEOUT) == READ_BUFFER_OK) && (received == msg[i]) && (OSMsgFree(received) == OK);
+  }
+  ok = ok && (OSMsgPoolDelete(&pool) == BUSY_RESOURCE);
+  ok = ok && (OSMsgQueueDelete(&queue) == DELETE_EVENT_OK) && (OSMsgPoolDelete(&pool) == DELETE_EVENT_OK);
+  check(ok, "message queue");
+
+  #ifdef UMM_INTEGRITY_CHECK
+  check(umm_integrity_check() == 0, "heap integrity");
+  #endif
+}
+#endif
+
+#if (BRTOS_WORKQ_EN == 1)
+/* Deferred work, records the order it runs in */
+static void work_item(void *arg)
+{
+  work_order[work_done++] = (int)(OS_CPU_TYPE)arg;
+}
+
+/* Interrupt, submits more work items than the queue holds */
+static void work_irq(void)
+{
+  int i;
+
+  for (i = 0; i < CHECK_WORK_ITEMS; i++)
+  {
+    if (OSWorkSubmit(work_item, (void *)(OS_CPU_TYPE)i) != OK) work_refused++;
+  }
+}
+
+/* The work submitted by an interrupt runs in order, in batches, and the items over the queue size are refused */
+static void check_workqueue(void)
+{
+  OS_WORKQ_STATS stats;
+  int i, ok;
+
+  (void)OSWorkQueueQuery(&stats, TRUE);
+  work_done = 0;
+  work_refused = 0;
+  OSPosixIRQInstall(CHECK_WORKQ_IRQ, work_irq);
+  OSPosixIRQRaise(CHECK_WORKQ_IRQ);
+  (void)DelayTask(2);
+  (void)OSWorkQueueQuery(&stats, FALSE);
+
+  ok = (work_done == BRTOS_WORKQ_SIZE) && (work_refused == (CHECK_WORK_ITEMS - BRTOS_WORKQ_SIZE));
+  for (i = 0; ok && (i < work_done); i++)
+  {
+    ok = (work_order[i] == i);
+  }
+  ok = ok && (stats.Submitted == BRTOS_WORKQ_SIZE) && (stats.Overruns == (CHECK_WORK_ITEMS - BRTOS_WORKQ_SIZE));
+  ok = ok && (stats.Executed == BRTOS_WORKQ_SIZE) && (stats.MaxBatch == BRTOS_WORKQ_BATCH) && (stats.Pending == 0);
+  check(ok, "work queue from interrupt");
+}
+#endif
+
+#if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+/* Lowest priority task, holds the mutex until a task waits for it */
+static void pi_low_task(void *param)
+{
+  (void)param;
+  for (;;)
+  {
+    (void)OSSemPend(pi_low_sem, 0);
+    (void)OSMutexAcquire(pi_mutex, 0);
+    while ((((volatile BRTOS_Mutex *)pi_mutex)->OSEventWait == 0) && !pi_stop)
+    {
+    }
+    (void)OSMutexRelease(pi_mutex);
+  }
+}
+
+/* Middle priority task, keeps the processor from the lower priority tasks */
+static void pi_mid_task(void *param)
+{
+  (void)param;
+  for (;;)
+  {
+    (void)OSSemPend(pi_mid_sem, 0);
+    while (!pi_stop)
+    {
+    }
+  }
+}
+
+/* The owner of an inheritance mutex runs at the priority of the task waiting for it,
+   without inheritance the middle task would keep it from releasing the mutex */
+static void check_inheritance(void)
+{
+  #if (BRTOS_MUTEX_STATS_EN == 1)
+  OS_MUTEX_STATS stats;
+  #endif
+  INT32U start, ticks;
+  INT8U ret;
+
+  pi_stop = 0;
+  (void)OSSemPost(pi_low_sem);
+  (void)DelayTask(1);
+  (void)OSSemPost(pi_mid_sem);
+  start = OSGetMonotonicCount();
+  ret = OSMutexAcquire(pi_mutex, CHECK_PI_TICKS);
+  ticks = OSGetMonotonicCount() - start;
+  pi_stop = 1;
+  if (ret == OK) (void)OSMutexRelease(pi_mutex);
+  (void)DelayTask(1);
+  check((ret == OK) && (ticks <= 1), "mutex priority inheritance");
+
+  #if (BRTOS_MUTEX_STATS_EN == 1)
+  (void)OSMutexQuery(pi_mutex, &stats);
+  check((stats.Owner == 0) && (stats.TasksWaiting == 0) && (stats.Contention == 1) && (stats.MaxHoldTime > 0), "mutex statistics");
+  #endif
+}
+#endif
+
+#if (BRTOS_SPSC_QUEUE_EN == 1)
+/* Producer, posts the next number to the queue on each interrupt of the host thread */
+static void spsc_irq(void)
+{
+  if (spsc_next == CHECK_SPSC_ITEMS) return;
+  if (OSSPSCQueuePost(spsc_queue, &spsc_next) == WRITE_BUFFER_OK)
+  {
+    spsc_next++;
+  }
+  else
+  {
+    spsc_full++;
+  }
+}
+
+/* Host thread, raises the interrupt of the producer at random points of the consumer */
+static void *spsc_thread(void *param)
+{
+  volatile unsigned int spin;
+  struct timespec pause = {0, (CHECK_SPSC_TICKS + 1) * 1000000L};
+
+  (void)param;
+  while (!spsc_stop)
+  {
+    OSPosixIRQRaise(CHECK_SPSC_IRQ);
+    for (spin = (unsigned int)rand() % 2000; spin > 0; spin--)
+    {
+    }
+    (void)sched_yield();
+
+    // now and then longer than the pend timeout of the consumer
+    if ((rand() % 1000) == 0)
+    {
+      (void)nanosleep(&pause, NULL);
+    }
+  }
+  return NULL;
+}
+
+/* Consumer, with short timeouts and some delays to fill the queue */
+static void spsc_task(void *param)
+{
+  INT32U data;
+  INT32U expected;
+
+  (void)param;
+  for (;;)
+  {
+    (void)OSSemPend(spsc_start_sem, 0);
+    for (expected = 0; expected < CHECK_SPSC_ITEMS; )
+    {
+      if (OSSPSCQueuePend(spsc_queue, &data, CHECK_SPSC_TICKS) != READ_BUFFER_OK)
+      {
+        spsc_timeouts++;
+        continue;
+      }
+      if (data != expected) spsc_errors++;
+      expected = data + 1;
+      if ((expected % 256) == 0) (void)DelayTask(1);
+    }
+    (void)OSSemPost(spsc_done_sem);
+  }
+}
+
+/* Every number posted by the interrupt must be read once and in order */
+static void check_spsc(void)
+{
+  pthread_t thread;
+  sigset_t all, old;
+  INT8U ret;
+
+  OSPosixIRQInstall(CHECK_SPSC_IRQ, spsc_irq);
+
+  // the signals of the port are only taken by the kernel thread
+  spsc_stop = 0;
+  sigfillset(&all);
+  (void)pthread_sigmask(SIG_BLOCK, &all, &old);
+  (void)pthread_create(&thread, NULL, spsc_thread, NULL);
+  (void)pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+  (void)OSSemPost(spsc_start_sem);
+  ret = OSSemPend(spsc_done_sem, 10000);
+  spsc_stop = 1;
+  (void)pthread_join(thread, NULL);
+
+  printf("  %lu posts to a full queue, %lu pend timeouts\n", spsc_full, spsc_timeouts);
+  check((ret == OK) && (spsc_errors == 0), "SPSC queue from interrupt");
+}
+#endif
+
+#if (OSTRACE == 1)
+/* The ring keeps the events of the running task in order and counts the records it overwrote */
+static void check_trace(void)
+{
+  OS_TRACE_RECORD rec[16];
+  INT16U n;
+  int i, post, ok;
+
+  // the records of the previous checks
+  while (OSTraceRead((INT8U *)rec, sizeof(rec)) != 0)
+  {
+  }
+
+  (void)OSSemPost(done_sem);
+  (void)OSSemPend(done_sem, 0);
+  n = (INT16U)(OSTraceRead((INT8U *)rec, sizeof(rec)) / sizeof(OS_TRACE_RECORD));
+
+  // a tick may switch to another task in between
+  post = -1;
+  ok = FALSE;
+  for (i = 0; i < n; i++)
+  {
+    if ((rec[i].Task != currentTask) || (rec[i].Arg != OS_TRACE_ADDR(done_sem))) continue;
+    if (rec[i].Event == OS_TRACE_SEM_POST) post = i;
+    if ((rec[i].Event == OS_TRACE_SEM_PEND) && (post >= 0)) ok = (rec[i].Timestamp >= rec[post].Timestamp);
+  }
+  check(ok, "trace of a semaphore");
+
+  // two records per loop, twice the ring size
+  for (i = 0; i < OS_TRACE_SIZE; i++)
+  {
+    (void)OSSemPost(done_sem);
+    (void)OSSemPend(done_sem, 0);
+  }
+  n = OSTraceRead((INT8U *)rec, sizeof(rec));
+  check((n != 0) && (rec[0].Event == OS_TRACE_LOST) && (rec[0].Arg >= (OS_TRACE_SIZE / 2)), "trace ring overflow");
+  while (OSTraceRead((INT8U *)rec, sizeof(rec)) != 0)
+  {
+  }
+}
+#endif
+
+#if (OS_TASK_RUNTIME_EN == 1)
+/* Lower priority task, spins while the bench task sleeps */
+static void runtime_task(void *param)
+{
+  (void)param;
+  for (;;)
+  {
+    (void)OSSemPend(runtime_sem, 0);
+    while (!runtime_stop)
+    {
+    }
+  }
+}
+
+/* The processor time of a task that spins during a delay of the bench task is about the delay */
+static void check_runtime(void)
+{
+  OS_SR_SAVE_VAR
+  INT32U run, switches;
+  double expected;
+
+  OSEnterCritical();
+  OSRuntimeUpdate();
+  run = ContextTask[runtime_th].RunTime;
+  switches = ContextTask[runtime_th].Switches;
+  OSExitCritical();
+
+  runtime_stop = 0;
+  (void)OSSemPost(runtime_sem);
+  (void)DelayTask(CHECK_RUNTIME_TICKS);
+  runtime_stop = 1;
+  (void)DelayTask(1);
+
+  OSEnterCritical();
+  OSRuntimeUpdate();
+  run = ContextTask[runtime_th].RunTime - run;
+  switches = ContextTask[runtime_th].Switches - switches;
+  OSExitCritical();
+
+  expected = (double)CHECK_RUNTIME_TICKS * OS_TIMESTAMP_HZ / configTICK_RATE_HZ;
+  printf("  %u timestamp units in %u switches, %.0f expected\n", (unsigned int)run, (unsigned int)switches, expected);
+  check((run > (expected / 2)) && (run < (2 * expected)) && (switches >= 1), "task runtime");
+}
+#endif
+
+#if (BRTOS_SHARED_PRIORITY_EN == 1)
+/* Waits forever at the priority of the latency task */
+static void peer_task(void *param)
+{
+  (void)param;
+  for (;;)
+  {
+    (void)OSSemPend(peer_sem, 0);
+  }
+}
+
+/* Tasks of one priority, must be woken in the order they waited */
+static void fifo_task(void *param)
+{
+  for (;;)
+  {
+    (void)OSSemPend(fifo_sem, 0);
+    fifo_order[fifo_woken++] = (int)(OS_CPU_TYPE)param;
+  }
+}
+
+/* Task of the priority of the fifo tasks, waits for another semaphore and times out
+   on every tick, so it leaves and joins the wait queue of the priority between them */
+static void fifo_other_task(void *param)
+{
+  (void)param;
+  for (;;)
+  {
+    if (OSSemPend(fifo_other_sem, fifo_other_stop ? 0 : 1) == OK)
+    {
+      fifo_other_posts++;
+    }
+    else
+    {
+      fifo_other_timeouts++;
+    }
+  }
+}
+
+/* Tasks of one priority below the bench task, must share the processor */
+static void slice_task(void *param)
+{
+  int i = (int)(OS_CPU_TYPE)param;
+
+  for (;;)
+  {
+    (void)OSSemPend(slice_sem, 0);
+    while (!slice_stop)
+    {
+      slice_count[i]++;
+    }
+  }
+}
+
+static void check_shared(void)
+{
+  int i, ok;
+
+  check(NumberOfInstalledTasks > 64, "more than 64 tasks installed");
+
+  // the fifo tasks wait in their install order, then in the order they were woken,
+  // while the other task of the priority keeps timing out in between
+  fifo_woken = 0;
+  for (i = 0; i < (2 * CHECK_FIFO_TASKS); i++)
+  {
+    (void)OSSemPost(fifo_sem);
+    (void)DelayTask(2);
+  }
+  ok = (fifo_woken == (2 * CHECK_FIFO_TASKS));
+  for (i = 0; ok && (i < fifo_woken); i++)
+  {
+    ok = (fifo_order[i] == (i % CHECK_FIFO_TASKS));
+  }
+  check(ok, "FIFO wake up of a priority");
+
+  // the post goes to the task waiting for the other semaphore, not to a fifo task
+  fifo_other_stop = 1;
+  (void)DelayTask(2);
+  (void)OSSemPost(fifo_other_sem);
+  check((fifo_other_posts == 1) && (fifo_other_timeouts > 0) && (fifo_woken == (2 * CHECK_FIFO_TASKS)),
+        "wait queue of a priority shared by two events");
+
+  // without the time slices the first spinning task would keep the processor
+  slice_stop = 0;
+  for (i = 0; i < CHECK_SLICE_TASKS; i++)
+  {
+    (void)OSSemPost(slice_sem);
+  }
+  (void)DelayTask(CHECK_SLICE_TICKS);
+  slice_stop = 1;
+  (void)DelayTask(CHECK_SLICE_TICKS);
+  ok = TRUE;
+  for (i = 0; i < CHECK_SLICE_TASKS; i++)
+  {
+    ok = ok && (slice_count[i] != 0);
+  }
+  check(ok, "time slices of a priority");
+}
+#endif
+
+/* Lower priority task, drives the benchmarks */
+static void bench_task(void *param)
+{
+  INT8U block[BENCH_BLOCK_SIZE] = {0};
+  INT16U written;
+  unsigned long i;
+  double t;
+
+  (void)param;
+
+  printf("%s benchmarks, %lu loops, semaphore fast path %s, tickless idle %s, shared priorities %s, %s scheduler\n",
+         BRTOS_VERSION, loops, (BRTOS_SEM_FAST_EN == 1) ? "on" : "off", (TICKLESS_IDLE_EN == 1) ? "on" : "off",
+         (BRTOS_SHARED_PRIORITY_EN == 1) ? "on" : "off",
+         (SCHEDULER_TYPE == SCHEDULER_CLZ) ? "clz" : ((SCHEDULER_TYPE == SCHEDULER_PORTABLE) ? "portable" : "default"));
+
+  check_ticks();
+  check_pend_many();
+  check_hook_post();
+  #if (BRTOS_DYNAMIC_QUEUE_ENABLED == 1)
+  check_dqueue();
+  #endif
+  #if (BRTOS_EVENT_GROUP_EN == 1)
+  check_event_group();
+  #endif
+  #if (BRTOS_MEMPOOL_EN == 1)
+  check_mempool();
+  #endif
+  #if (BRTOS_MSG_QUEUE_EN == 1)
+  check_msg_queue();
+  #endif
+  #if (BRTOS_WORKQ_EN == 1)
+  check_workqueue();
+  #endif
+  #if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+  check_inheritance();
+  #endif
+  #if (BRTOS_SPSC_QUEUE_EN == 1)
+  check_spsc();
+  #endif
+  #if (BRTOS_SHARED_PRIORITY_EN == 1)
+  check_shared();
+  #endif
+  #if (OSTRACE == 1)
+  check_trace();
+  #endif
+  #if (OS_TASK_RUNTIME_EN == 1)
+  check_runtime();
+  #endif
+
+  // tick timer, the delay must take about the same host time
+  t = now_ns();
+  (void)DelayTask(100);
+  printf("%-28s %10.1f ms\n", "delay of 100 ticks", (now_ns() - t) / 1e6);
+
+  bench_schedule();
+
+  // the delay list is sorted, the tick handler cost must not grow with the delayed tasks
+  bench_tick(4);
+  bench_tick(16);
+  bench_tick(BENCH_TICK_TASKS);
+
+  #if (BRTOS_TMR_EN == 1)
+  // the timers are kept in a heap, start, stop and expiration are O(log n)
+  bench_timers();
+  #endif
+
+  // uncontended semaphore, no context switch (the fast path, if enabled)
+  t = now_ns();
+  for (i = 0; i < loops; i++)
+  {
+    (void)OSSemPost(done_sem);
+    (void)OSSemPend(done_sem, 0);
+  }
+  report("semaphore post+pend", now_ns() - t, loops, "op");
+
+  // ping-pong, two context switches per loop (every post wakes a task, locked path)
+  t = now_ns();
+  for (i = 0; i < loops; i++)
+  {
+    (void)OSSemPost(ping_sem);
+    (void)OSSemPend(pong_sem, 0);
+  }
+  t = now_ns() - t;
+  report("semaphore ping-pong", t, loops, "loop");
+  report("context switch", t, loops * 2, "switch");
+
+  // from the post to the woken task, with BENCH_SHARED_TASKS more tasks at its priority if shared
+  switch_latency = 0;
+  for (i = 0; i < loops; i++)
+  {
+    switch_start = now_ns();
+    (void)OSSemPost(latency_sem);
+  }
+  report("context switch latency", switch_latency, loops, "switch");
+
+  // queue, one context switch per byte
+  t = now_ns();
+  for (i = 0; i < loops; i++)
+  {
+    (void)OSQueuePost(bench_queue, (INT8U)i);
+  }
+  (void)OSSemPend(done_sem, 0);
+  report("queue byte post/pend", now_ns() - t, loops, "byte");
+
+  // queue in blocks
+  t = now_ns();
+  for (i = 0; i < loops; i++)
+  {
+    (void)OSQueuePostMany(bench_queue, block, BENCH_BLOCK_SIZE, &written);
+  }
+  (void)OSSemPend(done_sem, 0);
+  report("queue block post/pend", now_ns() - t, loops * BENCH_BLOCK_SIZE, "byte");
+
+  #if (BRTOS_MBOX_MULTI_EN == 1)
+  // one sample to every consumer, the consumers run before each post returns
+  fan_received = 0;
+  t = now_ns();
+  for (fan_sample = 0; fan_sample < loops; fan_sample++)
+  {
+    for (i = 0; i < BENCH_FAN_OUT; i++)
+    {
+      (void)OSMboxPost(fan_mbox[i], &fan_sample);
+    }
+  }
+  report("mailbox fan out, N posts", now_ns() - t, loops, "sample");
+  if (fan_received != loops * BENCH_FAN_OUT) printf("  %lu samples lost\n", loops * BENCH_FAN_OUT - fan_received);
+
+  fan_received = 0;
+  t = now_ns();
+  for (fan_sample = 0; fan_sample < loops; fan_sample++)
+  {
+    (void)OSMboxPostAll(broadcast_mbox, &fan_sample);
+  }
+  report("mailbox fan out, broadcast", now_ns() - t, loops, "sample");
+  if (fan_received != loops * BENCH_FAN_OUT) printf("  %lu samples lost\n", loops * BENCH_FAN_OUT - fan_received);
+  #endif
+
+  if (failures) printf("%d checks FAILED\n", failures);
+  exit(failures ? 1 : 0);
+}
+
+
+int main(int argc, char *argv[])
+{
+  int i;
+
+  if (argc > 1)
+  {
+    loops = strtoul(argv[1], NULL, 0);
+  }
+
+  BRTOS_Init();
+
+  if (OSSemCreate(0, &ping_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &pong_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &done_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSQueueCreate(2 * BENCH_BLOCK_SIZE, &bench_queue) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &tick_start_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &tick_hold_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &latency_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSQueueCreate(8, &pend_queue) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &pend_start_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &pend_done_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &hook_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSMutexCreate(&check_mutex, CHECK_MUTEX_PRIO) != ALLOC_EVENT_OK) exit(1);
+  #if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+  if (OSMutexCreate(&pi_mutex, MUTEX_PRIORITY_INHERITANCE) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &pi_low_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &pi_mid_sem) != ALLOC_EVENT_OK) exit(1);
+  #endif
+  #if (OS_TASK_RUNTIME_EN == 1)
+  if (OSSemCreate(0, &runtime_sem) != ALLOC_EVENT_OK) exit(1);
+  #endif
+  #if (BRTOS_SPSC_QUEUE_EN == 1)
+  if (OSSPSCQueueCreate(CHECK_SPSC_LENGTH, sizeof(INT32U), &spsc_queue) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &spsc_start_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &spsc_done_sem) != ALLOC_EVENT_OK) exit(1);
+  #endif
+  #if (BRTOS_SHARED_PRIORITY_EN == 1)
+  if (OSSemCreate(0, &peer_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &fifo_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &fifo_other_sem) != ALLOC_EVENT_OK) exit(1);
+  if (OSSemCreate(0, &slice_sem) != ALLOC_EVENT_OK) exit(1);
+  #endif
+  #if (BRTOS_MBOX_MULTI_EN == 1)
+  for (i = 0; i < BENCH_FAN_OUT; i++)
+  {
+    if (OSMboxCreate(&fan_mbox[i], NULL) != ALLOC_EVENT_OK) exit(1);
+  }
+  if (OSMboxCreateMulti(&broadcast_mbox, 1) != ALLOC_EVENT_OK) exit(1);
+  #endif
+
+  if (InstallTask(&pong_task, "Pong", 256, 20, NULL, NULL) != OK) exit(1);
+  if (InstallTask(&consumer_task, "Consumer", 256, 19, NULL, NULL) != OK) exit(1);
+  #if (BRTOS_MBOX_MULTI_EN == 1)
+  for (i = 0; i < BENCH_FAN_OUT; i++)
+  {
+    if (InstallTask(&fan_task, "Fan", 256, (INT8U)(11 + i), (void *)(OS_CPU_TYPE)i, NULL) != OK) exit(1);
+  }
+  #endif
+  for (i = 0; i < BENCH_TICK_TASKS; i++)
+  {
+    if (InstallTask(&tick_task, "Tick", 256, (INT8U)(21 + i), (void *)(OS_CPU_TYPE)i, NULL) != OK) exit(1);
+  }
+  if (InstallTask(&latency_task, "Latency", 256, BENCH_LATENCY_PRIO, NULL, NULL) != OK) exit(1);
+  if (InstallTask(&pend_task, "Pend", 256, CHECK_PEND_PRIO, NULL, NULL) != OK) exit(1);
+  #if (BRTOS_SPSC_QUEUE_EN == 1)
+  if (InstallTask(&spsc_task, "SPSC", 256, CHECK_SPSC_PRIO, NULL, NULL) != OK) exit(1);
+  #endif
+  #if (BRTOS_WORKQ_EN == 1)
+  if (OSWorkQueueInit(256, CHECK_WORKQ_PRIO) != OK) exit(1);
+  #endif
+  #if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+  if (InstallTask(&pi_low_task, "PI low", 256, CHECK_PI_LOW_PRIO, NULL, NULL) != OK) exit(1);
+  if (InstallTask(&pi_mid_task, "PI middle", 256, CHECK_PI_MID_PRIO, NULL, NULL) != OK) exit(1);
+  #endif
+  #if (OS_TASK_RUNTIME_EN == 1)
+  if (InstallTask(&runtime_task, "Runtime", 256, CHECK_RUNTIME_PRIO, NULL, &runtime_th) != OK) exit(1);
+  #endif
+  #if (BRTOS_SHARED_PRIORITY_EN == 1)
+  for (i = 0; i < BENCH_SHARED_TASKS; i++)
+  {
+    if (InstallTask(&peer_task, "Peer", 256, BENCH_LATENCY_PRIO, NULL, NULL) != OK) exit(1);
+  }
+  for (i = 0; i < CHECK_FIFO_TASKS; i++)
+  {
+    if (InstallTask(&fifo_task, "FIFO", 256, CHECK_FIFO_PRIO, (void *)(OS_CPU_TYPE)i, NULL) != OK) exit(1);
+  }
+  if (InstallTask(&fifo_other_task, "FIFO other", 256, CHECK_FIFO_PRIO, NULL, NULL) != OK) exit(1);
+  for (i = 0; i < CHECK_SLICE_TASKS; i++)
+  {
+    if (InstallTask(&slice_task, "Slice", 256, CHECK_SLICE_PRIO, (void *)(OS_CPU_TYPE)i, NULL) != OK) exit(1);
+  }
+  #endif
+  if (InstallTask(&bench_task, "Bench", 256, 10, NULL, NULL) != OK) exit(1);
+
+  #if (BRTOS_TMR_EN == 1)
+  OSTimerInit(256, 60);
+  #endif
+
+  // Start Task Scheduler
+  if (BRTOSStart() != OK) exit(1);
+
+  return 0;
+}
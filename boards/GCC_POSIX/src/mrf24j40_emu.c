@@ -0,0 +1,299 @@
+/**
+* \file mrf24j40_emu.c
+* \brief Emulated MRF24J40 radio of the POSIX simulation port
+*
+* An access starts with CSn low. A first byte with bit 7 clear selects a short address,
+* bit 0 telling a write. A first byte with bit 7 set is followed by a second byte, the
+* ten bits long address spanning both and bit 4 of the second byte telling a write. The
+* next bytes are written to or read from the address, which is incremented after each
+* byte, until CSn goes high: a FIFO is moved in one access.
+*
+* CSn going high before the address is complete, a second CSn low, a byte moved in the
+* wrong direction or clocked with CSn high are counted as framing errors.
+*
+* INTSTAT is cleared when read. The interrupt line is raised while INTSTAT has a flag set
+* and the driver has the radio interrupt enabled.
+*
+**/
+
+#include <string.h>
+
+#include "BRTOS.h"
+#include "mrf24j40.h"
+#include "mrf24j40_emu.h"
+
+#define EMU_SHORT_SIZE      64
+#define EMU_LONG_SIZE       1024
+
+#define INT_TXNIF           0x01
+#define INT_RXIF            0x08
+
+enum
+{
+  EMU_IDLE,                 // CSn high
+  EMU_COMMAND,              // CSn low, waiting for the first byte
+  EMU_LONG_ADDRESS,         // waiting for the second byte of a long address
+  EMU_DATA                  // address decoded, moving data
+};
+
+static uint8_t emu_short[EMU_SHORT_SIZE];
+static uint8_t emu_long[EMU_LONG_SIZE];
+static uint8_t emu_state = EMU_IDLE;
+static uint8_t emu_long_access;
+static uint8_t emu_write;
+static uint16_t emu_address;
+static uint8_t emu_first;
+static volatile uint8_t emu_intstat;
+static volatile uint8_t emu_int_enabled;
+static uint8_t emu_rx_enabled = 1;
+static MRF24J40_EMU_TX_HOOK emu_tx_hook;
+static MRF24J40_EMU_STATS emu_stats;
+
+/* Radio interrupt handler of the MRF24J40 driver */
+void Radio_Interrupt(void);
+
+/* Raises the radio interrupt if a flag is set and the driver lets it in */
+static void emu_int_update(void)
+{
+  if (emu_int_enabled && (emu_intstat != 0))
+  {
+    OSPosixIRQRaise(MRF24J40_EMU_IRQ_LINE);
+  }
+}
+
+static uint8_t emu_load(void)
+{
+  uint8_t val;
+
+  if (!emu_long_access)
+  {
+    switch (emu_address)
+    {
+      case MRF24J40_INTSTAT:
+        val = emu_intstat;
+        emu_intstat = 0;
+        break;
+      case MRF24J40_SOFTRST:
+        // the reset bits are cleared by the radio at once
+        val = 0;
+        break;
+      case MRF24J40_BBREG6:
+        // the RSSI is always ready
+        val = emu_short[MRF24J40_BBREG6] | 0x01;
+        break;
+      default:
+        val = emu_short[emu_address % EMU_SHORT_SIZE];
+        break;
+    }
+  }
+  else
+  {
+    if (emu_address == MRF24J40_RFSTATE)
+    {
+      // always in the RX state
+      val = 0xA0;
+    }
+    else
+    {
+      val = emu_long[emu_address % EMU_LONG_SIZE];
+    }
+  }
+
+  emu_address++;
+  return val;
+}
+
+static void emu_store(uint8_t val)
+{
+  if (!emu_long_access)
+  {
+    emu_short[emu_address % EMU_SHORT_SIZE] = val;
+    switch (emu_address)
+    {
+      case MRF24J40_RXFLUSH:
+        if (val & 0x01)
+        {
+          emu_stats.flushes++;
+          emu_long[MRF24J40_RX_FIFO] = 0;
+        }
+        break;
+      case MRF24J40_BBREG1:
+        emu_rx_enabled = (val & 0x04) == 0;
+        break;
+      case MRF24J40_TXNCON:
+        if (val & 0x01)
+        {
+          emu_stats.transmits++;
+          if (emu_tx_hook != NULL)
+          {
+            emu_tx_hook(&emu_long[MRF24J40_NORMAL_TX_FIFO + 2], emu_long[MRF24J40_NORMAL_TX_FIFO + 1]);
+          }
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  else
+  {
+    emu_long[emu_address % EMU_LONG_SIZE] = val;
+  }
+
+  emu_address++;
+}
+
+void mrf24j40_emu_init(void)
+{
+  OSPosixIRQInstall(MRF24J40_EMU_IRQ_LINE, Radio_Interrupt);
+}
+
+void mrf24j40_emu_csn(uint8_t level)
+{
+  if (level == 0)
+  {
+    if (emu_state != EMU_IDLE)
+    {
+      emu_stats.errors++;
+    }
+    emu_state = EMU_COMMAND;
+    emu_stats.transactions++;
+  }
+  else
+  {
+    // an access cut before its address is complete, CSn driven high when idle is fine
+    if ((emu_state == EMU_COMMAND) || (emu_state == EMU_LONG_ADDRESS))
+    {
+      emu_stats.errors++;
+    }
+    emu_state = EMU_IDLE;
+  }
+}
+
+void mrf24j40_emu_spi_write(uint8_t *buf, uint16_t len)
+{
+  uint8_t b;
+
+  while (len-- > 0)
+  {
+    b = *buf++;
+    emu_stats.bytes++;
+    switch (emu_state)
+    {
+      case EMU_COMMAND:
+        emu_first = b;
+        if (b & 0x80)
+        {
+          emu_state = EMU_LONG_ADDRESS;
+        }
+        else
+        {
+          emu_long_access = 0;
+          emu_address = (b >> 1) & 0x3F;
+          emu_write = b & 0x01;
+          emu_state = EMU_DATA;
+        }
+        break;
+      case EMU_LONG_ADDRESS:
+        emu_long_access = 1;
+        emu_address = (uint16_t)(((emu_first & 0x7F) << 3) | (b >> 5));
+        emu_write = (b & 0x10) != 0;
+        emu_state = EMU_DATA;
+        break;
+      case EMU_DATA:
+        if (emu_write)
+        {
+          emu_store(b);
+        }
+        else
+        {
+          emu_stats.errors++;
+        }
+        break;
+      default:
+        // clocked with CSn high
+        emu_stats.errors++;
+        break;
+    }
+  }
+}
+
+void mrf24j40_emu_spi_read(uint8_t *buf, uint16_t len)
+{
+  while (len-- > 0)
+  {
+    emu_stats.bytes++;
+    if ((emu_state == EMU_DATA) && !emu_write)
+    {
+      *buf++ = emu_load();
+    }
+    else
+    {
+      emu_stats.errors++;
+      *buf++ = 0;
+    }
+  }
+}
+
+void mrf24j40_emu_int_enable(uint8_t enable)
+{
+  emu_int_enabled = enable;
+  emu_int_update();
+}
+
+void mrf24j40_emu_set_tx_hook(MRF24J40_EMU_TX_HOOK hook)
+{
+  emu_tx_hook = hook;
+}
+
+void mrf24j40_emu_tx_done(uint8_t txstat)
+{
+  OS_SR_SAVE_VAR
+
+  OSEnterCritical();
+  emu_short[MRF24J40_TXSTAT] = txstat;
+  emu_intstat |= INT_TXNIF;
+  OSExitCritical();
+
+  emu_int_update();
+}
+
+int mrf24j40_emu_receive(const uint8_t *frame, uint8_t len, uint8_t lqi, uint8_t rssi)
+{
+  OS_SR_SAVE_VAR
+  uint8_t *fifo = &emu_long[MRF24J40_RX_FIFO];
+
+  OSEnterCritical();
+  if (!emu_rx_enabled)
+  {
+    emu_stats.lost++;
+    OSExitCritical();
+    return 0;
+  }
+
+  // length with the FCS, frame, FCS, LQI and RSSI
+  fifo[0] = (uint8_t)(len + 2);
+  memcpy(&fifo[1], frame, len);
+  fifo[1 + len] = 0;
+  fifo[2 + len] = 0;
+  fifo[3 + len] = lqi;
+  fifo[4 + len] = rssi;
+  emu_intstat |= INT_RXIF;
+  emu_stats.received++;
+  OSExitCritical();
+
+  emu_int_update();
+  return 1;
+}
+
+void mrf24j40_emu_stats(MRF24J40_EMU_STATS *stats, uint8_t reset)
+{
+  OS_SR_SAVE_VAR
+
+  OSEnterCritical();
+  *stats = emu_stats;
+  if (reset)
+  {
+    memset(&emu_stats, 0, sizeof(emu_stats));
+  }
+  OSExitCritical();
+}
@@ -0,0 +1,69 @@
+/**
+* \file mrf24j40_emu.h
+* \brief Emulated MRF24J40 radio of the POSIX simulation port
+*
+* The SPI port of the MRF24J40 driver is mapped to these functions by mrf24j40_arch.h on
+* BOARD_POSIX. The emulator decodes the short and long address accesses of each CSn low
+* period, keeps the registers and the FIFOs of the radio and raises the radio interrupt
+* on a virtual interrupt line of the POSIX port. It counts the SPI transactions and the
+* framing errors, so the harness can check how the driver talks to the radio.
+*
+**/
+
+#ifndef MRF24J40_EMU_H
+#define MRF24J40_EMU_H
+
+#include <stdint.h>
+
+/// Virtual interrupt line of the radio, the rtimer uses line 0
+#define MRF24J40_EMU_IRQ_LINE     3
+
+/// SPI traffic and radio activity seen by the emulator
+typedef struct
+{
+  uint32_t transactions;    ///< CSn low periods
+  uint32_t bytes;           ///< Bytes clocked, command and address included
+  uint32_t errors;          ///< CSn toggled in the middle of an access, data in the wrong direction
+  uint32_t transmits;       ///< TXNTRIG writes
+  uint32_t received;        ///< Frames put in the RX FIFO
+  uint32_t lost;            ///< Frames arrived with the reception disabled
+  uint32_t flushes;         ///< RX FIFO flushes
+} MRF24J40_EMU_STATS;
+
+/// Called on the TXNTRIG write, the frame is in the TX normal FIFO
+typedef void (*MRF24J40_EMU_TX_HOOK)(const uint8_t *frame, uint8_t len);
+
+void mrf24j40_emu_init(void);
+void mrf24j40_emu_csn(uint8_t level);
+void mrf24j40_emu_spi_write(uint8_t *buf, uint16_t len);
+void mrf24j40_emu_spi_read(uint8_t *buf, uint16_t len);
+void mrf24j40_emu_int_enable(uint8_t enable);
+
+/*****************************************************************************************//**
+* \fn void mrf24j40_emu_set_tx_hook(MRF24J40_EMU_TX_HOOK hook)
+* \brief Installs the function told about each transmission. The transmission only
+*  completes when mrf24j40_emu_tx_done() is called, from the hook or later.
+*********************************************************************************************/
+void mrf24j40_emu_set_tx_hook(MRF24J40_EMU_TX_HOOK hook);
+
+/*****************************************************************************************//**
+* \fn void mrf24j40_emu_tx_done(uint8_t txstat)
+* \brief Completes the transmission: sets TXSTAT and raises TXNIF
+* \param txstat TXSTAT value, 0 for a frame sent and acknowledged
+*********************************************************************************************/
+void mrf24j40_emu_tx_done(uint8_t txstat);
+
+/*****************************************************************************************//**
+* \fn int mrf24j40_emu_receive(const uint8_t *frame, uint8_t len, uint8_t lqi, uint8_t rssi)
+* \brief Puts a frame in the RX FIFO, followed by the FCS, the LQI and the RSSI, and raises RXIF
+* \return 1 if the frame was received, 0 if the reception was disabled
+*********************************************************************************************/
+int mrf24j40_emu_receive(const uint8_t *frame, uint8_t len, uint8_t lqi, uint8_t rssi);
+
+/*****************************************************************************************//**
+* \fn void mrf24j40_emu_stats(MRF24J40_EMU_STATS *stats, uint8_t reset)
+* \brief Reads and optionally clears the emulator counters
+*********************************************************************************************/
+void mrf24j40_emu_stats(MRF24J40_EMU_STATS *stats, uint8_t reset);
+
+#endif
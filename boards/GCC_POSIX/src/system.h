@@ -0,0 +1,12 @@
+/**
+* \file system.h
+* \brief Board peripherals of the POSIX simulation port, for the Contiki drivers
+*
+**/
+
+#ifndef SYSTEM_H
+#define SYSTEM_H
+
+#include "mrf24j40_emu.h"
+
+#endif
@@ -1,4 +1,5 @@
 #define BOARD_NONE				 	 0
 #define BOARD_COLDUINO				 1
 #define BOARD_FRDM_KL25Z			 2
-#define BOARD_ROTEADORCFV1			 3
\ No newline at end of file
+#define BOARD_ROTEADORCFV1			 3
+#define BOARD_POSIX				 4
\ No newline at end of file
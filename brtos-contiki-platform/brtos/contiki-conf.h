@@ -4,6 +4,9 @@
 #include "BRTOS.h"
 #include "platform-conf.h"
 
+/* DEBUG of BRTOSConfig.h is for the kernel, the Contiki sources define their own */
+#undef DEBUG
+
 /* default contiki-conf */
 #ifndef CCIF
 #define CCIF
@@ -27,6 +30,62 @@ typedef unsigned long long clock_time_t;
 #endif
 
 #define CLOCK_CONF_SECOND 	1000
+
+#if (OSTRACE == 1)
+/* process dispatch in the BRTOS trace */
+#define PROCESS_CONF_CALL_HOOK(p, ev)    OSTraceRecord(OS_TRACE_PROCESS_CALL, OS_TRACE_ADDR(p))
+#define PROCESS_CONF_RETURN_HOOK(p, ev)  OSTraceRecord(OS_TRACE_PROCESS_RETURN, OS_TRACE_ADDR(p))
+#endif
+
+/*
+ * Contiki process partitions. Partition 0 runs in the contiki_main task,
+ * partition N in a task of priority CONTIKI_CONF_PARTITION_PRIORITIES[N - 1],
+ * each waiting on its own event queue, see contiki-partition.c. Move a
+ * process with process_set_partition() before starting it. A BRTOS mutex
+ * protects the process list and the posts, and is released while a handler
+ * runs, so a partition preempts a long handler of a lower priority one: the
+ * dispatch latency of a partition only depends on the handlers of its own
+ * and of the higher priority partitions. The Contiki libraries (uIP, etimer,
+ * ctimer) are not reentrant: use them from one partition, or call them
+ * between contiki_lock() and contiki_unlock(). Needs BRTOS_MUTEX_EN, one
+ * mutex and one semaphore per partition above 0.
+ */
+#ifndef PROCESS_CONF_PARTITIONS
+#define PROCESS_CONF_PARTITIONS   1
+#endif
+
+#if PROCESS_CONF_PARTITIONS > 1
+void contiki_lock(void);
+void contiki_unlock(void);
+void contiki_partition_signal(unsigned char partition);
+void contiki_partitions_init(void);
+void contiki_partitions_start(void);
+
+#define PROCESS_CONF_LOCK()               contiki_lock()
+#define PROCESS_CONF_UNLOCK()             contiki_unlock()
+#define PROCESS_CONF_SIGNAL(partition)    contiki_partition_signal(partition)
+
+/* process_post and process_poll may be called by any task or interrupt */
+#define PROCESS_CONF_CRITICAL_DECL        OS_SR_SAVE_VAR
+#if (NESTING_INT == 0)
+#define PROCESS_CONF_ENTER_CRITICAL()     do { if(!iNesting) { OSEnterCritical(); } } while(0)
+#define PROCESS_CONF_EXIT_CRITICAL()      do { if(!iNesting) { OSExitCritical(); } } while(0)
+#else
+#define PROCESS_CONF_ENTER_CRITICAL()     OSEnterCritical()
+#define PROCESS_CONF_EXIT_CRITICAL()      OSExitCritical()
+#endif
+
+/* Dispatch latency of each partition, see process_partition_stats(), in
+ * OS_TIMESTAMP() units when the HAL timestamp is compiled in, else in ticks */
+#ifndef PROCESS_CONF_STATS
+#define PROCESS_CONF_STATS                1
+#endif
+#if (OS_TASK_RUNTIME_EN == 1) || (OSTRACE == 1) || (BRTOS_MUTEX_STATS_EN == 1) || (BRTOS_WORKQ_EN == 1)
+#define PROCESS_CONF_TIMESTAMP()          OS_TIMESTAMP()
+#else
+#define PROCESS_CONF_TIMESTAMP()          OSGetMonotonicCount()
+#endif
+#endif
 #define INFINITE_TIME 	 	ULONG_MAX
 
 //#define SLIP_CONF_ANSWER_MAC_REQUEST	1
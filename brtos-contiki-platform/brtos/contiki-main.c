@@ -62,6 +62,9 @@
 #include "BRTOS.h"
 BRTOS_Sem *Contiki_Sem;
 
+#include "../mrf24j40/mrf24j40.h"
+#define RF_CHANNEL MRF24J40_DEFAULT_CHANNEL
+
 int main_win(void); // for simulation on Win32
 int main_minimal_net(void);
 void init_net(uint8_t node_id);  /* to init network using mrf24j40 radio */
@@ -364,8 +367,13 @@ main_minimal_net(void)
 {
 
 	clock_init();
+	rtimer_init();
 	process_init();
 
+#if PROCESS_CONF_PARTITIONS > 1
+	contiki_partitions_init();
+#endif
+
   /* procinit_init initializes RPL which sets a ctimer for the first DIS */
   /* We must start etimers and ctimers,before calling it */
 	process_start(&etimer_process, NULL);
@@ -405,14 +413,19 @@ main_minimal_net(void)
 
   OSSemBinaryCreate (0, &Contiki_Sem);
 
+#if PROCESS_CONF_PARTITIONS > 1
+  contiki_partitions_start();
+#endif
+
   PRINTF("\n*******%s online*******\n\r",CONTIKI_VERSION_STRING);
 
   while(1) {
 
     int n;
 
+    /* This task runs the partition 0, the others have their own task */
     do{
-    	n = process_run();
+    	n = process_run_partition(0);
     } while(n > 0);
 
     OSSemPend(Contiki_Sem, 0);
@@ -508,7 +521,6 @@ init_net(uint8_t node_id)
   linkaddr_t addr;
 #if NETSTACK_CONF_WITH_IPV6
   uip_ds6_addr_t *lladdr;
-  uip_ipaddr_t ipaddr;
 #endif
 
   uint8_t i;
@@ -552,9 +564,6 @@ init_net(uint8_t node_id)
 
   queuebuf_init();
 
-#include "../mrf24j40/mrf24j40.h"
-#define RF_CHANNEL MRF24J40_DEFAULT_CHANNEL
-
   if(node_id==1) mrf24j40_set_as_pan_coordinator(1);
   else mrf24j40_set_as_pan_coordinator(0);
 
@@ -601,6 +610,8 @@ init_net(uint8_t node_id)
 
   #if(!UIP_CONF_IPV6_RPL)
   {
+    uip_ipaddr_t ipaddr;
+
     uip_ip6addr(&ipaddr, 0x2001, 0x1418, 0x100, 0x823c, 0, 0, 0, 0);
     uip_ds6_set_addr_iid(&ipaddr, &uip_lladdr);
     uip_ds6_addr_add(&ipaddr, 0, ADDR_TENTATIVE);
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2015, Universidade Federal de Santa Maria.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the uFSM real time operating system.
+ *
+ */
+/**
+ * \file contiki-partition.c
+ * Tasks of the Contiki process partitions, see PROCESS_CONF_PARTITIONS
+ *
+ * Partition 0 runs in the contiki_main task, each partition above 0 in a
+ * task of its own. The dispatch mutex protects the process list and the
+ * posts, it is released while a handler runs, so a partition preempts a
+ * handler of a partition of lower priority.
+ */
+
+#include "contiki.h"
+#include "BRTOS.h"
+
+#define DEBUG_THIS 0
+#if DEBUG_THIS
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+#if PROCESS_CONF_PARTITIONS > 1
+
+/* Priorities of the tasks of the partitions 1 and above, e.g. {3, 1},
+ * below the priority of the contiki_main task, which runs partition 0 */
+#ifndef CONTIKI_CONF_PARTITION_PRIORITIES
+#error "CONTIKI_CONF_PARTITION_PRIORITIES: priorities of the tasks of the Contiki partitions"
+#endif
+
+#ifndef CONTIKI_CONF_PARTITION_STACK
+#define CONTIKI_CONF_PARTITION_STACK	(768)
+#endif
+
+/* Ceiling of the dispatch mutex, a free priority above all the Contiki tasks */
+#ifndef CONTIKI_CONF_LOCK_PRIORITY
+#if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+#define CONTIKI_CONF_LOCK_PRIORITY		MUTEX_PRIORITY_INHERITANCE
+#else
+#error "CONTIKI_CONF_LOCK_PRIORITY: a free priority above the Contiki tasks"
+#endif
+#endif
+
+/* Task of a partition above 0 and the semaphore that wakes it */
+typedef struct
+{
+	unsigned char partition;
+	INT8U priority;
+	BRTOS_Sem *sem;
+} CONTIKI_PARTITION;
+
+extern BRTOS_Sem *Contiki_Sem;
+
+static const INT8U partition_priority[PROCESS_CONF_PARTITIONS - 1] = CONTIKI_CONF_PARTITION_PRIORITIES;
+static CONTIKI_PARTITION partitions[PROCESS_CONF_PARTITIONS];
+static BRTOS_Mutex *contiki_mutex;
+
+/* Takes of the owner, only the outermost release frees the mutex */
+static INT8U contiki_lock_depth;
+
+/* Protects the process list and the posts, see PROCESS_CONF_LOCK. The
+ * interrupts only poll and post, under the critical section of the queues */
+void contiki_lock(void)
+{
+	if ((contiki_mutex != NULL) && (iNesting == 0))
+	{
+		(void)OSMutexAcquire(contiki_mutex, 0);
+		contiki_lock_depth++;
+	}
+}
+
+void contiki_unlock(void)
+{
+	if ((contiki_mutex != NULL) && (iNesting == 0))
+	{
+		if (--contiki_lock_depth == 0)
+		{
+			(void)OSMutexRelease(contiki_mutex);
+		}
+	}
+}
+
+/* Wakes the task of a partition after a post or a poll request */
+void contiki_partition_signal(unsigned char partition)
+{
+	BRTOS_Sem *sem = (partition == 0) ? Contiki_Sem : partitions[partition].sem;
+
+	if (sem != NULL)
+	{
+		(void)OSSemPost(sem);
+	}
+}
+
+#if (TASK_WITH_PARAMETERS == 1)
+static void contiki_partition_task(void *param)
+{
+	CONTIKI_PARTITION *part = (CONTIKI_PARTITION *)param;
+#else
+static void contiki_partition_task(void)
+{
+	CONTIKI_PARTITION *part = &partitions[1];
+	unsigned char partition;
+
+	/* Without a task parameter, the partition of the task by its priority */
+	for (partition = 1; partition < PROCESS_CONF_PARTITIONS; partition++)
+	{
+		if (partitions[partition].priority == ContextTask[currentTask].Priority)
+		{
+			part = &partitions[partition];
+			break;
+		}
+	}
+#endif
+
+	for (;;)
+	{
+		while (process_run_partition(part->partition) > 0)
+		{
+		}
+
+		OSSemPend(part->sem, 0);
+	}
+}
+
+/* Creates the dispatch mutex, before the first process is started */
+void contiki_partitions_init(void)
+{
+	if (contiki_mutex == NULL)
+	{
+		(void)OSMutexCreate(&contiki_mutex, CONTIKI_CONF_LOCK_PRIORITY);
+	}
+}
+
+/* Starts the tasks of the partitions above 0, after the Contiki init */
+void contiki_partitions_start(void)
+{
+	unsigned char partition;
+	CONTIKI_PARTITION *part;
+
+	for (partition = 1; partition < PROCESS_CONF_PARTITIONS; partition++)
+	{
+		part = &partitions[partition];
+		part->partition = partition;
+		part->priority = partition_priority[partition - 1];
+
+		if (OSSemBinaryCreate(0, &part->sem) != ALLOC_EVENT_OK)
+		{
+			PRINTF("Contiki partition %u: no semaphore\n", partition);
+			continue;
+		}
+
+		#if (TASK_WITH_PARAMETERS == 1)
+		if (InstallTask(&contiki_partition_task, "Contiki partition", CONTIKI_CONF_PARTITION_STACK,
+						part->priority, part, NULL) != OK)
+		#else
+		if (InstallTask(&contiki_partition_task, "Contiki partition", CONTIKI_CONF_PARTITION_STACK,
+						part->priority, NULL) != OK)
+		#endif
+		{
+			PRINTF("Contiki partition %u: no task\n", partition);
+		}
+	}
+}
+
+#endif
@@ -97,5 +97,55 @@ void BRTOS_TimerHook(void)
 			OSSemPost(Contiki_Sem);
 		}
 	}
+
+#if !RTIMER_ARCH_TIMER
+	rtimer_arch_tick();
+#endif
 }
 
+
+#if (TICKLESS_IDLE_EN == 1)
+/* Ticks until the next etimer expiration, or the next rtimer when it runs
+ * on the tick, used to bound the tickless idle */
+INT16U BRTOS_TimerHookNextEvent(void)
+{
+	clock_time_t next_event;
+	INT16U ticks = (INT16U)(TICK_COUNT_OVERFLOW - 1);
+#if !RTIMER_ARCH_TIMER
+	rtimer_clock_t rtimer_next, rtimer_now;
+#endif
+
+	next_event = etimer_next_expiration_time();
+	if(next_event != 0)
+	{
+		if(next_event <= clock)
+		{
+			return 1;
+		}
+
+		next_event -= clock;
+		if(next_event < ticks)
+		{
+			ticks = (INT16U)next_event;
+		}
+	}
+
+#if !RTIMER_ARCH_TIMER
+	if(rtimer_arch_next(&rtimer_next))
+	{
+		rtimer_now = rtimer_arch_now();
+		if(!RTIMER_CLOCK_LT(rtimer_now, rtimer_next))
+		{
+			return 1;
+		}
+
+		if((INT16U)(rtimer_clock_t)(rtimer_next - rtimer_now) < ticks)
+		{
+			ticks = (INT16U)(rtimer_clock_t)(rtimer_next - rtimer_now);
+		}
+	}
+#endif
+
+	return ticks;
+}
+#endif
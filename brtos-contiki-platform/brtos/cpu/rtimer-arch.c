@@ -37,8 +37,10 @@
  *         Adam Dunkels <adam@sics.se>
  */
 
+#include "contiki.h"
 #include "sys/rtimer.h"
 #include "sys/clock.h"
+#include "BRTOS.h"
 
 #define DEBUG_THIS 0
 #if DEBUG_THIS
@@ -48,19 +50,328 @@
 #define PRINTF(...)
 #endif
 
-/* real time tasks are supported by BRTOS kernel, and not implemented here */
+extern BRTOS_Sem *Contiki_Sem;
 
+/* Wakes the Contiki task when an rtimer callback polled a process */
+#define RTIMER_ARCH_WAKE_CONTIKI()                          \
+  do {                                                      \
+    if((Contiki_Sem != NULL) && (process_nevents() > 0)) {  \
+      OSSemPost(Contiki_Sem);                               \
+    }                                                       \
+  } while(0)
+
+#if RTIMER_ARCH_TIMER && defined(BOARD_FRDM_KL25Z) && (BRTOS_PLATFORM == BOARD_FRDM_KL25Z)
+
+#include "xhw_types.h"
+#include "xhw_ints.h"
+#include "xhw_memmap.h"
+#include "xhw_sysctl.h"
+#include "xhw_tpm.h"
+#include "xcore.h"
+
+/*
+ * TPM1 counts the 32 kHz slow internal reference clock (MCGIRCLK), which
+ * also runs in the low power stop modes. The channel 0 compare raises the
+ * rtimer interrupt.
+ *
+ * SIM_SOPT2 TPMSRC clocks TPM0, TPM1 and TPM2 alike, and MCG_C2 IRCS sets
+ * MCGIRCLK for all its users. rtimer_arch_init() only switches them when
+ * TPM0 and TPM2 are stopped and the fast IRC is not in use. Otherwise the
+ * rtimer stays stopped: the board must clock its other TPMs from the slow
+ * MCGIRCLK, or start them after the rtimer.
+ */
+#define RTIMER_TPM_BASE         TPM1_BASE
+#define RTIMER_TPM_INT          INT_FTM1
+
+/* Shortest delay programmed, a compare in the past waits a whole wrap */
+#define RTIMER_ARCH_MIN_DELAY   2
+
+static uint8_t rtimer_arch_running;
+
+/*---------------------------------------------------------------------------*/
+/* A TPM counts when its clock gate is on, its registers fault otherwise */
+static uint8_t
+tpm_counting(uint32_t base, uint32_t gate)
+{
+  return ((xHWREG(SIM_SCGC6) & gate) != 0) &&
+         ((xHWREG(base + TPM_SC) & TPM_SC_CMOD_M) != 0);
+}
+/*---------------------------------------------------------------------------*/
+/* Whether the TPM clock can be the slow MCGIRCLK without reclocking others */
+static uint8_t
+rtimer_arch_clock_free(void)
+{
+  const uint8_t c1 = xHWREGB(MCG_C1);
+  const uint8_t fast_irc = (xHWREGB(MCG_C2) & MCG_C2_IRCS) != 0;
+
+  if(((xHWREG(SIM_SOPT2) & SIM_SOPT2_TPMSRC_M) == SIM_SOPT2_TPMSRC_MCGIRCLK) &&
+     !fast_irc) {
+    return 1;
+  }
+
+  if(tpm_counting(TPM0_BASE, SIM_SCGC6_TPM0_EN) ||
+     tpm_counting(TPM2_BASE, SIM_SCGC6_TPM2_EN)) {
+    return 0;
+  }
+
+  /* MCGIRCLK or the core clock running from the fast IRC */
+  if(fast_irc && (((c1 & MCG_C1_IRCLKEN) != 0) ||
+                  ((c1 & MCG_C1_SRC_MCGOUTCLK_M) == MCG_C1_SRC_MCGOUTCLK_INTERAL))) {
+    return 0;
+  }
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_arch_init(void)
+{
+  if(!rtimer_arch_clock_free()) {
+    PRINTF("rtimer_arch_init: TPM clock in use, rtimer stopped\n");
+    rtimer_arch_running = 0;
+    return;
+  }
+
+  xHWREGB(MCG_C1) |= MCG_C1_IRCLKEN | MCG_C1_IREFSTEN;
+  xHWREGB(MCG_C2) &= ~MCG_C2_IRCS;
+
+  xHWREG(SIM_SOPT2) = (xHWREG(SIM_SOPT2) & ~SIM_SOPT2_TPMSRC_M) | SIM_SOPT2_TPMSRC_MCGIRCLK;
+  xHWREG(SIM_SCGC6) |= SIM_SCGC6_TPM1_EN;
+
+  xHWREG(RTIMER_TPM_BASE + TPM_SC) = 0;
+  xHWREG(RTIMER_TPM_BASE + TPM_CNT) = 0;
+  xHWREG(RTIMER_TPM_BASE + TPM_MOD) = 0xFFFF;
+
+  /* Software compare, interrupt enabled when a rtimer is scheduled */
+  xHWREG(RTIMER_TPM_BASE + TPM_C0SC) = TPM_CNSC_MSA | TPM_CNSC_CHF;
+  xHWREG(RTIMER_TPM_BASE + TPM_SC) = TPM_SC_CMOD_CLK | TPM_SC_PS_1;
+
+  xIntEnable(RTIMER_TPM_INT);
+
+  rtimer_arch_running = 1;
+}
+/*---------------------------------------------------------------------------*/
+rtimer_clock_t
+rtimer_arch_now(void)
+{
+  if(!rtimer_arch_running) {
+    return 0;
+  }
+
+  return (rtimer_clock_t)xHWREG(RTIMER_TPM_BASE + TPM_CNT);
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_arch_schedule(rtimer_clock_t t)
+{
+  const rtimer_clock_t now = rtimer_arch_now();
+
+  PRINTF("rtimer_arch_schedule %u at %u\n", t, now);
+
+  if(!rtimer_arch_running) {
+    return;
+  }
+
+  if(RTIMER_CLOCK_LT(t, (rtimer_clock_t)(now + RTIMER_ARCH_MIN_DELAY))) {
+    t = (rtimer_clock_t)(now + RTIMER_ARCH_MIN_DELAY);
+  }
+
+  xHWREG(RTIMER_TPM_BASE + TPM_C0SC) = TPM_CNSC_MSA | TPM_CNSC_CHF;
+  xHWREG(RTIMER_TPM_BASE + TPM_C0V) = t;
+  xHWREG(RTIMER_TPM_BASE + TPM_C0SC) = TPM_CNSC_MSA | TPM_CNSC_CHIE;
+}
+/*---------------------------------------------------------------------------*/
+void
+TPM1_IRQHandler(void)
+{
+  // ************************
+  // Entrada de interrupcao
+  // ************************
+#if (PROCESSOR != ARM_Cortex_M0)
+  OS_INT_ENTER();
+#endif
+
+  /* Clears the compare flag and disables the channel interrupt */
+  xHWREG(RTIMER_TPM_BASE + TPM_C0SC) = TPM_CNSC_MSA | TPM_CNSC_CHF;
+
+  rtimer_run_next();
+
+  RTIMER_ARCH_WAKE_CONTIKI();
+
+  // ************************
+  // Interrupt Exit
+  // ************************
+#if (PROCESSOR == ARM_Cortex_M0)
+  OS_INT_EXIT_EXT();
+#else
+  OS_INT_EXIT();
+#endif
+}
+/*---------------------------------------------------------------------------*/
+
+#elif RTIMER_ARCH_TIMER && defined(BOARD_POSIX) && (BRTOS_PLATFORM == BOARD_POSIX)
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+/*
+ * A timerfd armed with the absolute time of the compare. A host thread
+ * sleeps on it and raises a virtual interrupt line of the BRTOS POSIX
+ * port, so the rtimer callbacks run in interrupt context of the kernel
+ * thread, as on the targets.
+ */
+#ifdef RTIMER_ARCH_CONF_IRQ_LINE
+#define RTIMER_ARCH_IRQ_LINE    RTIMER_ARCH_CONF_IRQ_LINE
+#else
+#define RTIMER_ARCH_IRQ_LINE    0
+#endif
+
+#define NSEC_PER_SEC            1000000000ull
+
+static int timer_fd = -1;
+static pthread_t timer_thread;
+
+/* 64 bits count of rtimer ticks of a monotonic time */
+static uint64_t
+ticks_of(const struct timespec *ts)
+{
+  return (uint64_t)ts->tv_sec * RTIMER_ARCH_SECOND +
+         ((uint64_t)ts->tv_nsec * RTIMER_ARCH_SECOND) / NSEC_PER_SEC;
+}
+/*---------------------------------------------------------------------------*/
+static void *
+rtimer_arch_thread(void *arg)
+{
+  uint64_t expirations;
+
+  (void)arg;
+
+  for(;;) {
+    if(read(timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+      OSPosixIRQRaise(RTIMER_ARCH_IRQ_LINE);
+    }
+  }
+
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+rtimer_arch_irq(void)
+{
+  rtimer_run_next();
+
+  RTIMER_ARCH_WAKE_CONTIKI();
+}
 /*---------------------------------------------------------------------------*/
 void
 rtimer_arch_init(void)
 {
+  sigset_t all, old;
+
+  if(timer_fd >= 0) {
+    return;
+  }
+
+  timer_fd = timerfd_create(CLOCK_MONOTONIC, 0);
+  if(timer_fd < 0) {
+    PRINTF("rtimer_arch_init: no timerfd\n");
+    return;
+  }
+
+  OSPosixIRQInstall(RTIMER_ARCH_IRQ_LINE, rtimer_arch_irq);
+
+  /* The signals of the BRTOS port are only taken by the kernel thread */
+  sigfillset(&all);
+  (void)pthread_sigmask(SIG_BLOCK, &all, &old);
+  (void)pthread_create(&timer_thread, NULL, rtimer_arch_thread, NULL);
+  (void)pthread_sigmask(SIG_SETMASK, &old, NULL);
+}
+/*---------------------------------------------------------------------------*/
+rtimer_clock_t
+rtimer_arch_now(void)
+{
+  struct timespec ts;
 
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (rtimer_clock_t)ticks_of(&ts);
 }
 /*---------------------------------------------------------------------------*/
 void
 rtimer_arch_schedule(rtimer_clock_t t)
 {
+  struct timespec ts;
+  struct itimerspec its;
+  uint64_t now, deadline;
+  int16_t delta;
+
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  now = ticks_of(&ts);
+
+  /* A time in the past fires at once */
+  delta = (int16_t)(t - (rtimer_clock_t)now);
+  deadline = now + (delta > 0 ? (uint64_t)delta : 0);
 
+  memset(&its, 0, sizeof(its));
+  if(delta > 0) {
+    its.it_value.tv_sec = (time_t)(deadline / RTIMER_ARCH_SECOND);
+    its.it_value.tv_nsec = (long)(((deadline % RTIMER_ARCH_SECOND) * NSEC_PER_SEC +
+                                   RTIMER_ARCH_SECOND - 1) / RTIMER_ARCH_SECOND);
+  } else {
+    its.it_value = ts;
+  }
 
+  PRINTF("rtimer_arch_schedule %u at %u\n", t, (rtimer_clock_t)now);
+
+  (void)timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+/*---------------------------------------------------------------------------*/
+
+#else
+
+static volatile rtimer_clock_t next_time;
+static volatile uint8_t armed;
+
+/*---------------------------------------------------------------------------*/
+void
+rtimer_arch_init(void)
+{
+  armed = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_arch_schedule(rtimer_clock_t t)
+{
+  next_time = t;
+  armed = 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_arch_tick(void)
+{
+  if(armed && !RTIMER_CLOCK_LT(rtimer_arch_now(), next_time)) {
+    armed = 0;
+    rtimer_run_next();
+
+    RTIMER_ARCH_WAKE_CONTIKI();
+  }
 }
 /*---------------------------------------------------------------------------*/
+int
+rtimer_arch_next(rtimer_clock_t *t)
+{
+  if(!armed) {
+    return 0;
+  }
+
+  *t = next_time;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+
+#endif
+
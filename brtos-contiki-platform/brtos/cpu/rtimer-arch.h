@@ -42,8 +42,30 @@
 
 #include "contiki-conf.h"
 
-#define RTIMER_ARCH_SECOND CLOCK_CONF_SECOND
+#if (defined(BOARD_FRDM_KL25Z) && (BRTOS_PLATFORM == BOARD_FRDM_KL25Z)) || \
+    (defined(BOARD_POSIX) && (BRTOS_PLATFORM == BOARD_POSIX))
 
-#define rtimer_arch_now() clock_time()
+/* Free running 16 bits timer with a compare interrupt: TPM1 clocked by
+ * the 32 kHz MCGIRCLK on the KL25Z, a timerfd on the POSIX host */
+#define RTIMER_ARCH_TIMER   1
+#define RTIMER_ARCH_SECOND  32768
+
+rtimer_clock_t rtimer_arch_now(void);
+
+#else
+
+/* Without a timer for the rtimer, it runs on the BRTOS tick */
+#define RTIMER_ARCH_TIMER   0
+#define RTIMER_ARCH_SECOND  CLOCK_CONF_SECOND
+
+#define rtimer_arch_now() ((rtimer_clock_t)clock_time())
+
+/* Called by the tick hook, runs the rtimer when it is due */
+void rtimer_arch_tick(void);
+
+/* Time of the scheduled rtimer, returns 0 when none is, bounds the tickless idle */
+int rtimer_arch_next(rtimer_clock_t *t);
+
+#endif
 
 #endif /* RTIMER_ARCH_H_ */
@@ -57,6 +57,8 @@
 #include "boards/board-frdm-kl25z-conf.h"
 #elif BRTOS_PLATFORM == BOARD_ROTEADORCFV1
 #include "boards/board-roteadorcfv1-conf.h"
+#elif BRTOS_PLATFORM == BOARD_POSIX
+#include "boards/board-posix-conf.h"
 #endif
 
 #endif /* PLATFORM_CONF_H_ */
@@ -48,6 +48,8 @@
  * \date   2012-03-21
  */
 
+#include <string.h>
+
 #include "contiki.h"
 
 #include "mrf24j40.h"
@@ -57,6 +59,72 @@
 #include "net/netstack.h"
 
 #define DEBUG 0
+
+/* Runs the SPI part of the radio interrupt in the BRTOS work queue, the
+ * worker task must have a higher priority than the Contiki task */
+#ifdef MRF24J40_CONF_DEFERRED_ISR
+#define MRF24J40_DEFERRED_ISR MRF24J40_CONF_DEFERRED_ISR
+#else
+#define MRF24J40_DEFERRED_ISR 0
+#endif
+
+#if MRF24J40_DEFERRED_ISR && (BRTOS_WORKQ_EN != 1)
+#error "MRF24J40_CONF_DEFERRED_ISR needs the BRTOS work queue (BRTOS_WORKQ_EN)"
+#endif
+
+/* Blocks the transmitting task on a semaphore posted by the TXNIF
+ * interrupt instead of spinning for the airtime and the retries */
+#ifdef MRF24J40_CONF_TX_SEM
+#define MRF24J40_TX_SEM MRF24J40_CONF_TX_SEM
+#else
+#define MRF24J40_TX_SEM 1
+#endif
+
+/* Bound of the wait for TXNIF, airtime of a full frame and the retries */
+#ifdef MRF24J40_CONF_TX_TIMEOUT_MS
+#define MRF24J40_TX_TIMEOUT_MS MRF24J40_CONF_TX_TIMEOUT_MS
+#else
+#define MRF24J40_TX_TIMEOUT_MS 50
+#endif
+#define MRF24J40_TX_TIMEOUT \
+  ((INT16U)(((INT32U)MRF24J40_TX_TIMEOUT_MS * configTICK_RATE_HZ + 999) / 1000))
+
+#if MRF24J40_TX_SEM && (BRTOS_SEM_EN != 1)
+#error "MRF24J40_CONF_TX_SEM needs the BRTOS semaphores (BRTOS_SEM_EN)"
+#endif
+
+/* Counts the SPI transactions (CSn low periods) and the bytes moved */
+#ifdef MRF24J40_CONF_SPI_STATS
+#define MRF24J40_SPI_STATS MRF24J40_CONF_SPI_STATS
+#else
+#define MRF24J40_SPI_STATS 0
+#endif
+
+#if MRF24J40_SPI_STATS
+static volatile uint32_t spi_transactions;
+static volatile uint32_t spi_bytes;
+#define SPI_TRANSACTION(bytes)  do { spi_transactions++; spi_bytes += (bytes); } while(0)
+#else
+#define SPI_TRANSACTION(bytes)
+#endif
+
+/* Frames copied out of the RX FIFO by the interrupt and not yet handed
+ * to the RDC, a power of two */
+#ifdef MRF24J40_CONF_RX_SLOTS
+#define MRF24J40_RX_SLOTS MRF24J40_CONF_RX_SLOTS
+#else
+#define MRF24J40_RX_SLOTS 4
+#endif
+
+#if (MRF24J40_RX_SLOTS < 1) || (MRF24J40_RX_SLOTS > 128) || \
+    (MRF24J40_RX_SLOTS & (MRF24J40_RX_SLOTS - 1))
+#error "MRF24J40_CONF_RX_SLOTS must be a power of two up to 128"
+#endif
+
+/* First two bytes of a long address access */
+#define LONG_ADD_HI(addr)       ((((uint8_t)((addr) >> 3)) & 0x7F) | 0x80)
+#define LONG_ADD_LO(addr)       (((uint8_t)((addr) << 5)) & 0xE0)
+#define LONG_ADD_WRITE          0x10
 #if DEBUG
 #include <stdio.h>
 #define PRINTF(...) printf(__VA_ARGS__)
@@ -77,9 +145,31 @@ PROCESS(mrf24j40_process, "MRF24J40 driver");
 static volatile uint8_t mrf24j40_last_lqi;
 static volatile uint8_t mrf24j40_last_rssi;
 static volatile uint8_t status_tx;
-static volatile uint8_t pending;
 static volatile uint8_t receive_on;
 static volatile uint8_t is_pan_coordinator;
+#if MRF24J40_TX_SEM
+static BRTOS_Sem *tx_sem;
+#endif
+
+/*
+ * RX ring. The interrupt fills the slot at rx_head and the driver process
+ * empties the slot at rx_tail; each side only writes its own free running
+ * index, so no critical section is needed between them.
+ */
+struct rx_slot {
+  rtimer_clock_t stamp;
+  uint8_t len;
+  uint8_t lqi;
+  uint8_t rssi;
+  uint8_t data[MRF24J40_MAX_PAYLOAD];
+};
+
+static struct rx_slot rx_ring[MRF24J40_RX_SLOTS];
+static volatile uint8_t rx_head;
+static volatile uint8_t rx_tail;
+static struct mrf24j40_rx_stats rx_stats;
+
+#define RX_RING_USED()  ((uint8_t)(rx_head - rx_tail))
 
 /*---------------------------------------------------------------------------*/
 static void
@@ -98,6 +188,7 @@ set_short_add_mem(uint8_t addr, uint8_t val)
   MRF24J40_CSn_LOW();
   MRF24J40_SPI_PORT_WRITE(msg, 2);
   MRF24J40_CSn_HIGH();
+  SPI_TRANSACTION(2);
 
   if(tmp) {
     MRF24J40_INTERRUPT_ENABLE_SET();
@@ -110,8 +201,8 @@ set_long_add_mem(uint16_t addr, uint8_t val)
   const uint8_t tmp = MRF24J40_INTERRUPT_ENABLE_STAT();
   uint8_t msg[3];
 
-  msg[0] = (((uint8_t)(addr >> 3)) & 0x7F) | 0x80;
-  msg[1] = (((uint8_t)(addr << 5)) & 0xE0) | 0x10;
+  msg[0] = LONG_ADD_HI(addr);
+  msg[1] = LONG_ADD_LO(addr) | LONG_ADD_WRITE;
   msg[2] = val;
 
   if(tmp) {
@@ -121,6 +212,7 @@ set_long_add_mem(uint16_t addr, uint8_t val)
   MRF24J40_CSn_LOW();
   MRF24J40_SPI_PORT_WRITE(msg, 3);
   MRF24J40_CSn_HIGH();
+  SPI_TRANSACTION(3);
 
   if(tmp) {
     MRF24J40_INTERRUPT_ENABLE_SET();
@@ -143,6 +235,7 @@ get_short_add_mem(uint8_t addr)
   MRF24J40_SPI_PORT_WRITE(&addr, 1);
   MRF24J40_SPI_PORT_READ(&ret_val, 1);
   MRF24J40_CSn_HIGH();
+  SPI_TRANSACTION(2);
 
   if(tmp) {
     MRF24J40_INTERRUPT_ENABLE_SET();
@@ -158,8 +251,8 @@ get_long_add_mem(uint16_t addr)
   uint8_t ret_val;
   uint8_t msg[2];
 
-  msg[0] = (((uint8_t)(addr >> 3)) & 0x7F) | 0x80;
-  msg[1] = ((uint8_t)(addr << 5)) & 0xE0;
+  msg[0] = LONG_ADD_HI(addr);
+  msg[1] = LONG_ADD_LO(addr);
 
   if(tmp) {
     MRF24J40_INTERRUPT_ENABLE_CLR();
@@ -169,6 +262,7 @@ get_long_add_mem(uint16_t addr)
   MRF24J40_SPI_PORT_WRITE(msg, 2);
   MRF24J40_SPI_PORT_READ(&ret_val, 1);
   MRF24J40_CSn_HIGH();
+  SPI_TRANSACTION(3);
 
   if(tmp) {
     MRF24J40_INTERRUPT_ENABLE_SET();
@@ -396,18 +490,31 @@ mrf24j40_get_last_lqi(void)
 int32_t
 mrf24j40_set_txfifo(const uint8_t *buf, uint8_t buf_len)
 {
-  uint8_t i;
+  const uint8_t tmp = MRF24J40_INTERRUPT_ENABLE_STAT();
+  uint8_t msg[4];
 
   if((buf_len == 0) || (buf_len > 128)) {
     return -1;
   }
 
-  set_long_add_mem(MRF24J40_NORMAL_TX_FIFO, 0);
+  /* Header length, frame length and the frame, in one burst write */
+  msg[0] = LONG_ADD_HI(MRF24J40_NORMAL_TX_FIFO);
+  msg[1] = LONG_ADD_LO(MRF24J40_NORMAL_TX_FIFO) | LONG_ADD_WRITE;
+  msg[2] = 0;
+  msg[3] = buf_len;
+
+  if(tmp) {
+    MRF24J40_INTERRUPT_ENABLE_CLR();
+  }
 
-  set_long_add_mem(MRF24J40_NORMAL_TX_FIFO + 1, buf_len);
+  MRF24J40_CSn_LOW();
+  MRF24J40_SPI_PORT_WRITE(msg, 4);
+  MRF24J40_SPI_PORT_WRITE_BURST((uint8_t *)buf, buf_len);
+  MRF24J40_CSn_HIGH();
+  SPI_TRANSACTION(4 + buf_len);
 
-  for(i = 0; i < buf_len; ++i) {
-    set_long_add_mem(MRF24J40_NORMAL_TX_FIFO + 2 + i, buf[i]);
+  if(tmp) {
+    MRF24J40_INTERRUPT_ENABLE_SET();
   }
 
   return 0;
@@ -421,38 +528,51 @@ mrf24j40_set_txfifo(const uint8_t *buf, uint8_t buf_len)
 int32_t
 mrf24j40_get_rxfifo(uint8_t *buf, uint8_t buf_len)
 {
-  uint8_t i, len;
+  const uint8_t tmp = MRF24J40_INTERRUPT_ENABLE_STAT();
+  uint8_t len;
+  uint8_t msg[2];
+  uint8_t tail[4];
 
-  MRF24J40_INTERRUPT_ENABLE_CLR();
+  if(tmp) {
+    MRF24J40_INTERRUPT_ENABLE_CLR();
+  }
 
   /* Disable packet reception */
   set_short_add_mem(MRF24J40_BBREG1, 0b00000100);
 
-  /* Get packet length discarding 2 bytes (LQI, RSSI) */
-  len = get_long_add_mem(MRF24J40_RX_FIFO) - 2;
-  
-  if(len <= buf_len) {
+  msg[0] = LONG_ADD_HI(MRF24J40_RX_FIFO);
+  msg[1] = LONG_ADD_LO(MRF24J40_RX_FIFO);
+
+  /* Length and frame in one burst read, CSn is kept low after the length */
+  MRF24J40_CSn_LOW();
+  MRF24J40_SPI_PORT_WRITE(msg, 2);
+  MRF24J40_SPI_PORT_READ(&len, 1);
+
+  /* Get packet length discarding 2 bytes (FCS) */
+  len -= 2;
+
+  if((len > 0) && (len <= buf_len)) {
     /* Get the packet */
-    for(i = 0; i < len; ++i) {
-      buf[i] = get_long_add_mem(MRF24J40_RX_FIFO + i + 1);
-    }
+    MRF24J40_SPI_PORT_READ_BURST(buf, len);
 
     /*
      * packet len includes = header + paylod + LQI + RSSI
      */
-#ifdef ADD_RSSI_AND_LQI_TO_PACKET
-    mrf24j40_last_lqi = get_long_add_mem(MRF24J40_RX_FIFO + len + 3);
-    mrf24j40_last_rssi = get_long_add_mem(MRF24J40_RX_FIFO + len + 4);
-#endif
+    /* FCS, LQI and RSSI follow the frame */
+    MRF24J40_SPI_PORT_READ(tail, 4);
+    mrf24j40_last_lqi = tail[2];
+    mrf24j40_last_rssi = tail[3];
+    MRF24J40_CSn_HIGH();
+    SPI_TRANSACTION(7 + len);
   } else {
+    MRF24J40_CSn_HIGH();
+    SPI_TRANSACTION(3);
     len = 0;
   }
 
   /* Enable packet reception */
   set_short_add_mem(MRF24J40_BBREG1, 0b00000000);
   
-  pending = 0;
-  
 #ifdef MRF24J40_PROMISCUOUS_MODE
   /*
    * Flush RX FIFO as suggested by the work around 1 in
@@ -461,11 +581,147 @@ mrf24j40_get_rxfifo(uint8_t *buf, uint8_t buf_len)
   flush_rx_fifo();
 #endif
   
-  MRF24J40_INTERRUPT_ENABLE_SET();
+  if(tmp) {
+    MRF24J40_INTERRUPT_ENABLE_SET();
+  }
 
   return len == 0 ? -1 : len;
 }
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief Store the received frame
+ *
+ *        This routine is called by the RXIF interrupt. It moves the frame
+ *        from the RX_FIFO to the RX ring, with its reception time, LQI and
+ *        RSSI, so the FIFO is free for the next frame.
+ */
+static void
+rx_ring_put(void)
+{
+  struct rx_slot *slot;
+  int32_t len;
+
+  if(RX_RING_USED() >= MRF24J40_RX_SLOTS) {
+    /* No slot for the frame, discard it so the FIFO is not stale */
+    flush_rx_fifo();
+    rx_stats.overruns++;
+    return;
+  }
+
+  slot = &rx_ring[rx_head & (MRF24J40_RX_SLOTS - 1)];
+  slot->stamp = RTIMER_NOW();
+
+  len = mrf24j40_get_rxfifo(slot->data, sizeof(slot->data));
+  if(len < 0) {
+    rx_stats.drops++;
+    return;
+  }
+
+  slot->len = (uint8_t)len;
+  slot->lqi = mrf24j40_last_lqi;
+  slot->rssi = mrf24j40_last_rssi;
+
+  rx_head++;
+
+  rx_stats.frames++;
+  if(RX_RING_USED() > rx_stats.max_used) {
+    rx_stats.max_used = RX_RING_USED();
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Get a frame from the RX ring
+ *
+ *        This routine copies the oldest frame of the RX ring to buf and
+ *        frees its slot. It returns the frame length, or 0 when the ring
+ *        is empty or the frame does not fit in buf.
+ */
+static int
+rx_ring_get(void *buf, uint16_t buf_len, rtimer_clock_t *stamp)
+{
+  struct rx_slot *slot;
+  int len;
+
+  if(RX_RING_USED() == 0) {
+    return 0;
+  }
+
+  slot = &rx_ring[rx_tail & (MRF24J40_RX_SLOTS - 1)];
+  len = slot->len;
+
+  if(len <= buf_len) {
+    memcpy(buf, slot->data, len);
+    mrf24j40_last_lqi = slot->lqi;
+    mrf24j40_last_rssi = slot->rssi;
+    if(stamp != NULL) {
+      *stamp = slot->stamp;
+    }
+  } else {
+    rx_stats.drops++;
+    len = 0;
+  }
+
+  rx_tail++;
+
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Get the reception statistics
+ *
+ *        This routine returns the frames stored in the RX ring, the frames
+ *        dropped for a bad length and the frames lost with the ring full.
+ */
+void
+mrf24j40_get_rx_stats(struct mrf24j40_rx_stats *stats, uint8_t reset)
+{
+  const uint8_t tmp = MRF24J40_INTERRUPT_ENABLE_STAT();
+
+  if(tmp) {
+    MRF24J40_INTERRUPT_ENABLE_CLR();
+  }
+
+  *stats = rx_stats;
+
+  if(reset) {
+    memset(&rx_stats, 0, sizeof(rx_stats));
+  }
+
+  if(tmp) {
+    MRF24J40_INTERRUPT_ENABLE_SET();
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if MRF24J40_SPI_STATS
+/**
+ * \brief Get the SPI statistics
+ *
+ *        This routine returns the number of SPI transactions and bytes
+ *        since the last reset, to measure the cost of the radio traffic.
+ */
+void
+mrf24j40_get_spi_stats(uint32_t *transactions, uint32_t *bytes, uint8_t reset)
+{
+  const uint8_t tmp = MRF24J40_INTERRUPT_ENABLE_STAT();
+
+  if(tmp) {
+    MRF24J40_INTERRUPT_ENABLE_CLR();
+  }
+
+  *transactions = spi_transactions;
+  *bytes = spi_bytes;
+
+  if(reset) {
+    spi_transactions = 0;
+    spi_bytes = 0;
+  }
+
+  if(tmp) {
+    MRF24J40_INTERRUPT_ENABLE_SET();
+  }
+}
+/*---------------------------------------------------------------------------*/
+#endif
 /**
  * \brief Start sleep
  *
@@ -724,7 +980,8 @@ mrf24j40_init(void)
   mrf24j40_last_lqi = 0;
   mrf24j40_last_rssi = 0;
   status_tx = MRF24J40_TX_ERR_NONE;
-  pending = 0;
+  rx_head = 0;
+  rx_tail = 0;
 
   receive_on = 1;
   ENERGEST_ON(ENERGEST_TYPE_LISTEN);
@@ -736,6 +993,12 @@ mrf24j40_init(void)
 
   process_start(&mrf24j40_process, NULL);
 
+#if MRF24J40_TX_SEM
+  if(tx_sem == NULL) {
+    (void)OSSemCreate(0, &tx_sem);
+  }
+#endif
+
   /*
    *
    * Setup interrupts.
@@ -787,6 +1050,10 @@ mrf24j40_transmit(unsigned short len)
   PRINTF("TRANSMIT %u bytes\n", len);
 
   uint8_t receive_was_on = receive_on;
+#if MRF24J40_TX_SEM
+  /* Only a task can block, the init and the interrupts keep spinning */
+  const uint8_t use_sem = (tx_sem != NULL) && (currentTask != 0) && (iNesting == 0);
+#endif
 
   mrf24j40_on();
 
@@ -796,9 +1063,27 @@ mrf24j40_transmit(unsigned short len)
   
   status_tx = MRF24J40_TX_WAIT;
 
+#if MRF24J40_TX_SEM
+  if(use_sem) {
+    /* Drop the completion of a transmission that timed out */
+    while(OSSemPend(tx_sem, NO_TIMEOUT) == OK) {
+      ;
+    }
+  }
+#endif
+
   set_short_add_mem(MRF24J40_TXNCON, 0b00000001);
 
   /* Wait until the transmission has finished. */
+#if MRF24J40_TX_SEM
+  if(use_sem) {
+    /* Other tasks run during the airtime, TXNIF posts the semaphore */
+    if((OSSemPend(tx_sem, MRF24J40_TX_TIMEOUT) != OK) &&
+       (status_tx == MRF24J40_TX_WAIT)) {
+      status_tx = MRF24J40_TX_ERR_NOTSPECIFIED;
+    }
+  }
+#endif
   while(status_tx == MRF24J40_TX_WAIT) {
     ;
   }
@@ -842,7 +1127,7 @@ mrf24j40_write(const void *data, uint16_t len)
 int
 mrf24j40_read(void *data, uint16_t len)
 {
-  return mrf24j40_get_rxfifo(data, len);
+  return rx_ring_get(data, len, NULL);
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -878,7 +1163,7 @@ mrf24j40_receiving_packet(void)
 int
 mrf24j40_pending_packet(void)
 {
-  return pending;
+  return RX_RING_USED() != 0;
 }
 /*---------------------------------------------------------------------------*/
 void MRF24J40_ISR(void)
@@ -896,7 +1181,7 @@ void MRF24J40_ISR(void)
 
   if(int_status.bits.RXIF) {
   
-    pending = 1;
+    rx_ring_put();
     
     process_poll(&mrf24j40_process);
 
@@ -915,6 +1200,12 @@ void MRF24J40_ISR(void)
     } else {
       status_tx = MRF24J40_TX_ERR_NONE;
     }
+
+#if MRF24J40_TX_SEM
+    if(tx_sem != NULL) {
+      OSSemPost(tx_sem);
+    }
+#endif
   }
   
   MRF24J40_INTERRUPT_FLAG_CLR();
@@ -924,6 +1215,17 @@ void MRF24J40_ISR(void)
 
 extern BRTOS_Sem *Contiki_Sem;
 
+#if MRF24J40_DEFERRED_ISR
+static void
+mrf24j40_isr_work(void *arg)
+{
+  (void)arg;
+
+  MRF24J40_ISR();
+  OSSemPost(Contiki_Sem);
+}
+#endif
+
 #if !__GNUC__
 #if (NESTING_INT == 1)
 #pragma TRAP_PROC
@@ -944,8 +1246,14 @@ void Radio_Interrupt(void)
   // ************************
 #endif
 
+#if MRF24J40_DEFERRED_ISR
+  /* The INTSTAT read by the worker task releases the interrupt line */
+  MRF24J40_INTERRUPT_FLAG_CLR();
+  (void)OSWorkSubmit(mrf24j40_isr_work, NULL);
+#else
   MRF24J40_ISR();
   OSSemPost(Contiki_Sem);
+#endif
 
   // ************************
   // Sada de interrupo
@@ -971,27 +1279,31 @@ PROCESS_THREAD(mrf24j40_process, ev, data)
 {
   PROCESS_BEGIN();
   
-  uint8_t ret;
+  int ret;
+  rtimer_clock_t stamp;
 
   while(1) {
     PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
     
-    if(!pending) {
-      continue;
-    }
-    
-    packetbuf_clear();
+    /* Hand every frame of the RX ring to the RDC */
+    while(RX_RING_USED() != 0) {
+      packetbuf_clear();
     
-    ret = mrf24j40_read(packetbuf_dataptr(), PACKETBUF_SIZE);
+      ret = rx_ring_get(packetbuf_dataptr(), PACKETBUF_SIZE, &stamp);
+      if(ret <= 0) {
+        continue;
+      }
     
-    packetbuf_set_datalen(ret);
+      packetbuf_set_datalen(ret);
+      packetbuf_set_attr(PACKETBUF_ATTR_TIMESTAMP, (uint16_t)stamp);
     
 #ifdef ADD_RSSI_AND_LQI_TO_PACKET
-    packetbuf_set_attr(PACKETBUF_ATTR_RSSI, mrf24j40_last_rssi);
-    packetbuf_set_attr(PACKETBUF_ATTR_LINK_QUALITY, mrf24j40_last_lqi);
+      packetbuf_set_attr(PACKETBUF_ATTR_RSSI, mrf24j40_last_rssi);
+      packetbuf_set_attr(PACKETBUF_ATTR_LINK_QUALITY, mrf24j40_last_lqi);
 #endif
 
-    NETSTACK_RDC.input();
+      NETSTACK_RDC.input();
+    }
   }
 
   PROCESS_END();
@@ -61,6 +61,17 @@ extern const struct radio_driver mrf24j40_driver;
 #define MRF24J40_TX_ERR_MAXRETRY        3
 #define MRF24J40_TX_WAIT                4
 
+/* Largest frame without the FCS */
+#define MRF24J40_MAX_PAYLOAD            125
+
+/* Reception statistics */
+struct mrf24j40_rx_stats {
+  uint32_t frames;      /* frames stored in the RX ring */
+  uint32_t drops;       /* frames with a bad length */
+  uint32_t overruns;    /* frames lost with the RX ring full */
+  uint8_t max_used;     /* highest number of slots in use */
+};
+
 /* Functions prototypes */
 void mrf24j40_set_as_pan_coordinator(uint8_t flag);
 void mrf24j40_set_channel(uint16_t ch);
@@ -77,6 +88,8 @@ uint8_t mrf24j40_get_last_rssi(void);
 uint8_t mrf24j40_get_last_lqi(void);
 int32_t mrf24j40_set_txfifo(const uint8_t * buf, uint8_t buf_len);
 int32_t mrf24j40_get_rxfifo(uint8_t * buf, uint8_t buf_len);
+void mrf24j40_get_rx_stats(struct mrf24j40_rx_stats * stats, uint8_t reset);
+void mrf24j40_get_spi_stats(uint32_t * transactions, uint32_t * bytes, uint8_t reset);
 
 /* Long address registers */
 #define MRF24J40_RFCON0         (0x200)
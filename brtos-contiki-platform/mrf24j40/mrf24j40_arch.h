@@ -68,6 +68,8 @@
 #elif BRTOS_PLATFORM == BOARD_ROTEADORCFV1
 #include "drivers.h"
 #endif
+#elif defined(BOARD_POSIX) && (BRTOS_PLATFORM == BOARD_POSIX)
+#include "mrf24j40_emu.h"
 #else
 #error "Please define your platform"
 #endif
@@ -112,6 +114,42 @@
 #define MRF24J40_SPI_PORT_WRITE 			SPI0_SendChar
 #define MRF24J40_SPI_PORT_READ  			SPI0_GetChar
 
+#elif defined(BOARD_POSIX) && (BRTOS_PLATFORM == BOARD_POSIX)
+
+/* Emulated radio of the POSIX port, the pins have no effect */
+#define MRF24J40_CS_AS_IO
+#define MRF24J40_CS_DS
+#define MRF24J40_CS_LOW       	mrf24j40_emu_csn(0)
+#define MRF24J40_CS_HIGH     	mrf24j40_emu_csn(1)
+#define MRF24J40_CS_DIR_IN
+#define MRF24J40_CS_DIR_OUT
+#define MRF24J40_RESETn_AS_IO
+#define MRF24J40_RESETn_DS
+#define MRF24J40_RESETn_LOW
+#define MRF24J40_RESETn_HIGH
+#define MRF24J40_RESETn_DIR_IN
+#define MRF24J40_RESETn_DIR_OUT
+#define MRF24J40_WAKE_AS_IO
+#define MRF24J40_WAKE_DS
+#define MRF24J40_WAKE_LOW
+#define MRF24J40_WAKE_HIGH
+#define MRF24J40_WAKE_DIR_IN
+#define MRF24J40_WAKE_DIR_OUT
+#define MRF24J40_PIN_CLOCK_INIT
+
+#define MRF24J40_INT_ENABLE()				int_status = 1;			\
+											mrf24j40_emu_int_enable(1)
+#define MRF24J40_INTERRUPT_FLAG_CLR()
+#define MRF24J40_INTERRUPT_ENABLE_CLR()		int_status = 0;			\
+											mrf24j40_emu_int_enable(0)
+#define MRF24J40_INTERRUPT_ENABLE_SET()		int_status = 1;			\
+											mrf24j40_emu_int_enable(1)
+
+/* Spi port Mapping */
+#define MRF24J40_SPI_PORT_INIT()  			mrf24j40_emu_init()
+#define MRF24J40_SPI_PORT_WRITE 			mrf24j40_emu_spi_write
+#define MRF24J40_SPI_PORT_READ  			mrf24j40_emu_spi_read
+
 #elif BRTOS_PLATFORM == BOARD_COLDUINO || BRTOS_PLATFORM == BOARD_ROTEADORCFV1
 
 #if BRTOS_PLATFORM == BOARD_COLDUINO
@@ -243,6 +281,20 @@
 
 #endif
 
+/*
+ * Burst transfers of the TX and RX FIFOs. The MRF24J40 increments the
+ * long address while CSn stays low, so a whole frame is moved in one SPI
+ * transaction. By default they use the byte-wise port functions; a board
+ * with a SPI DMA channel may map them to a DMA transfer that returns once
+ * the last byte is clocked.
+ */
+#ifndef MRF24J40_SPI_PORT_WRITE_BURST
+#define MRF24J40_SPI_PORT_WRITE_BURST       MRF24J40_SPI_PORT_WRITE
+#endif
+#ifndef MRF24J40_SPI_PORT_READ_BURST
+#define MRF24J40_SPI_PORT_READ_BURST        MRF24J40_SPI_PORT_READ
+#endif
+
 /* RESET low/high */
 #define MRF24J40_HARDRESET_LOW()            MRF24J40_RESETn_LOW     					///< RESET pin = 0
 #define MRF24J40_HARDRESET_HIGH()           MRF24J40_RESETn_HIGH     					///< RESET pin = 1
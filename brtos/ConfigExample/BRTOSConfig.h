@@ -26,14 +26,42 @@
 /// Define if compute cpu load is active
 #define COMPUTES_CPU_LOAD 		1
 
+/// Define if the processor time, context switches and longest blocking time of each task are measured
+/// The time source is OS_TIMESTAMP() from the HAL. For HALs without one it can be defined here
+/// (with OS_TIMESTAMP_HZ), otherwise the tick count is used.
+/// When active the CPU load is computed from the idle task processor time
+#define OS_TASK_RUNTIME_EN 		0
+
+/// Define if the task stacks are painted at install, to measure their peak usage
+/// (OSTaskStackUsage, OSStackReport) and recommend their sizes
+#define OS_STACK_WATERMARK_EN 	0
+
+/// Define if the last OS_STACK_GUARD_SIZE bytes of the stack of the task leaving the
+/// processor are verified on every context switch. Requires OS_STACK_WATERMARK_EN and
+/// the user function OSStackOverflowHook()
+#define OS_STACK_GUARD_EN 		0
+
 // The Nesting define must be set in the file HAL.h
 // Example:
 /// Define if nesting interrupt is active
 //#define NESTING_INT 0
 
-/// Define Number of Priorities
+/// Define Number of Priorities (8, 16, 32 or 64)
 #define NUMBER_OF_PRIORITIES 	32
 
+/// Define the scheduler implementation
+/// SCHEDULER_DEFAULT  - HAL optimized scheduler if available, otherwise the portable one
+/// SCHEDULER_PORTABLE - portable successive approximation scheduler
+/// SCHEDULER_CLZ      - count leading zeros scheduler (GCC __builtin_clz)
+#define SCHEDULER_TYPE 			SCHEDULER_DEFAULT
+
+/// Enable or disable the shared priorities
+/// Several tasks may be installed at the same priority, they run in FIFO order
+/// and share the processor in time slices of RR_TIME_SLICE ticks (0 disables the slices).
+/// The task count is not limited by the TaskAlloc bits anymore.
+#define BRTOS_SHARED_PRIORITY_EN 	0
+#define RR_TIME_SLICE 			10
+
 /// Define the maximum number of Tasks to be Installed
 /// must always be equal or higher to NumberOfInstalledTasks
 #define NUMBER_OF_TASKS 		(INT8U)10
@@ -49,11 +77,15 @@
 #define configMAX_TASK_NAME_LEN 32
 
 /// Define if OS Trace is active
+/// Records the kernel events in a ring, drained with OSTraceRead or OSTraceSendSLIP
+/// and decoded on the host by tools/brtos-trace-decode.py
 #define OSTRACE 0
 
-#if (OSTRACE == 1)  
-  #include "debug_stack.h"
-#endif
+/// Number of records of the trace ring (8 bytes each), must be a power of 2
+#define OS_TRACE_SIZE 256
+
+/// Records the tick interrupt entry and exit
+#define OS_TRACE_TICK_EN 0
 
 /// Define if TimerHook function is active
 #define TIMER_HOOK_EN 0
@@ -61,27 +93,81 @@
 /// Define if IdleHook function is active
 #define IDLE_HOOK_EN 0
 
+/// Enable or disable the tickless idle mode
+/// The HAL must provide OSTicklessSleep() or OS_TICKLESS_SLEEP(ticks) must be defined here
+/// If TimerHook is active, BRTOS_TimerHookNextEvent() must also be provided
+#define TICKLESS_IDLE_EN 0
+
+/// Minimum idle time, in ticks, to suppress the tick timer
+#define TICKLESS_MIN_IDLE_TICKS 2
+
 /// Enable or disable timers service
 #define BRTOS_TMR_EN           1
 
+/// Max number of soft timers (up to 65534, stop and restart are O(log n))
+#define BRTOS_MAX_TIMER        8
+
+/// Enable or disable the immediate soft timers, whose callbacks run from the tick interrupt
+#define BRTOS_TMR_IMMEDIATE_EN 0
+
+/// Enable or disable the soft timers callback latency histograms
+#define BRTOS_TMR_LATENCY_EN   0
+
 /// Enable or disable semaphore controls
 #define BRTOS_SEM_EN           1
 
 /// Enable or disable binary semaphore controls
 #define BRTOS_BINARY_SEM_EN	   1
 
+/// Enable or disable the lock free semaphore pend and post when nobody waits
+/// Needs OS_CPU_CAS16 from the HAL (GCC Cortex-M3/M4 and POSIX ports), ignored otherwise
+#define BRTOS_SEM_FAST_EN      0
+
 /// Enable or disable mutex controls
 #define BRTOS_MUTEX_EN         1
 
+/// Enable or disable the priority inheritance mutexes, created with MUTEX_PRIORITY_INHERITANCE
+/// instead of a ceiling priority. The owner only runs at the priority of the tasks blocked on the mutex
+#define BRTOS_MUTEX_INHERITANCE_EN 0
+
+/// Enable or disable the mutex contention counter and hold time measurement (OSMutexQuery)
+#define BRTOS_MUTEX_STATS_EN   0
+
 /// Enable or disable mailbox controls
 #define BRTOS_MBOX_EN          1
 
+/// Enable or disable the multi-slot mailboxes (OSMboxCreateMulti) and the broadcast post (OSMboxPostAll)
+#define BRTOS_MBOX_MULTI_EN    0
+
+/// Defines the maximum number of messages kept by a multi-slot mailbox
+#define BRTOS_MBOX_MAX_SLOTS   4
+
 /// Enable or disable queue controls
 #define BRTOS_QUEUE_EN         1
 
+/// Enable or disable event groups and the wait for multiple semaphores, mailboxes and queues
+#define BRTOS_EVENT_GROUP_EN   0
+
 /// Enable or disable dynamic queue controls
 #define BRTOS_DYNAMIC_QUEUE_ENABLED	1
 
+/// Enable or disable the pools of fixed size memory blocks
+/// The pools added with OSMemHeapAdd can back the dynamic tasks and queues by defining
+/// BRTOS_ALLOC as OSMemAlloc and BRTOS_DEALLOC as OSMemFree
+#define BRTOS_MEMPOOL_EN       0
+
+/// Enable or disable the message queues (pool allocated messages passed by reference)
+/// Needs the dynamic queue controls and the memory pools
+#define BRTOS_MSG_QUEUE_EN     0
+
+/// Enable or disable the work queue, a worker task that runs the functions queued by the interrupts
+/// Installed by OSWorkQueueInit, holds BRTOS_WORKQ_SIZE work items (default 16)
+#define BRTOS_WORKQ_EN         0
+
+/// Enable or disable the single producer / single consumer queue
+/// Needs the binary semaphores and the BRTOS memory allocation method
+#define BRTOS_SPSC_QUEUE_EN    0
+
 /// Enable or disable queue 16 bits controls
 #define BRTOS_QUEUE_16_EN      0
 
@@ -104,6 +190,14 @@
 /// Limits the memory allocation for queues
 #define BRTOS_MAX_QUEUE        20
 
+/// Defines the maximum number of event groups\n
+/// Limits the memory allocation for event groups
+#define BRTOS_MAX_EVENT_GROUP  4
+
+/// Defines the maximum number of memory pools\n
+/// Each message pool uses one memory pool
+#define BRTOS_MAX_MEMPOOL      4
+
 
 /// TickTimer Defines
 #define configCPU_CLOCK_HZ          	(INT32U)168000000   ///< CPU clock in Hertz
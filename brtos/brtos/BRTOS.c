@@ -99,6 +99,14 @@ CHAR8 BufferText[TEXT_BUFFER_SIZE];
 #endif
                      
 INT8U PriorityVector[configMAX_TASK_INSTALL];   ///< Allocate task priorities
+#if (BRTOS_SHARED_PRIORITY_EN == 1)
+INT8U OSReadyHead[configMAX_TASK_INSTALL];      ///< First ready task of each priority, the one that runs
+INT8U OSReadyTail[configMAX_TASK_INSTALL];      ///< Last ready task of each priority
+INT8U OSPriorityTasks[configMAX_TASK_INSTALL];  ///< Number of tasks installed at each priority
+static INT8U  OSWaitHead[configMAX_TASK_INSTALL]; ///< First task waiting for an event at each priority
+static INT8U  OSWaitTail[configMAX_TASK_INSTALL]; ///< Last task waiting for an event at each priority
+static INT16U OSSliceCounter = 0;               ///< Ticks used by the current task in its time slice
+#endif
 INT16U iStackAddress = 0;                       ///< Virtual stack counter - Informs the stack occupation in bytes
 
 
@@ -122,7 +130,10 @@ INT8U NumberOfInstalledTasks;                 ///< Number of Installed tasks at
 volatile INT8U currentTask;                            ///< Current task being executed
 volatile INT8U SelectedTask;
 
-#if (NUMBER_OF_PRIORITIES > 16)
+#if (NUMBER_OF_PRIORITIES > 32)
+  PriorityType OSReadyList = 0;
+  PriorityType OSBlockedList = 0xFFFFFFFFFFFFFFFFULL;
+#elif (NUMBER_OF_PRIORITIES > 16)
   PriorityType OSReadyList = 0;
   PriorityType OSBlockedList = 0xFFFFFFFF;
 #else
@@ -136,6 +147,7 @@ volatile INT8U SelectedTask;
 #endif
 
 static   INT16U OSTickCounter;                    ///< Incremented each tick timer - Used in delay and timeout functions
+static   INT32U OSMonotonicCounter;               ///< Incremented each tick timer and never folded - Used by the soft timers
 volatile INT32U OSDuty=0;                         ///< Used to compute the CPU load
 volatile INT32U OSDutyTmp=0;                      ///< Used to compute the CPU load
 
@@ -146,7 +158,20 @@ volatile INT16U LastOSDuty = 0;                   ///< Last CPU load computed
 #endif
 
 INT16U DutyCnt = 0;                               ///< Used to compute the CPU load
+
+#if (OS_TASK_RUNTIME_EN == 1)
+static INT8U  OSRuntimeTask = 0;                  ///< Task being charged for the processor time
+static OS_TIMESTAMP_TYPE OSRuntimeStamp = 0;      ///< Timestamp of the last processor time update
+#if (COMPUTES_CPU_LOAD == 1)
+static OS_TIMESTAMP_TYPE OSLoadStamp = 0;         ///< Timestamp of the last CPU load computation
+static INT32U OSLoadIdleTime = 0;                 ///< Idle task processor time in the last CPU load computation
+#endif
+#endif
+#if (NUMBER_OF_PRIORITIES > 32)
+INT64U TaskAlloc = 0;                             ///< Used to search a empty task control block
+#else
 INT32U TaskAlloc = 0;                             ///< Used to search a empty task control block
+#endif
 INT8U  iNesting = 0;                              ///< Used to inform if the current code position is an interrupt handler code
 
 ContextType *Tail;
@@ -157,7 +182,27 @@ volatile INT8U flag_load = TRUE;
 #endif
 
 
-#if (NUMBER_OF_PRIORITIES > 16)
+#if (NUMBER_OF_PRIORITIES > 32)
+  const PriorityType PriorityMask[configMAX_TASK_PRIORITY+1]=
+  {
+    0x0000000000000001ULL,0x0000000000000002ULL,0x0000000000000004ULL,0x0000000000000008ULL,
+    0x0000000000000010ULL,0x0000000000000020ULL,0x0000000000000040ULL,0x0000000000000080ULL,
+    0x0000000000000100ULL,0x0000000000000200ULL,0x0000000000000400ULL,0x0000000000000800ULL,
+    0x0000000000001000ULL,0x0000000000002000ULL,0x0000000000004000ULL,0x0000000000008000ULL,
+    0x0000000000010000ULL,0x0000000000020000ULL,0x0000000000040000ULL,0x0000000000080000ULL,
+    0x0000000000100000ULL,0x0000000000200000ULL,0x0000000000400000ULL,0x0000000000800000ULL,
+    0x0000000001000000ULL,0x0000000002000000ULL,0x0000000004000000ULL,0x0000000008000000ULL,
+    0x0000000010000000ULL,0x0000000020000000ULL,0x0000000040000000ULL,0x0000000080000000ULL,
+    0x0000000100000000ULL,0x0000000200000000ULL,0x0000000400000000ULL,0x0000000800000000ULL,
+    0x0000001000000000ULL,0x0000002000000000ULL,0x0000004000000000ULL,0x0000008000000000ULL,
+    0x0000010000000000ULL,0x0000020000000000ULL,0x0000040000000000ULL,0x0000080000000000ULL,
+    0x0000100000000000ULL,0x0000200000000000ULL,0x0000400000000000ULL,0x0000800000000000ULL,
+    0x0001000000000000ULL,0x0002000000000000ULL,0x0004000000000000ULL,0x0008000000000000ULL,
+    0x0010000000000000ULL,0x0020000000000000ULL,0x0040000000000000ULL,0x0080000000000000ULL,
+    0x0100000000000000ULL,0x0200000000000000ULL,0x0400000000000000ULL,0x0800000000000000ULL,
+    0x1000000000000000ULL,0x2000000000000000ULL,0x4000000000000000ULL,0x8000000000000000ULL
+  };
+#elif (NUMBER_OF_PRIORITIES > 16)
   const PriorityType PriorityMask[configMAX_TASK_PRIORITY+1]=
   {
     0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80,0x0100,0x0200,0x0400,0x0800,0x1000,0x2000,0x4000,0x8000,
@@ -194,6 +239,10 @@ volatile INT8U flag_load = TRUE;
 #if (BRTOS_MUTEX_EN == 1)
   /// Mutex Control Block
   BRTOS_Mutex      BRTOS_Mutex_Table[BRTOS_MAX_MUTEX];    // Table of EVENT control blocks
+  #if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+  PriorityType     OSMutexInheritList = 0;               // Priorities lent to mutex owners
+  INT8U            OSMutexInheritor[configMAX_TASK_INSTALL];
+  #endif
 #endif
 
 
@@ -216,6 +265,24 @@ volatile INT8U flag_load = TRUE;
 #endif
 
 
+////////////////////////////////////////////////////////////
+/////      Event Group Control Block Declaration       /////
+////////////////////////////////////////////////////////////
+#if (BRTOS_EVENT_GROUP_EN == 1)
+  /// Event Group Control Block
+  BRTOS_EventGroup BRTOS_EventGroup_Table[BRTOS_MAX_EVENT_GROUP];   // Table of EVENT control blocks
+#endif
+
+
+////////////////////////////////////////////////////////////
+/////      Memory Pool Control Block Declaration       /////
+////////////////////////////////////////////////////////////
+#if (BRTOS_MEMPOOL_EN == 1)
+  /// Memory Pool Control Block
+  BRTOS_MemPool    BRTOS_MemPool_Table[BRTOS_MAX_MEMPOOL];   // Table of memory pool control blocks
+#endif
+
+
 ///// RAM definitions
 #ifdef OS_CPU_TYPE
 #if (!BRTOS_DYNAMIC_TASKS_ENABLED)
@@ -252,13 +319,451 @@ ContextType ContextTask[NUMBER_OF_TASKS + 1];          ///< Task context info
 * \brief Priority Preemptive Scheduler (Internal kernel function).
 ****************************************************************/
 
+#if (OS_TASK_RUNTIME_EN == 1)
+void OSRuntimeUpdate(void)
+{
+  OS_TIMESTAMP_TYPE now = OS_TIMESTAMP();
+  
+  ContextTask[OSRuntimeTask].RunTime += (INT32U)(now - OSRuntimeStamp);
+  OSRuntimeStamp = now;
+}
+
+
+static void OSRuntimeSwitch(INT8U NextTask)
+{
+  ContextType *Task = &ContextTask[OSRuntimeTask];
+  INT32U blocked;
+  
+  OSRuntimeUpdate();
+  
+  // The task leaving the processor blocked if it is not ready anymore
+  if ((Task->Priority < NUMBER_OF_PRIORITIES) && !OSTaskReady(Task))
+  {
+    Task->Blocking = TRUE;
+    Task->BlockStart = OSRuntimeStamp;
+  }
+  
+  Task = &ContextTask[NextTask];
+  Task->Switches++;
+  
+  if (Task->Blocking)
+  {
+    Task->Blocking = FALSE;
+    blocked = OS_TIMESTAMP_SPAN(OSRuntimeStamp - Task->BlockStart);
+    if (blocked > Task->MaxBlockTime)
+    {
+      Task->MaxBlockTime = blocked;
+    }
+  }
+  
+  OSRuntimeTask = NextTask;
+}
+
+
+#if (COMPUTES_CPU_LOAD == 1)
+// CPU load, in tenths of percent, from the idle task processor time
+static INT32U OSRuntimeLoad(void)
+{
+  INT32U elapsed, idle, busy;
+  ContextType *Task = &ContextTask[PriorityVector[0]];
+  
+  OSRuntimeUpdate();
+  
+  elapsed = OS_TIMESTAMP_SPAN(OSRuntimeStamp - OSLoadStamp);
+  idle = Task->RunTime - OSLoadIdleTime;
+  OSLoadStamp = OSRuntimeStamp;
+  OSLoadIdleTime = Task->RunTime;
+  
+  if ((elapsed == 0) || (idle >= elapsed))
+  {
+    return 0;
+  }
+  
+  busy = elapsed - idle;
+  if (elapsed >= 1000)
+  {
+    busy = busy / (elapsed / 1000);
+  }else
+  {
+    busy = (busy * 1000) / elapsed;
+  }
+  
+  return (busy > 1000) ? 1000 : busy;
+}
+#endif
+#endif
+
+
+#if (OS_STACK_WATERMARK_EN == 1)
+// Only the virtual stacks of the static install of STACK_GROWTH == 1 ports grow up
+#if (STACK_GROWTH == 1) && (BRTOS_DYNAMIC_TASKS_ENABLED == 0)
+#define OS_STACK_GROWS_UP   1
+#else
+#define OS_STACK_GROWS_UP   0
+#endif
+
+// Stack word filled with the paint byte
+#define OS_STACK_PATTERN    ((OS_CPU_TYPE)((OS_CPU_TYPE)~(OS_CPU_TYPE)0 / 0xFFu * OS_STACK_PAINT))
+
+// Lowest address of the task virtual stack
+static OS_CPU_TYPE *OSStackBottom(ContextType *Task)
+{
+  #if (BRTOS_DYNAMIC_TASKS_ENABLED == 0) && (STACK_GROWTH == 0)
+  return (OS_CPU_TYPE*)(Task->StackInit - Task->StackSize);
+  #else
+  return (OS_CPU_TYPE*)Task->StackInit;
+  #endif
+}
+
+static void OSStackPaint(OS_CPU_TYPE *stack, INT16U size)
+{
+  OS_CPU_TYPE *end = stack + (size / sizeof(OS_CPU_TYPE));
+  
+  while (stack < end)
+  {
+    *stack++ = OS_STACK_PATTERN;
+  }
+}
+
+// Never used words of the stack, counted from the far end of the stack. Resumes after
+// the unused words already counted and looks at no more than count words
+static INT16U OSStackUnused(const OS_CPU_TYPE *stack, INT16U words, INT16U unused, INT16U count)
+{
+  INT16U end = ((words - unused) > count) ? (INT16U)(unused + count) : words;
+  
+  #if (OS_STACK_GROWS_UP == 1)
+  stack += words - 1 - unused;
+  while ((unused < end) && (*stack-- == OS_STACK_PATTERN))
+  #else
+  stack += unused;
+  while ((unused < end) && (*stack++ == OS_STACK_PATTERN))
+  #endif
+  {
+    unused++;
+  }
+  
+  return unused;
+}
+
+#if (OS_STACK_GUARD_EN == 1)
+#define OS_STACK_GUARD_WORDS  ((OS_STACK_GUARD_SIZE + sizeof(OS_CPU_TYPE) - 1) / sizeof(OS_CPU_TYPE))
+
+// Verifies that the last words of the task stack were never written
+static void OSStackGuard(INT8U TaskNumber)
+{
+  ContextType *Task = &ContextTask[TaskNumber];
+  const OS_CPU_TYPE *stack;
+  INT8U i;
+  
+  // A task uninstalling itself has no stack anymore
+  if (Task->StackSize < (OS_STACK_GUARD_WORDS * sizeof(OS_CPU_TYPE)))
+  {
+    return;
+  }
+  
+  stack = OSStackBottom(Task);
+  #if (OS_STACK_GROWS_UP == 1)
+  stack += (Task->StackSize / sizeof(OS_CPU_TYPE)) - OS_STACK_GUARD_WORDS;
+  #endif
+  
+  for (i = 0; i < OS_STACK_GUARD_WORDS; i++)
+  {
+    if (stack[i] != OS_STACK_PATTERN)
+    {
+      OSStackOverflowHook((BRTOS_TH)TaskNumber);
+      return;
+    }
+  }
+}
+#endif
+#endif
+
+
+#if (BRTOS_SHARED_PRIORITY_EN == 1)
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Shared Priority Ready and Wait Lists        /////
+/////                                                  /////
+/////  The tasks of a priority wait in a FIFO queue,   /////
+/////  linked by the task numbers. The priority bit of /////
+/////  the ready list is set while its queue is not    /////
+/////  empty, so SAScheduler still selects the level.  /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+// Appends the task to the ready queue of its priority
+static void OSReadyLink(ContextType *Task)
+{
+  INT8U iPriority = Task->Priority;
+  
+  Task->ReadyNext = 0;
+  
+  if (OSReadyHead[iPriority] == 0)
+  {
+    OSReadyHead[iPriority] = Task->Id;
+    OSReadyList = OSReadyList | (PriorityMask[iPriority]);
+  }
+  else
+  {
+    ContextTask[OSReadyTail[iPriority]].ReadyNext = Task->Id;
+  }
+  
+  OSReadyTail[iPriority] = Task->Id;
+}
+
+// Removes the task from the ready queue of its priority
+static void OSReadyUnlink(ContextType *Task)
+{
+  INT8U iPriority = Task->Priority;
+  INT8U iTask = OSReadyHead[iPriority];
+  INT8U previous = 0;
+  
+  // The running task is usually the first one
+  while ((iTask != 0) && (iTask != Task->Id))
+  {
+    previous = iTask;
+    iTask = ContextTask[iTask].ReadyNext;
+  }
+  
+  if (iTask == 0)
+  {
+    return;
+  }
+  
+  if (previous == 0)
+  {
+    OSReadyHead[iPriority] = Task->ReadyNext;
+  }
+  else
+  {
+    ContextTask[previous].ReadyNext = Task->ReadyNext;
+  }
+  
+  if (OSReadyTail[iPriority] == Task->Id)
+  {
+    OSReadyTail[iPriority] = previous;
+  }
+  
+  if (OSReadyHead[iPriority] == 0)
+  {
+    OSReadyList = OSReadyList & ~(PriorityMask[iPriority]);
+  }
+  
+  Task->ReadyNext = 0;
+}
+
+void OSReadyInsert(ContextType *Task)
+{
+  if (!Task->Ready)
+  {
+    Task->Ready = TRUE;
+    if (!Task->Suspended)
+    {
+      OSReadyLink(Task);
+    }
+  }
+}
+
+void OSReadyRemove(ContextType *Task)
+{
+  if (Task->Ready)
+  {
+    Task->Ready = FALSE;
+    if (!Task->Suspended)
+    {
+      OSReadyUnlink(Task);
+    }
+  }
+}
+
+// Blocks a single task of a priority (OSBlockTask)
+static void OSReadySuspend(ContextType *Task)
+{
+  if (!Task->Suspended)
+  {
+    Task->Suspended = TRUE;
+    if (Task->Ready)
+    {
+      OSReadyUnlink(Task);
+    }
+  }
+}
+
+// Unblocks a single task of a priority (OSUnBlockTask)
+static void OSReadyResume(ContextType *Task)
+{
+  if (Task->Suspended)
+  {
+    Task->Suspended = FALSE;
+    if (Task->Ready)
+    {
+      OSReadyLink(Task);
+    }
+  }
+}
+
+// Appends the task to the wait queue of its priority. The tasks of a priority
+// waiting for any event share this queue, in arrival order
+void OSEventWaitInsert(PriorityType *waitlist, void *event, ContextType *Task)
+{
+  INT8U iPriority = Task->Priority;
+  
+  Task->WaitEvent = event;
+  Task->WaitNext = 0;
+  
+  if (OSWaitHead[iPriority] == 0)
+  {
+    OSWaitHead[iPriority] = Task->Id;
+  }
+  else
+  {
+    ContextTask[OSWaitTail[iPriority]].WaitNext = Task->Id;
+  }
+  
+  OSWaitTail[iPriority] = Task->Id;
+  *waitlist = *waitlist | (PriorityMask[iPriority]);
+}
+
+// Removes the task from the wait queue of its priority, and tells whether another
+// task of the priority keeps waiting for the same event. Only the tasks waiting at
+// the priority are walked
+static INT8U OSEventWaitUnlink(ContextType *Task)
+{
+  INT8U iPriority = Task->Priority;
+  INT8U iTask = OSWaitHead[iPriority];
+  INT8U previous = 0;
+  INT8U found = FALSE;
+  INT8U others = FALSE;
+  
+  while ((iTask != 0) && !(found && others))
+  {
+    if (iTask == Task->Id)
+    {
+      if (previous == 0)
+      {
+        OSWaitHead[iPriority] = Task->WaitNext;
+      }
+      else
+      {
+        ContextTask[previous].WaitNext = Task->WaitNext;
+      }
+      
+      if (OSWaitTail[iPriority] == Task->Id)
+      {
+        OSWaitTail[iPriority] = previous;
+      }
+      
+      found = TRUE;
+      iTask = Task->WaitNext;
+    }
+    else
+    {
+      if (ContextTask[iTask].WaitEvent == Task->WaitEvent)
+      {
+        others = TRUE;
+      }
+      previous = iTask;
+      iTask = ContextTask[iTask].WaitNext;
+    }
+  }
+  
+  Task->WaitNext = 0;
+  Task->WaitEvent = NULL;
+  
+  return others;
+}
+
+void OSEventWaitRemove(PriorityType *waitlist, ContextType *Task)
+{
+  INT8U iPriority = Task->Priority;
+  
+  if (!OSEventWaitUnlink(Task))
+  {
+    *waitlist = *waitlist & ~(PriorityMask[iPriority]);
+  }
+}
+
+INT8U OSEventWaitTake(PriorityType *waitlist, void *event, INT8U *priority)
+{
+  INT8U iPriority = SAScheduler(*waitlist);
+  INT8U iTask = OSWaitHead[iPriority];
+  
+  // The first task of the wait queue of the priority waiting for the event arrived first
+  while ((iTask != 0) && (ContextTask[iTask].WaitEvent != event))
+  {
+    iTask = ContextTask[iTask].WaitNext;
+  }
+  
+  if (!OSEventWaitUnlink(&ContextTask[iTask]))
+  {
+    *waitlist = *waitlist & ~(PriorityMask[iPriority]);
+  }
+  
+  *priority = iPriority;
+  return iTask;
+}
+#endif
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
 INT8U OSSchedule(void)
 {
 	INT8U TaskSelect = 0xFF;
 	INT8U Priority   = 0;
 	
   Priority = SAScheduler(OSReadyList & OSBlockedList);
+  
+  #if (BRTOS_MUTEX_EN == 1) && (BRTOS_MUTEX_INHERITANCE_EN == 1)
+  // The priority of a task blocked on a mutex runs the mutex owner
+  if (OSMutexInheritList)
+  {
+    Priority = OSMutexInheritPriority(Priority);
+  }
+  #endif
+  
+  #if (BRTOS_SHARED_PRIORITY_EN == 1)
+  // The first task of the ready queue of the priority runs
+  TaskSelect = OSReadyHead[Priority];
+  
+  // A task that gets the processor starts a new time slice
+  if (TaskSelect != currentTask)
+  {
+    OSSliceCounter = 0;
+  }
+  #else
   TaskSelect = PriorityVector[Priority];
+  #endif
+  
+  #if (BRTOS_MUTEX_EN == 1) && (BRTOS_MUTEX_INHERITANCE_EN == 1)
+  if (OSMutexInheritList & PriorityMask[Priority])
+  {
+    TaskSelect = OSMutexInheritor[Priority];
+  }
+  #endif
+  
+  #if (OS_STACK_GUARD_EN == 1)
+  // The task leaving the processor, or keeping it, is verified
+  if (currentTask)
+  {
+    OSStackGuard(currentTask);
+  }
+  #endif
+  
+  #if (OS_TASK_RUNTIME_EN == 1)
+  // The selected task is switched in by the caller
+  if (TaskSelect != OSRuntimeTask)
+  {
+    OSRuntimeSwitch(TaskSelect);
+  }
+  #endif
+  
+  #if (OSTRACE == 1)
+  OSTraceSwitch(TaskSelect);
+  #endif
   
   return TaskSelect;
 }
@@ -313,6 +818,24 @@ INT16U OSGetCount(void)
 
 
 
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Get the 32 bits monotonic tick count        /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+INT32U OSGetMonotonicCount(void)
+{
+  return OSMonotonicCounter;
+}
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 /////      Update the tick count                       /////
@@ -320,8 +843,79 @@ INT16U OSGetCount(void)
 ////////////////////////////////////////////////////////////
 void OSIncCounter(void)
 {
-	  OSTickCounter++;
-	  if (OSTickCounter == TickCountOverFlow) OSTickCounter = 0;
+	  OSTickCounter++;
+	  if (OSTickCounter == TickCountOverFlow) OSTickCounter = 0;
+	  OSMonotonicCounter++;
+}
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Delay List Functions                        /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+// Ticks left until the tick counter reaches the wake up time.
+// A wake up time equal to the current count means a full counter turn.
+#define DelayTicksLeft(wake)   (INT16U)(((wake) > OSTickCounter) ? ((wake) - OSTickCounter) : \
+                                        (((wake) + TICK_COUNT_OVERFLOW) - OSTickCounter))
+
+void OSDelayListInsert(ContextType *Task)
+{
+  ContextType *Prev = Tail;
+  INT16U ticks = DelayTicksLeft(Task->TimeToWait);
+  
+  // Search from the tail, since new delays are usually the longest ones.
+  // Tasks with the same wake up time are kept in FIFO order.
+  while((Prev != NULL) && (DelayTicksLeft(Prev->TimeToWait) > ticks))
+  {
+    Prev = Prev->Previous;
+  }
+  
+  Task->Previous = Prev;
+  
+  if (Prev == NULL)
+  {
+    // New list head
+    Task->Next = Head;
+    Head = Task;
+  }
+  else
+  {
+    Task->Next = Prev->Next;
+    Prev->Next = Task;
+  }
+  
+  if (Task->Next == NULL)
+  {
+    Tail = Task;
+  }
+  else
+  {
+    Task->Next->Previous = Task;
+  }
+}
+
+
+void OSDelayListUpdate(ContextType *Task, INT16U time_to_wait)
+{
+  if ((Task == Head) || (Task->Previous != NULL))
+  {
+    RemoveFromDelayList();
+    Task->TimeToWait = time_to_wait;
+    OSDelayListInsert(Task);
+  }
+  else
+  {
+    Task->TimeToWait = time_to_wait;
+  }
 }
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
@@ -358,11 +952,7 @@ INT8U OSDelayTask(INT16U time_wait)
         
         // BRTOS TRACE SUPPORT
         #if (OSTRACE == 1) 
-            #if(OS_TRACE_BY_TASK == 1)
-            Update_OSTrace(currentTask, DELAYTASK);
-            #else
-            Update_OSTrace(Task->Priority, DELAYTASK);
-            #endif
+        OSTraceWrite(OS_TRACE_DELAY, time_wait);
         #endif    
 
         timeout = (INT32U)((INT32U)OSTickCounter + (INT32U)time_wait);
@@ -384,7 +974,7 @@ INT8U OSDelayTask(INT16U time_wait)
         Task->SuspendedType = DELAY;
         #endif
         
-        OSReadyList = OSReadyList & ~(PriorityMask[Task->Priority]);
+        OSReadyListRemove(Task);
         
         // Change context
         // Return to task when occur delay overflow
@@ -476,52 +1066,103 @@ INT8U OSDelayTaskHMSM(INT8U hours, INT8U minutes, INT8U seconds, INT16U miliseco
 
 void OS_TICK_HANDLER(void)
 {
+  #if (NESTING_INT == 1)
   OS_SR_SAVE_VAR
-  INT8U  iPrio = 0;  
+  #endif
   ContextType *Task = Head;  
+  
+  #if (BRTOS_TMR_EN == 1) && (BRTOS_TMR_IMMEDIATE_EN == 1)
+  ////////////////////////////////////////////////////
+  // Immediate soft timers run before any task is   //
+  // woken up, in order to reduce their jitter      //
+  ////////////////////////////////////////////////////
+  OSTimerTickHandler();
+  
+  // a callback may have changed the delay list
+  Task = Head;
+  #endif
    
   ////////////////////////////////////////////////////
   // Put task with delay overflow in the ready list //
   ////////////////////////////////////////////////////  
-  while(Task != NULL)
+  // The delay list is sorted by wake up time, so only the
+  // tasks at the head of the list can expire at this tick
+  while((Task != NULL) && (Task->TimeToWait == OSTickCounter))
   {      
-      if (Task->TimeToWait == OSTickCounter)
-      {
+      #if (NESTING_INT == 1)
+      OSEnterCritical();
+      #endif        
 
-        iPrio = Task->Priority;
+      #if (BRTOS_MUTEX_EN == 1) && (BRTOS_MUTEX_INHERITANCE_EN == 1)
+      // A task that gives up waiting for a mutex takes its priority back
+      OSMutexInheritList = OSMutexInheritList & ~(PriorityMask[Task->Priority]);
+      #endif
+      
+      // Put the task into the ready list
+      OSReadyListInsert(Task);
+      
+      #if (VERBOSE == 1)
+          Task->State = READY;        
+      #endif
+      
+      Task->TimeToWait = EXIT_BY_TIMEOUT;
         
-        #if (NESTING_INT == 1)
-        OSEnterCritical();
-        #endif        
+      // Remove from delay list
+      RemoveFromDelayList();
+      
+      #if (NESTING_INT == 1)
+      OSExitCritical();
+      #endif                  
 
-        // Put the task into the ready list
-        OSReadyList = OSReadyList | (PriorityMask[iPrio]);
-        
-        #if (VERBOSE == 1)
-            Task->State = READY;        
-        #endif
-        
-        Task->TimeToWait = EXIT_BY_TIMEOUT;
-        
-        #if (NESTING_INT == 1)
-        OSExitCritical();
-        #endif                  
-          
-        // Remove from delay list
-        RemoveFromDelayList();
-
-		#if ((PROCESSOR == ARM_Cortex_M0) || (PROCESSOR == ARM_Cortex_M3) || (PROCESSOR == ARM_Cortex_M4) || (PROCESSOR == ARM_Cortex_M4F))
-		OS_INT_EXIT_EXT();
-		#endif
-      }
+      #if ((PROCESSOR == ARM_Cortex_M0) || (PROCESSOR == ARM_Cortex_M3) || (PROCESSOR == ARM_Cortex_M4) || (PROCESSOR == ARM_Cortex_M4F))
+      OS_INT_EXIT_EXT();
+      #endif
  
-      Task = Task->Next;
+      Task = Head;
   }
+  
+  #if (BRTOS_SHARED_PRIORITY_EN == 1) && (RR_TIME_SLICE > 0)
+  //////////////////////////////////////////
+  // Time slice of the shared priorities  //
+  //////////////////////////////////////////
+  if (++OSSliceCounter >= RR_TIME_SLICE)
+  {
+    OSSliceCounter = 0;
+    Task = &ContextTask[currentTask];
+    
+    // The task goes to the end of its ready queue, if another task of its priority is ready
+    if ((currentTask != 0) && OSTaskReady(Task) && (Task->ReadyNext != 0))
+    {
+      #if (NESTING_INT == 1)
+      OSEnterCritical();
+      #endif
+      
+      OSReadyRemove(Task);
+      OSReadyInsert(Task);
+      
+      #if (NESTING_INT == 1)
+      OSExitCritical();
+      #endif
+      
+      #if ((PROCESSOR == ARM_Cortex_M0) || (PROCESSOR == ARM_Cortex_M3) || (PROCESSOR == ARM_Cortex_M4) || (PROCESSOR == ARM_Cortex_M4F))
+      OS_INT_EXIT_EXT();
+      #endif
+    }
+  }
+  #endif
 
   //////////////////////////////////////////
   // System Load                          //
   //////////////////////////////////////////  
   #if (COMPUTES_CPU_LOAD == 1)
+   #if (OS_TASK_RUNTIME_EN == 1)
+     // Measured from the idle task processor time, once per 1000 ticks
+     if (++DutyCnt >= 1000)
+     {
+       DutyCnt = 0;
+       LastOSDuty = OSRuntimeLoad();
+     }
+   #else
      if (DutyCnt >= 1000)
      {
        DutyCnt = 0;
@@ -533,6 +1174,7 @@ void OS_TICK_HANDLER(void)
        OSDutyTmp = 0;
        DutyCnt++;
      }
+   #endif
   #endif
   //////////////////////////////////////////
 	
@@ -586,15 +1228,38 @@ void PreInstallTasks(void)
 {
   INT8U i=0;
   OSTickCounter = 0;
+  OSMonotonicCounter = 0;
   currentTask = 0;
   NumberOfInstalledTasks = 0;
   TaskAlloc = 0;
   iStackAddress = 0;
+  #if (OSTRACE == 1)
+  OSTraceInit();
+  #endif
+  #if (OS_TASK_RUNTIME_EN == 1)
+  OSRuntimeTask = 0;
+  OSRuntimeStamp = OS_TIMESTAMP();
+  #if (COMPUTES_CPU_LOAD == 1)
+  OSLoadStamp = OSRuntimeStamp;
+  OSLoadIdleTime = 0;
+  #endif
+  #endif
   
   for(i=0;i<configMAX_TASK_INSTALL;i++)
   {
     PriorityVector[i]=EMPTY_PRIO;
+    #if (BRTOS_SHARED_PRIORITY_EN == 1)
+    OSReadyHead[i] = 0;
+    OSReadyTail[i] = 0;
+    OSWaitHead[i] = 0;
+    OSWaitTail[i] = 0;
+    OSPriorityTasks[i] = 0;
+    #endif
   }
+  
+  #if (BRTOS_SHARED_PRIORITY_EN == 1)
+  OSSliceCounter = 0;
+  #endif
 
   for(i=1;i<=NUMBER_OF_TASKS;i++)
   {
@@ -627,7 +1292,9 @@ void PreInstallTasks(void)
 INT8U OSBlockPriority(INT8U iPriority)
 {
   OS_SR_SAVE_VAR
+  #if (VERBOSE == 1)
   INT8U BlockedTask = 0;
+  #endif
   
   if (iNesting > 0) {                                // See if caller is an interrupt
      return(IRQ_PEND_ERR);                           // Can't be blocked by interrupt
@@ -638,17 +1305,16 @@ INT8U OSBlockPriority(INT8U iPriority)
     OSEnterCritical();
 
 
-  // Detects the task priority
-  BlockedTask = PriorityVector[iPriority];  
   // Block task with priority iPriority
   #if (VERBOSE == 1)
+  BlockedTask = PriorityVector[iPriority];  
   ContextTask[BlockedTask].Blocked = TRUE;
   #endif
   
   OSBlockedList = OSBlockedList & ~(PriorityMask[iPriority]);
    
   
-  if (currentTask == BlockedTask)
+  if (ContextTask[currentTask].Priority == iPriority)
   {
      ChangeContext();
   }
@@ -731,7 +1397,9 @@ INT8U OSUnBlockPriority(INT8U iPriority)
 INT8U OSBlockTask(BRTOS_TH TaskHandle)
 {
   OS_SR_SAVE_VAR
+  #if (BRTOS_SHARED_PRIORITY_EN == 0)
   INT8U iPriority = 0;
+  #endif
   
   if (iNesting > 0) {                                // See if caller is an interrupt
      return(IRQ_PEND_ERR);                           // Can't be blocked by interrupt
@@ -760,9 +1428,14 @@ INT8U OSBlockTask(BRTOS_TH TaskHandle)
   #if (VERBOSE == 1)
   ContextTask[TaskHandle].Blocked = TRUE;
   #endif
+  #if (BRTOS_SHARED_PRIORITY_EN == 1)
+  // Only this task of the priority stops running
+  OSReadySuspend(&ContextTask[TaskHandle]);
+  #else
   iPriority = ContextTask[TaskHandle].Priority;
   
   OSBlockedList = OSBlockedList & ~(PriorityMask[iPriority]);
+  #endif
   
   if (currentTask == TaskHandle)
   {
@@ -793,7 +1466,9 @@ INT8U OSBlockTask(BRTOS_TH TaskHandle)
 INT8U OSUnBlockTask(BRTOS_TH TaskHandle)
 {
   OS_SR_SAVE_VAR
+  #if (BRTOS_SHARED_PRIORITY_EN == 0)
   INT8U iPriority = 0;
+  #endif
   
   // Enter Critical Section
   #if (NESTING_INT == 0)
@@ -806,9 +1481,13 @@ INT8U OSUnBlockTask(BRTOS_TH TaskHandle)
   #endif
   
   // Determina a prioridade da funo  
+  #if (BRTOS_SHARED_PRIORITY_EN == 1)
+  OSReadyResume(&ContextTask[TaskHandle]);
+  #else
   iPriority = ContextTask[TaskHandle].Priority;
 
   OSBlockedList = OSBlockedList | (PriorityMask[iPriority]);
+  #endif
   
   // check if we have unblocked a higher priority task  
   if (currentTask)
@@ -848,7 +1527,9 @@ INT8U OSBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
   OS_SR_SAVE_VAR
   INT8U iTask = 0;
   INT8U TaskFinish = 0;
-  INT8U iPriority = 0;  
+  #if (BRTOS_SHARED_PRIORITY_EN == 0)
+  INT8U iPriority = 0;
+  #endif
   
   if (iNesting > 0) {                                // See if caller is an interrupt
      return(IRQ_PEND_ERR);                           // Can't be blocked by interrupt
@@ -868,9 +1549,13 @@ INT8U OSBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
       ContextTask[iTask].Blocked = TRUE;
       #endif
       // Determina a prioridade da funo
+      #if (BRTOS_SHARED_PRIORITY_EN == 1)
+      OSReadySuspend(&ContextTask[iTask]);
+      #else
       iPriority = ContextTask[iTask].Priority;   
       
       OSBlockedList = OSBlockedList & ~(PriorityMask[iPriority]);
+      #endif
     }
   }
   
@@ -900,7 +1585,9 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
   OS_SR_SAVE_VAR
   INT8U iTask = 0;
   INT8U TaskFinish = 0;
-  INT8U iPriority = 0;    
+  #if (BRTOS_SHARED_PRIORITY_EN == 0)
+  INT8U iPriority = 0;
+  #endif
   
   if (iNesting > 0) {                                // See if caller is an interrupt
      return(IRQ_PEND_ERR);                           // Can't be blocked by interrupt
@@ -917,13 +1604,17 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
     // Determina a prioridade da funo
     if (iTask != currentTask)
     {
-      iPriority = ContextTask[iTask].Priority;
-      
       #if (VERBOSE == 1)
       ContextTask[iTask].Blocked = FALSE;
       #endif
       
+      #if (BRTOS_SHARED_PRIORITY_EN == 1)
+      OSReadyResume(&ContextTask[iTask]);
+      #else
+      iPriority = ContextTask[iTask].Priority;
+      
       OSBlockedList = OSBlockedList | (PriorityMask[iPriority]);
+      #endif
     }
   }
   
@@ -949,6 +1640,100 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
 
 
 
+////////////////////////////////////////////////////////////
+/////    OS Tickless Idle                              /////
+/////                                                  /////
+/////    Suppress the tick timer while only the idle   /////
+/////    task is ready to run                          /////
+/////                                                  /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#if (TICKLESS_IDLE_EN == 1)
+void OSTicklessIdle(void)
+{
+  OS_SR_SAVE_VAR
+  INT16U ticks = TICK_COUNT_OVERFLOW - 1;
+  INT16U elapsed;
+  #if (TIMER_HOOK_EN == 1) || ((BRTOS_TMR_EN == 1) && (BRTOS_TMR_IMMEDIATE_EN == 1))
+  INT16U hook_ticks;
+  #endif
+  
+  OSEnterCritical();
+  
+  // Only the idle task is ready to run ?
+  if (SAScheduler(OSReadyList & OSBlockedList) == 0)
+  {
+    // Earliest deadline of the delay list. The timer service task
+    // sleeps in the delay list until its next timer expires.
+    if (Head != NULL)
+    {
+      ticks = DelayTicksLeft(Head->TimeToWait);
+    }
+    
+    #if (TIMER_HOOK_EN == 1)
+    hook_ticks = BRTOS_TimerHookNextEvent();
+    if (hook_ticks < ticks)
+    {
+      ticks = hook_ticks;
+    }
+    #endif
+    
+    // Immediate soft timers run from the tick interrupt, not from the timer task
+    #if (BRTOS_TMR_EN == 1) && (BRTOS_TMR_IMMEDIATE_EN == 1)
+    hook_ticks = OSTimerNextImmediate();
+    if (hook_ticks < ticks)
+    {
+      ticks = hook_ticks;
+    }
+    #endif
+  }
+  else
+  {
+    ticks = 0;
+  }
+  
+  if (ticks < TICKLESS_MIN_IDLE_TICKS)
+  {
+    OSExitCritical();
+    OS_Wait;
+    return;
+  }
+  
+  elapsed = OS_TICKLESS_SLEEP(ticks);
+  
+  // Process the suppressed ticks as if they were generated by the tick
+  // timer, so that delays, timeouts, cpu load and timer hook stay in sync
+  iNesting++;
+  while(elapsed > 0)
+  {
+    OSIncCounter();
+    #if (COMPUTES_CPU_LOAD == 1)
+    OSDutyTmp = 1;
+    #endif
+    OS_TICK_HANDLER();
+    elapsed--;
+  }
+  iNesting--;
+  
+  // check if a higher priority task was woken up
+  if (SAScheduler(OSReadyList & OSBlockedList) != 0)
+  {
+    ChangeContext();
+  }
+  
+  OSExitCritical();
+}
+#endif
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 /////    OS Idle Task                                  /////
@@ -980,7 +1765,11 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
         OSDutyTmp = 1;
      #endif            
      
-     OS_Wait;
+     #if (TICKLESS_IDLE_EN == 1)
+        OSTicklessIdle();
+     #else
+        OS_Wait;
+     #endif
   }
 }
 ////////////////////////////////////////////////////////////
@@ -1046,7 +1835,12 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
         return END_OF_AVAILABLE_PRIORITIES;
      }
      
+     #if (BRTOS_SHARED_PRIORITY_EN == 1)
+     // The tasks share a priority, but not the ceiling of a mutex
+     if (PriorityVector[iPriority] == MUTEX_PRIO)
+     #else
      if (PriorityVector[iPriority] != EMPTY_PRIO)
+     #endif
      {
         if (currentTask)
          // Exit Critical Section
@@ -1066,9 +1860,24 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
    }
       
    // Number Task Discovery
+   #if (BRTOS_SHARED_PRIORITY_EN == 1)
+   // Free task control blocks have no priority, there may be more than the TaskAlloc bits
+   for(i=1;i<=NUMBER_OF_TASKS;i++)
+   {
+      if (ContextTask[i].Priority == EMPTY_PRIO)
+      {
+         TaskNumber = i;
+         break;
+      }
+   }
+   #else
    for(i=0;i<NUMBER_OF_TASKS;i++)
    {
+      #if (NUMBER_OF_PRIORITIES > 32)
+      INT64U teste = 1;
+      #else
       INT32U teste = 1;
+      #endif
       teste = teste<<i;
     
       if (!(teste & TaskAlloc))
@@ -1078,6 +1887,7 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
          break;
       }
    }   
+   #endif
    
    // Verifica se encontrou lugar para o contexto da tarefa
    if (TaskNumber == 0) 
@@ -1115,12 +1925,33 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
 	#else
 	Task->StackInit = StackAddress + USER_STACKED_BYTES;
 	#endif
+	
+  #if (OS_STACK_WATERMARK_EN == 1)
+   Task->StackSize = USER_STACKED_BYTES;
+   OSStackPaint((OS_CPU_TYPE*)StackAddress, USER_STACKED_BYTES);
+  #endif
     
 
    // Determina a prioridade da funo
    Task->Priority = iPriority;
+   
+   #if (OS_TASK_RUNTIME_EN == 1)
+   Task->RunTime = 0;
+   Task->Switches = 0;
+   Task->MaxBlockTime = 0;
+   Task->Blocking = FALSE;
+   #endif
 
    // Determina a tarefa que ir ocupar esta prioridade
+   #if (BRTOS_SHARED_PRIORITY_EN == 1)
+   Task->Id = TaskNumber;
+   Task->Ready = FALSE;
+   Task->Suspended = FALSE;
+   Task->WaitEvent = NULL;
+   Task->WaitNext = 0;
+   OSPriorityTasks[iPriority]++;
+   if (PriorityVector[iPriority] == EMPTY_PRIO)
+   #endif
    PriorityVector[iPriority] = TaskNumber;
    // set the function entry address in the context
    
@@ -1146,7 +1977,7 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
    Task->State = READY;
    #endif   
    
-   OSReadyList = OSReadyList | (PriorityMask[iPriority]);   
+   OSReadyListInsert(Task);
    
    if (currentTask)
     // Exit Critical Section
@@ -1192,7 +2023,12 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
         return END_OF_AVAILABLE_PRIORITIES;
      }
 
+     #if (BRTOS_SHARED_PRIORITY_EN == 1)
+     // The tasks share a priority, but not the ceiling of a mutex
+     if (PriorityVector[iPriority] == MUTEX_PRIO)
+     #else
      if (PriorityVector[iPriority] != EMPTY_PRIO)
+     #endif
      {
         if (currentTask)
          // Exit Critical Section
@@ -1223,9 +2059,24 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
    }
 
    // Number Task Discovery
+   #if (BRTOS_SHARED_PRIORITY_EN == 1)
+   // Free task control blocks have no priority, there may be more than the TaskAlloc bits
+   for(i=1;i<=NUMBER_OF_TASKS;i++)
+   {
+      if (ContextTask[i].Priority == EMPTY_PRIO)
+      {
+         TaskNumber = i;
+         break;
+      }
+   }
+   #else
    for(i=0;i<NUMBER_OF_TASKS;i++)
    {
+      #if (NUMBER_OF_PRIORITIES > 32)
+      INT64U teste = 1;
+      #else
       INT32U teste = 1;
+      #endif
       teste = teste<<i;
 
       if (!(teste & TaskAlloc))
@@ -1235,6 +2086,7 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
          break;
       }
    }
+   #endif
 
    // Verify if there is space for the task in the TCB Table
    if (TaskNumber == 0)
@@ -1260,12 +2112,32 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
    Task->TaskName = TaskName;
 
    // Posiciona o inicio do stack da tarefa
-   Task->StackInit = (unsigned int)Stack;
+   Task->StackInit = (OS_CPU_TYPE)Stack;
+   
+   #if (OS_STACK_WATERMARK_EN == 1)
+   OSStackPaint((OS_CPU_TYPE*)Stack, USER_STACKED_BYTES);
+   #endif
 
    // Determina a prioridade da funo
    Task->Priority = iPriority;
+   
+   #if (OS_TASK_RUNTIME_EN == 1)
+   Task->RunTime = 0;
+   Task->Switches = 0;
+   Task->MaxBlockTime = 0;
+   Task->Blocking = FALSE;
+   #endif
 
    // Determina a tarefa que ir ocupar esta prioridade
+   #if (BRTOS_SHARED_PRIORITY_EN == 1)
+   Task->Id = TaskNumber;
+   Task->Ready = FALSE;
+   Task->Suspended = FALSE;
+   Task->WaitEvent = NULL;
+   Task->WaitNext = 0;
+   OSPriorityTasks[iPriority]++;
+   if (PriorityVector[iPriority] == EMPTY_PRIO)
+   #endif
    PriorityVector[iPriority] = TaskNumber;
    // set the function entry address in the context
 
@@ -1286,7 +2158,7 @@ INT8U OSUnBlockMultipleTask(INT8U TaskStart, INT8U TaskNumber)
    Task->State = READY;
    #endif
 
-   OSReadyList = OSReadyList | (PriorityMask[iPriority]);
+   OSReadyListInsert(Task);
 
    if (currentTask)
     // Exit Critical Section
@@ -1348,11 +2220,35 @@ INT8U OSUninstallTask(BRTOS_TH TaskHandle){
 	  // Checks whether the task handler is valid
 	  if (Task != NULL){
 		  // Verify if the task is waiting for an event
+		  #if (BRTOS_SHARED_PRIORITY_EN == 1)
+		  if (Task->Ready){
+			  // If not, it is possible to proceed with the uninstall
+			  OSReadyListRemove(Task);
+			  Task->Suspended = FALSE;
+			  OSPriorityTasks[Task->Priority]--;
+
+			  // Another task of the priority takes its place
+			  if (PriorityVector[Task->Priority] == TaskHandle){
+				  INT8U iTask;
+				  PriorityVector[Task->Priority] = EMPTY_PRIO;
+				  for (iTask = 1; iTask <= NUMBER_OF_TASKS; iTask++){
+					  if ((iTask != TaskHandle) && (ContextTask[iTask].Priority == Task->Priority)){
+						  PriorityVector[Task->Priority] = iTask;
+						  break;
+					  }
+				  }
+			  }
+		  #else
 		  if ((OSReadyList & PriorityMask[Task->Priority]) == PriorityMask[Task->Priority]){
 			  // If not, it is possible to proceed with the uninstall
+			  #if (NUMBER_OF_PRIORITIES > 32)
+			  TaskAlloc = TaskAlloc & ~((INT64U)1 << (TaskHandle-1));
+			  #else
 			  TaskAlloc = TaskAlloc & ~(1 << (TaskHandle-1));
+			  #endif
 			  OSReadyList = OSReadyList & ~(PriorityMask[Task->Priority]);
 			  PriorityVector[Task->Priority] = EMPTY_PRIO;
+		  #endif
 
 			  BRTOS_DEALLOC((void*)Task->StackInit);
 
@@ -1403,6 +2299,114 @@ INT8U OSUninstallTask(BRTOS_TH TaskHandle){
 
 
 
+#if (OS_STACK_WATERMARK_EN == 1)
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Task Stack Usage Function                   /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSTaskStackUsage(BRTOS_TH TaskHandle, INT16U *size, INT16U *peak)
+{
+  OS_SR_SAVE_VAR
+  const OS_CPU_TYPE *stack;
+  INT16U stack_size;
+  INT16U words;
+  INT16U unused = 0;
+  INT16U scanned;
+  
+  if (!TaskHandle)
+  {
+    TaskHandle = currentTask;
+  }
+  
+  if ((TaskHandle == 0) || (TaskHandle > NUMBER_OF_TASKS))
+  {
+    return NOT_VALID_TASK;
+  }
+  
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+  
+  if (ContextTask[TaskHandle].Priority == EMPTY_PRIO)
+  {
+    // Exit Critical Section
+    #if (NESTING_INT == 0)
+    if (!iNesting)
+    #endif
+       OSExitCritical();
+    return NOT_VALID_TASK;
+  }
+  
+  stack = OSStackBottom(&ContextTask[TaskHandle]);
+  stack_size = ContextTask[TaskHandle].StackSize;
+  words = stack_size / sizeof(OS_CPU_TYPE);
+  
+  // The stack is scanned a few words at a time inside the critical section, so a task
+  // uninstalled by an interrupt or a task switch in between the chunks never has its
+  // freed stack read
+  for (;;)
+  {
+    scanned = OSStackUnused(stack, words, unused, OS_STACK_SCAN_WORDS);
+    if ((scanned == words) || ((scanned - unused) < OS_STACK_SCAN_WORDS))
+    {
+      unused = scanned;
+      break;
+    }
+    unused = scanned;
+    
+    // Lets the interrupts in
+    #if (NESTING_INT == 0)
+    if (!iNesting)
+    #endif
+    {
+       OSExitCritical();
+       OSEnterCritical();
+    }
+    
+    if ((ContextTask[TaskHandle].Priority == EMPTY_PRIO) ||
+        (OSStackBottom(&ContextTask[TaskHandle]) != stack) ||
+        (ContextTask[TaskHandle].StackSize != stack_size))
+    {
+      // Exit Critical Section
+      #if (NESTING_INT == 0)
+      if (!iNesting)
+      #endif
+         OSExitCritical();
+      return NOT_VALID_TASK;
+    }
+  }
+  
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSExitCritical();
+  
+  if (size != NULL)
+  {
+    *size = stack_size;
+  }
+  
+  if (peak != NULL)
+  {
+    *peak = (INT16U)((words - unused) * sizeof(OS_CPU_TYPE));
+  }
+  
+  return OK;
+}
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+#endif
+
+
+
+
 void BRTOSInit(void)
 {  
   ////////////////////////////////////////////////////////////  
@@ -1454,6 +2458,16 @@ void initEvents(void)
     for(i=0;i<BRTOS_MAX_QUEUE;i++)
       BRTOS_Queue_Table[i].OSEventAllocated = 0;    
   #endif
+  
+  #if (BRTOS_EVENT_GROUP_EN == 1)
+    for(i=0;i<BRTOS_MAX_EVENT_GROUP;i++)
+      BRTOS_EventGroup_Table[i].OSEventAllocated = 0;    
+  #endif
+  
+  #if (BRTOS_MEMPOOL_EN == 1)
+    for(i=0;i<BRTOS_MAX_MEMPOOL;i++)
+      BRTOS_MemPool_Table[i].OSEventAllocated = 0;
+  #endif
 }
 
 ////////////////////////////////////////////////////////////
@@ -1469,7 +2483,29 @@ void initEvents(void)
 /////    Sucessive Aproximation Scheduler Algorithm    /////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
-#if (OPTIMIZED_SCHEDULER == 1)
+#if (SCHEDULER_TYPE == SCHEDULER_CLZ)
+
+// Highest bit set of a non zero 32 bits word.
+// GCC emits the CLZ instruction when available, or a libgcc routine otherwise.
+#define HighestBit32(x)   (INT8U)(((sizeof(unsigned long) * 8u) - 1u) - (INT8U)__builtin_clzl((unsigned long)(x)))
+
+INT8U SAScheduler(PriorityType ReadyList)
+{
+  #if (NUMBER_OF_PRIORITIES > 32)
+  // Two level search: 32 bits word first, then the priority inside the word
+  INT32U word = (INT32U)(ReadyList >> 32);
+  
+  if (word)
+  {
+    return (INT8U)(32u + HighestBit32(word));
+  }
+  return HighestBit32((INT32U)ReadyList);
+  #else
+  return HighestBit32(ReadyList);
+  #endif
+}
+
+#elif (OPTIMIZED_SCHEDULER == 1) && (SCHEDULER_TYPE == SCHEDULER_DEFAULT) && (NUMBER_OF_PRIORITIES <= 32)
 
 INT8U SAScheduler(PriorityType READY_LIST_VAR)
 {
@@ -1478,7 +2514,11 @@ INT8U SAScheduler(PriorityType READY_LIST_VAR)
 
 #else
 
+#if (NUMBER_OF_PRIORITIES > 32)
+static INT8U SAScheduler32(INT32U ReadyList)
+#else
 INT8U SAScheduler(PriorityType ReadyList)
+#endif
 {
   INT8U prio = 0;
   
@@ -1712,4 +2752,18 @@ INT8U SAScheduler(PriorityType ReadyList)
   return prio;
 }
 
+#if (NUMBER_OF_PRIORITIES > 32)
+INT8U SAScheduler(PriorityType ReadyList)
+{
+  // Two level search: 32 bits word first, then the priority inside the word
+  INT32U word = (INT32U)(ReadyList >> 32);
+  
+  if (word)
+  {
+    return (INT8U)(32u + SAScheduler32(word));
+  }
+  return SAScheduler32((INT32U)ReadyList);
+}
+#endif
+
 #endif
@@ -6,6 +6,9 @@
  */
 #include "BRTOS.h"
 #include "OSInfo.h"
+#if (BRTOS_TMR_EN == 1)
+#include "stimer.h"
+#endif
 
 static int mem_cpy(char *dst, const char *src)
 {
@@ -63,22 +66,113 @@ char *PrintDecimal(INT16S val, CHAR8 *buff)
 }
 
 
+#if ((BRTOS_TMR_EN == 1) && (BRTOS_TMR_LATENCY_EN == 1)) || (OS_TASK_RUNTIME_EN == 1) || (OS_STACK_WATERMARK_EN == 1)
+// Same as PrintDecimal, but for 32 bits counters
+static char *PrintUnsigned(INT32U val, CHAR8 *buff)
+{
+   INT8U i = 10;
+
+   // Null termination for data
+   *(buff + i) = 0;
+
+   do
+   {
+      i--;
+      *(buff + i) = (val % 10) + '0';
+      val /= 10;
+   }while ((val != 0) && (i > 0));
+
+   return (buff+i);
+}
+
+#endif
+
+
+#if (OS_TASK_RUNTIME_EN == 1) || (OS_STACK_WATERMARK_EN == 1)
+// Right aligned column
+static int PrintColumn(char *string, const char *text, int width)
+{
+   int z = 0;
+   const char *t = text;
+
+   while(*t++)
+   {
+      width--;
+   }
+   while(width-- > 0)
+   {
+      string[z++] = ' ';
+   }
+   return z + mem_cpy(string + z, text);
+}
+#endif
+
+// Task name cut and padded to the name column, so that the rows fit in OS_INFO_ROW_SIZE
+static int PrintName(char *string, const CHAR8 *name)
+{
+   int z = 0;
+
+   while ((z < OS_INFO_NAME_SIZE) && (name[z] != 0))
+   {
+      string[z] = name[z];
+      z++;
+   }
+   while (z < OS_INFO_NAME_SIZE)
+   {
+      string[z++] = ' ';
+   }
+   return z;
+}
+
+#if (OS_TASK_RUNTIME_EN == 1)
+static INT32U OSInfoRunTime[NUMBER_OF_TASKS + 1];    ///< Task processor time in the previous task list
+#endif
+
+
 // Imprimir ID, nome, estado, prioridade, stack
 /* Tasks are reported as blocked ('B'), ready ('R') or suspended ('S'). */
+/* With OS_TASK_RUNTIME_EN the processor usage since the previous task list,
+   the number of context switches and the longest blocking time are also shown. */
+/* With OS_STACK_WATERMARK_EN the stack column is the peak usage of the task stack. */
 void OSTaskList(char *string)
 {
     INT16U VirtualStack = 0;
     INT8U  j = 0;
     INT8U  i = 0;
     INT8U  prio = 0;
-    CHAR8  str[9];
+    CHAR8  str[11];
+  #if (OS_STACK_WATERMARK_EN == 0)
     INT32U *sp_end = 0;
     INT32U *sp_address = 0;
-    int z,count;
+  #endif
+  #if (OS_TASK_RUNTIME_EN == 1)
+    int z;
+    INT32U RunTime[NUMBER_OF_TASKS + 1];
+    INT32U Elapsed = 0;
+    INT32U value;
+
+    // Processor time of each task since the previous list. Every time slice
+    // is charged to a task control block, so the sum is the elapsed time
+    UserEnterCritical();
+    OSRuntimeUpdate();
+    for (j=0;j<=NUMBER_OF_TASKS;j++)
+    {
+        RunTime[j] = ContextTask[j].RunTime - OSInfoRunTime[j];
+        OSInfoRunTime[j] = ContextTask[j].RunTime;
+        Elapsed += RunTime[j];
+    }
+    UserExitCritical();
+  #endif
     
+  #if (OS_TASK_RUNTIME_EN == 1)
+    string += mem_cpy(string,"\n\r**************************************************************************************\n\r");
+    string += mem_cpy(string,"ID   NAME            STATE   PRIORITY   STACK SIZE   CPU %   SWITCHES   MAX BLOCK (ms)\n\r");
+    string += mem_cpy(string,"**************************************************************************************\n\r");
+  #else
     string += mem_cpy(string,"\n\r***************************************************\n\r");
     string += mem_cpy(string,"ID   NAME            STATE   PRIORITY   STACK SIZE\n\r");
     string += mem_cpy(string,"***************************************************\n\r");
+  #endif
 
 	#if (!BRTOS_DYNAMIC_TASKS_ENABLED)
     for (j=1;j<=NumberOfInstalledTasks;j++)
@@ -98,22 +192,22 @@ void OSTaskList(char *string)
 				  string += mem_cpy(string, (str+4));
 				  string += mem_cpy(string, "] ");
 			  }
-			  z = mem_cpy(string,(char*)ContextTask[j].TaskName);
-			  string +=z;
-
-			  // Task name align
-			  for(count=0;count<(16-z);count++)
-			  {
-				  *string++ = ' ';
-			  }
+			  string += PrintName(string, ContextTask[j].TaskName);
 
 			  // Print the task state
 			  string += mem_cpy(string,"  ");
 			  UserEnterCritical();
+			  #if (BRTOS_SHARED_PRIORITY_EN == 1)
+			  if (((OSBlockedList & (PriorityMask[ContextTask[j].Priority])) == 0) || ContextTask[j].Suspended){
+				  *string++ = 'B';
+			  }else{
+				  if (ContextTask[j].Ready){
+			  #else
 			  if ((OSBlockedList & (PriorityMask[ContextTask[j].Priority])) == 0){
 				  *string++ = 'B';
 			  }else{
 				  if ((OSReadyList & (PriorityMask[ContextTask[j].Priority])) == PriorityMask[ContextTask[j].Priority]){
+			  #endif
 					  *string++ = 'R';
 				  }else{
 					  *string++ = 'S';
@@ -132,6 +226,9 @@ void OSTaskList(char *string)
 			  string += mem_cpy(string,"       ");
 
 			  // Print the task stack size
+			#if (OS_STACK_WATERMARK_EN == 1)
+			  (void)OSTaskStackUsage(j, NULL, &VirtualStack);
+			#else
 			  UserEnterCritical();
 			  sp_address = (INT32U*)ContextTask[j].StackPoint;
 			  if (j == 1)
@@ -178,9 +275,50 @@ void OSTaskList(char *string)
 			  #endif
 			  UserExitCritical();
 
+			#endif
+
 			  (void)PrintDecimal(VirtualStack, str);
 			  string += mem_cpy(string, str);
 
+			#if (OS_TASK_RUNTIME_EN == 1)
+			  // Print the processor usage, in tenths of percent
+			  value = 0;
+			  if (Elapsed != 0)
+			  {
+				  if (Elapsed >= 1000)
+				  {
+					  value = RunTime[j] / (Elapsed / 1000);
+				  }else
+				  {
+					  value = (RunTime[j] * 1000) / Elapsed;
+				  }
+				  if (value > 1000) value = 1000;
+			  }
+			  z = mem_cpy(str, PrintUnsigned(value / 10, str));
+			  str[z++] = '.';
+			  str[z++] = (value % 10) + '0';
+			  str[z] = 0;
+			  string += PrintColumn(string, str, 11);
+
+			  // Print the context switches and the longest blocking time
+			  UserEnterCritical();
+			  value = ContextTask[j].Switches;
+			  UserExitCritical();
+			  string += PrintColumn(string, PrintUnsigned(value, str), 11);
+
+			  UserEnterCritical();
+			  value = ContextTask[j].MaxBlockTime;
+			  UserExitCritical();
+			  if (OS_TIMESTAMP_HZ >= 1000u)
+			  {
+				  value = value / (OS_TIMESTAMP_HZ / 1000u);
+			  }else
+			  {
+				  value = value * (1000u / OS_TIMESTAMP_HZ);
+			  }
+			  string += PrintColumn(string, PrintUnsigned(value, str), 17);
+			#endif
+
 			  string += mem_cpy(string, "\n\r");
 		}
     }
@@ -192,12 +330,81 @@ void OSTaskList(char *string)
 }
 
 
+#if (OS_STACK_WATERMARK_EN == 1)
+/* Peak stack usage of each task and the stack size recommended from it,
+   OS_STACK_MARGIN percent above the peak, in multiples of 8 bytes.
+   The peaks only cover the code paths run since the tasks were installed. */
+void OSStackReport(char *string)
+{
+    INT8U  j;
+    int    z, count;
+    CHAR8  str[11];
+    INT16U size, peak;
+    INT32U recommended;
+    INT32U total_size = 0;
+    INT32U total_recommended = 0;
+
+    string += mem_cpy(string,"\n\r**********************************************************\n\r");
+    string += mem_cpy(string,"ID   NAME                  SIZE      PEAK   RECOMMENDED\n\r");
+    string += mem_cpy(string,"**********************************************************\n\r");
+
+    for (j=1;j<=NUMBER_OF_TASKS;j++)
+    {
+        if (OSTaskStackUsage(j, &size, &peak) != OK)
+        {
+            continue;
+        }
+
+        recommended = (INT32U)peak + (((INT32U)peak * OS_STACK_MARGIN) / 100);
+        recommended = (recommended + 7) & ~(INT32U)7;
+        if (recommended < NUMBER_MIN_OF_STACKED_BYTES)
+        {
+            recommended = NUMBER_MIN_OF_STACKED_BYTES;
+        }
+        total_size += size;
+        total_recommended += recommended;
+
+        *string++ = '[';
+        z = mem_cpy(string, PrintUnsigned(j, str));
+        string += z;
+        *string++ = ']';
+        for(count=0;count<(3-z);count++)
+        {
+            *string++ = ' ';
+        }
+
+        string += PrintName(string, ContextTask[j].TaskName);
+
+        string += PrintColumn(string, PrintUnsigned(size, str), 10);
+        string += PrintColumn(string, PrintUnsigned(peak, str), 10);
+        string += PrintColumn(string, PrintUnsigned(recommended, str), 14);
+        string += mem_cpy(string, "\n\r");
+    }
+
+    string += mem_cpy(string, "TOTAL                ");
+    string += PrintColumn(string, PrintUnsigned(total_size, str), 10);
+    string += PrintColumn(string, "", 10);
+    string += PrintColumn(string, PrintUnsigned(total_recommended, str), 14);
+    string += mem_cpy(string, "\n\rRECLAIMABLE: ");
+    string += mem_cpy(string, PrintUnsigned((total_size > total_recommended) ? (total_size - total_recommended) : 0, str));
+    string += mem_cpy(string, " bytes\n\r");
+
+    // End of string
+    *string = '\0';
+}
+#endif
+
+
 // memoria total heap de tarefas
 // memoria total heap de filas
 void OSAvailableMemory(char *string)
 {
     INT16U address = 0;
     CHAR8  str[8];
+#if (BRTOS_DYNAMIC_TASKS_ENABLED)
+    INT32U free_bytes;
+    INT32U largest;
+#endif
 
     string += mem_cpy(string, "\n\r***** BRTOS Memory Info *****\n\r");
 #if (!BRTOS_DYNAMIC_TASKS_ENABLED)
@@ -224,6 +431,20 @@ void OSAvailableMemory(char *string)
     string += mem_cpy(string, PrintDecimal(DYNAMIC_HEAP_SIZE, str));
 	#endif
 
+#if (BRTOS_DYNAMIC_TASKS_ENABLED)
+    string += mem_cpy(string, "\n\rDYNAMIC HEAP PEAK:        ");
+    string += mem_cpy(string, PrintDecimal((INT16S)OSGetPeakHeapSize(), str));
+
+    // Fragmentation is the share of the free memory out of the largest free block
+    free_bytes = OSGetFreeHeapSize();
+    largest = OSGetMaxFreeHeapBlock();
+    string += mem_cpy(string, "\n\rLARGEST FREE BLOCK:       ");
+    string += mem_cpy(string, PrintDecimal((INT16S)largest, str));
+    string += mem_cpy(string, " (");
+    string += mem_cpy(string, PrintDecimal((free_bytes != 0) ? (INT16S)(100 - ((largest * 100) / free_bytes)) : 0, str));
+    string += mem_cpy(string, "% fragmented)");
+#endif
+
 #if (!BRTOS_DYNAMIC_TASKS_ENABLED)
     string += mem_cpy(string, "\n\rQUEUE MEMORY HEAP: ");
 #else
@@ -319,3 +540,72 @@ void OSCPULoad(char *string)
 }
 #endif
 
+
+#if (BRTOS_TMR_EN == 1) && (BRTOS_TMR_LATENCY_EN == 1)
+// Soft timer callback latency histograms, one column per timer class
+void OSTimerLatencyInfo(char *string)
+{
+    OS_TIMER_LATENCY latency[TIMER_CLASSES];
+    CHAR8  str[11];
+    INT8U  bucket, c;
+    int    z, count;
+
+    for (c = 0; c < TIMER_CLASSES; c++)
+    {
+        (void)OSTimerGetLatency(c, &latency[c]);
+    }
+
+    string += mem_cpy(string, "\n\r***** BRTOS Timer Latency *****\n\r");
+#if (BRTOS_TMR_IMMEDIATE_EN == 1)
+    string += mem_cpy(string, "TICKS LATE   DEFERRED     IMMEDIATE\n\r");
+#else
+    string += mem_cpy(string, "TICKS LATE   DEFERRED\n\r");
+#endif
+
+    for (bucket = 0; bucket <= TIMER_LATENCY_BUCKETS; bucket++)
+    {
+        // Print the bucket range, or the worst case in the last line
+        if (bucket == TIMER_LATENCY_BUCKETS)
+        {
+            z = mem_cpy(string, "MAX");
+        }else if (bucket == 0)
+        {
+            z = mem_cpy(string, "0");
+        }else
+        {
+            z = mem_cpy(string, PrintUnsigned((INT32U)1 << (bucket - 1), str));
+            if (bucket == (TIMER_LATENCY_BUCKETS - 1))
+            {
+                z += mem_cpy(string + z, "+");
+            }else if (bucket > 1)
+            {
+                z += mem_cpy(string + z, "-");
+                z += mem_cpy(string + z, PrintUnsigned(((INT32U)1 << bucket) - 1, str));
+            }
+        }
+        string += z;
+
+        for (c = 0; c < TIMER_CLASSES; c++)
+        {
+            // Column align
+            for (count = 0; count < (13 - z); count++)
+            {
+                *string++ = ' ';
+            }
+            if (bucket == TIMER_LATENCY_BUCKETS)
+            {
+                z = mem_cpy(string, PrintUnsigned(latency[c].max, str));
+            }else
+            {
+                z = mem_cpy(string, PrintUnsigned(latency[c].hist[bucket], str));
+            }
+            string += z;
+        }
+        string += mem_cpy(string, "\n\r");
+    }
+
+    // End of string
+    *string = '\0';
+}
+#endif
+
@@ -0,0 +1,335 @@
+/**
+* \file OSTrace.c
+* \brief BRTOS binary trace of kernel events
+*
+* Ring of timestamped trace records and the functions to drain it
+*
+**/
+/*********************************************************************************************************
+*                                               BRTOS
+*                                Brazilian Real-Time Operating System
+*                            Acronymous of Basic Real-Time Operating System
+*
+*
+*                                  Open Source RTOS under MIT License
+*
+*
+*
+*                                        OS Trace functions
+*
+*
+*   Revision: 1.0
+*
+*********************************************************************************************************/
+
+#include "BRTOS.h"
+
+#if (PROCESSOR == COLDFIRE_V1 && __CWCC__)
+#pragma warn_implicitconv off
+#endif
+
+#if (OSTRACE == 1)
+
+#define OS_TRACE_MASK         (INT16U)(OS_TRACE_SIZE - 1)
+
+/* SLIP special characters */
+#define SLIP_END              (INT8U)0xC0
+#define SLIP_ESC              (INT8U)0xDB
+#define SLIP_ESC_END          (INT8U)0xDC
+#define SLIP_ESC_ESC          (INT8U)0xDD
+
+static OS_TRACE_RECORD OSTraceBuffer[OS_TRACE_SIZE];
+static INT16U OSTraceHead = 0;          ///< Next record to be written
+static INT16U OSTraceTail = 0;          ///< Oldest record not read
+static INT16U OSTraceLost = 0;          ///< Records overwritten since the last read
+static INT8U  OSTraceTask = 0;          ///< Last task recorded as switched in
+
+
+static void OSTraceStore(INT8U event, INT8U task, INT16U arg)
+{
+  OS_TRACE_RECORD *rec = &OSTraceBuffer[OSTraceHead];
+
+  rec->Timestamp = (INT32U)OS_TIMESTAMP();
+  rec->Event = event;
+  rec->Task = task;
+  rec->Arg = arg;
+
+  OSTraceHead = (OSTraceHead + 1) & OS_TRACE_MASK;
+
+  // Ring full, drop the oldest record
+  if (OSTraceHead == OSTraceTail)
+  {
+    OSTraceTail = (OSTraceTail + 1) & OS_TRACE_MASK;
+    if (OSTraceLost < 0xFFFF)
+    {
+      OSTraceLost++;
+    }
+  }
+}
+
+// Copies a record in the destination byte by byte, the buffer may be unaligned
+static void OSTraceCopy(INT8U *buff, const OS_TRACE_RECORD *rec)
+{
+  const INT8U *src = (const INT8U*)rec;
+  INT8U i;
+
+  for (i = 0; i < sizeof(OS_TRACE_RECORD); i++)
+  {
+    buff[i] = src[i];
+  }
+}
+
+static void OSTraceMake(OS_TRACE_RECORD *rec, INT32U timestamp, INT8U event, INT8U task, INT16U arg)
+{
+  rec->Timestamp = timestamp;
+  rec->Event = event;
+  rec->Task = task;
+  rec->Arg = arg;
+}
+
+// Task name record followed by the name padded with zeros up to the chunk size
+static INT16U OSTraceDescribeTask(INT8U *buff, INT8U task)
+{
+  OS_TRACE_RECORD rec;
+  const CHAR8 *name = ContextTask[task].TaskName;
+  INT16U len = 0;
+  INT16U chunks;
+  INT16U i;
+
+  while ((name[len] != 0) && (len < OS_TRACE_NAME_LEN))
+  {
+    len++;
+  }
+  chunks = (len + OS_TRACE_NAME_CHUNK - 1) / OS_TRACE_NAME_CHUNK;
+
+  OSTraceMake(&rec, 0, OS_TRACE_TASK_NAME, task, chunks);
+  OSTraceCopy(buff, &rec);
+  buff += sizeof(OS_TRACE_RECORD);
+
+  for (i = 0; i < (chunks * OS_TRACE_NAME_CHUNK); i++)
+  {
+    buff[i] = (i < len) ? (INT8U)name[i] : 0;
+  }
+
+  return (INT16U)((chunks + 1) * sizeof(OS_TRACE_RECORD));
+}
+
+static void OSTraceSLIPByte(void (*putbyte)(INT8U data), INT8U data)
+{
+  if (data == SLIP_END)
+  {
+    putbyte(SLIP_ESC);
+    putbyte(SLIP_ESC_END);
+  }
+  else if (data == SLIP_ESC)
+  {
+    putbyte(SLIP_ESC);
+    putbyte(SLIP_ESC_ESC);
+  }
+  else
+  {
+    putbyte(data);
+  }
+}
+
+static void OSTraceSLIPFrame(void (*putbyte)(INT8U data), const INT8U *buff, INT16U size)
+{
+  putbyte(SLIP_END);
+  while (size > 0)
+  {
+    OSTraceSLIPByte(putbyte, *buff++);
+    size--;
+  }
+  putbyte(SLIP_END);
+}
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Trace Init Function                         /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+void OSTraceInit(void)
+{
+  OSTraceHead = 0;
+  OSTraceTail = 0;
+  OSTraceLost = 0;
+  OSTraceTask = 0;
+}
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Trace Record Functions                      /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+void OSTraceWrite(INT8U event, INT16U arg)
+{
+  OSTraceStore(event, currentTask, arg);
+}
+
+
+void OSTraceRecord(INT8U event, INT16U arg)
+{
+  OS_SR_SAVE_VAR
+
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+
+  OSTraceStore(event, currentTask, arg);
+
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSExitCritical();
+}
+
+
+void OSTraceSwitch(INT8U task)
+{
+  // The ARM Cortex ports run the scheduler in the PendSV handler, with the interrupts enabled
+  #if ((PROCESSOR == ARM_Cortex_M0) || (PROCESSOR == ARM_Cortex_M3) || (PROCESSOR == ARM_Cortex_M4) || (PROCESSOR == ARM_Cortex_M4F))
+  OS_SR_SAVE_VAR
+  OSEnterCritical();
+  #endif
+
+  if (task != OSTraceTask)
+  {
+    OSTraceStore(OS_TRACE_SWITCH, task, (INT16U)OSTraceTask);
+    OSTraceTask = task;
+  }
+
+  #if ((PROCESSOR == ARM_Cortex_M0) || (PROCESSOR == ARM_Cortex_M3) || (PROCESSOR == ARM_Cortex_M4) || (PROCESSOR == ARM_Cortex_M4F))
+  OSExitCritical();
+  #endif
+}
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Trace Drain Functions                       /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT16U OSTraceDescribe(INT8U *buff, INT16U size)
+{
+  OS_TRACE_RECORD rec;
+  INT16U written;
+  INT8U  j;
+
+  if (size < sizeof(OS_TRACE_RECORD))
+  {
+    return 0;
+  }
+
+  OSTraceMake(&rec, (INT32U)OS_TIMESTAMP_HZ, OS_TRACE_HEADER, OS_TRACE_VERSION, OS_TRACE_MAGIC);
+  OSTraceCopy(buff, &rec);
+  written = sizeof(OS_TRACE_RECORD);
+
+  for (j = 1; j <= NUMBER_OF_TASKS; j++)
+  {
+    if ((ContextTask[j].Priority == EMPTY_PRIO) || (ContextTask[j].TaskName == NULL))
+    {
+      continue;
+    }
+
+    // Only complete descriptions
+    if ((written + (OS_TRACE_NAME_RECORDS * sizeof(OS_TRACE_RECORD))) > size)
+    {
+      break;
+    }
+
+    written += OSTraceDescribeTask(&buff[written], j);
+  }
+
+  return written;
+}
+
+
+INT16U OSTraceRead(INT8U *buff, INT16U size)
+{
+  OS_SR_SAVE_VAR
+  OS_TRACE_RECORD rec;
+  INT16U written = 0;
+
+  while ((written + sizeof(OS_TRACE_RECORD)) <= size)
+  {
+    // Enter Critical Section
+    OSEnterCritical();
+
+    if (OSTraceLost > 0)
+    {
+      // Stamped as the oldest record left, so the timestamps keep increasing
+      OSTraceMake(&rec, (OSTraceTail != OSTraceHead) ? OSTraceBuffer[OSTraceTail].Timestamp : (INT32U)OS_TIMESTAMP(),
+                  OS_TRACE_LOST, currentTask, OSTraceLost);
+      OSTraceLost = 0;
+    }
+    else if (OSTraceTail != OSTraceHead)
+    {
+      rec = OSTraceBuffer[OSTraceTail];
+      OSTraceTail = (OSTraceTail + 1) & OS_TRACE_MASK;
+    }
+    else
+    {
+      // Exit Critical Section
+      OSExitCritical();
+      break;
+    }
+
+    // Exit Critical Section
+    OSExitCritical();
+
+    OSTraceCopy(&buff[written], &rec);
+    written += sizeof(OS_TRACE_RECORD);
+  }
+
+  return written;
+}
+
+
+INT16U OSTraceSendSLIP(void (*putbyte)(INT8U data), INT8U describe)
+{
+  INT8U  frame[OS_TRACE_SLIP_RECORDS * sizeof(OS_TRACE_RECORD)];
+  INT16U records = 0;
+  INT16U size;
+  INT8U  j;
+
+  if (describe == TRUE)
+  {
+    // Header and one frame for each task name, keeps the frame buffer small
+    size = OSTraceDescribe(frame, sizeof(OS_TRACE_RECORD));
+    OSTraceSLIPFrame(putbyte, frame, size);
+
+    for (j = 1; j <= NUMBER_OF_TASKS; j++)
+    {
+      if ((ContextTask[j].Priority != EMPTY_PRIO) && (ContextTask[j].TaskName != NULL))
+      {
+        size = OSTraceDescribeTask(frame, j);
+        OSTraceSLIPFrame(putbyte, frame, size);
+      }
+    }
+  }
+
+  do
+  {
+    size = OSTraceRead(frame, sizeof(frame));
+    if (size > 0)
+    {
+      OSTraceSLIPFrame(putbyte, frame, size);
+      records += size / sizeof(OS_TRACE_RECORD);
+    }
+  } while (size == sizeof(frame));
+
+  return records;
+}
+
+#endif
@@ -0,0 +1,591 @@
+/**
+* \file eventgroup.c
+* \brief BRTOS Event Group functions
+*
+* Functions to install and use event flag groups and to wait for
+* multiple semaphores, mutexes, mailboxes and queues
+*
+**/
+/*********************************************************************************************************
+*                                               BRTOS
+*                                Brazilian Real-Time Operating System
+*                            Acronymous of Basic Real-Time Operating System
+*
+*
+*                                  Open Source RTOS under MIT License
+*
+*
+*
+*                                       OS Event Group functions
+*
+*
+*   Revision: 1.0
+*
+*********************************************************************************************************/
+
+#include "BRTOS.h"
+
+#if (PROCESSOR == COLDFIRE_V1 && __CWCC__)
+#pragma warn_implicitconv off
+#endif
+
+#if (BRTOS_EVENT_GROUP_EN == 1)
+
+// Verify if the flags of an event group release a waiting task
+#define EventGroupSatisfied(set, wanted, opt)   ((((opt) & OS_FLAGS_WAIT_ALL) != 0) ? \
+                                                 (((set) & (wanted)) == (wanted)) : \
+                                                 (((set) & (wanted)) != 0))
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Create Event Group Function                 /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSEventGroupCreate(INT32U flags, BRTOS_EventGroup **event)
+{
+  OS_SR_SAVE_VAR
+  INT16S i=0;
+
+  BRTOS_EventGroup *pont_event;
+
+  if (iNesting > 0) {                                // See if caller is an interrupt
+     return(IRQ_PEND_ERR);                           // Can't be create by interrupt
+  }
+
+  // Enter critical Section
+  if (currentTask)
+     OSEnterCritical();
+
+  // Verify if there is an available event control block
+  for(i=0;i<=BRTOS_MAX_EVENT_GROUP;i++)
+  {
+
+    if(i >= BRTOS_MAX_EVENT_GROUP)
+    {
+      // There are no more available blocks
+
+      // Exit critical Section
+      if (currentTask)
+         OSExitCritical();
+
+      return(NO_AVAILABLE_EVENT);
+    }
+
+
+    if(BRTOS_EventGroup_Table[i].OSEventAllocated != TRUE)
+    {
+      BRTOS_EventGroup_Table[i].OSEventAllocated = TRUE;
+      pont_event = &BRTOS_EventGroup_Table[i];
+      break;
+    }
+  }
+
+  pont_event->OSEventFlags    = flags;
+  pont_event->OSEventLinked   = 0;
+  pont_event->OSEventWait     = 0;
+  pont_event->OSEventWaitList = 0;
+
+  *event = pont_event;
+
+  // Exit critical Section
+  if (currentTask)
+     OSExitCritical();
+
+  return(ALLOC_EVENT_OK);
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Delete Event Group Function                 /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSEventGroupDelete(BRTOS_EventGroup **event)
+{
+  OS_SR_SAVE_VAR
+  BRTOS_EventGroup *pont_event;
+
+  if (iNesting > 0) {                                // See if caller is an interrupt
+      return(IRQ_PEND_ERR);                          // Can't be delete by interrupt
+  }
+
+  // Enter Critical Section
+  OSEnterCritical();
+
+  pont_event = *event;
+  pont_event->OSEventAllocated = 0;
+  pont_event->OSEventFlags     = 0;
+  pont_event->OSEventLinked    = 0;
+  pont_event->OSEventWait      = 0;
+  pont_event->OSEventWaitList  = 0;
+
+  *event = NULL;
+
+  // Exit Critical Section
+  OSExitCritical();
+
+  return(DELETE_EVENT_OK);
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Event Group Wait Function                   /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSEventGroupWait(BRTOS_EventGroup *pont_event, INT32U flags, INT8U options, INT32U *fired, INT16U time_wait)
+{
+  OS_SR_SAVE_VAR
+  INT32U timeout;
+  INT32U set;
+  ContextType *Task;
+
+  #if (ERROR_CHECK == 1)
+    // Can not use event group wait function from interrupt handling code
+    if(iNesting > 0)
+    {
+      return(IRQ_PEND_ERR);
+    }
+
+    // Verifies if the pointer is NULL
+    if(pont_event == NULL)
+    {
+      return(NULL_EVENT_POINTER);
+    }
+  #endif
+
+  // Without flags, a wait for any flag would never end
+  if (flags == 0)
+  {
+    return(INVALID_PARAMETERS);
+  }
+
+  // Enter Critical Section
+  OSEnterCritical();
+
+  #if (ERROR_CHECK == 1)
+    // Verifies if the event is allocated
+    if(pont_event->OSEventAllocated != TRUE)
+    {
+      // Exit Critical Section
+      OSExitCritical();
+      return(ERR_EVENT_NO_CREATED);
+    }
+  #endif
+
+  // BRTOS TRACE SUPPORT
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_EVENTGROUP_PEND, OS_TRACE_ADDR(pont_event));
+  #endif
+
+  // Verify if the flags are already set
+  if (EventGroupSatisfied(pont_event->OSEventFlags, flags, options))
+  {
+    set = pont_event->OSEventFlags & flags;
+
+    if (options & OS_FLAGS_CONSUME)
+    {
+      pont_event->OSEventFlags &= ~set;
+    }
+
+    // Exit Critical Section
+    OSExitCritical();
+
+    if (fired != NULL) *fired = set;
+    return OK;
+  }
+
+  // If no timeout is used and the flags are not set, exit with an error
+  if (time_wait == NO_TIMEOUT){
+  	// Exit Critical Section
+    OSExitCritical();
+    return EXIT_BY_NO_ENTRY_AVAILABLE;
+  }
+
+  Task = (ContextType*)&ContextTask[currentTask];
+
+  // Saves the wait condition to be verified by the flags set
+  Task->WaitFlags    = flags;
+  Task->WaitFlagsOpt = options;
+
+  // Increases the event group wait list counter
+  pont_event->OSEventWait++;
+
+  // Allocates the current task on the event group wait list
+  OSEventWaitListInsert(pont_event, Task);
+
+  // Task entered suspended state, waiting for the flags
+  #if (VERBOSE == 1)
+  Task->State = SUSPENDED;
+  Task->SuspendedType = EVENT_GROUP;
+  #endif
+
+  // Remove current task from the Ready List
+  OSReadyListRemove(Task);
+
+  // Set timeout overflow
+  if (time_wait)
+  {
+    timeout = (INT32U)((INT32U)OSGetCount() + (INT32U)time_wait);
+
+    if (timeout >= TICK_COUNT_OVERFLOW)
+    {
+      Task->TimeToWait = (INT16U)(timeout - TICK_COUNT_OVERFLOW);
+    }
+    else
+    {
+      Task->TimeToWait = (INT16U)timeout;
+    }
+
+    // Put task into delay list
+    IncludeTaskIntoDelayList();
+  } else
+  {
+    Task->TimeToWait = NO_TIMEOUT;
+  }
+
+  // Change Context - Returns on time overflow or flags set
+  ChangeContext();
+
+  // Exit Critical Section
+  OSExitCritical();
+  // Enter Critical Section
+  OSEnterCritical();
+
+  if (time_wait)
+  {
+      // Verify if the reason of task wake up was timeout
+      if(Task->TimeToWait == EXIT_BY_TIMEOUT)
+      {
+          // Test if both timeout and flags set have occured before arrive here
+          if (OSEventWaitListContains(pont_event, Task))
+          {
+            // Remove the task from the event group wait list
+            OSEventWaitListRemove(pont_event, Task);
+
+            // Decreases the event group wait list counter
+            pont_event->OSEventWait--;
+
+            // Exit Critical Section
+            OSExitCritical();
+
+            // Indicates timeout
+            return TIMEOUT;
+          }
+      }
+      else
+      {
+          // Remove the time to wait condition
+          Task->TimeToWait = NO_TIMEOUT;
+
+          // Remove from delay list
+          RemoveFromDelayList();
+      }
+  }
+
+  // The flags set stored the flags that released the task
+  set = Task->WaitFlags;
+
+  // Exit Critical Section
+  OSExitCritical();
+
+  if (fired != NULL) *fired = set;
+  return OK;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+// Releases a waiting task if the flags set satisfy its wait condition.
+// Must be called inside a critical section.
+static INT8U EventGroupRelease(BRTOS_EventGroup *pont_event, ContextType *Task, INT32U *consumed)
+{
+  if (!EventGroupSatisfied(pont_event->OSEventFlags, Task->WaitFlags, Task->WaitFlagsOpt))
+  {
+    return FALSE;
+  }
+
+  // Informs the task which flags released it
+  Task->WaitFlags = pont_event->OSEventFlags & Task->WaitFlags;
+
+  if (Task->WaitFlagsOpt & OS_FLAGS_CONSUME)
+  {
+    *consumed |= Task->WaitFlags;
+  }
+
+  // Remove the selected task from the event group wait list
+  OSEventWaitListRemove(pont_event, Task);
+
+  // Decreases the event group wait list counter
+  pont_event->OSEventWait--;
+
+  // Put the selected task into Ready List
+  #if (VERBOSE == 1)
+  Task->State = READY;
+  #endif
+
+  OSReadyListInsert(Task);
+
+  return TRUE;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Event Group Signal Function                 /////
+/////                                                  /////
+/////      Must be called inside a critical section    /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSEventGroupSignal(BRTOS_EventGroup *pont_event, INT32U flags)
+{
+  #if (BRTOS_SHARED_PRIORITY_EN == 1)
+  INT8U        iTask;
+  #else
+  INT8U        iPriority;
+  PriorityType waitlist;
+  #endif
+  INT8U        released = FALSE;
+  INT32U       consumed = 0;
+
+  // BRTOS TRACE SUPPORT
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_EVENTGROUP_POST, OS_TRACE_ADDR(pont_event));
+  #endif
+
+  pont_event->OSEventFlags |= flags;
+
+  // All the waiting tasks are verified against the flags set before any consume
+  #if (BRTOS_SHARED_PRIORITY_EN == 1)
+  // Several tasks may wait at the same priority
+  for (iTask = 1; (iTask <= NUMBER_OF_TASKS) && (pont_event->OSEventWait != 0); iTask++)
+  {
+    if (OSEventWaitListContains(pont_event, &ContextTask[iTask]))
+    {
+      released |= EventGroupRelease(pont_event, &ContextTask[iTask], &consumed);
+    }
+  }
+  #else
+  waitlist = pont_event->OSEventWaitList;
+  while(waitlist != 0)
+  {
+    // Selects the highest priority task
+    iPriority = SAScheduler(waitlist);
+    waitlist = waitlist & ~(PriorityMask[iPriority]);
+
+    released |= EventGroupRelease(pont_event, &ContextTask[PriorityVector[iPriority]], &consumed);
+  }
+  #endif
+
+  pont_event->OSEventFlags &= ~consumed;
+
+  return released;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Event Group Set / Clear Functions           /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSEventGroupSet(BRTOS_EventGroup *pont_event, INT32U flags)
+{
+  OS_SR_SAVE_VAR
+
+  #if (ERROR_CHECK == 1)
+    // Verifies if the pointer is NULL
+    if(pont_event == NULL)
+    {
+      return(NULL_EVENT_POINTER);
+    }
+  #endif
+
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+
+  if (OSEventGroupSignal(pont_event, flags) == TRUE)
+  {
+    // If outside of an interrupt service routine, change context to the highest priority task
+    // If inside of an interrupt, the interrupt itself will change the context to the highest priority task
+    if (!iNesting)
+    {
+      // Verify if there is a higher priority task ready to run
+      ChangeContext();
+    }
+  }
+
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+    OSExitCritical();
+
+  return OK;
+}
+
+
+INT8U OSEventGroupClear(BRTOS_EventGroup *pont_event, INT32U flags)
+{
+  OS_SR_SAVE_VAR
+
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+
+  pont_event->OSEventFlags &= ~flags;
+
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+    OSExitCritical();
+
+  return OK;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Multiple Objects Wait Functions             /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSEventGroupLink(BRTOS_EventGroup *pont_event, INT32U flag, INT8U type, void *object)
+{
+  OS_SR_SAVE_VAR
+  struct BRTOS_EventGroup_s **group;
+  INT32U                    *group_flags;
+
+  switch(type)
+  {
+    #if (BRTOS_SEM_EN == 1)
+    case SEMAPHORE:
+      group       = &((BRTOS_Sem*)object)->OSEventGroup;
+      group_flags = &((BRTOS_Sem*)object)->OSEventGroupFlags;
+      break;
+    #endif
+    #if (BRTOS_MUTEX_EN == 1)
+    case MUTEX:
+      group       = &((BRTOS_Mutex*)object)->OSEventGroup;
+      group_flags = &((BRTOS_Mutex*)object)->OSEventGroupFlags;
+      break;
+    #endif
+    #if (BRTOS_MBOX_EN == 1)
+    case MAILBOX:
+      group       = &((BRTOS_Mbox*)object)->OSEventGroup;
+      group_flags = &((BRTOS_Mbox*)object)->OSEventGroupFlags;
+      break;
+    #endif
+    #if ((BRTOS_QUEUE_EN == 1) || (BRTOS_DYNAMIC_QUEUE_ENABLED == 1))
+    case QUEUE:
+      group       = &((BRTOS_Queue*)object)->OSEventGroup;
+      group_flags = &((BRTOS_Queue*)object)->OSEventGroupFlags;
+      break;
+    #endif
+    default:
+      return(INVALID_PARAMETERS);
+  }
+
+  // Enter Critical Section
+  OSEnterCritical();
+
+  // Remove the previous link
+  if (*group != NULL)
+  {
+    (*group)->OSEventLinked &= ~(*group_flags);
+  }
+
+  *group       = pont_event;
+  *group_flags = flag;
+
+  if (pont_event != NULL)
+  {
+    pont_event->OSEventLinked |= flag;
+  }
+
+  // Exit Critical Section
+  OSExitCritical();
+
+  return OK;
+}
+
+
+INT8U OSEventWaitAny(BRTOS_EventGroup *pont_event, INT32U *fired, INT16U time_wait)
+{
+  #if (ERROR_CHECK == 1)
+    // Verifies if the pointer is NULL
+    if(pont_event == NULL)
+    {
+      return(NULL_EVENT_POINTER);
+    }
+  #endif
+
+  return OSEventGroupWait(pont_event, pont_event->OSEventLinked, OS_FLAGS_WAIT_ANY | OS_FLAGS_CONSUME, fired, time_wait);
+}
+
+
+INT8U OSEventWaitAll(BRTOS_EventGroup *pont_event, INT32U *fired, INT16U time_wait)
+{
+  #if (ERROR_CHECK == 1)
+    // Verifies if the pointer is NULL
+    if(pont_event == NULL)
+    {
+      return(NULL_EVENT_POINTER);
+    }
+  #endif
+
+  return OSEventGroupWait(pont_event, pont_event->OSEventLinked, OS_FLAGS_WAIT_ALL | OS_FLAGS_CONSUME, fired, time_wait);
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+#endif
@@ -81,6 +81,184 @@
 #define READY_LIST_VAR
 #endif
 
+#ifndef TICKLESS_IDLE_EN
+#define TICKLESS_IDLE_EN              0
+#endif
+
+#ifndef TICKLESS_MIN_IDLE_TICKS
+#define TICKLESS_MIN_IDLE_TICKS       2   ///< Minimum idle time, in ticks, to suppress the tick timer (must be >= 2)
+#endif
+
+/// Scheduler implementations
+#define SCHEDULER_DEFAULT             0   ///< HAL optimized scheduler if available, otherwise the portable one
+#define SCHEDULER_PORTABLE            1   ///< Portable successive approximation scheduler
+#define SCHEDULER_CLZ                 2   ///< Count leading zeros scheduler, using the GCC builtin
+
+#ifndef SCHEDULER_TYPE
+#define SCHEDULER_TYPE                SCHEDULER_DEFAULT
+#endif
+
+#ifndef BRTOS_SHARED_PRIORITY_EN
+#define BRTOS_SHARED_PRIORITY_EN      0
+#endif
+
+#if (BRTOS_SHARED_PRIORITY_EN == 1)
+  #ifndef RR_TIME_SLICE
+    #define RR_TIME_SLICE             10  ///< Ticks a task runs before the next ready task of its priority, 0 disables the time slice
+  #endif
+  #if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+    #error "The priority inheritance mutexes lend one priority to one task, they need BRTOS_SHARED_PRIORITY_EN 0"
+  #endif
+#endif
+
+#if (TICKLESS_IDLE_EN == 1)
+  #ifndef OS_TICKLESS_SLEEP
+    #define OS_TICKLESS_SLEEP(ticks)  OSTicklessSleep(ticks)    ///< HAL hook used to sleep with the tick timer suppressed
+  #endif
+#endif
+
+#ifndef BRTOS_SPSC_QUEUE_EN
+#define BRTOS_SPSC_QUEUE_EN           0
+#endif
+
+#if (BRTOS_SPSC_QUEUE_EN == 1)
+  #if ((BRTOS_SEM_EN != 1) || (BRTOS_BINARY_SEM_EN != 1))
+    #error "The SPSC queue needs the binary semaphores (BRTOS_SEM_EN and BRTOS_BINARY_SEM_EN)"
+  #endif
+  #ifndef OS_MEMORY_BARRIER
+    #define OS_MEMORY_BARRIER()       ///< HAL hook to order memory accesses between cores, not needed on single core MCUs
+  #endif
+#endif
+
+#ifndef BRTOS_MEMPOOL_EN
+#define BRTOS_MEMPOOL_EN              0
+#endif
+
+#if (BRTOS_MEMPOOL_EN == 1)
+  #ifndef BRTOS_MAX_MEMPOOL
+    #define BRTOS_MAX_MEMPOOL         4   ///< Defines the maximum number of memory pools
+  #endif
+#endif
+
+#ifndef BRTOS_MSG_QUEUE_EN
+#define BRTOS_MSG_QUEUE_EN            0
+#endif
+
+#if ((BRTOS_MSG_QUEUE_EN == 1) && (BRTOS_DYNAMIC_QUEUE_ENABLED != 1))
+  #error "The message queue needs the dynamic queues (BRTOS_DYNAMIC_QUEUE_ENABLED)"
+#endif
+
+#if ((BRTOS_MSG_QUEUE_EN == 1) && (BRTOS_MEMPOOL_EN != 1))
+  #error "The message queue needs the memory pools (BRTOS_MEMPOOL_EN)"
+#endif
+
+#ifndef BRTOS_MUTEX_INHERITANCE_EN
+#define BRTOS_MUTEX_INHERITANCE_EN    0
+#endif
+
+#ifndef BRTOS_MUTEX_STATS_EN
+#define BRTOS_MUTEX_STATS_EN          0
+#endif
+
+#ifndef BRTOS_MBOX_MULTI_EN
+#define BRTOS_MBOX_MULTI_EN           0
+#endif
+
+#if (BRTOS_MBOX_MULTI_EN == 1)
+  #ifndef BRTOS_MBOX_MAX_SLOTS
+    #define BRTOS_MBOX_MAX_SLOTS      4   ///< Defines the maximum depth of a multi-slot mailbox
+  #endif
+#endif
+
+#ifndef BRTOS_EVENT_GROUP_EN
+#define BRTOS_EVENT_GROUP_EN          0
+#endif
+
+#ifndef BRTOS_WORKQ_EN
+#define BRTOS_WORKQ_EN                0
+#endif
+
+#if (BRTOS_WORKQ_EN == 1)
+  #ifndef BRTOS_WORKQ_SIZE
+    #define BRTOS_WORKQ_SIZE          16  ///< Defines the number of work items that can wait for the worker task
+  #endif
+  #ifndef BRTOS_WORKQ_BATCH
+    #define BRTOS_WORKQ_BATCH         8   ///< Defines the number of work items taken by the worker task at once
+  #endif
+#endif
+
+#if (BRTOS_EVENT_GROUP_EN == 1)
+  #ifndef BRTOS_MAX_EVENT_GROUP
+    #define BRTOS_MAX_EVENT_GROUP     4   ///< Defines the maximum number of event groups
+  #endif
+#endif
+
+#ifndef BRTOS_TMR_IMMEDIATE_EN
+#define BRTOS_TMR_IMMEDIATE_EN        0
+#endif
+
+#ifndef BRTOS_TMR_LATENCY_EN
+#define BRTOS_TMR_LATENCY_EN          0
+#endif
+
+#ifndef OS_TASK_RUNTIME_EN
+#define OS_TASK_RUNTIME_EN            0
+#endif
+
+#ifndef OSTRACE
+#define OSTRACE                       0
+#endif
+
+#ifndef BRTOS_SEM_FAST_EN
+#define BRTOS_SEM_FAST_EN             0
+#endif
+
+// The semaphore fast path needs the compare and swap of the HAL, the other ports and
+// the traced builds (every pend and post is recorded) keep the critical section path
+#if (BRTOS_SEM_FAST_EN == 1) && (!defined(OS_CPU_CAS16) || (OSTRACE == 1))
+  #undef  BRTOS_SEM_FAST_EN
+  #define BRTOS_SEM_FAST_EN           0
+#endif
+
+#ifndef OS_STACK_WATERMARK_EN
+#define OS_STACK_WATERMARK_EN         0
+#endif
+
+#ifndef OS_STACK_GUARD_EN
+#define OS_STACK_GUARD_EN             0
+#endif
+
+#if (OS_STACK_WATERMARK_EN == 1)
+  #ifndef OS_STACK_PAINT
+    #define OS_STACK_PAINT            0xA5      ///< Byte painted on the task stacks at install, tells the never used stack
+  #endif
+  #ifndef OS_STACK_MARGIN
+    #define OS_STACK_MARGIN           25        ///< Headroom over the peak stack usage, in percent, of the recommended stack sizes
+  #endif
+  #ifndef OS_STACK_SCAN_WORDS
+    #define OS_STACK_SCAN_WORDS       32        ///< Stack words scanned by OSTaskStackUsage in each critical section
+  #endif
+  #if (OS_STACK_GUARD_EN == 1)
+    #ifndef OS_STACK_GUARD_SIZE
+      #define OS_STACK_GUARD_SIZE     16        ///< Bytes at the end of each task stack verified on every context switch
+    #endif
+  #endif
+#elif (OS_STACK_GUARD_EN == 1)
+  #error "OS_STACK_GUARD_EN requires OS_STACK_WATERMARK_EN"
+#endif
+
+#if (OS_TASK_RUNTIME_EN == 1) || (OSTRACE == 1) || (BRTOS_MUTEX_STATS_EN == 1) || (BRTOS_WORKQ_EN == 1)
+  #ifndef OS_TIMESTAMP
+    #define OS_TIMESTAMP()            OSGetMonotonicCount()     ///< HAL hook returning a free running 32 bits timestamp, tick resolution if the HAL has no better source
+    #define OS_TIMESTAMP_HZ           configTICK_RATE_HZ        ///< Frequency of the OS_TIMESTAMP() counter
+  #endif
+  #ifndef OS_TIMESTAMP_TYPE
+    #define OS_TIMESTAMP_TYPE         INT32U                    ///< Type of OS_TIMESTAMP(), INT64U for HALs whose counter wraps around too fast in 32 bits
+  #endif
+  /// Interval between two OS_TIMESTAMP() values, saturated to the 32 bits of the statistics
+  #define OS_TIMESTAMP_SPAN(interval) (((((interval) >> 16) >> 16) != 0u) ? (INT32U)0xFFFFFFFFu : (INT32U)(interval))
+#endif
+
 #define BRTOS_BIG_ENDIAN              (0)
 #define BRTOS_LITTLE_ENDIAN           (1)
 
@@ -94,6 +272,9 @@
 #define SUSPENDED                    (INT8U)1     ///< Task is suspended
 #define BLOCKED                      (INT8U)2     ///< Task is blocked - Will not run until be released
 #define MUTEX_PRIO                   (INT8U)0xFE
+#if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+#define MUTEX_PRIORITY_INHERITANCE   (INT8U)0xFD  ///< Given as ceiling priority, creates a priority inheritance mutex
+#endif
 #define EMPTY_PRIO                   (INT8U)0xFF
 
 
@@ -143,6 +324,8 @@
 #define BUSY_RESOURCE           (INT8U)12     ///< The resource is busy
 #define AVAILABLE_MESSAGE       (INT8U)13     ///< There is a message
 #define NO_MESSAGE              (INT8U)14     ///< There is no message
+#define ERR_MBOX_FULL           (INT8U)15     ///< All the slots of a multi-slot mailbox hold a message
+#define ERR_WORKQ_FULL          (INT8U)16     ///< The work queue has no room for another work item
 
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
@@ -171,18 +354,43 @@
 
 
 
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Event Group Defines                         /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+// Event group wait options
+#define OS_FLAGS_WAIT_ANY    (INT8U)0     ///< Wait for any of the flags
+#define OS_FLAGS_WAIT_ALL    (INT8U)1     ///< Wait for all the flags
+#define OS_FLAGS_CONSUME     (INT8U)2     ///< Clear the flags that released the task
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
 /// Suspended Types
 #define DELAY     0                               ///< Task suspended by delay
 #define SEMAPHORE 1                               ///< Task suspended by semaphore
 #define MAILBOX   2                               ///< Task suspended by mailbox
 #define QUEUE     3                               ///< Task suspended by queue
 #define MUTEX     4                               ///< Task suspended by mutex
+#define EVENT_GROUP 5                             ///< Task suspended by event group
+#define MEMORY_POOL 6                             ///< Task suspended by memory pool
+#define WORK_QUEUE  7                             ///< Worker task waiting for work items
 
 
 
 /// Task Defines
 
-#if (NUMBER_OF_PRIORITIES > 16)
+#if (NUMBER_OF_PRIORITIES > 32)
+  #define configMAX_TASK_INSTALL  64                 ///< Defines the maximum number of tasks that can be installed
+  #define configMAX_TASK_PRIORITY 63
+  typedef INT64U PriorityType;
+#elif (NUMBER_OF_PRIORITIES > 16)
   #define configMAX_TASK_INSTALL  32                 ///< Defines the maximum number of tasks that can be installed
   #define configMAX_TASK_PRIORITY 31  
   typedef INT32U PriorityType;
@@ -221,14 +429,17 @@
 struct Context
 {
    const CHAR8 * TaskName;  ///< Task name
-  #if SP_SIZE == 32
+  #if SP_SIZE == 64
+   INT64U StackPoint;       ///< Current position of virtual stack pointer
+   INT64U StackInit;        ///< Virtual stack pointer init
+  #elif SP_SIZE == 32
    INT32U StackPoint;       ///< Current position of virtual stack pointer
    INT32U StackInit;        ///< Virtual stack pointer init
   #else
    INT16U StackPoint;       ///< Current position of virtual stack pointer
    INT16U StackInit;        ///< Virtual stack pointer init  
   #endif
-#if (BRTOS_DYNAMIC_TASKS_ENABLED == 1)
+#if (BRTOS_DYNAMIC_TASKS_ENABLED == 1) || (OS_STACK_WATERMARK_EN == 1)
  INT16U StackSize;
 #endif
    INT16U TimeToWait;       ///< Time to wait - could be used by delay or timeout
@@ -238,6 +449,28 @@ struct Context
    INT8U  SuspendedType;    ///< Task suspended type
   #endif
    INT8U  Priority;         ///< Task priority
+  #if (BRTOS_SHARED_PRIORITY_EN == 1)
+   INT8U  Id;               ///< Task number, index of the task control block
+   INT8U  ReadyNext;        ///< Next task in the ready queue of the priority, 0 for the last one
+   INT8U  Ready;            ///< The task waits for no event nor delay
+   INT8U  Suspended;        ///< The task is blocked by OSBlockTask
+   void   *WaitEvent;       ///< Event the task waits for
+   INT8U  WaitNext;         ///< Next task in the wait queue of the priority, to wake up the tasks of a priority in FIFO order
+  #endif
+  #if (BRTOS_EVENT_GROUP_EN == 1)
+   INT32U WaitFlags;        ///< Event group flags being waited - holds the flags that released the task
+   INT8U  WaitFlagsOpt;     ///< Event group wait options
+  #endif
+  #if (BRTOS_MBOX_MULTI_EN == 1)
+   void   *MboxMessage;     ///< Message handed over by the mailbox post that released the task
+  #endif
+  #if (OS_TASK_RUNTIME_EN == 1)
+   INT32U RunTime;          ///< Processor time used by the task, in OS_TIMESTAMP() units (wraps around)
+   INT32U Switches;         ///< Number of times the task got the processor
+   INT32U MaxBlockTime;     ///< Longest time the task stayed blocked, in OS_TIMESTAMP() units
+   OS_TIMESTAMP_TYPE BlockStart; ///< Timestamp of the moment the task blocked
+   INT8U  Blocking;         ///< The task left the processor blocked
+  #endif
    struct Context *Next;
    struct Context *Previous;
 };
@@ -259,18 +492,36 @@ typedef struct Context ContextType;
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
+struct BRTOS_EventGroup_s;
+
 /**
 * \struct BRTOS_Sem
 * Semaphore Control Block Structure
 */
 typedef struct {
+#if (BRTOS_SEM_FAST_EN == 1)
+  // The fast path swaps the count and the wait counter together, as one aligned 16 bits word
+  union {
+    struct {
+      INT8U    OSEventCount;                  ///< Semaphore Count - This value is increased with a post and decremented with a pend
+      INT8U    OSEventWait;                   ///< Counter of waiting Tasks
+    };
+    INT16U     OSEventState;                  ///< Count and wait counter seen by OS_CPU_CAS16
+  };
+  INT8U        OSEventAllocated;              ///< Indicate if the event is allocated or not
+#else
   INT8U        OSEventAllocated;              ///< Indicate if the event is allocated or not
   INT8U        OSEventCount;                  ///< Semaphore Count - This value is increased with a post and decremented with a pend
   INT8U        OSEventWait;                   ///< Counter of waiting Tasks
+#endif
 #if (BRTOS_BINARY_SEM_EN == 1)
   INT8U		   Binary;						  ///< Defines if semaphore is binary or counting
 #endif
   PriorityType OSEventWaitList;               ///< Task wait list for event to occur
+#if (BRTOS_EVENT_GROUP_EN == 1)
+  struct BRTOS_EventGroup_s *OSEventGroup;    ///< Event group signaled by a post - Used to wait for multiple events
+  INT32U       OSEventGroupFlags;             ///< Flags set in the event group by a post
+#endif
 } BRTOS_Sem;
 
 ////////////////////////////////////////////////////////////
@@ -300,8 +551,31 @@ typedef struct {
   INT8U        OSOriginalPriority;            ///< Save original priority of Mutex owner task - used to the priority ceiling implementation
   INT8U        OSEventWait;                   ///< Counter of waiting Tasks
   PriorityType OSEventWaitList;               ///< Task wait list for event to occur
+#if (BRTOS_MUTEX_STATS_EN == 1)
+  INT32U       OSContention;                  ///< Acquires that found the mutex owned by another task
+  OS_TIMESTAMP_TYPE OSHoldStart;              ///< Timestamp of the moment the owner got the mutex
+  INT32U       OSMaxHoldTime;                 ///< Longest time the mutex was owned, in OS_TIMESTAMP() units
+#endif
+#if (BRTOS_EVENT_GROUP_EN == 1)
+  struct BRTOS_EventGroup_s *OSEventGroup;    ///< Event group signaled by a release - Used to wait for multiple events
+  INT32U       OSEventGroupFlags;             ///< Flags set in the event group by a release
+#endif
 } BRTOS_Mutex;
 
+#if (BRTOS_MUTEX_STATS_EN == 1)
+/**
+* \struct OS_MUTEX_STATS
+* Mutex statistics
+*/
+typedef struct
+{
+  INT8U        Owner;                         ///< Task owning the mutex, 0 if available
+  INT8U        TasksWaiting;                  ///< Tasks waiting for the mutex
+  INT32U       Contention;                    ///< Acquires that found the mutex owned by another task
+  INT32U       MaxHoldTime;                   ///< Longest time the mutex was owned, in OS_TIMESTAMP() units
+} OS_MUTEX_STATS;
+#endif
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
@@ -326,7 +600,18 @@ typedef struct {
   INT8U        OSEventWait;                   ///< Counter of waiting Tasks
   INT8U        OSEventState;                  ///< Mailbox state - Defines if the message is available or not
   PriorityType OSEventWaitList;               ///< Task wait list for event to occur
+#if (BRTOS_MBOX_MULTI_EN == 1)
+  INT8U        OSEventDepth;                  ///< Number of slots of the mailbox - 1 overwrites the unread message
+  INT8U        OSEventCount;                  ///< Number of messages kept while no task waits
+  INT8U        OSEventOut;                    ///< Slot of the oldest message
+  void         *OSEventSlots[BRTOS_MBOX_MAX_SLOTS]; ///< Messages kept while no task waits
+#else
   void         *OSEventPointer;               ///< Pointer to the message structure / type
+#endif
+#if (BRTOS_EVENT_GROUP_EN == 1)
+  struct BRTOS_EventGroup_s *OSEventGroup;    ///< Event group signaled by a post - Used to wait for multiple events
+  INT32U       OSEventGroupFlags;             ///< Flags set in the event group by a post
+#endif
 } BRTOS_Mbox;
 
 ////////////////////////////////////////////////////////////
@@ -354,6 +639,10 @@ typedef struct {
   INT8U        OSEventWait;                   ///< Counter of waiting Tasks
   void         *OSEventPointer;               ///< Pointer to queue structure
   PriorityType OSEventWaitList;               ///< Task wait list for event to occur
+#if (BRTOS_EVENT_GROUP_EN == 1)
+  struct BRTOS_EventGroup_s *OSEventGroup;    ///< Event group signaled by a post - Used to wait for multiple events
+  INT32U       OSEventGroupFlags;             ///< Flags set in the event group by a post
+#endif
 } BRTOS_Queue;
 
 ////////////////////////////////////////////////////////////
@@ -364,6 +653,154 @@ typedef struct {
 
 
 
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////    Event Group Control Block Structure           /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+/**
+* \struct BRTOS_EventGroup
+* Event Group Control Block Structure
+*/
+typedef struct BRTOS_EventGroup_s {
+  INT8U        OSEventAllocated;              ///< Indicate if the event is allocated or not
+  INT8U        OSEventWait;                   ///< Counter of waiting Tasks
+  INT32U       OSEventFlags;                  ///< Current flags of the group
+  INT32U       OSEventLinked;                 ///< Flags owned by the semaphores, mailboxes and queues linked to the group
+  PriorityType OSEventWaitList;               ///< Task wait list for event to occur
+} BRTOS_EventGroup;
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+#if (BRTOS_MEMPOOL_EN == 1)
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////    Memory Pool Control Block Structure           /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+/// Size of each block of a memory pool, rounded up to keep the blocks aligned to a pointer
+#define OS_MEM_BLOCK_SIZE(size)       ((INT16U)(((size) + sizeof(void*) - 1) & ~(sizeof(void*) - 1)))
+
+/// Bytes of memory needed by a pool of fixed size blocks
+#define OS_MEM_POOL_BYTES(blocks, size)   ((INT32U)(blocks) * OS_MEM_BLOCK_SIZE(size))
+
+/// Declares the memory of a pool of fixed size blocks, aligned to a pointer
+#define OS_MEM_POOL_DECLARE(name, blocks, size)   void *name[OS_MEM_POOL_BYTES(blocks, size) / sizeof(void*)]
+
+/**
+* \struct OS_MEM_BLOCK
+* Link of a free block, placed in the block itself
+*/
+typedef struct OS_MEM_BLOCK_s
+{
+  struct OS_MEM_BLOCK_s *OSMemNext;           ///< Next free block of the pool
+} OS_MEM_BLOCK;
+
+/**
+* \struct BRTOS_MemPool
+* Memory Pool Control Block Structure
+*/
+typedef struct BRTOS_MemPool_s {
+  INT8U        OSEventAllocated;              ///< Indicate if the event is allocated or not
+  INT8U        OSEventWait;                   ///< Counter of waiting Tasks
+  INT8U        OSMemHeap;                     ///< TRUE if the pool serves OSMemAlloc
+  INT8U        *OSMemStart;                   ///< First block of the pool
+  INT8U        *OSMemEnd;                     ///< End of the pool memory
+  OS_MEM_BLOCK *OSMemFree;                    ///< First free block
+  INT16U       OSMemBlockSize;                ///< Size of each block - Defined in the create pool function
+  INT16U       OSMemBlocks;                   ///< Number of blocks - Defined in the create pool function
+  INT16U       OSMemFreeBlocks;               ///< Number of blocks in the free list
+  INT16U       OSMemReserved;                 ///< Free blocks already given to tasks released by a put
+  INT16U       OSMemMinFree;                  ///< Lowest number of available blocks since the pool creation
+  INT32U       OSMemGets;                     ///< Blocks taken from the pool
+  INT32U       OSMemFails;                    ///< Gets that failed or timed out with the pool empty
+  PriorityType OSEventWaitList;               ///< Task wait list for event to occur
+} BRTOS_MemPool;
+
+/**
+* \struct OS_MEM_POOL_STATS
+* Memory pool statistics
+*/
+typedef struct
+{
+  INT16U       BlockSize;                     ///< Size of each block
+  INT16U       Blocks;                        ///< Number of blocks
+  INT16U       FreeBlocks;                    ///< Available blocks
+  INT16U       MinFreeBlocks;                 ///< Lowest number of available blocks since the pool creation
+  INT8U        TasksWaiting;                  ///< Tasks waiting for a block
+  INT32U       Gets;                          ///< Blocks taken from the pool
+  INT32U       Fails;                         ///< Gets that failed or timed out with the pool empty
+} OS_MEM_POOL_STATS;
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#endif
+
+
+
+#if (BRTOS_WORKQ_EN == 1)
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////    Work Queue Structures                         /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+/// Function run by the worker task on behalf of an interrupt
+typedef void (*OS_WORK_FUNC)(void *arg);
+
+/**
+* \struct OS_WORK_ITEM
+* Work item waiting for the worker task
+*/
+typedef struct
+{
+  OS_WORK_FUNC Func;                          ///< Deferred function
+  void         *Arg;                          ///< Argument given to the function
+  OS_TIMESTAMP_TYPE Stamp;                    ///< OS_TIMESTAMP() of the submission
+} OS_WORK_ITEM;
+
+/**
+* \struct OS_WORKQ_STATS
+* Work queue statistics. The latency of an item is the time from its submission
+* to the moment the worker task takes it, in OS_TIMESTAMP() units
+*/
+typedef struct
+{
+  INT32U       Submitted;                     ///< Work items accepted
+  INT32U       Overruns;                      ///< Work items refused with the queue full
+  INT32U       Executed;                      ///< Work items taken by the worker task
+  INT32U       Batches;                       ///< Times the worker task emptied the queue or took a full batch
+  INT16U       Pending;                       ///< Work items waiting now
+  INT16U       MaxPending;                    ///< Highest number of waiting work items
+  INT16U       MaxBatch;                      ///< Largest batch taken at once
+  INT32U       LastLatency;                   ///< Latency of the last work item
+  INT32U       MaxLatency;                    ///< Longest latency
+  INT32U       TotalLatency;                  ///< Sum of the latencies, divided by Executed gives the mean (wraps around)
+} OS_WORKQ_STATS;
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#endif
+
+
+
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 /////      Queue Structure                             /////
@@ -380,7 +817,8 @@ typedef struct
   INT8U        *OSQEnd;                 ///< Pointer to the queue end
   INT8U        *OSQIn;                  ///< Pointer to the next queue entry
   INT8U        *OSQOut;                 ///< Pointer to the next data in the queue output
-  INT16U       OSQSize;                 ///< Size of the queue - Defined in the create queue function
+  INT16U       OSQTSize;                ///< Size of the queue type - 1, 2 or 4 bytes for the 8, 16 and 32 bits queues, any size for the dynamic queues
+  INT16U       OSQSize;                 ///< Size of the queue, in entries - Defined in the create queue function
   INT16U       OSQEntries;              ///< Size of data inside the queue
 } OS_QUEUE;
 
@@ -400,48 +838,104 @@ typedef struct
 ////////////////////////////////////////////////////////////
 
 /**
-* \struct OS_QUEUE
-* Dynamic Queue Control Block Structure
+* \struct OS_DQUEUE
+* The dynamic queues share the generic queue control block, with any entry size
+*/
+typedef OS_QUEUE OS_DQUEUE;
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+#if (BRTOS_MSG_QUEUE_EN == 1)
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Message Pool Structure                      /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+/**
+* \struct OS_MSG_HEADER
+* Header placed in front of each message block
 */
 typedef struct
 {
-  INT8U        *OSQStart;               ///< Pointer to the queue start
-  INT8U        *OSQEnd;                 ///< Pointer to the queue end
-  INT8U        *OSQIn;                  ///< Pointer to the next queue entry
-  INT8U        *OSQOut;                 ///< Pointer to the next data in the queue output
-  INT16U       OSQTSize;                ///< Size of the queue type - Defined in the create queue function
-  INT16U       OSQLength;               ///< Length of the queue - Defined in the create queue function
-  INT16U       OSQEntries;              ///< Size of data inside the queue
-} OS_DQUEUE;
+  BRTOS_MemPool  *OSMsgPool;                ///< Memory pool that owns the block - Used to return the block on free
+} OS_MSG_HEADER;
+
+/**
+* \struct BRTOS_MsgPool
+* Pool of fixed size message blocks, allocated in the heap
+*/
+typedef struct
+{
+  BRTOS_MemPool  *OSMsgMemPool;             ///< Memory pool of the message blocks
+  void           *OSMsgMemory;              ///< Heap memory of the pool
+} BRTOS_MsgPool;
 
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
+#endif
 
 
 
+#if (BRTOS_SPSC_QUEUE_EN == 1)
 
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
-/////      Queue 16 Structure                          /////
+/////      SPSC Queue Structure                        /////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
 /**
-* \struct OS_QUEUE
-* Queue Control Block Structure
+* \struct BRTOS_SPSC_Queue
+* Single producer / single consumer queue control block structure
+* The indexes use the native word size, so they are read and written atomically.
+* OSQIn and OSQSignalSeq are only written by the producer, OSQOut and OSQWaitSeq only
+* by the consumer. The consumer asks for a signal by incrementing OSQWaitSeq and the
+* producer answers it once, by copying OSQWaitSeq to OSQSignalSeq before the post.
 */
 typedef struct
 {
-  INT16U  *OSQStart;               ///< Pointer to the queue start
-  INT16U  *OSQEnd;                 ///< Pointer to the queue end
-  INT16U  *OSQIn;                  ///< Pointer to the next queue entry
-  INT16U  *OSQOut;                 ///< Pointer to the next data in the queue output
-  INT16U  OSQSize;                 ///< Size of the queue - Defined in the create queue function
-  INT16U  OSQEntries;              ///< Size of data inside the queue
-} OS_QUEUE_16;
+  volatile INT8U        *OSQStart;      ///< Pointer to the queue start
+  INT16U                OSQTSize;       ///< Size of the queue type - Defined in the create queue function
+  OS_CPU_TYPE           OSQSlots;       ///< Number of slots - queue length plus one empty slot
+  volatile OS_CPU_TYPE  OSQIn;          ///< Index of the next queue entry
+  volatile OS_CPU_TYPE  OSQOut;         ///< Index of the next data in the queue output
+  volatile OS_CPU_TYPE  OSQWaitSeq;     ///< Number of signal requests of the consumer
+  volatile OS_CPU_TYPE  OSQSignalSeq;   ///< Last signal request answered by the producer
+  BRTOS_Sem             *OSQSignal;     ///< Binary semaphore used to wake up the consumer
+} BRTOS_SPSC_Queue;
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#endif
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Queue 16 Structure                          /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+/**
+* \struct OS_QUEUE_16
+* The 16 bits queues share the generic queue control block
+*/
+typedef OS_QUEUE OS_QUEUE_16;
 
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
@@ -458,18 +952,10 @@ typedef struct
 ////////////////////////////////////////////////////////////
 
 /**
-* \struct OS_QUEUE
-* Queue Control Block Structure
+* \struct OS_QUEUE_32
+* The 32 bits queues share the generic queue control block
 */
-typedef struct
-{
-  INT32U  *OSQStart;               ///< Pointer to the queue start
-  INT32U  *OSQEnd;                 ///< Pointer to the queue end
-  INT32U  *OSQIn;                  ///< Pointer to the next queue entry
-  INT32U  *OSQOut;                 ///< Pointer to the next data in the queue output
-  INT16U  OSQSize;                 ///< Size of the queue - Defined in the create queue function
-  INT16U  OSQEntries;              ///< Size of data inside the queue
-} OS_QUEUE_32;
+typedef OS_QUEUE OS_QUEUE_32;
 
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
@@ -518,6 +1004,34 @@ typedef struct
 INT8U OSUninstallTask(BRTOS_TH TaskHandle);
 #define UninstallTask OSUninstallTask
 
+#if (OS_STACK_WATERMARK_EN == 1)
+/*****************************************************************************************//**
+* \fn INT8U OSTaskStackUsage(BRTOS_TH TaskHandle, INT16U *size, INT16U *peak)
+* \brief Peak stack usage of a task, found by scanning the stack painted at the task install
+* \param TaskHandle The task handle id, 0 for the current task
+*  The stack is scanned OS_STACK_SCAN_WORDS words per critical section, and the scan gives
+*  up if the task is uninstalled in between, so a dynamic task stack is never read after free
+* \param size Returns the task stack size, in bytes (may be NULL)
+* \param peak Returns the largest stack usage since the task install, in bytes (may be NULL)
+* \return OK Success
+* \return NOT_VALID_TASK Not valid task id, or the task was uninstalled during the scan
+*********************************************************************************************/
+INT8U OSTaskStackUsage(BRTOS_TH TaskHandle, INT16U *size, INT16U *peak);
+#endif
+
+/*****************************************************************************************//**
+* \fn void OSStackOverflowHook(BRTOS_TH TaskHandle)
+* \brief Called when the guard at the end of a task stack was overwritten
+*  Must be provided by the user when OS_STACK_GUARD_EN is active. It is called by the
+*  scheduler with the interrupts disabled, before the task is switched out, and should
+*  log the task and reset the system, since the memory after the stack is corrupted.
+* \param TaskHandle The task that overflowed its stack
+* \return NONE
+*********************************************************************************************/
+#if (OS_STACK_GUARD_EN == 1)
+void OSStackOverflowHook(BRTOS_TH TaskHandle);
+#endif
+
 /*****************************************************************************************//**
 * \fn void Idle(void)
 * \brief Idle Task. May be used to implement low power commands.
@@ -548,6 +1062,57 @@ void BRTOS_TimerHook(void);
 void IdleHook(void);
 #endif
 
+/*****************************************************************************************//**
+* \fn INT16U BRTOS_TimerHookNextEvent(void)
+* \brief Inform how many ticks the timer hook can be skipped in the tickless idle mode.
+*  Must be provided by the user when both the timer hook and the tickless idle are enabled.
+* \return Number of ticks until the next timer hook event
+*********************************************************************************************/
+#if (TICKLESS_IDLE_EN == 1) && (TIMER_HOOK_EN == 1)
+INT16U BRTOS_TimerHookNextEvent(void);
+#endif
+
+/*****************************************************************************************//**
+* \fn INT16U OSTicklessSleep(INT16U ticks)
+* \brief Sleep with the tick timer suppressed (HAL function).
+*  Called with interrupts disabled. Must program the tick timer to expire after the
+*  given number of ticks, enter the low power mode and, on wake up, restart the periodic
+*  tick aligned to the tick boundaries. A different implementation can be plugged
+*  by defining OS_TICKLESS_SLEEP in BRTOSConfig.h.
+* \param ticks Maximum number of ticks to sleep
+* \return Number of whole ticks elapsed while sleeping
+*********************************************************************************************/
+#if (TICKLESS_IDLE_EN == 1)
+INT16U OSTicklessSleep(INT16U ticks);
+
+/*****************************************************************************************//**
+* \fn void OSTicklessIdle(void)
+* \brief Idle with dynamic tick suppression (Internal kernel function).
+*  Sleeps until the earliest delay list deadline or timer hook event and then
+*  processes the ticks elapsed while sleeping.
+* \return NONE
+*********************************************************************************************/
+void OSTicklessIdle(void);
+#endif
+
+/*****************************************************************************************//**
+* \fn void OSTimerTickHandler(void)
+* \brief Run the expired immediate soft timers (Internal kernel function).
+*  Called by the tick timer interrupt handler.
+* \return NONE
+*********************************************************************************************/
+#if (BRTOS_TMR_EN == 1) && (BRTOS_TMR_IMMEDIATE_EN == 1)
+void OSTimerTickHandler(void);
+
+/*****************************************************************************************//**
+* \fn INT16U OSTimerNextImmediate(void)
+* \brief Inform how many ticks remain until the next immediate soft timer expires.
+*  Used by the tickless idle mode (Internal kernel function).
+* \return Number of ticks until the next immediate timer
+*********************************************************************************************/
+INT16U OSTimerNextImmediate(void);
+#endif
+
 /**************************************************************************//**
 * \fn void OS_TICK_HANDLER(void)
 * \brief Tick timer interrupt handler routine (Internal kernel function).
@@ -606,6 +1171,15 @@ INT16U OSGetTickCount(void);
 *********************************************************************************************/
 INT16U OSGetCount(void);
 
+/*****************************************************************************************//**
+* \fn INT32U OSGetMonotonicCount(void)
+* \brief Return the 32 bits tick count.
+*  Internal BRTOS function. Unlike OSGetCount, this counter is not folded at
+*  TICK_COUNT_OVERFLOW and only wraps at 2^32 ticks. Must be read inside a critical section.
+* \return current monotonic tick count
+*********************************************************************************************/
+INT32U OSGetMonotonicCount(void);
+
 /*****************************************************************************************//**
 * \fn void OSIncCounter(void)
 * \brief Update the tick counter.
@@ -613,6 +1187,38 @@ INT16U OSGetCount(void);
 *********************************************************************************************/
 void OSIncCounter(void);
 
+#if (OS_TASK_RUNTIME_EN == 1)
+/*****************************************************************************************//**
+* \fn void OSRuntimeUpdate(void)
+* \brief Charges the processor time used since the last context switch to the running task.
+*  Called by the scheduler. Call it inside a critical section before reading the
+*  RunTime of the tasks, so that the time slice in progress is also counted.
+* \return NONE
+*********************************************************************************************/
+void OSRuntimeUpdate(void);
+#endif
+
+/*****************************************************************************************//**
+* \fn void OSDelayListInsert(ContextType *Task)
+* \brief Insert a task into the delay list (Internal kernel function).
+*  The list is sorted by the ticks remaining to Task->TimeToWait, taking the
+*  tick counter overflow into account. Must be called inside a critical section.
+* \param Task Task control block with the TimeToWait field already updated
+* \return NONE
+*********************************************************************************************/
+void OSDelayListInsert(ContextType *Task);
+
+/*****************************************************************************************//**
+* \fn void OSDelayListUpdate(ContextType *Task, INT16U time_to_wait)
+* \brief Change the wake up time of a task (Internal kernel function).
+*  If the task is in the delay list it is moved to its new sorted position.
+*  Must be called inside a critical section.
+* \param Task Task control block
+* \param time_to_wait New wake up tick count
+* \return NONE
+*********************************************************************************************/
+void OSDelayListUpdate(ContextType *Task, INT16U time_to_wait);
+
 /*****************************************************************************************//**
 * \fn void PreInstallTasks(void)
 * \brief Function that initialize the kernel main variables.
@@ -704,10 +1310,55 @@ INT8U OSSchedule(void);
 /*****************************************************************//**
 * \fn INT8U SAScheduler(PriorityType ReadyList)
 * \brief Sucessive Aproximation Scheduler (Internal kernel function).
-* \param ReadyList List of the tasks ready to run
+*  The implementation is selected by SCHEDULER_TYPE.
+* \param ReadyList List of the tasks ready to run (must not be empty)
 * \return The priority of the highest priority task ready to run
 *********************************************************************/
-INT8U SAScheduler(PriorityType ReadyList);
+INT8U SAScheduler(PriorityType ReadyList);
+
+#if (BRTOS_SHARED_PRIORITY_EN == 1)
+/*****************************************************************//**
+* \fn void OSReadyInsert(ContextType *Task)
+* \brief Puts a task at the end of the ready queue of its priority (Internal kernel function).
+* \param Task Task control block
+*********************************************************************/
+void OSReadyInsert(ContextType *Task);
+
+/*****************************************************************//**
+* \fn void OSReadyRemove(ContextType *Task)
+* \brief Removes a task from the ready queue of its priority (Internal kernel function).
+* \param Task Task control block
+*********************************************************************/
+void OSReadyRemove(ContextType *Task);
+
+/*****************************************************************//**
+* \fn void OSEventWaitInsert(PriorityType *waitlist, void *event, ContextType *Task)
+* \brief Puts a task in the wait list of an event (Internal kernel function).
+* \param waitlist Wait list of the event
+* \param event    Event control block
+* \param Task     Task control block
+*********************************************************************/
+void OSEventWaitInsert(PriorityType *waitlist, void *event, ContextType *Task);
+
+/*****************************************************************//**
+* \fn void OSEventWaitRemove(PriorityType *waitlist, ContextType *Task)
+* \brief Removes a task that gave up waiting from the wait list of an event (Internal kernel function).
+* \param waitlist Wait list of the event
+* \param Task     Task control block
+*********************************************************************/
+void OSEventWaitRemove(PriorityType *waitlist, ContextType *Task);
+
+/*****************************************************************//**
+* \fn INT8U OSEventWaitTake(PriorityType *waitlist, void *event, INT8U *priority)
+* \brief Removes the highest priority task from the wait list of an event,
+*  the first one to arrive among the tasks of that priority (Internal kernel function).
+* \param waitlist Wait list of the event (must not be empty)
+* \param event    Event control block
+* \param priority Returns the priority of the task
+* \return The task number
+*********************************************************************/
+INT8U OSEventWaitTake(PriorityType *waitlist, void *event, INT8U *priority);
+#endif
 
 
 
@@ -725,6 +1376,12 @@ INT8U SAScheduler(PriorityType ReadyList);
 #if (BRTOS_MUTEX_EN == 1)
   /// Mutex Control Block
   extern BRTOS_Mutex BRTOS_Mutex_Table[BRTOS_MAX_MUTEX];
+  #if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+  /// Priorities of the tasks blocked on priority inheritance mutexes, lent to the mutex owners
+  extern PriorityType OSMutexInheritList;
+  /// Task running in place of each lent priority
+  extern INT8U OSMutexInheritor[configMAX_TASK_INSTALL];
+  #endif
 #endif
 
 #if (BRTOS_MBOX_EN == 1)
@@ -738,6 +1395,16 @@ INT8U SAScheduler(PriorityType ReadyList);
   extern OS_QUEUE	 BRTOS_OS_QUEUE_Table[BRTOS_MAX_QUEUE];
 #endif
 
+#if (BRTOS_EVENT_GROUP_EN == 1)
+  /// Event Group Control Block
+  extern BRTOS_EventGroup BRTOS_EventGroup_Table[BRTOS_MAX_EVENT_GROUP];
+#endif
+
+#if (BRTOS_MEMPOOL_EN == 1)
+  /// Memory Pool Control Block
+  extern BRTOS_MemPool BRTOS_MemPool_Table[BRTOS_MAX_MEMPOOL];
+#endif
+
 
 /*****************************************************************************************//**
 * \fn void initEvents(void)
@@ -812,7 +1479,9 @@ void initEvents(void);
   * \fn INT8U OSMutexCreate (BRTOS_Mutex **event, INT8U HigherPriority)
   * \brief Allocates a mutex control block
   * \param **event Address of the mutex control block pointer
-  * \param HigherPriority Higher priority of the tasks that will share a resource
+  * \param HigherPriority Higher priority of the tasks that will share a resource, or
+  *        MUTEX_PRIORITY_INHERITANCE for a mutex that only raises the owner priority to the
+  *        priority of the tasks blocked on it (BRTOS_MUTEX_INHERITANCE_EN)
   * \return IRQ_PEND_ERR Can not use mutex create function from interrupt handler code
   * \return NO_AVAILABLE_EVENT No mutex control blocks available
   * \return ALLOC_EVENT_OK Mutex control block successfully allocated
@@ -852,6 +1521,29 @@ void initEvents(void);
   * \return ERR_MUTEX_OVF Mutex counter overflow
   *********************************************************************************************/  
   INT8U OSMutexRelease(BRTOS_Mutex *pont_event);
+
+  #if (BRTOS_MUTEX_STATS_EN == 1)
+  /*****************************************************************************************//**
+  * \fn INT8U OSMutexQuery(BRTOS_Mutex *pont_event, OS_MUTEX_STATS *stats)
+  * \brief Reads the statistics of a mutex
+  * \param *pont_event Mutex pointer
+  * \param *stats Statistics of the mutex
+  * \return OK Statistics read
+  * \return NULL_EVENT_POINTER The mutex pointer is NULL
+  *********************************************************************************************/
+  INT8U OSMutexQuery(BRTOS_Mutex *pont_event, OS_MUTEX_STATS *stats);
+  #endif
+
+  #if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+  /*****************************************************************************************//**
+  * \fn INT8U OSMutexInheritPriority(INT8U priority)
+  * \brief Scheduler helper, returns the highest lent priority whose owner is ready to run
+  *  if it is higher than the given ready priority. Called with the interrupts disabled
+  * \param priority Highest priority of the ready list
+  * \return The priority to be scheduled
+  *********************************************************************************************/
+  INT8U OSMutexInheritPriority(INT8U priority);
+  #endif
 #endif
 
 #if (BRTOS_MBOX_EN == 1)
@@ -899,11 +1591,361 @@ void initEvents(void);
   * \param *pont_event Semaphore pointer
   * \param *message Pointer to the message to be sent
   * \return OK Success
+  * \return ERR_MBOX_FULL No waiting task and no free slot in a multi-slot mailbox
   * \return ERR_EVENT_NO_CREATED No tasks waiting for the message
   *********************************************************************************************/  
   INT8U OSMboxPost(BRTOS_Mbox *pont_event, void *message);
+
+  #if (BRTOS_MBOX_MULTI_EN == 1)
+  /*****************************************************************************************//**
+  * \fn INT8U OSMboxCreateMulti(BRTOS_Mbox **event, INT8U depth)
+  * \brief Allocates a mailbox control block that keeps up to depth messages
+  *  The messages are received in the posting order. A post to a full mailbox fails,
+  *  while a mailbox created by OSMboxCreate still overwrites its unread message.
+  * \param **event Address of the mailbox control block pointer
+  * \param depth Number of messages kept, from 1 to BRTOS_MBOX_MAX_SLOTS
+  * \return INVALID_PARAMETERS The depth is out of range
+  * \return IRQ_PEND_ERR Can not use mailbox create function from interrupt handler code
+  * \return NO_AVAILABLE_EVENT No mailbox control blocks available
+  * \return ALLOC_EVENT_OK Mailbox control block successfully allocated
+  *********************************************************************************************/
+  INT8U OSMboxCreateMulti(BRTOS_Mbox **event, INT8U depth);
+
+  /*****************************************************************************************//**
+  * \fn INT8U OSMboxPostAll(BRTOS_Mbox *pont_event, void *message)
+  * \brief Mailbox broadcast
+  *  Hands the same message over to every task waiting on the mailbox, in one critical
+  *  section. Without waiting tasks the message is kept as by OSMboxPost.
+  * \param *pont_event Mailbox pointer
+  * \param *message Pointer to the message to be sent
+  * \return OK Success
+  * \return ERR_MBOX_FULL No waiting task and no free slot
+  * \return ERR_EVENT_NO_CREATED The mailbox is not allocated
+  *********************************************************************************************/
+  INT8U OSMboxPostAll(BRTOS_Mbox *pont_event, void *message);
+  #endif
+#endif
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Event Group Prototypes                      /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#if (BRTOS_EVENT_GROUP_EN == 1)
+
+  /*****************************************************************************************//**
+  * \fn INT8U OSEventGroupCreate(INT32U flags, BRTOS_EventGroup **event)
+  * \brief Allocates an event group control block
+  * \param flags Initial value of the flags
+  * \param **event Event group pointer
+  * \return IRQ_PEND_ERR Can not use event group create function from interrupt handler code
+  * \return NO_AVAILABLE_EVENT No event group control blocks available
+  * \return ALLOC_EVENT_OK Event group control block successfully allocated
+  *********************************************************************************************/
+  INT8U OSEventGroupCreate(INT32U flags, BRTOS_EventGroup **event);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSEventGroupDelete(BRTOS_EventGroup **event)
+  * \brief Releases an event group control block
+  * \param **event Address of the event group pointer
+  * \return IRQ_PEND_ERR Can not use event group delete function from interrupt handler code
+  * \return DELETE_EVENT_OK Event group control block released with success
+  *********************************************************************************************/
+  INT8U OSEventGroupDelete(BRTOS_EventGroup **event);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSEventGroupWait(BRTOS_EventGroup *pont_event, INT32U flags, INT8U options, INT32U *fired, INT16U time_wait)
+  * \brief Wait for any or all of the flags of an event group
+  * \param *pont_event Event group pointer
+  * \param flags Flags to wait for
+  * \param options OS_FLAGS_WAIT_ANY or OS_FLAGS_WAIT_ALL, optionally ored with OS_FLAGS_CONSUME
+  * \param *fired Flags that released the task (may be NULL)
+  * \param time_wait Timeout to the event group wait exits
+  * \return OK Success
+  * \return TIMEOUT The flags were not set in the specified time
+  * \return EXIT_BY_NO_ENTRY_AVAILABLE Flags not set and time_wait equal to NO_TIMEOUT
+  * \return INVALID_PARAMETERS No flags to wait for
+  * \return IRQ_PEND_ERR Can not use event group wait function from interrupt handler code
+  *********************************************************************************************/
+  INT8U OSEventGroupWait(BRTOS_EventGroup *pont_event, INT32U flags, INT8U options, INT32U *fired, INT16U time_wait);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSEventGroupSet(BRTOS_EventGroup *pont_event, INT32U flags)
+  * \brief Sets flags of an event group. Can be called from interrupt handling code
+  *  Every waiting task whose condition is satisfied is released.
+  * \param *pont_event Event group pointer
+  * \param flags Flags to set
+  * \return OK Success
+  *********************************************************************************************/
+  INT8U OSEventGroupSet(BRTOS_EventGroup *pont_event, INT32U flags);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSEventGroupClear(BRTOS_EventGroup *pont_event, INT32U flags)
+  * \brief Clears flags of an event group
+  * \param *pont_event Event group pointer
+  * \param flags Flags to clear
+  * \return OK Success
+  *********************************************************************************************/
+  INT8U OSEventGroupClear(BRTOS_EventGroup *pont_event, INT32U flags);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSEventGroupLink(BRTOS_EventGroup *pont_event, INT32U flag, INT8U type, void *object)
+  * \brief Links a semaphore, mutex, mailbox or queue to a flag of the event group
+  *  A post that leaves the object with data, or a release that leaves the mutex available,
+  *  without waking a task waiting on the object, sets the flag. A pend that leaves data
+  *  in the object sets it again. Pass a NULL event group to unlink the object.
+  * \param *pont_event Event group pointer
+  * \param flag Flag set by the object
+  * \param type SEMAPHORE, MUTEX, MAILBOX or QUEUE
+  * \param *object Semaphore, mutex, mailbox or queue pointer
+  * \return OK Success
+  * \return INVALID_PARAMETERS Unknown object type
+  *********************************************************************************************/
+  INT8U OSEventGroupLink(BRTOS_EventGroup *pont_event, INT32U flag, INT8U type, void *object);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSEventWaitAny(BRTOS_EventGroup *pont_event, INT32U *fired, INT16U time_wait)
+  * \brief Wait for a post in any of the objects linked to the event group
+  *  The fired flags are consumed. The caller takes one item of each fired object with
+  *  a NO_TIMEOUT pend, which sets the flag again while the object keeps data.
+  * \param *pont_event Event group pointer
+  * \param *fired Flags of the objects that were posted
+  * \param time_wait Timeout to the wait exits
+  * \return INVALID_PARAMETERS No object linked to the event group
+  * \return Same return values of OSEventGroupWait
+  *********************************************************************************************/
+  INT8U OSEventWaitAny(BRTOS_EventGroup *pont_event, INT32U *fired, INT16U time_wait);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSEventWaitAll(BRTOS_EventGroup *pont_event, INT32U *fired, INT16U time_wait)
+  * \brief Wait for a post in all the objects linked to the event group
+  * \param *pont_event Event group pointer
+  * \param *fired Flags of the objects that were posted
+  * \param time_wait Timeout to the wait exits
+  * \return INVALID_PARAMETERS No object linked to the event group
+  * \return Same return values of OSEventGroupWait
+  *********************************************************************************************/
+  INT8U OSEventWaitAll(BRTOS_EventGroup *pont_event, INT32U *fired, INT16U time_wait);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSEventGroupSignal(BRTOS_EventGroup *pont_event, INT32U flags)
+  * \brief Sets flags and releases the satisfied tasks, without changing context.
+  *  Used by the object posts - must be called inside a critical section.
+  * \param *pont_event Event group pointer
+  * \param flags Flags to set
+  * \return TRUE if a task was released
+  *********************************************************************************************/
+  INT8U OSEventGroupSignal(BRTOS_EventGroup *pont_event, INT32U flags);
+  
+  /// Signals the event group linked to an object after a post that kept data in the object
+  #define OS_EVENT_GROUP_SIGNAL(obj)                                              \
+    if (((obj)->OSEventGroup != NULL) &&                                          \
+        (OSEventGroupSignal((obj)->OSEventGroup, (obj)->OSEventGroupFlags) == TRUE) && \
+        (!iNesting))                                                              \
+    {                                                                             \
+      ChangeContext();                                                            \
+    }
+  
+  /// Sets the flag of the event group linked to an object again after a pend that left data
+  /// in the object, since OSEventWaitAny consumed it
+  #define OS_EVENT_GROUP_REARM(obj, available)                                    \
+    if (available)                                                                \
+    {                                                                             \
+      OS_EVENT_GROUP_SIGNAL(obj)                                                  \
+    }
+  
+  /// Clears the event group link of a new object
+  #define OS_EVENT_GROUP_INIT(obj)    (obj)->OSEventGroup = NULL
+  
+  /// Removes the event group link of a deleted object
+  #define OS_EVENT_GROUP_UNLINK(obj)                                              \
+    if ((obj)->OSEventGroup != NULL)                                              \
+    {                                                                             \
+      (obj)->OSEventGroup->OSEventLinked &= ~((obj)->OSEventGroupFlags);          \
+      (obj)->OSEventGroup = NULL;                                                 \
+    }
+#else
+  #define OS_EVENT_GROUP_SIGNAL(obj)
+  #define OS_EVENT_GROUP_REARM(obj, available)
+  #define OS_EVENT_GROUP_INIT(obj)
+  #define OS_EVENT_GROUP_UNLINK(obj)
+#endif
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Memory Pool Prototypes                      /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#if (BRTOS_MEMPOOL_EN == 1)
+
+  /*****************************************************************************************//**
+  * \fn INT8U OSMemPoolCreate(void *memory, INT16U blocks, INT16U block_size, BRTOS_MemPool **pool)
+  * \brief Allocates a memory pool control block and splits the memory in fixed size blocks
+  * \param *memory Pool memory of OS_MEM_POOL_BYTES(blocks, block_size) bytes aligned to a pointer,
+  *  usually declared with OS_MEM_POOL_DECLARE
+  * \param blocks Number of blocks
+  * \param block_size Size of each block
+  * \param **pool Memory pool pointer
+  * \return INVALID_PARAMETERS There is at least one invalid parameter
+  * \return IRQ_PEND_ERR Can not use pool create function from interrupt handler code
+  * \return NO_AVAILABLE_EVENT No memory pool control blocks available
+  * \return ALLOC_EVENT_OK Memory pool successfully allocated
+  *********************************************************************************************/
+  INT8U OSMemPoolCreate(void *memory, INT16U blocks, INT16U block_size, BRTOS_MemPool **pool);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSMemPoolDelete(BRTOS_MemPool **pool)
+  * \brief Releases a memory pool control block. The pool memory belongs to the caller again
+  * \param **pool Address of the memory pool pointer
+  * \return IRQ_PEND_ERR Can not use pool delete function from interrupt handler code
+  * \return BUSY_RESOURCE There are blocks in use or tasks waiting for a block
+  * \return DELETE_EVENT_OK Memory pool released with success
+  *********************************************************************************************/
+  INT8U OSMemPoolDelete(BRTOS_MemPool **pool);
+  
+  /*****************************************************************************************//**
+  * \fn void *OSMemGet(BRTOS_MemPool *pool)
+  * \brief Gets a block without waiting. Can be called from interrupt handling code
+  * \param *pool Memory pool pointer
+  * \return Pointer to the block or NULL if the pool is empty
+  *********************************************************************************************/
+  void *OSMemGet(BRTOS_MemPool *pool);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSMemPend(BRTOS_MemPool *pool, void **block, INT16U time_wait)
+  * \brief Gets a block, waiting for a put if the pool is empty
+  * \param *pool Memory pool pointer
+  * \param **block Block taken from the pool
+  * \param time_wait Timeout to the pend exits (0 waits forever)
+  * \return OK A block was taken from the pool
+  * \return EXIT_BY_NO_RESOURCE_AVAILABLE Pool empty and time_wait equal to NO_TIMEOUT
+  * \return TIMEOUT The pend exit by timeout
+  * \return IRQ_PEND_ERR Can not use pend function from interrupt handler code
+  * \return NULL_EVENT_POINTER The pool pointer is NULL
+  * \return ERR_EVENT_NO_CREATED The pool was not created
+  *********************************************************************************************/
+  INT8U OSMemPend(BRTOS_MemPool *pool, void **block, INT16U time_wait);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSMemPut(BRTOS_MemPool *pool, void *block)
+  * \brief Returns a block to its pool, handing it to the highest priority task waiting for one.
+  *  Can be called from interrupt handling code
+  * \param *pool Memory pool pointer
+  * \param *block Block taken from the same pool
+  * \return OK Block returned to the pool
+  * \return INVALID_PARAMETERS The block does not belong to the pool or was already returned (ERROR_CHECK)
+  * \return NULL_EVENT_POINTER The pool pointer is NULL
+  *********************************************************************************************/
+  INT8U OSMemPut(BRTOS_MemPool *pool, void *block);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSMemPoolQuery(BRTOS_MemPool *pool, OS_MEM_POOL_STATS *stats)
+  * \brief Reads the statistics of a memory pool
+  * \param *pool Memory pool pointer
+  * \param *stats Statistics of the pool
+  * \return OK Statistics read
+  * \return NULL_EVENT_POINTER The pool pointer is NULL
+  *********************************************************************************************/
+  INT8U OSMemPoolQuery(BRTOS_MemPool *pool, OS_MEM_POOL_STATS *stats);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSMemHeapAdd(BRTOS_MemPool *pool)
+  * \brief Adds a pool to the blocks served by OSMemAlloc and OSMemFree
+  *  Defining BRTOS_ALLOC as OSMemAlloc and BRTOS_DEALLOC as OSMemFree in BRTOSConfig.h makes
+  *  the dynamic tasks and queues allocate their stacks and buffers from these pools, which
+  *  must then be created after BRTOS_Init and before the first task install.
+  * \param *pool Memory pool pointer
+  * \return OK Pool added
+  * \return NULL_EVENT_POINTER The pool pointer is NULL
+  *********************************************************************************************/
+  INT8U OSMemHeapAdd(BRTOS_MemPool *pool);
+  
+  /*****************************************************************************************//**
+  * \fn void *OSMemAlloc(INT32U size)
+  * \brief Gets a block from the pool of smallest blocks of at least size bytes with a free block.
+  *  Can be called from interrupt handling code
+  * \param size Requested size
+  * \return Pointer to the block or NULL if there is no free block big enough
+  *********************************************************************************************/
+  void *OSMemAlloc(INT32U size);
+  
+  /*****************************************************************************************//**
+  * \fn void OSMemFree(void *block)
+  * \brief Returns a block got with OSMemAlloc to its pool. Can be called from interrupt handling code
+  * \param *block Block to release, NULL is ignored
+  *********************************************************************************************/
+  void OSMemFree(void *block);
 #endif
 
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Work Queue Prototypes                       /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#if (BRTOS_WORKQ_EN == 1)
+
+  /*****************************************************************************************//**
+  * \fn INT8U OSWorkQueueInit(INT16U stack_size, INT8U priority)
+  * \brief Installs the worker task, which runs the work items submitted by the interrupts.
+  *  Give it a priority above the tasks that depend on the deferred work
+  * \param stack_size Stack size of the worker task
+  * \param priority Priority of the worker task
+  * \return IRQ_PEND_ERR Can not be called from interrupt handler code
+  * \return OK Worker task installed, else the InstallTask error
+  *********************************************************************************************/
+  INT8U OSWorkQueueInit(INT16U stack_size, INT8U priority);
+
+  /*****************************************************************************************//**
+  * \fn INT8U OSWorkSubmit(OS_WORK_FUNC func, void *arg)
+  * \brief Queues a function to be run by the worker task, in O(1).
+  *  Made to be called from interrupt handling code, which is then left with a few instructions.
+  *  The work items run in the order they were submitted
+  * \param func Function to run
+  * \param *arg Argument given to the function
+  * \return OK Work item queued
+  * \return ERR_WORKQ_FULL No room for the work item, counted as an overrun
+  * \return INVALID_PARAMETERS The function pointer is NULL (ERROR_CHECK)
+  *********************************************************************************************/
+  INT8U OSWorkSubmit(OS_WORK_FUNC func, void *arg);
+
+  /*****************************************************************************************//**
+  * \fn INT8U OSWorkQueueQuery(OS_WORKQ_STATS *stats, INT8U reset)
+  * \brief Reads the statistics of the work queue
+  * \param *stats Statistics of the work queue
+  * \param reset TRUE clears the counters and the latencies after the read
+  * \return OK Statistics read
+  *********************************************************************************************/
+  INT8U OSWorkQueueQuery(OS_WORKQ_STATS *stats, INT8U reset);
+#endif
 
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
@@ -982,6 +2024,81 @@ void initEvents(void);
   * \return First data in the output buffer of the specified queue
   *********************************************************************************************/
   INT8U OSQueuePost(BRTOS_Queue *pont_event, INT8U data); 
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSQueuePendMany(BRTOS_Queue *pont_event, INT8U *pdata, INT16U size, INT16U *read, INT16U time_wait)
+  * \brief Wait for a queue post and read all available data, up to size bytes
+  *  The whole block is copied inside a single critical section.
+  * \param *pont_event Queue event pointer
+  * \param *pdata Destination buffer
+  * \param size Size of the destination buffer
+  * \param *read Number of bytes read
+  * \param time_wait Timeout to the queue pend exits
+  * \return READ_BUFFER_OK At least one byte was read
+  * \return EXIT_BY_NO_ENTRY_AVAILABLE Queue empty and time_wait equal to NO_TIMEOUT
+  * \return TIMEOUT Queue pend timeout
+  *********************************************************************************************/
+  INT8U OSQueuePendMany(BRTOS_Queue *pont_event, INT8U *pdata, INT16U size, INT16U *read, INT16U time_wait);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSQueuePostMany(BRTOS_Queue *pont_event, const INT8U *data, INT16U size, INT16U *written)
+  * \brief Write a block of data into the queue
+  *  The block is copied inside a single critical section and one waiting task
+  *  is woken up for each byte written. Can be called from interrupt handling code.
+  * \param *pont_event Queue event pointer
+  * \param *data Data to be written in the queue
+  * \param size Number of bytes to write
+  * \param *written Number of bytes written
+  * \return WRITE_BUFFER_OK All data successfully written
+  * \return BUFFER_UNDERRUN Queue full, only part of the data was written
+  *********************************************************************************************/
+  INT8U OSQueuePostMany(BRTOS_Queue *pont_event, const INT8U *data, INT16U size, INT16U *written);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSQueueReserve(BRTOS_Queue *pont_event, INT8U **region, INT16U *size)
+  * \brief Get the contiguous free region at the queue input (zero copy write)
+  *  The data written in the region is made visible by OSQueueCommit.
+  *  Only one producer may use reserve / commit at a time.
+  * \param *pont_event Queue event pointer
+  * \param **region Start of the free region
+  * \param *size Size of the free region
+  * \return WRITE_BUFFER_OK Free region available
+  * \return BUFFER_UNDERRUN Queue full
+  *********************************************************************************************/
+  INT8U OSQueueReserve(BRTOS_Queue *pont_event, INT8U **region, INT16U *size);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSQueueCommit(BRTOS_Queue *pont_event, INT16U size)
+  * \brief Commit size bytes written in the region given by OSQueueReserve
+  * \param *pont_event Queue event pointer
+  * \param size Number of bytes written
+  * \return WRITE_BUFFER_OK Data successfully committed
+  * \return BUFFER_UNDERRUN Size larger than the reserved region
+  *********************************************************************************************/
+  INT8U OSQueueCommit(BRTOS_Queue *pont_event, INT16U size);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSQueuePeek(BRTOS_Queue *pont_event, INT8U **region, INT16U *size)
+  * \brief Get the contiguous data region at the queue output (zero copy read)
+  *  The data is released by OSQueueConsume.
+  *  Only one consumer may use peek / consume at a time.
+  * \param *pont_event Queue event pointer
+  * \param **region Start of the data region
+  * \param *size Size of the data region
+  * \return READ_BUFFER_OK Data available
+  * \return NO_ENTRY_AVAILABLE Queue empty
+  *********************************************************************************************/
+  INT8U OSQueuePeek(BRTOS_Queue *pont_event, INT8U **region, INT16U *size);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSQueueConsume(BRTOS_Queue *pont_event, INT16U size)
+  * \brief Release size bytes of the region given by OSQueuePeek
+  * \param *pont_event Queue event pointer
+  * \param size Number of bytes consumed
+  * \return READ_BUFFER_OK Data successfully released
+  * \return NO_ENTRY_AVAILABLE Size larger than the peeked region
+  *********************************************************************************************/
+  INT8U OSQueueConsume(BRTOS_Queue *pont_event, INT16U size);
 #endif
 
 ////////////////////////////////////////////////////////////
@@ -1163,6 +2280,141 @@ void initEvents(void);
   INT8U OSDQueuePost(BRTOS_Queue *pont_event, void *pdata);
 #endif
 
+#if (BRTOS_MSG_QUEUE_EN == 1)
+
+  /*****************************************************************************************//**
+  * \fn INT8U OSMsgPoolCreate(INT16U blocks, INT16U block_size, BRTOS_MsgPool **pool)
+  * \brief Allocates a pool of fixed size message blocks
+  * \param blocks Number of message blocks
+  * \param block_size Size of the message data of each block
+  * \param **pool Message pool pointer
+  * \return INVALID_PARAMETERS There is at least one invalid parameter
+  * \return NO_AVAILABLE_MEMORY There is no memory for allocate the pool
+  * \return NO_AVAILABLE_EVENT No memory pool control blocks available
+  * \return IRQ_PEND_ERR Can not use pool create function from interrupt handler code
+  * \return ALLOC_EVENT_OK Message pool successfully allocated
+  *********************************************************************************************/
+  INT8U OSMsgPoolCreate(INT16U blocks, INT16U block_size, BRTOS_MsgPool **pool);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSMsgPoolDelete(BRTOS_MsgPool **pool)
+  * \brief Releases a message pool
+  * \param **pool Address of the message pool pointer
+  * \return IRQ_PEND_ERR Can not use pool delete function from interrupt handler code
+  * \return BUSY_RESOURCE There are message blocks in use
+  * \return DELETE_EVENT_OK Message pool released with success
+  *********************************************************************************************/
+  INT8U OSMsgPoolDelete(BRTOS_MsgPool **pool);
+  
+  /*****************************************************************************************//**
+  * \fn void *OSMsgAlloc(BRTOS_MsgPool *pool)
+  * \brief Gets a message block from the pool. Can be called from interrupt handling code
+  * \param *pool Message pool pointer
+  * \return Pointer to the message data or NULL if the pool is empty
+  *********************************************************************************************/
+  void *OSMsgAlloc(BRTOS_MsgPool *pool);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSMsgFree(void *msg)
+  * \brief Returns a message block to the pool it was allocated from.
+  *  Can be called from interrupt handling code
+  * \param *msg Pointer to the message data
+  * \return OK Message block released
+  * \return NULL_EVENT_POINTER The message pointer is NULL
+  * \return INVALID_PARAMETERS The message was already released (ERROR_CHECK)
+  *********************************************************************************************/
+  INT8U OSMsgFree(void *msg);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSMsgQueueCreate(INT16U queue_length, BRTOS_Queue **event)
+  * \brief Allocates a queue of message pointers
+  *  Messages are passed by reference, so the message data is never copied.
+  * \param queue_length Queue length
+  * \param **event Queue event pointer
+  * \return Same return values of OSDQueueCreate
+  *********************************************************************************************/
+  INT8U OSMsgQueueCreate(INT16U queue_length, BRTOS_Queue **event);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSMsgQueueDelete(BRTOS_Queue **event)
+  * \brief Releases a message queue. The messages still in the queue are returned to their pools
+  * \param **event Address of the queue event pointer
+  * \return Same return values of OSDQueueDelete
+  *********************************************************************************************/
+  INT8U OSMsgQueueDelete(BRTOS_Queue **event);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSMsgQueuePost(BRTOS_Queue *pont_event, void *msg)
+  * \brief Posts a message block. On success the ownership of the block is passed to the queue
+  * \param *pont_event Queue event pointer
+  * \param *msg Message allocated with OSMsgAlloc
+  * \return WRITE_BUFFER_OK Message posted
+  * \return BUFFER_UNDERRUN Queue full - the caller keeps the ownership of the message
+  *********************************************************************************************/
+  INT8U OSMsgQueuePost(BRTOS_Queue *pont_event, void *msg);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSMsgQueuePend(BRTOS_Queue *pont_event, void **msg, INT16U time_wait)
+  * \brief Waits for a message block. The receiver owns the block and must release it with OSMsgFree
+  * \param *pont_event Queue event pointer
+  * \param **msg Received message
+  * \param time_wait Timeout to the queue pend exits
+  * \return Same return values of OSDQueuePend
+  *********************************************************************************************/
+  INT8U OSMsgQueuePend(BRTOS_Queue *pont_event, void **msg, INT16U time_wait);
+#endif
+
+#if (BRTOS_SPSC_QUEUE_EN == 1)
+
+  /*****************************************************************************************//**
+  * \fn INT8U OSSPSCQueueCreate(INT16U queue_length, OS_CPU_TYPE type_size, BRTOS_SPSC_Queue **queue)
+  * \brief Allocates a single producer / single consumer queue
+  *  Post and pend only update their own index, so no critical section is needed
+  *  unless the consumer is blocked. Only one task or ISR may post and only one task may pend.
+  * \param queue_length Queue length
+  * \param type_size Queue type size
+  * \param **queue Queue pointer
+  * \return INVALID_PARAMETERS There is at least one invalid parameter
+  * \return NO_AVAILABLE_MEMORY There is no memory for allocate the queue
+  * \return IRQ_PEND_ERR Can not use queue create function from interrupt handler code
+  * \return NO_AVAILABLE_EVENT No semaphore control blocks available
+  * \return ALLOC_EVENT_OK Queue successfully allocated
+  *********************************************************************************************/
+  INT8U OSSPSCQueueCreate(INT16U queue_length, OS_CPU_TYPE type_size, BRTOS_SPSC_Queue **queue);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSSPSCQueueDelete(BRTOS_SPSC_Queue **queue)
+  * \brief Releases a single producer / single consumer queue
+  * \param **queue Address of the queue pointer
+  * \return IRQ_PEND_ERR Can not use queue delete function from interrupt handler code
+  * \return DELETE_EVENT_OK Queue released with success
+  *********************************************************************************************/
+  INT8U OSSPSCQueueDelete(BRTOS_SPSC_Queue **queue);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSSPSCQueuePend(BRTOS_SPSC_Queue *queue, void *pdata, INT16U time_wait)
+  * \brief Wait for a queue post, with the same timeout semantics of OSDQueuePend
+  * \param *queue Queue pointer
+  * \param *pdata First data in the output buffer of the specified queue
+  * \param time_wait Timeout to the queue pend exits (0 waits forever)
+  * \return READ_BUFFER_OK The queue was successfully read
+  * \return EXIT_BY_NO_ENTRY_AVAILABLE Queue empty and time_wait equal to NO_TIMEOUT
+  * \return TIMEOUT The queue pend exit by timeout
+  * \return IRQ_PEND_ERR Can not use queue pend function from interrupt handler code
+  *********************************************************************************************/
+  INT8U OSSPSCQueuePend(BRTOS_SPSC_Queue *queue, void *pdata, INT16U time_wait);
+  
+  /*****************************************************************************************//**
+  * \fn INT8U OSSPSCQueuePost(BRTOS_SPSC_Queue *queue, const void *pdata)
+  * \brief Queue post. Can be called from interrupt handling code
+  * \param *queue Queue pointer
+  * \param *pdata Pointer of the data to be written in the queue
+  * \return WRITE_BUFFER_OK Data successfully written
+  * \return BUFFER_UNDERRUN Queue full
+  *********************************************************************************************/
+  INT8U OSSPSCQueuePost(BRTOS_SPSC_Queue *queue, const void *pdata);
+#endif
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
@@ -1193,6 +2445,11 @@ extern INT16U               iStackAddress;
 extern INT8U                NumberOfInstalledTasks;
 extern volatile INT32U      OSDuty;
 extern INT8U                PriorityVector[configMAX_TASK_INSTALL];
+#if (BRTOS_SHARED_PRIORITY_EN == 1)
+extern INT8U                OSReadyHead[configMAX_TASK_INSTALL];
+extern INT8U                OSReadyTail[configMAX_TASK_INSTALL];
+extern INT8U                OSPriorityTasks[configMAX_TASK_INSTALL];
+#endif
 extern volatile INT32U      OSDutyTmp;
 
 #ifdef TICK_TIMER_32BITS
@@ -1210,7 +2467,11 @@ extern volatile INT32U      OSDutyTmp;
 	#error("You must define the OS_CPU_TYPE !!!")
 #endif
 
+#if (NUMBER_OF_PRIORITIES > 32)
+extern INT64U TaskAlloc;
+#else
 extern INT32U TaskAlloc;
+#endif
 extern INT16U iQueueAddress;
 
 #if (PROCESSOR == ATMEGA)
@@ -1240,6 +2501,10 @@ extern CHAR8 BufferText[32];
   extern INT16U StackAddress;
 #endif
 
+#if (OSTRACE == 1)
+  #include "OSTrace.h"
+#endif
+
 
 
 ////////////////////////////////////////////////////////////
@@ -1298,7 +2563,11 @@ extern CHAR8 BufferText[32];
 ////////////////////////////////////////////////////////////
 
 
+/// The delay list is kept sorted by the number of ticks left to each task
+/// wake up, so the tick handler only has to look at the list head.
+/// Links are cleared on removal in order to tell if a task is in the list.
 #define RemoveFromDelayList()                       \
+  do {                                              \
         if(Task == Head)                            \
         {                                           \
           if(Task == Tail)                          \
@@ -1324,25 +2593,70 @@ extern CHAR8 BufferText[32];
             Task->Next->Previous = Task->Previous;  \
             Task->Previous->Next = Task->Next;      \
           }                                         \
-        }
+        }                                           \
+        Task->Next = NULL;                          \
+        Task->Previous = NULL;                      \
+  } while (0)
 
 
 #define IncludeTaskIntoDelayList()                  \
-        if(Tail != NULL)                            \
-        {                                           \
-          /* Insert task into list */               \
-          Tail->Next = Task;                        \
-          Task->Previous = Tail;                    \
-          Tail = Task;                              \
-          Tail->Next = NULL;                        \
-        }                                           \
-        else{                                       \
-           /* Init delay list */                    \
-           Tail = Task;                             \
-           Head = Task;                             \
-           Task->Next = NULL;                       \
-           Task->Previous = NULL;                   \
-        }
+        OSDelayListInsert(Task)
+
+
+/// Ready list and event wait lists. With unique priorities, a bit of the list is
+/// the task itself. With shared priorities, a bit tells that the priority has
+/// ready or waiting tasks, kept in FIFO order by the kernel functions.
+/// OSEventWaitListTake removes the highest priority task from the wait list,
+/// returns its task number and sets prio to its priority.
+#if (BRTOS_SHARED_PRIORITY_EN == 1)
+
+#define OSReadyListInsert(Task)                     \
+        OSReadyInsert(Task)
+
+#define OSReadyListRemove(Task)                     \
+        OSReadyRemove(Task)
+
+#define OSTaskReady(Task)                           \
+        ((Task)->Ready && !(Task)->Suspended && (OSBlockedList & PriorityMask[(Task)->Priority]))
+
+#define OSEventWaitListInsert(event, Task)          \
+        OSEventWaitInsert(&(event)->OSEventWaitList, (void*)(event), Task)
+
+#define OSEventWaitListContains(event, Task)        \
+        ((Task)->WaitEvent == (void*)(event))
+
+#define OSEventWaitListRemove(event, Task)          \
+        OSEventWaitRemove(&(event)->OSEventWaitList, Task)
+
+#define OSEventWaitListTake(event, prio)            \
+        OSEventWaitTake(&(event)->OSEventWaitList, (void*)(event), &(prio))
+
+#else
+
+#define OSReadyListInsert(Task)                     \
+        OSReadyList = OSReadyList | (PriorityMask[(Task)->Priority])
+
+#define OSReadyListRemove(Task)                     \
+        OSReadyList = OSReadyList & ~(PriorityMask[(Task)->Priority])
+
+#define OSTaskReady(Task)                           \
+        (OSReadyList & OSBlockedList & PriorityMask[(Task)->Priority])
+
+#define OSEventWaitListInsert(event, Task)          \
+        (event)->OSEventWaitList = (event)->OSEventWaitList | (PriorityMask[(Task)->Priority])
+
+#define OSEventWaitListContains(event, Task)        \
+        ((event)->OSEventWaitList & PriorityMask[(Task)->Priority])
+
+#define OSEventWaitListRemove(event, Task)          \
+        (event)->OSEventWaitList = (event)->OSEventWaitList & ~(PriorityMask[(Task)->Priority])
+
+#define OSEventWaitListTake(event, prio)            \
+        ((prio) = SAScheduler((event)->OSEventWaitList),                                    \
+         (event)->OSEventWaitList = (event)->OSEventWaitList & ~(PriorityMask[(prio)]),     \
+         PriorityVector[(prio)])
+
+#endif
 
 
 #endif
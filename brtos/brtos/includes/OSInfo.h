@@ -12,10 +12,19 @@
 #define SPACE_ALIGN (INT8U)1
 #define ZEROS_ALIGN (INT8U)2
 
+#define OS_INFO_NAME_SIZE     16      ///< Width of the task name column, longer names are cut
+#define OS_INFO_ROW_SIZE      96      ///< Longest task row of OSTaskList and OSStackReport
+#define OS_INFO_HEADER_SIZE   288     ///< Header, trailer and end of string of OSTaskList and OSStackReport
+
+/// Buffer size needed by OSTaskList and OSStackReport to list n tasks
+#define OS_INFO_LIST_SIZE(n)  (((n) * OS_INFO_ROW_SIZE) + OS_INFO_HEADER_SIZE)
+
 void OSTaskList(char *string);
+void OSStackReport(char *string);
 void OSAvailableMemory(char *string);
 void OSUptimeInfo(char *string);
 void OSCPULoad(char *string);
+void OSTimerLatencyInfo(char *string);
 char *PrintDecimal(signed short val, char *buff);
 
 
@@ -0,0 +1,175 @@
+/**
+* \file OSTrace.h
+* \brief BRTOS binary trace of kernel events
+*
+* Timestamped records of context switches, pend and post on the kernel
+* objects, interrupts, soft timers and Contiki process dispatch, kept in a
+* ring and drained by the application over a serial link. The host side
+* decoder is tools/brtos-trace-decode.py.
+*
+**/
+/*********************************************************************************************************
+*                                               BRTOS
+*                                Brazilian Real-Time Operating System
+*                            Acronymous of Basic Real-Time Operating System
+*
+*
+*                                  Open Source RTOS under MIT License
+*
+*
+*
+*                                        OS Trace functions
+*
+*
+*   Revision: 1.0
+*
+*********************************************************************************************************/
+
+#ifndef OS_TRACE_H
+#define OS_TRACE_H
+
+#include "BRTOS.h"
+
+#if (OSTRACE == 1)
+
+/// Number of records of the trace ring, must be a power of 2
+#ifndef OS_TRACE_SIZE
+  #define OS_TRACE_SIZE               256
+#endif
+
+#if ((OS_TRACE_SIZE & (OS_TRACE_SIZE - 1)) != 0) || (OS_TRACE_SIZE > 32768)
+  #error "OS_TRACE_SIZE must be a power of 2 up to 32768"
+#endif
+
+/// Records each tick interrupt, fills the ring at the tick rate
+#ifndef OS_TRACE_TICK_EN
+  #define OS_TRACE_TICK_EN            0
+#endif
+
+/// Task names longer than this are truncated in the trace description
+#ifndef OS_TRACE_NAME_LEN
+  #define OS_TRACE_NAME_LEN           16
+#endif
+
+/// Maximum number of records in each SLIP frame of OSTraceSendSLIP
+#ifndef OS_TRACE_SLIP_RECORDS
+  #define OS_TRACE_SLIP_RECORDS       8
+#endif
+
+/* trace format */
+#define OS_TRACE_MAGIC                (INT16U)0x5442    /* "BT" in little endian, tells the byte order */
+#define OS_TRACE_VERSION              (INT8U)1
+#define OS_TRACE_NAME_CHUNK           8                 /* task names are sent in chunks of one record size */
+#define OS_TRACE_NAME_RECORDS         (1 + ((OS_TRACE_NAME_LEN + OS_TRACE_NAME_CHUNK - 1) / OS_TRACE_NAME_CHUNK))
+
+#if (OS_TRACE_SLIP_RECORDS < OS_TRACE_NAME_RECORDS)
+  #error "OS_TRACE_SLIP_RECORDS is too small for the task names of OS_TRACE_NAME_LEN"
+#endif
+
+/* trace events */
+#define OS_TRACE_HEADER               (INT8U)0    /* timestamp = OS_TIMESTAMP_HZ, task = version, arg = magic */
+#define OS_TRACE_TASK_NAME            (INT8U)1    /* arg = number of name chunks following the record */
+#define OS_TRACE_LOST                 (INT8U)2    /* arg = records overwritten before being read */
+#define OS_TRACE_SWITCH               (INT8U)3    /* task = task switched in, arg = task switched out */
+#define OS_TRACE_DELAY                (INT8U)4    /* arg = ticks */
+#define OS_TRACE_SEM_PEND             (INT8U)5    /* arg = object address */
+#define OS_TRACE_SEM_POST             (INT8U)6
+#define OS_TRACE_MUTEX_PEND           (INT8U)7
+#define OS_TRACE_MUTEX_POST           (INT8U)8
+#define OS_TRACE_MBOX_PEND            (INT8U)9
+#define OS_TRACE_MBOX_POST            (INT8U)10
+#define OS_TRACE_QUEUE_PEND           (INT8U)11
+#define OS_TRACE_QUEUE_POST           (INT8U)12
+#define OS_TRACE_EVENTGROUP_PEND      (INT8U)13
+#define OS_TRACE_EVENTGROUP_POST      (INT8U)14
+#define OS_TRACE_ISR_ENTER            (INT8U)15   /* arg = interrupt number */
+#define OS_TRACE_ISR_EXIT             (INT8U)16
+#define OS_TRACE_TIMER_FIRE           (INT8U)17   /* arg = callback address */
+#define OS_TRACE_PROCESS_CALL         (INT8U)18   /* arg = Contiki process address */
+#define OS_TRACE_PROCESS_RETURN       (INT8U)19
+#define OS_TRACE_USER                 (INT8U)32   /* first event code free for the application */
+
+/// Interrupt number of the tick timer
+#define OS_TRACE_IRQ_TICK             (INT16U)0
+
+/// Objects are identified by the 16 lower bits of their address,
+/// resolved by the decoder from the symbols of the firmware
+#define OS_TRACE_ADDR(obj)            ((INT16U)(unsigned long)(obj))
+
+/// Trace record, 8 bytes in the CPU byte order
+typedef struct
+{
+  INT32U  Timestamp;    ///< OS_TIMESTAMP() of the event
+  INT8U   Event;        ///< Event code
+  INT8U   Task;         ///< Running task, 0 before the scheduler start
+  INT16U  Arg;          ///< Event argument
+} OS_TRACE_RECORD;
+
+
+/// Interrupt handlers may call these at their entry and exit
+#define OS_TRACE_ISR_ENTER_HOOK(irq)  OSTraceRecord(OS_TRACE_ISR_ENTER, (INT16U)(irq))
+#define OS_TRACE_ISR_EXIT_HOOK(irq)   OSTraceRecord(OS_TRACE_ISR_EXIT, (INT16U)(irq))
+
+
+/*****************************************************************************************//**
+* \fn void OSTraceInit(void)
+* \brief Empties the trace ring (Internal kernel function)
+*********************************************************************************************/
+void OSTraceInit(void);
+
+/*****************************************************************************************//**
+* \fn void OSTraceWrite(INT8U event, INT16U arg)
+* \brief Records an event of the running task, must be called with the interrupts disabled
+*  When the ring is full the oldest record is overwritten and counted as lost.
+* \param event Event code
+* \param arg Event argument
+*********************************************************************************************/
+void OSTraceWrite(INT8U event, INT16U arg);
+
+/*****************************************************************************************//**
+* \fn void OSTraceRecord(INT8U event, INT16U arg)
+* \brief Records an event from a task or from an interrupt handler
+* \param event Event code, OS_TRACE_USER or higher for application events
+* \param arg Event argument
+*********************************************************************************************/
+void OSTraceRecord(INT8U event, INT16U arg);
+
+/*****************************************************************************************//**
+* \fn void OSTraceSwitch(INT8U task)
+* \brief Records the task selected by the scheduler (Internal kernel function)
+* \param task Task that will run next
+*********************************************************************************************/
+void OSTraceSwitch(INT8U task);
+
+/*****************************************************************************************//**
+* \fn INT16U OSTraceDescribe(INT8U *buff, INT16U size)
+* \brief Writes the trace header and the names of the installed tasks
+*  A raw trace stream must start with this description.
+* \param buff Destination buffer
+* \param size Buffer size, in bytes
+* \return Number of bytes written, always a multiple of the record size
+*********************************************************************************************/
+INT16U OSTraceDescribe(INT8U *buff, INT16U size);
+
+/*****************************************************************************************//**
+* \fn INT16U OSTraceRead(INT8U *buff, INT16U size)
+* \brief Moves the oldest records from the ring to a buffer
+*  A lost record is inserted first if records were overwritten since the last read.
+* \param buff Destination buffer
+* \param size Buffer size, in bytes
+* \return Number of bytes written, always a multiple of the record size
+*********************************************************************************************/
+INT16U OSTraceRead(INT8U *buff, INT16U size);
+
+/*****************************************************************************************//**
+* \fn INT16U OSTraceSendSLIP(void (*putbyte)(INT8U data), INT8U describe)
+* \brief Drains the trace ring as SLIP frames of up to OS_TRACE_SLIP_RECORDS records
+* \param putbyte Function transmitting one byte, usually the UART putchar
+* \param describe TRUE to send the trace description in a frame before the records
+* \return Number of records sent
+*********************************************************************************************/
+INT16U OSTraceSendSLIP(void (*putbyte)(INT8U data), INT8U describe);
+
+#endif
+
+#endif
@@ -49,6 +49,7 @@ typedef unsigned short int uint16_t;
 typedef signed short int   int16_t;
 typedef unsigned long      uint32_t;
 typedef signed long        int32_t;
+typedef unsigned long long uint64_t;
 #endif
 
 /* for compatibility purpose */
@@ -60,6 +61,7 @@ typedef uint16_t           INT16U;
 typedef int16_t            INT16S;
 typedef uint32_t      	   INT32U;
 typedef int32_t            INT32S;
+typedef uint64_t           INT64U;
 
 /* for portability purpose */
 typedef unsigned int       stack_pointer_t;	
@@ -39,16 +39,42 @@
 #if (BRTOS_TMR_EN == 1)
 
 /// Defines the maximum number of timers by default
-/// Limits the memory allocation for timers
+/// Limits the memory allocation for timers (up to 65534 timers)
 #define BRTOS_MAX_TIMER_DEFAULT        8
 #ifndef BRTOS_MAX_TIMER  
   #define BRTOS_MAX_TIMER BRTOS_MAX_TIMER_DEFAULT
 #endif
 
+#if (BRTOS_MAX_TIMER > 65534)
+  #error "BRTOS_MAX_TIMER must be lower than 65535"
+#endif
+
 /* config defines */ 
 // do not change, unless we know what are you doing
 #define TIMER_CNT             INT16U                  
 #define TIMER_MAX_COUNTER     (TIMER_CNT)(TICK_COUNT_OVERFLOW-1)   
+#define TIMER_DEADLINE        INT32U                  /* absolute monotonic tick */
+#define TIMER_IDX             INT16U                  /* heap position, 0 = not queued */
+
+/* TRUE if deadline "a" comes before deadline "b" (wrap safe) */
+#define TIMER_BEFORE(a,b)     ((INT32S)((TIMER_DEADLINE)(a) - (TIMER_DEADLINE)(b)) < 0)
+
+/* soft timer classes:
+   deferred timers run their callback from the timer task,
+   immediate timers run it from the tick interrupt and must be ISR safe
+   (short, never blocking, only posting to events) */
+#define TIMER_DEFERRED        (INT8U)0
+#define TIMER_IMMEDIATE       (INT8U)1
+
+#if (BRTOS_TMR_IMMEDIATE_EN == 1)
+  #define TIMER_CLASSES       2
+#else
+  #define TIMER_CLASSES       1
+#endif
+
+/* latency histogram: bucket 0 counts callbacks run in the deadline tick,
+   bucket n counts the ones run 2^(n-1) to 2^n - 1 ticks late */
+#define TIMER_LATENCY_BUCKETS 8
 
 /* typedefs for callback struct */  
 typedef TIMER_CNT (*FCN_CALLBACK) (void);  
@@ -61,7 +87,7 @@ typedef enum
   TIMER_NOT_USED = 1,
   TIMER_STOPPED = 2,
   TIMER_RUNNING = 3,
-  TIMER_SEARCH = 4,
+  TIMER_FIRING = 4,
 } TIMER_STATE;
 
 /* soft timer data struct
@@ -69,8 +95,10 @@ typedef enum
 typedef struct BRTOS_TIMER_S 
 {
       FCN_CALLBACK       func_cb;
-      TIMER_CNT          timeout;
+      TIMER_DEADLINE     deadline;     /* expiration in OSGetMonotonicCount ticks */
+      TIMER_IDX          heap_index;   /* position in the timer heap, makes stop O(log n) */
       TIMER_STATE        state;
+      INT8U              tclass;       /* TIMER_DEFERRED or TIMER_IMMEDIATE */
 } BRTOS_TIMER_T;
 
 /* soft timer typedef
@@ -82,10 +110,17 @@ typedef  BRTOS_TIMER_T*  BRTOS_TIMER;
 
 typedef struct
 {    
-    BRTOS_TIMER timers [BRTOS_MAX_TIMER];
-    INT8S       count;
+    BRTOS_TIMER timers [BRTOS_MAX_TIMER + 1];   /* 1-based binary heap */
+    TIMER_IDX   count;
 }BRTOS_TMR_T;
 
+/* callback latency of a timer class */
+typedef struct
+{
+    INT32U      hist[TIMER_LATENCY_BUCKETS];
+    INT32U      max;                         /* worst latency, in ticks */
+}OS_TIMER_LATENCY;
+
 
 /* TIMER TASK prototype */  
 #if (TASK_WITH_PARAMETERS == 1)
@@ -97,9 +132,15 @@ void BRTOSTimerTask(void);
 /************* public API *********************/ 
 void OSTimerInit(INT16U timertask_stacksize, INT8U prio);
 INT8U OSTimerSet (BRTOS_TIMER *cbp, FCN_CALLBACK cb, TIMER_CNT timeout);
+#if (BRTOS_TMR_IMMEDIATE_EN == 1)
+INT8U OSTimerSetImmediate (BRTOS_TIMER *cbp, FCN_CALLBACK cb, TIMER_CNT timeout);
+#endif
 TIMER_CNT OSTimerGet (BRTOS_TIMER p);
 INT8U OSTimerStart (BRTOS_TIMER p, TIMER_CNT timeout);  
 INT8U OSTimerStop (BRTOS_TIMER p, INT8U del); 
+#if (BRTOS_TMR_LATENCY_EN == 1)
+INT8U OSTimerGetLatency (INT8U tclass, OS_TIMER_LATENCY *latency);
+#endif
 
 /***************************************/
 
@@ -76,6 +76,56 @@
 
 
 #if (BRTOS_MBOX_EN == 1)
+#if (BRTOS_MBOX_MULTI_EN == 1)
+// Keeps a message for the next pend - must be called inside a critical section.
+// A single slot mailbox overwrites its unread message, as the classic mailbox does
+static INT8U OSMboxStore(BRTOS_Mbox *pont_event, void *message)
+{
+  INT8U in;
+
+  if (pont_event->OSEventCount >= pont_event->OSEventDepth)
+  {
+    if (pont_event->OSEventDepth > 1)
+    {
+      return ERR_MBOX_FULL;
+    }
+    pont_event->OSEventCount = 0;
+  }
+
+  in = (INT8U)(pont_event->OSEventOut + pont_event->OSEventCount);
+  if (in >= pont_event->OSEventDepth)
+  {
+    in = (INT8U)(in - pont_event->OSEventDepth);
+  }
+
+  pont_event->OSEventSlots[in] = message;
+  pont_event->OSEventCount++;
+  pont_event->OSEventState = AVAILABLE_MESSAGE;
+
+  return OK;
+}
+
+// Takes the oldest kept message - must be called inside a critical section
+static void *OSMboxFetch(BRTOS_Mbox *pont_event)
+{
+  void *message = pont_event->OSEventSlots[pont_event->OSEventOut];
+
+  pont_event->OSEventOut++;
+  if (pont_event->OSEventOut >= pont_event->OSEventDepth)
+  {
+    pont_event->OSEventOut = 0;
+  }
+
+  pont_event->OSEventCount--;
+  if (pont_event->OSEventCount == 0)
+  {
+    pont_event->OSEventState = NO_MESSAGE;
+  }
+
+  return message;
+}
+#endif
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 /////      Create MailBox Function                     /////
@@ -120,6 +170,17 @@ INT8U OSMboxCreate (BRTOS_Mbox **event, void *message)
     }
   }    
     
+  #if (BRTOS_MBOX_MULTI_EN == 1)
+  pont_event->OSEventDepth = 1;
+  pont_event->OSEventCount = 0;
+  pont_event->OSEventOut   = 0;
+  pont_event->OSEventState = NO_MESSAGE;
+  
+  if (message != NULL)
+  {
+    (void)OSMboxStore(pont_event, message);
+  }
+  #else
   if (message != NULL)
   {
     pont_event->OSEventState = AVAILABLE_MESSAGE;
@@ -130,8 +191,10 @@ INT8U OSMboxCreate (BRTOS_Mbox **event, void *message)
   }
   
   pont_event->OSEventPointer   = message;
+  #endif
   pont_event->OSEventWait      = 0;  
   pont_event->OSEventWaitList=0;
+  OS_EVENT_GROUP_INIT(pont_event);
   
   
   *event = pont_event;
@@ -143,6 +206,28 @@ INT8U OSMboxCreate (BRTOS_Mbox **event, void *message)
   return(ALLOC_EVENT_OK);
 }
 
+#if (BRTOS_MBOX_MULTI_EN == 1)
+INT8U OSMboxCreateMulti(BRTOS_Mbox **event, INT8U depth)
+{
+  INT8U err;
+
+  if ((depth == 0) || (depth > BRTOS_MBOX_MAX_SLOTS))
+  {
+    return(INVALID_PARAMETERS);
+  }
+
+  err = OSMboxCreate(event, NULL);
+
+  // Nobody knows the new mailbox yet
+  if (err == ALLOC_EVENT_OK)
+  {
+    (*event)->OSEventDepth = depth;
+  }
+
+  return err;
+}
+#endif
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
@@ -172,11 +257,17 @@ INT8U OSMboxDelete (BRTOS_Mbox **event)
   
   pont_event = *event;
   pont_event->OSEventAllocated   = 0;
+  #if (BRTOS_MBOX_MULTI_EN == 1)
+  pont_event->OSEventCount       = 0;
+  pont_event->OSEventOut         = 0;
+  #else
   pont_event->OSEventPointer     = NULL;
+  #endif
   pont_event->OSEventWait        = 0;
   pont_event->OSEventState       = NO_MESSAGE;
   
   pont_event->OSEventWaitList=0;
+  OS_EVENT_GROUP_UNLINK(pont_event);
   
   *event = NULL;
   
@@ -204,7 +295,6 @@ INT8U OSMboxDelete (BRTOS_Mbox **event)
 INT8U OSMboxPend (BRTOS_Mbox *pont_event, void **Mail, INT16U time_wait)
 {
   OS_SR_SAVE_VAR
-  INT8U  iPriority = 0;
   INT32U  timeout;
   ContextType *Task;  
   
@@ -237,14 +327,27 @@ INT8U OSMboxPend (BRTOS_Mbox *pont_event, void **Mail, INT16U time_wait)
     }
   #endif
   
+  // BRTOS TRACE SUPPORT
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_MBOX_PEND, OS_TRACE_ADDR(pont_event));
+  #endif
+  
   // Verify if there was a message post
   if (pont_event->OSEventState == AVAILABLE_MESSAGE)
   {
+    #if (BRTOS_MBOX_MULTI_EN == 1)
+    // Take the oldest message
+    *Mail = OSMboxFetch(pont_event);
+    
+    // Keeps the event group flag set while messages are left
+    OS_EVENT_GROUP_REARM(pont_event, pont_event->OSEventState == AVAILABLE_MESSAGE);
+    #else
     // Copy message pointer
     *Mail = pont_event->OSEventPointer;
     
     // Free message slot
     pont_event->OSEventState = NO_MESSAGE;
+    #endif
     
     // Exit Critical Section
     OSExitCritical();
@@ -261,14 +364,11 @@ INT8U OSMboxPend (BRTOS_Mbox *pont_event, void **Mail, INT16U time_wait)
   	
     Task = (ContextType*)&ContextTask[currentTask];
       
-    // Copy task priority to local scope
-    iPriority = Task->Priority;
-    
     // Increases the semaphore wait list counter
     pont_event->OSEventWait++;
     
     // Allocates the current task on the mailbox wait list
-    pont_event->OSEventWaitList = pont_event->OSEventWaitList | (PriorityMask[iPriority]);
+    OSEventWaitListInsert(pont_event, Task);
     
     // Task entered suspended state, waiting for mailbox post
     #if (VERBOSE == 1)
@@ -277,7 +377,7 @@ INT8U OSMboxPend (BRTOS_Mbox *pont_event, void **Mail, INT16U time_wait)
     #endif
     
     // Remove current task from the Ready List
-    OSReadyList = OSReadyList & ~(PriorityMask[iPriority]);
+    OSReadyListRemove(Task);
 
     // Set timeout overflow
     if (time_wait)
@@ -314,10 +414,10 @@ INT8U OSMboxPend (BRTOS_Mbox *pont_event, void **Mail, INT16U time_wait)
         if(Task->TimeToWait == EXIT_BY_TIMEOUT)
         {
             // Test if both timeout and post have occured before arrive here
-            if ((pont_event->OSEventWaitList & PriorityMask[iPriority]))
+            if (OSEventWaitListContains(pont_event, Task))
             {
               // Remove the task from the queue wait list
-              pont_event->OSEventWaitList = pont_event->OSEventWaitList & ~(PriorityMask[iPriority]);
+              OSEventWaitListRemove(pont_event, Task);
               
               // Decreases the queue wait list counter
               pont_event->OSEventWait--;
@@ -343,11 +443,16 @@ INT8U OSMboxPend (BRTOS_Mbox *pont_event, void **Mail, INT16U time_wait)
        
     }
     
+    #if (BRTOS_MBOX_MULTI_EN == 1)
+    // The post handed the message over to the task
+    *Mail = Task->MboxMessage;
+    #else
     // Copy message pointer
     *Mail = pont_event->OSEventPointer;
     
     // Free message slot
     pont_event->OSEventState = NO_MESSAGE;
+    #endif
     
     // Exit Critical Section
     OSExitCritical();  
@@ -374,9 +479,12 @@ INT8U OSMboxPost(BRTOS_Mbox *pont_event, void *message)
 {
   OS_SR_SAVE_VAR
   INT8U iPriority = (INT8U)0;
-  #if (VERBOSE == 1)
+  #if (VERBOSE == 1) || (BRTOS_MBOX_MULTI_EN == 1)
   INT8U TaskSelect = 0;  
   #endif
+  #if (BRTOS_MBOX_MULTI_EN == 1)
+  INT8U err;
+  #endif
   
   #if (ERROR_CHECK == 1)    
     // Verifies if the pointer is NULL
@@ -404,32 +512,38 @@ INT8U OSMboxPost(BRTOS_Mbox *pont_event, void *message)
       return(ERR_EVENT_NO_CREATED);
     }
   #endif
+  
+  // BRTOS TRACE SUPPORT
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_MBOX_POST, OS_TRACE_ADDR(pont_event));
+  #endif
        
   // See if any task is waiting for a message
   if (pont_event->OSEventWait != 0)
   {
-    // Selects the highest priority task
-    iPriority = SAScheduler(pont_event->OSEventWaitList);
-
-    // Remove the selected task from the mailbox wait list
-    pont_event->OSEventWaitList = pont_event->OSEventWaitList & ~(PriorityMask[iPriority]);
+    // Selects the highest priority task and removes it from the mailbox wait list
+    TaskSelect = OSEventWaitListTake(pont_event, iPriority);
     
     // Decreases the mailbox wait list counter
     pont_event->OSEventWait--;
     
     // Put the selected task into Ready List
     #if (VERBOSE == 1)
-    TaskSelect = PriorityVector[iPriority];
     ContextTask[TaskSelect].State = READY;
     #endif
     
-    OSReadyList = OSReadyList | (PriorityMask[iPriority]);
+    OSReadyListInsert(&ContextTask[TaskSelect]);
     
+    #if (BRTOS_MBOX_MULTI_EN == 1)
+    // Hand the message over to the task, the slots keep the messages nobody waited for
+    ContextTask[TaskSelect].MboxMessage = message;
+    #else
     // Copy message pointer
     pont_event->OSEventPointer = message;
     
     // Free message slot
     pont_event->OSEventState = AVAILABLE_MESSAGE;
+    #endif
     
     // If outside of an interrupt service routine, change context to the highest priority task
     // If inside of an interrupt, the interrupt itself will change the context to the highest priority task
@@ -449,11 +563,29 @@ INT8U OSMboxPost(BRTOS_Mbox *pont_event, void *message)
   }
   else
   {
+    #if (BRTOS_MBOX_MULTI_EN == 1)
+    // Keep the message in a free slot
+    err = OSMboxStore(pont_event, message);
+    if (err != OK)
+    {
+      // Exit Critical Section
+      #if (NESTING_INT == 0)
+      if (!iNesting)
+      #endif
+         OSExitCritical();
+      
+      return err;
+    }
+    #else
     // Copy message pointer
     pont_event->OSEventPointer = message;
     
     // Free message slot
     pont_event->OSEventState = AVAILABLE_MESSAGE;
+    #endif
+    
+    // Signal a task waiting for multiple events
+    OS_EVENT_GROUP_SIGNAL(pont_event);
       
   // Exit Critical Section
   #if (NESTING_INT == 0)
@@ -469,4 +601,104 @@ INT8U OSMboxPost(BRTOS_Mbox *pont_event, void *message)
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
+
+
+
+#if (BRTOS_MBOX_MULTI_EN == 1)
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Mailbox Broadcast Function                  /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSMboxPostAll(BRTOS_Mbox *pont_event, void *message)
+{
+  OS_SR_SAVE_VAR
+  INT8U iPriority = (INT8U)0;
+  INT8U TaskSelect = 0;
+  INT8U err = OK;
+  
+  #if (ERROR_CHECK == 1)    
+    // Verifies if the pointer is NULL
+    if(pont_event == NULL)
+    {
+      return(NULL_EVENT_POINTER);
+    }
+  #endif
+
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+     
+  #if (ERROR_CHECK == 1)        
+    // Verifies if the event is allocated
+    if(pont_event->OSEventAllocated != TRUE)
+    {
+      // Exit Critical Section
+      #if (NESTING_INT == 0)
+      if (!iNesting)
+      #endif
+         OSExitCritical();
+      return(ERR_EVENT_NO_CREATED);
+    }
+  #endif
+  
+  // BRTOS TRACE SUPPORT
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_MBOX_POST, OS_TRACE_ADDR(pont_event));
+  #endif
+  
+  // See if any task is waiting for a message
+  if (pont_event->OSEventWait != 0)
+  {
+    // Hand the message over to every waiting task
+    while (pont_event->OSEventWaitList != 0)
+    {
+      TaskSelect = OSEventWaitListTake(pont_event, iPriority);
+      
+      ContextTask[TaskSelect].MboxMessage = message;
+      #if (VERBOSE == 1)
+      ContextTask[TaskSelect].State = READY;
+      #endif
+      
+      OSReadyListInsert(&ContextTask[TaskSelect]);
+    }
+    pont_event->OSEventWait = 0;
+    
+    // If outside of an interrupt service routine, change context to the highest priority task
+    // If inside of an interrupt, the interrupt itself will change the context to the highest priority task
+    if (!iNesting)
+    {
+      // Verify if there is a higher priority task ready to run
+      ChangeContext();      
+    }
+  }
+  else
+  {
+    // Nobody waits, the message is kept for the next pend
+    err = OSMboxStore(pont_event, message);
+    if (err == OK)
+    {
+      // Signal a task waiting for multiple events
+      OS_EVENT_GROUP_SIGNAL(pont_event);
+    }
+  }
+  
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSExitCritical();
+  
+  return err;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+#endif
 #endif
@@ -0,0 +1,658 @@
+/**
+* \file mempool.c
+* \brief BRTOS Memory Pool functions
+*
+* Functions to install and use pools of fixed size memory blocks. Blocks
+* are taken and returned in constant time and can be used from interrupts.
+*
+**/
+/*********************************************************************************************************
+*                                               BRTOS
+*                                Brazilian Real-Time Operating System
+*                            Acronymous of Basic Real-Time Operating System
+*
+*
+*                                  Open Source RTOS under MIT License
+*
+*
+*
+*                                       OS Memory Pool functions
+*
+*
+*   Revision: 1.0
+*
+*********************************************************************************************************/
+
+#include "BRTOS.h"
+
+#if (PROCESSOR == COLDFIRE_V1 && __CWCC__)
+#pragma warn_implicitconv off
+#endif
+
+#if (BRTOS_MEMPOOL_EN == 1)
+
+// Takes the first free block, the caller verifies that there is an available block
+static void *OSMemTake(BRTOS_MemPool *pool)
+{
+  OS_MEM_BLOCK *block = pool->OSMemFree;
+  INT16U available;
+
+  pool->OSMemFree = block->OSMemNext;
+  pool->OSMemFreeBlocks--;
+  pool->OSMemGets++;
+
+  available = pool->OSMemFreeBlocks - pool->OSMemReserved;
+  if (available < pool->OSMemMinFree)
+  {
+    pool->OSMemMinFree = available;
+  }
+
+  return (void*)block;
+}
+
+// Verify if a block was taken from the pool
+#define OSMemOwns(pool, block)    (((INT8U*)(block) >= (pool)->OSMemStart) && ((INT8U*)(block) < (pool)->OSMemEnd))
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Create Memory Pool Function                 /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSMemPoolCreate(void *memory, INT16U blocks, INT16U block_size, BRTOS_MemPool **pool)
+{
+  OS_SR_SAVE_VAR
+  int i=0;
+  INT16U j;
+  INT16U stride;
+  OS_MEM_BLOCK *block;
+
+  BRTOS_MemPool *pont_event;
+
+  if (iNesting > 0) {                                // See if caller is an interrupt
+     return(IRQ_PEND_ERR);                           // Can't be create by interrupt
+  }
+
+  // The blocks hold the free list link, so the memory must be aligned to a pointer
+  if ((memory == NULL) || (blocks == 0) || (block_size == 0) ||
+      (((unsigned long)memory & (sizeof(void*) - 1)) != 0))
+  {
+    return(INVALID_PARAMETERS);
+  }
+
+  stride = OS_MEM_BLOCK_SIZE(block_size);
+  if (stride < block_size)
+  {
+    return(INVALID_PARAMETERS);
+  }
+
+  // Enter critical Section
+  if (currentTask)
+     OSEnterCritical();
+
+  // Verify if there is an available memory pool control block
+  for(i=0;i<=BRTOS_MAX_MEMPOOL;i++)
+  {
+    if(i >= BRTOS_MAX_MEMPOOL)
+    {
+      // Exit critical Section
+      if (currentTask)
+         OSExitCritical();
+
+      return(NO_AVAILABLE_EVENT);
+    }
+
+    if(BRTOS_MemPool_Table[i].OSEventAllocated != TRUE)
+    {
+      BRTOS_MemPool_Table[i].OSEventAllocated = TRUE;
+      pont_event = &BRTOS_MemPool_Table[i];
+      break;
+    }
+  }
+
+  pont_event->OSMemStart = (INT8U*)memory;
+  pont_event->OSMemEnd = (INT8U*)memory + ((INT32U)blocks * stride);
+
+  // Link all blocks into the free list, in address order
+  pont_event->OSMemFree = NULL;
+  for (j = blocks; j > 0; j--)
+  {
+    block = (OS_MEM_BLOCK*)(pont_event->OSMemStart + ((INT32U)(j - 1) * stride));
+    block->OSMemNext = pont_event->OSMemFree;
+    pont_event->OSMemFree = block;
+  }
+
+  pont_event->OSMemHeap       = FALSE;
+  pont_event->OSMemBlockSize  = stride;
+  pont_event->OSMemBlocks     = blocks;
+  pont_event->OSMemFreeBlocks = blocks;
+  pont_event->OSMemReserved   = 0;
+  pont_event->OSMemMinFree    = blocks;
+  pont_event->OSMemGets       = 0;
+  pont_event->OSMemFails      = 0;
+  pont_event->OSEventWait     = 0;
+  pont_event->OSEventWaitList = 0;
+
+  *pool = pont_event;
+
+  // Exit critical Section
+  if (currentTask)
+     OSExitCritical();
+
+  return(ALLOC_EVENT_OK);
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Delete Memory Pool Function                 /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSMemPoolDelete(BRTOS_MemPool **pool)
+{
+  OS_SR_SAVE_VAR
+  BRTOS_MemPool *pont_event;
+
+  if (iNesting > 0) {                                // See if caller is an interrupt
+      return(IRQ_PEND_ERR);                          // Can't be delete by interrupt
+  }
+
+  // Enter Critical Section
+  OSEnterCritical();
+
+  pont_event = *pool;
+
+  // All blocks must have been returned to the pool
+  if ((pont_event->OSMemFreeBlocks != pont_event->OSMemBlocks) || (pont_event->OSEventWait != 0))
+  {
+    // Exit Critical Section
+    OSExitCritical();
+    return(BUSY_RESOURCE);
+  }
+
+  pont_event->OSEventAllocated = 0;
+  pont_event->OSMemHeap        = FALSE;
+  pont_event->OSMemFree        = NULL;
+
+  *pool = NULL;
+
+  // Exit Critical Section
+  OSExitCritical();
+
+  return(DELETE_EVENT_OK);
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Memory Get Function                         /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+void *OSMemGet(BRTOS_MemPool *pool)
+{
+  OS_SR_SAVE_VAR
+  void *block = NULL;
+
+  #if (ERROR_CHECK == 1)
+    // Verifies if the pointer is NULL
+    if(pool == NULL)
+    {
+      return(NULL);
+    }
+  #endif
+
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+
+  // The blocks reserved by a put belong to the released tasks
+  if (pool->OSMemFreeBlocks > pool->OSMemReserved)
+  {
+    block = OSMemTake(pool);
+  }
+  else
+  {
+    pool->OSMemFails++;
+  }
+
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSExitCritical();
+
+  return block;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Memory Pend Function                        /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSMemPend(BRTOS_MemPool *pool, void **block, INT16U time_wait)
+{
+  OS_SR_SAVE_VAR
+  INT32U timeout;
+  ContextType *Task;
+
+  #if (ERROR_CHECK == 1)
+    // Can not use memory pend function from interrupt handling code
+    if(iNesting > 0)
+    {
+      return(IRQ_PEND_ERR);
+    }
+
+    // Verifies if the pointer is NULL
+    if(pool == NULL)
+    {
+      return(NULL_EVENT_POINTER);
+    }
+  #endif
+
+  // Enter Critical Section
+  OSEnterCritical();
+
+  #if (ERROR_CHECK == 1)
+    // Verifies if the event is allocated
+    if(pool->OSEventAllocated != TRUE)
+    {
+      // Exit Critical Section
+      OSExitCritical();
+      return(ERR_EVENT_NO_CREATED);
+    }
+  #endif
+
+  // Verify if there is an available block
+  if (pool->OSMemFreeBlocks > pool->OSMemReserved)
+  {
+    *block = OSMemTake(pool);
+
+    // Exit Critical Section
+    OSExitCritical();
+    return OK;
+  }
+
+  // If no timeout is used and the pool is empty, exit with an error
+  if (time_wait == NO_TIMEOUT){
+    pool->OSMemFails++;
+
+    // Exit Critical Section
+    OSExitCritical();
+    return EXIT_BY_NO_RESOURCE_AVAILABLE;
+  }
+
+  Task = (ContextType*)&ContextTask[currentTask];
+
+  // Increases the memory pool wait list counter
+  pool->OSEventWait++;
+
+  // Allocates the current task on the memory pool wait list
+  OSEventWaitListInsert(pool, Task);
+
+  // Task entered suspended state, waiting for a memory put
+  #if (VERBOSE == 1)
+  Task->State = SUSPENDED;
+  Task->SuspendedType = MEMORY_POOL;
+  #endif
+
+  // Remove current task from the Ready List
+  OSReadyListRemove(Task);
+
+  // Set timeout overflow
+  if (time_wait)
+  {
+    timeout = (INT32U)((INT32U)OSGetCount() + (INT32U)time_wait);
+
+    if (timeout >= TICK_COUNT_OVERFLOW)
+    {
+      Task->TimeToWait = (INT16U)(timeout - TICK_COUNT_OVERFLOW);
+    }
+    else
+    {
+      Task->TimeToWait = (INT16U)timeout;
+    }
+
+    // Put task into delay list
+    IncludeTaskIntoDelayList();
+  } else
+  {
+    Task->TimeToWait = NO_TIMEOUT;
+  }
+
+  // Change Context - Returns on time overflow or memory put
+  ChangeContext();
+
+  if (time_wait)
+  {
+      // Exit Critical Section
+      OSExitCritical();
+      // Enter Critical Section
+      OSEnterCritical();
+
+      // Verify if the reason of task wake up was timeout
+      if(Task->TimeToWait == EXIT_BY_TIMEOUT)
+      {
+          // Test if both timeout and put have occured before arrive here
+          if (OSEventWaitListContains(pool, Task))
+          {
+            // Remove the task from the memory pool wait list
+            OSEventWaitListRemove(pool, Task);
+
+            // Decreases the memory pool wait list counter
+            pool->OSEventWait--;
+
+            pool->OSMemFails++;
+
+            // Exit Critical Section
+            OSExitCritical();
+
+            // Indicates timeout
+            return TIMEOUT;
+          }
+      }
+      else
+      {
+          // Remove the time to wait condition
+          Task->TimeToWait = NO_TIMEOUT;
+
+          // Remove from delay list
+          RemoveFromDelayList();
+      }
+  }
+
+  // The put reserved a block for this task
+  pool->OSMemReserved--;
+  *block = OSMemTake(pool);
+
+  // Exit Critical Section
+  OSExitCritical();
+
+  return OK;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Memory Put Function                         /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSMemPut(BRTOS_MemPool *pool, void *block)
+{
+  OS_SR_SAVE_VAR
+  INT8U iPriority = (INT8U)0;
+  INT8U TaskSelect = 0;
+
+  #if (ERROR_CHECK == 1)
+    // Verifies if the pointer is NULL
+    if(pool == NULL)
+    {
+      return(NULL_EVENT_POINTER);
+    }
+
+    // Verifies if the block was taken from this pool
+    if ((!OSMemOwns(pool, block)) ||
+        ((((INT8U*)block - pool->OSMemStart) % pool->OSMemBlockSize) != 0))
+    {
+      return(INVALID_PARAMETERS);
+    }
+  #endif
+
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+
+  #if (ERROR_CHECK == 1)
+    // A block returned twice
+    if (pool->OSMemFreeBlocks >= pool->OSMemBlocks)
+    {
+      // Exit Critical Section
+      #if (NESTING_INT == 0)
+      if (!iNesting)
+      #endif
+         OSExitCritical();
+      return(INVALID_PARAMETERS);
+    }
+  #endif
+
+  ((OS_MEM_BLOCK*)block)->OSMemNext = pool->OSMemFree;
+  pool->OSMemFree = (OS_MEM_BLOCK*)block;
+  pool->OSMemFreeBlocks++;
+
+  // See if any task is waiting for a block
+  if (pool->OSEventWait != 0)
+  {
+    // Selects the highest priority task and removes it from the memory pool wait list
+    TaskSelect = OSEventWaitListTake(pool, iPriority);
+
+    // Decreases the memory pool wait list counter
+    pool->OSEventWait--;
+
+    // Keeps the block for the selected task until it runs
+    pool->OSMemReserved++;
+
+    // Put the selected task into Ready List
+    #if (VERBOSE == 1)
+    ContextTask[TaskSelect].State = READY;
+    #endif
+
+    OSReadyListInsert(&ContextTask[TaskSelect]);
+
+    // If outside of an interrupt service routine, change context to the highest priority task
+    // If inside of an interrupt, the interrupt itself will change the context to the highest priority task
+    if (!iNesting)
+    {
+      // Verify if there is a higher priority task ready to run
+      ChangeContext();
+    }
+  }
+
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSExitCritical();
+
+  return OK;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Memory Pool Query Function                  /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSMemPoolQuery(BRTOS_MemPool *pool, OS_MEM_POOL_STATS *stats)
+{
+  OS_SR_SAVE_VAR
+
+  if(pool == NULL)
+  {
+    return(NULL_EVENT_POINTER);
+  }
+
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+
+  stats->BlockSize     = pool->OSMemBlockSize;
+  stats->Blocks        = pool->OSMemBlocks;
+  stats->FreeBlocks    = pool->OSMemFreeBlocks - pool->OSMemReserved;
+  stats->MinFreeBlocks = pool->OSMemMinFree;
+  stats->TasksWaiting  = pool->OSEventWait;
+  stats->Gets          = pool->OSMemGets;
+  stats->Fails         = pool->OSMemFails;
+
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSExitCritical();
+
+  return OK;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Memory Pool Heap Functions                  /////
+/////                                                  /////
+/////      BRTOS_ALLOC / BRTOS_DEALLOC backend         /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSMemHeapAdd(BRTOS_MemPool *pool)
+{
+  OS_SR_SAVE_VAR
+
+  if(pool == NULL)
+  {
+    return(NULL_EVENT_POINTER);
+  }
+
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+
+  pool->OSMemHeap = TRUE;
+
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSExitCritical();
+
+  return OK;
+}
+
+
+void *OSMemAlloc(INT32U size)
+{
+  OS_SR_SAVE_VAR
+  BRTOS_MemPool *pool;
+  BRTOS_MemPool *best = NULL;
+  void *block = NULL;
+  INT8U i;
+
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+
+  // Smallest blocks that fit, a bigger class is used when it is exhausted
+  for (i = 0; i < BRTOS_MAX_MEMPOOL; i++)
+  {
+    pool = &BRTOS_MemPool_Table[i];
+    if ((pool->OSEventAllocated == TRUE) && (pool->OSMemHeap == TRUE) &&
+        (pool->OSMemBlockSize >= size) && (pool->OSMemFreeBlocks > pool->OSMemReserved))
+    {
+      if ((best == NULL) || (pool->OSMemBlockSize < best->OSMemBlockSize))
+      {
+        best = pool;
+      }
+    }
+  }
+
+  if (best != NULL)
+  {
+    block = OSMemTake(best);
+  }
+
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSExitCritical();
+
+  return block;
+}
+
+
+void OSMemFree(void *block)
+{
+  INT8U i;
+
+  if (block == NULL)
+  {
+    return;
+  }
+
+  // The pools do not move, so their ranges can be searched outside of a critical section
+  for (i = 0; i < BRTOS_MAX_MEMPOOL; i++)
+  {
+    if ((BRTOS_MemPool_Table[i].OSEventAllocated == TRUE) && OSMemOwns(&BRTOS_MemPool_Table[i], block))
+    {
+      (void)OSMemPut(&BRTOS_MemPool_Table[i], block);
+      return;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#endif
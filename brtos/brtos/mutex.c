@@ -64,6 +64,13 @@
 
 
 #if (BRTOS_MUTEX_EN == 1)
+
+#if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+  #define OSMutexCeiling(mutex)   ((mutex)->OSMaxPriority != MUTEX_PRIORITY_INHERITANCE)
+#else
+  #define OSMutexCeiling(mutex)   TRUE
+#endif
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 /////      Create Mutex Function                       /////
@@ -85,16 +92,22 @@ INT8U OSMutexCreate (BRTOS_Mutex **event, INT8U HigherPriority)
   if (currentTask)
      OSEnterCritical();
   
-  if (PriorityVector[HigherPriority] != EMPTY_PRIO)
+  #if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+  // Priority inheritance mutexes do not reserve a ceiling priority
+  if (HigherPriority != MUTEX_PRIORITY_INHERITANCE)
+  #endif
   {
-      // Exit critical Section
-      if (currentTask)
-        OSExitCritical();
-      return BUSY_PRIORITY;                          // The priority is busy
+    if (PriorityVector[HigherPriority] != EMPTY_PRIO)
+    {
+        // Exit critical Section
+        if (currentTask)
+          OSExitCritical();
+        return BUSY_PRIORITY;                          // The priority is busy
+    }
+    
+    // Allocate priority to the mutex
+    PriorityVector[HigherPriority] = MUTEX_PRIO;
   }
-  
-  // Allocate priority to the mutex
-  PriorityVector[HigherPriority] = MUTEX_PRIO;
 
   // Verifica se ainda h blocos de controle de eventos disponveis
   for(i=0;i<=BRTOS_MAX_MUTEX;i++)
@@ -128,6 +141,12 @@ INT8U OSMutexCreate (BRTOS_Mutex **event, INT8U HigherPriority)
 
   
   pont_event->OSEventWaitList=0;
+  OS_EVENT_GROUP_INIT(pont_event);
+  
+  #if (BRTOS_MUTEX_STATS_EN == 1)
+  pont_event->OSContention  = 0;
+  pont_event->OSMaxHoldTime = 0;
+  #endif
   
   *event = pont_event;
   
@@ -166,6 +185,12 @@ INT8U OSMutexDelete (BRTOS_Mutex **event)
   OSEnterCritical();
   
   pont_event = *event;  
+  
+  #if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+  // Takes back the priorities lent by the tasks waiting for the mutex
+  OSMutexInheritList = OSMutexInheritList & ~(pont_event->OSEventWaitList);
+  #endif
+  
   pont_event->OSEventAllocated   = 0;
   pont_event->OSEventState       = 0;
   pont_event->OSEventOwner       = 0;                        
@@ -174,6 +199,7 @@ INT8U OSMutexDelete (BRTOS_Mutex **event)
   pont_event->OSEventWait        = 0;  
   
   pont_event->OSEventWaitList=0;
+  OS_EVENT_GROUP_UNLINK(pont_event);
   
   *event = NULL;
   
@@ -235,12 +261,8 @@ INT8U OSMutexAcquire(BRTOS_Mutex *pont_event, INT16U time_wait)
   
   // BRTOS TRACE SUPPORT
   #if (OSTRACE == 1)
-      #if(OS_TRACE_BY_TASK == 1)
-      Update_OSTrace(currentTask, MUTEXPEND);
-      #else
-      Update_OSTrace(ContextTask[currentTask].Priority, MUTEXPEND);
-      #endif 
-  #endif    
+  OSTraceWrite(OS_TRACE_MUTEX_PEND, OS_TRACE_ADDR(pont_event));
+  #endif
   
   
   // Verifies if the task is trying to acquire the mutex again
@@ -261,6 +283,10 @@ INT8U OSMutexAcquire(BRTOS_Mutex *pont_event, INT16U time_wait)
     
     // Current task becomes the temporary owner of the mutex
     pont_event->OSEventOwner = currentTask;
+    
+    #if (BRTOS_MUTEX_STATS_EN == 1)
+    pont_event->OSHoldStart = OS_TIMESTAMP();
+    #endif
         
     ///////////////////////////////////////////////////////////////////////////////
     // Performs the temporary exchange of mutex owner priority, if needed        //
@@ -269,18 +295,19 @@ INT8U OSMutexAcquire(BRTOS_Mutex *pont_event, INT16U time_wait)
     // Backup the original task priority
     pont_event->OSOriginalPriority = ContextTask[currentTask].Priority;
     
-    if (pont_event->OSMaxPriority > ContextTask[currentTask].Priority)
+    if (OSMutexCeiling(pont_event) && (pont_event->OSMaxPriority > ContextTask[currentTask].Priority))
     {
+      // Remove "original priority current task" from the Ready List
+      OSReadyListRemove(Task);
+      
       // Receives the priority ceiling temporarily
       Task->Priority = pont_event->OSMaxPriority;
       
       // Priority vector change       
       PriorityVector[pont_event->OSMaxPriority] = currentTask;
       
-      // Remove "original priority current task" from the Ready List
-      OSReadyList = OSReadyList & ~(PriorityMask[pont_event->OSOriginalPriority]);
       // Put the "max priority current task" into Ready List
-      OSReadyList = OSReadyList | (PriorityMask[pont_event->OSMaxPriority]);
+      OSReadyListInsert(Task);
     }
     
     OSExitCritical();
@@ -288,6 +315,10 @@ INT8U OSMutexAcquire(BRTOS_Mutex *pont_event, INT16U time_wait)
   }
   else
   {
+    #if (BRTOS_MUTEX_STATS_EN == 1)
+    pont_event->OSContention++;
+    #endif
+    
 	// If no timeout is used and the mutex is not available, exit the mutex with an error
 	if (time_wait == NO_TIMEOUT){
 		// Exit Critical Section
@@ -301,7 +332,7 @@ INT8U OSMutexAcquire(BRTOS_Mutex *pont_event, INT16U time_wait)
     pont_event->OSEventWait++;
     
     // Allocates the current task on the mutex wait list
-    pont_event->OSEventWaitList = pont_event->OSEventWaitList | (PriorityMask[iPriority]);
+    OSEventWaitListInsert(pont_event, Task);
       
     // Task entered suspended state, waiting for mutex release
     #if (VERBOSE == 1)
@@ -310,7 +341,7 @@ INT8U OSMutexAcquire(BRTOS_Mutex *pont_event, INT16U time_wait)
     #endif
 
     // Remove current task from the Ready List
-    OSReadyList = OSReadyList & ~(PriorityMask[iPriority]);
+    OSReadyListRemove(Task);
 
     // Set timeout overflow
     if (time_wait)
@@ -332,6 +363,17 @@ INT8U OSMutexAcquire(BRTOS_Mutex *pont_event, INT16U time_wait)
     {
       Task->TimeToWait = NO_TIMEOUT;
     }
+    
+    #if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+    // The mutex owner runs with the current task priority while the current task is blocked.
+    // The lent priority is not passed on if the owner is blocked on another mutex
+    if ((pont_event->OSMaxPriority == MUTEX_PRIORITY_INHERITANCE) &&
+        (iPriority > ContextTask[pont_event->OSEventOwner].Priority))
+    {
+      OSMutexInheritor[iPriority] = pont_event->OSEventOwner;
+      OSMutexInheritList = OSMutexInheritList | (PriorityMask[iPriority]);
+    }
+    #endif
             
     // Change Context - Returns on mutex release
     ChangeContext();
@@ -346,10 +388,10 @@ INT8U OSMutexAcquire(BRTOS_Mutex *pont_event, INT16U time_wait)
         if(Task->TimeToWait == EXIT_BY_TIMEOUT)
         {
             // Test if both timeout and post have occured before arrive here
-            if ((pont_event->OSEventWaitList & PriorityMask[iPriority]))
+            if (OSEventWaitListContains(pont_event, Task))
             {
               // Remove the task from the queue wait list
-              pont_event->OSEventWaitList = pont_event->OSEventWaitList & ~(PriorityMask[iPriority]);
+              OSEventWaitListRemove(pont_event, Task);
 
               // Decreases the queue wait list counter
               pont_event->OSEventWait--;
@@ -375,18 +417,19 @@ INT8U OSMutexAcquire(BRTOS_Mutex *pont_event, INT16U time_wait)
     // Backup the original task priority
     pont_event->OSOriginalPriority = iPriority;
     
-    if (pont_event->OSMaxPriority > iPriority)
+    if (OSMutexCeiling(pont_event) && (pont_event->OSMaxPriority > iPriority))
     {
+      // Remove "original priority current task" from the Ready List
+      OSReadyListRemove(Task);
+      
       // Receives the priority ceiling temporarily
       Task->Priority = pont_event->OSMaxPriority;
       
       // Priority vector change
       PriorityVector[pont_event->OSMaxPriority] = currentTask;
       
-      // Remove "original priority current task" from the Ready List
-      OSReadyList = OSReadyList & ~(PriorityMask[iPriority]);
       // Put the "max priority current task" into Ready List
-      OSReadyList = OSReadyList | (PriorityMask[pont_event->OSMaxPriority]);
+      OSReadyListInsert(Task);
     }
     
     OSExitCritical();
@@ -413,8 +456,11 @@ INT8U OSMutexRelease(BRTOS_Mutex *pont_event)
 {
   OS_SR_SAVE_VAR
   INT8U iPriority = (INT8U)0;
-  #if (VERBOSE == 1)
+  INT8U iRestored = FALSE;
   INT8U TaskSelect = 0;
+  #if (BRTOS_MUTEX_STATS_EN == 1)
+  OS_TIMESTAMP_TYPE iNow;
+  INT32U iHoldTime;
   #endif
   
   #if (ERROR_CHECK == 1)      
@@ -445,17 +491,9 @@ INT8U OSMutexRelease(BRTOS_Mutex *pont_event)
   #endif
      
   // BRTOS TRACE SUPPORT
-  #if (OSTRACE == 1)  
-    if(!iNesting){  
-      #if(OS_TRACE_BY_TASK == 1)
-      Update_OSTrace(currentTask, MUTEXPOST);
-      #else
-      Update_OSTrace(ContextTask[currentTask].Priority, MUTEXPOST);
-      #endif 
-    }else{
-      Update_OSTrace(0, MUTEXPOST);
-    }
-  #endif     
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_MUTEX_POST, OS_TRACE_ADDR(pont_event));
+  #endif
 
   // Verify Mutex Owner
   if (pont_event->OSEventOwner != currentTask)
@@ -468,44 +506,63 @@ INT8U OSMutexRelease(BRTOS_Mutex *pont_event)
   // Returns to the original priority, if needed
   // Copy backuped original priority to the task context
   iPriority = ContextTask[currentTask].Priority;
-  if (iPriority != pont_event->OSOriginalPriority)
+  if (OSMutexCeiling(pont_event) && (iPriority != pont_event->OSOriginalPriority))
   {              
     // Since current task is executing with another priority, reallocate its priority to the original
     // into the Ready List
     // Remove "max priority current task" from the Ready List
-    OSReadyList = OSReadyList & ~(PriorityMask[iPriority]);
-    // Put the "original priority current task" into Ready List
-    OSReadyList = OSReadyList | (PriorityMask[pont_event->OSOriginalPriority]);
+    OSReadyListRemove(&ContextTask[currentTask]);
     
     ContextTask[currentTask].Priority = pont_event->OSOriginalPriority;
+    
+    // Put the "original priority current task" into Ready List
+    OSReadyListInsert(&ContextTask[currentTask]);
+    iRestored = TRUE;
   }
 
   // Release mutex ownership
   pont_event->OSEventOwner = 0;
   
+  #if (BRTOS_MUTEX_STATS_EN == 1)
+  iNow = OS_TIMESTAMP();
+  iHoldTime = OS_TIMESTAMP_SPAN(iNow - pont_event->OSHoldStart);
+  if (iHoldTime > pont_event->OSMaxHoldTime)
+  {
+    pont_event->OSMaxHoldTime = iHoldTime;
+  }
+  #endif
+  
+  #if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+  // Takes back the priorities lent by the tasks waiting for the mutex.
+  // The mutex goes to the highest of them, so the new owner does not
+  // need the priorities of the others
+  OSMutexInheritList = OSMutexInheritList & ~(pont_event->OSEventWaitList);
+  #endif
+  
   // See if any task is waiting for mutex release
   if (pont_event->OSEventWait != 0)
   {
-    // Selects the highest priority task
-    iPriority = SAScheduler(pont_event->OSEventWaitList);
-
-    // Remove the selected task from the mutex wait list
-    pont_event->OSEventWaitList = pont_event->OSEventWaitList & ~(PriorityMask[iPriority]);
+    // Selects the highest priority task and removes it from the mutex wait list
+    TaskSelect = OSEventWaitListTake(pont_event, iPriority);
     
     // Decreases the mutex wait list counter
     pont_event->OSEventWait--;
     
     // Changes the task that owns the mutex
-    pont_event->OSEventOwner = PriorityVector[iPriority];    
+    pont_event->OSEventOwner = TaskSelect;    
+    
+    #if (BRTOS_MUTEX_STATS_EN == 1)
+    // The new owner holds the mutex from now on
+    pont_event->OSHoldStart = iNow;
+    #endif
          
     // Indicates that selected task is ready to run
     #if (VERBOSE == 1)
-    TaskSelect = PriorityVector[iPriority];
     ContextTask[TaskSelect].State = READY;    
     #endif    
     
     // Put the selected task into Ready List
-    OSReadyList = OSReadyList | (PriorityMask[iPriority]);
+    OSReadyListInsert(&ContextTask[TaskSelect]);
         
     // Verify if there is a higher priority task ready to run
     ChangeContext();
@@ -518,7 +575,19 @@ INT8U OSMutexRelease(BRTOS_Mutex *pont_event)
       
   // Release Mutex
   pont_event->OSEventState = AVAILABLE_RESOURCE;
-  PriorityVector[pont_event->OSMaxPriority] = MUTEX_PRIO;
+  if (OSMutexCeiling(pont_event))
+  {
+    PriorityVector[pont_event->OSMaxPriority] = MUTEX_PRIO;
+  }
+  
+  // Signal a task waiting for multiple events
+  OS_EVENT_GROUP_SIGNAL(pont_event);
+  
+  // Tasks made ready while the owner ran at the ceiling priority may now preempt it
+  if (iRestored == TRUE)
+  {
+    ChangeContext();
+  }
       
   // Exit Critical Section
   OSExitCritical();      
@@ -530,4 +599,91 @@ INT8U OSMutexRelease(BRTOS_Mutex *pont_event)
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
+
+
+
+
+
+#if (BRTOS_MUTEX_STATS_EN == 1)
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Mutex Query Function                        /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSMutexQuery(BRTOS_Mutex *pont_event, OS_MUTEX_STATS *stats)
+{
+  OS_SR_SAVE_VAR
+
+  if (pont_event == NULL)
+  {
+    return(NULL_EVENT_POINTER);
+  }
+
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+
+  stats->Owner        = pont_event->OSEventOwner;
+  stats->TasksWaiting = pont_event->OSEventWait;
+  stats->Contention   = pont_event->OSContention;
+  stats->MaxHoldTime  = pont_event->OSMaxHoldTime;
+
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSExitCritical();
+
+  return OK;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+#endif
+
+
+
+
+
+#if (BRTOS_MUTEX_INHERITANCE_EN == 1)
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Mutex Priority Inheritance Function         /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSMutexInheritPriority(INT8U priority)
+{
+  INT8U iPriority;
+  PriorityType lent;
+
+  // Lent priorities higher than the ready one
+  lent = OSMutexInheritList & OSBlockedList & ~((PriorityType)(PriorityMask[priority] << 1) - 1);
+
+  while (lent)
+  {
+    iPriority = SAScheduler(lent);
+
+    // A lent priority is ready while the task that holds it is ready
+    if (OSReadyList & OSBlockedList & PriorityMask[ContextTask[OSMutexInheritor[iPriority]].Priority])
+    {
+      return iPriority;
+    }
+
+    lent = lent & ~(PriorityMask[iPriority]);
+  }
+
+  return priority;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+#endif
 #endif
@@ -83,109 +83,154 @@
 #endif
 
 
-#if (BRTOS_QUEUE_EN == 1)
+#if ((BRTOS_QUEUE_EN == 1) || (BRTOS_QUEUE_16_EN == 1) || (BRTOS_QUEUE_32_EN == 1) || (BRTOS_DYNAMIC_QUEUE_ENABLED == 1))
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
-/////      Create Queue Function                       /////
+/////      Generic Queue Internal Functions            /////
+/////                                                  /////
+/////      Used by the 8, 16, 32 bits and the          /////
+/////      dynamic queues                              /////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
-INT8U OSQueueCreate(INT16U size, BRTOS_Queue **event)
+// Sets up an empty queue of length entries of type_size bytes in the buffer start.
+static void OSQueueSetup(OS_QUEUE *cqueue, INT8U *start, INT16U length, INT16U type_size)
 {
-  OS_SR_SAVE_VAR
-  INT16S i=0;
-  BRTOS_Queue *pont_event;
-  OS_QUEUE *cqueue; 
+  cqueue->OSQStart    = start;
+  cqueue->OSQTSize    = type_size;
+  cqueue->OSQSize     = length;
+  cqueue->OSQEntries  = 0;
+  cqueue->OSQEnd      = start + ((INT32U)length * type_size);
+  cqueue->OSQIn       = start;
+  cqueue->OSQOut      = start;
+}
 
-  if (iNesting > 0) {                                // See if caller is an interrupt
-     return(IRQ_PEND_ERR);                           // Can't be create by interrupt
-  }
-    
-  // Enter critical Section
-  if (currentTask)
-     OSEnterCritical();
-  
-  // Fix the queue size to the OS_CPU_TYPE
-  if (size % sizeof(OS_CPU_TYPE))
+
+// Copies size bytes, without any alignment requirement.
+static void OSQueueCopyBytes(INT8U *dst, const INT8U *src, INT16U size)
+{
+  while(size)
   {
-    size = (INT16U)(size + (sizeof(OS_CPU_TYPE) - (size % sizeof(OS_CPU_TYPE))));
+    *dst++ = *src++;
+    size--;
   }
+}
+
+
+// Returns the slot of the next entry to be written, and counts the entry.
+// The caller verifies the free space and copies the entry.
+// Must be called inside a critical section.
+static INT8U *OSQueueIn(OS_QUEUE *cqueue)
+{
+  INT8U *slot;
   
-  if ((iQueueAddress + (size / sizeof(OS_CPU_TYPE))) > (QUEUE_HEAP_SIZE / sizeof(OS_CPU_TYPE)))
-  {
-      // Exit critical Section
-      if (currentTask)
-         OSExitCritical();
-      
-       return NO_MEMORY;
-  }  
+  // Verify for input pointer overflow
+  if (cqueue->OSQIn == cqueue->OSQEnd)
+    cqueue->OSQIn = cqueue->OSQStart;
   
-  // Verifica se ainda h blocos de controle de eventos disponveis
-  for(i=0;i<=BRTOS_MAX_QUEUE;i++)
-  {
-    
-    if(i >= BRTOS_MAX_QUEUE)
-    {
-      // Caso no haja mais blocos disponveis, retorna exceo
-      
-      // Exit critical Section
-      if (currentTask)
-         OSExitCritical();
-      
-      return(NO_AVAILABLE_EVENT);
-    }
-          
-    
-    if(BRTOS_Queue_Table[i].OSEventAllocated != TRUE)
-    {
-      BRTOS_Queue_Table[i].OSEventAllocated = TRUE;
-      pont_event = &BRTOS_Queue_Table[i];
-      cqueue = &BRTOS_OS_QUEUE_Table[i];
-      break;      
-    }
-  } 
+  slot = cqueue->OSQIn;
+  cqueue->OSQIn += cqueue->OSQTSize;
+  cqueue->OSQEntries++;
   
-  // Configura dados de evento de lista
-  cqueue->OSQStart    = (INT8U *)&QUEUE_STACK[iQueueAddress];
-  iQueueAddress       = (INT16U)(iQueueAddress + (size / sizeof(OS_CPU_TYPE)));
-  cqueue->OSQSize     = size;
-  cqueue->OSQEntries  = 0;
-  cqueue->OSQEnd      = cqueue->OSQStart + cqueue->OSQSize;
-  cqueue->OSQIn       = cqueue->OSQStart;
-  cqueue->OSQOut      = cqueue->OSQStart;
+  return slot;
+}
+
+
+// Returns the slot of the next entry to be read, and releases the entry.
+// The caller verifies the entries and copies the entry.
+// Must be called inside a critical section.
+static INT8U *OSQueueOut(OS_QUEUE *cqueue)
+{
+  INT8U *slot;
   
-  // Aloca tipo de evento e dados do evento
-  pont_event->OSEventPointer = cqueue;
-  pont_event->OSEventWait = 0;
+  // Verify for output pointer overflow
+  if (cqueue->OSQOut == cqueue->OSQEnd)
+    cqueue->OSQOut = cqueue->OSQStart;
   
+  slot = cqueue->OSQOut;
+  cqueue->OSQOut += cqueue->OSQTSize;
+  cqueue->OSQEntries--;
   
-  pont_event->OSEventWaitList=0;
+  return slot;
+}
+
+
+static INT8U OSQueueReset(OS_QUEUE *cqueue)
+{
+  OS_SR_SAVE_VAR
   
-  *event = pont_event;
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
   
-  // Exit critical Section
-  if (currentTask)
-     OSExitCritical();  
+  cqueue->OSQEntries = 0;
   
-  return(ALLOC_EVENT_OK);
-}
+  cqueue->OSQIn = cqueue->OSQStart;
+  cqueue->OSQOut = cqueue->OSQStart;
+  
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+    OSExitCritical();  
 
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
+  return CLEAN_BUFFER_OK;
+}
 
+#if ((BRTOS_QUEUE_EN == 1) || (BRTOS_QUEUE_16_EN == 1) || (BRTOS_QUEUE_32_EN == 1))
 
+// Allocates size entries of type_size bytes from the queue heap.
+// Must be called inside a critical section.
+static INT8U OSQueueInit(OS_QUEUE *cqueue, INT16U size, INT16U type_size)
+{
+  INT16U size_in_bytes = (INT16U)(size * type_size);
+  
+  // Fix the queue size to the OS_CPU_TYPE
+  if (size_in_bytes % sizeof(OS_CPU_TYPE))
+  {
+    size_in_bytes = (INT16U)(size_in_bytes + (sizeof(OS_CPU_TYPE) - (size_in_bytes % sizeof(OS_CPU_TYPE))));
+  }
+  
+  if ((iQueueAddress + (size_in_bytes / sizeof(OS_CPU_TYPE))) > (QUEUE_HEAP_SIZE / sizeof(OS_CPU_TYPE)))
+  {
+    return NO_MEMORY;
+  }
+  
+  // Configura dados de evento de lista
+  OSQueueSetup(cqueue, (INT8U *)&QUEUE_STACK[iQueueAddress], (INT16U)(size_in_bytes / type_size), type_size);
+  iQueueAddress = (INT16U)(iQueueAddress + (size_in_bytes / sizeof(OS_CPU_TYPE)));
+  
+  return(ALLOC_EVENT_OK);
+}
 
 
+// Copies one entry of the 8, 16 and 32 bits queues. size is the size of the
+// caller's data, which has the type of the queue entries, so the 16 and 32 bits
+// entries are copied with a single access and never past the caller's data.
+// The queue buffer is aligned to OS_CPU_TYPE.
+static void OSQueueCopy(void *dst, const void *src, INT16U size)
+{
+  switch(size)
+  {
+    case 1:
+      *(INT8U*)dst = *(const INT8U*)src;
+      break;
+    case 2:
+      *(INT16U*)dst = *(const INT16U*)src;
+      break;
+    case 4:
+      *(INT32U*)dst = *(const INT32U*)src;
+      break;
+    default:
+      OSQueueCopyBytes((INT8U*)dst, (const INT8U*)src, size);
+      break;
+  }
+}
 
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-/////      Write Queue Function                        /////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
 
-INT8U OSWQueue(OS_QUEUE *cqueue,INT8U data)
+static INT8U OSQueueWrite(OS_QUEUE *cqueue, const void *pdata, INT16U size)
 {  
   OS_SR_SAVE_VAR
   
@@ -195,11 +240,7 @@ INT8U OSWQueue(OS_QUEUE *cqueue,INT8U data)
   #endif
      OSEnterCritical();
   
-  if (cqueue->OSQEntries < cqueue->OSQSize)
-  {  
-    cqueue->OSQEntries++;
-  }
-  else
+  if (cqueue->OSQEntries >= cqueue->OSQSize)
   { 
      // Exit Critical Section
      #if (NESTING_INT == 0)
@@ -210,11 +251,7 @@ INT8U OSWQueue(OS_QUEUE *cqueue,INT8U data)
      return BUFFER_UNDERRUN;
   }
   
-  if (cqueue->OSQIn == cqueue->OSQEnd)
-    cqueue->OSQIn = cqueue->OSQStart;
-  
-  *cqueue->OSQIn = data;
-  cqueue->OSQIn++; 
+  OSQueueCopy(OSQueueIn(cqueue), pdata, size);
  
    // Exit Critical Section
   #if (NESTING_INT == 0)
@@ -223,25 +260,10 @@ INT8U OSWQueue(OS_QUEUE *cqueue,INT8U data)
       OSExitCritical();
   
   return WRITE_BUFFER_OK;
-  
 }
 
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-
-
-
-
 
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-/////      Read Queue Function                         /////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-
-INT8U OSRQueue(OS_QUEUE *cqueue, INT8U* pdata)
+static INT8U OSQueueRead(OS_QUEUE *cqueue, void *pdata, INT16U size)
 {
   OS_SR_SAVE_VAR
   
@@ -253,14 +275,7 @@ INT8U OSRQueue(OS_QUEUE *cqueue, INT8U* pdata)
   
   if(cqueue->OSQEntries > 0)
   {
-      
-    if (cqueue->OSQOut == cqueue->OSQEnd)
-      cqueue->OSQOut = cqueue->OSQStart;
-  
-    *pdata = *(cqueue->OSQOut);
-  
-    cqueue->OSQOut++;
-    cqueue->OSQEntries--;
+    OSQueueCopy(pdata, OSQueueOut(cqueue), size);
     
     // Exit Critical Section
     #if (NESTING_INT == 0)
@@ -282,44 +297,111 @@ INT8U OSRQueue(OS_QUEUE *cqueue, INT8U* pdata)
   }
 }
 
+#endif
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
+#endif
 
 
 
-
+#if (BRTOS_QUEUE_EN == 1)
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
-/////      Clean Queue Function                        /////
+/////      Create Queue Function                       /////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
-INT8U OSQueueClean(BRTOS_Queue *pont_event)
+INT8U OSQueueCreate(INT16U size, BRTOS_Queue **event)
 {
   OS_SR_SAVE_VAR
-  OS_QUEUE *cqueue = pont_event->OSEventPointer;
-  
-  // Enter Critical Section
-  #if (NESTING_INT == 0)
-  if (!iNesting)
-  #endif
+  INT16S i=0;
+  BRTOS_Queue *pont_event;
+  OS_QUEUE *cqueue; 
+
+  if (iNesting > 0) {                                // See if caller is an interrupt
+     return(IRQ_PEND_ERR);                           // Can't be create by interrupt
+  }
+    
+  // Enter critical Section
+  if (currentTask)
      OSEnterCritical();
   
-  cqueue->OSQEntries = 0;
+  // Verifica se ainda h blocos de controle de eventos disponveis
+  for(i=0;i<=BRTOS_MAX_QUEUE;i++)
+  {
+    
+    if(i >= BRTOS_MAX_QUEUE)
+    {
+      // Caso no haja mais blocos disponveis, retorna exceo
+      
+      // Exit critical Section
+      if (currentTask)
+         OSExitCritical();
+      
+      return(NO_AVAILABLE_EVENT);
+    }
+          
+    
+    if(BRTOS_Queue_Table[i].OSEventAllocated != TRUE)
+    {
+      BRTOS_Queue_Table[i].OSEventAllocated = TRUE;
+      pont_event = &BRTOS_Queue_Table[i];
+      cqueue = &BRTOS_OS_QUEUE_Table[i];
+      break;      
+    }
+  } 
   
-  cqueue->OSQIn = cqueue->OSQStart;
-  cqueue->OSQOut = cqueue->OSQStart;
+  // Allocates the queue data in the queue heap
+  if (OSQueueInit(cqueue, size, sizeof(INT8U)) != ALLOC_EVENT_OK)
+  {
+    pont_event->OSEventAllocated = FALSE;
+    
+    // Exit critical Section
+    if (currentTask)
+       OSExitCritical();
+    
+    return NO_MEMORY;
+  }
   
-  // Exit Critical Section
-  #if (NESTING_INT == 0)
-  if (!iNesting)
-  #endif
-    OSExitCritical();  
+  // Aloca tipo de evento e dados do evento
+  pont_event->OSEventPointer = cqueue;
+  pont_event->OSEventWait = 0;
+  
+  
+  pont_event->OSEventWaitList=0;
+  OS_EVENT_GROUP_INIT(pont_event);
+  
+  *event = pont_event;
+  
+  // Exit critical Section
+  if (currentTask)
+     OSExitCritical();  
+  
+  return(ALLOC_EVENT_OK);
+}
 
-  return CLEAN_BUFFER_OK;
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Write Queue Function                        /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSWQueue(OS_QUEUE *cqueue,INT8U data)
+{  
+  return OSQueueWrite(cqueue, &data, sizeof(data));
 }
 
 ////////////////////////////////////////////////////////////
@@ -333,22 +415,61 @@ INT8U OSQueueClean(BRTOS_Queue *pont_event)
 
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
-/////      Queue Pend Function                         /////
+/////      Read Queue Function                         /////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
-INT8U OSQueuePend (BRTOS_Queue *pont_event, INT8U* pdata, INT16U time_wait)
+INT8U OSRQueue(OS_QUEUE *cqueue, INT8U* pdata)
 {
-  OS_SR_SAVE_VAR
-  INT8U iPriority = 0;
-  INT32U timeout;
-  ContextType *Task;
-  OS_QUEUE *cqueue = pont_event->OSEventPointer;
-   
-  #if (ERROR_CHECK == 1)
-    /// Can not use Queue pend function from interrupt handling code
-    if(iNesting > 0)
-    {
+  return OSQueueRead(cqueue, pdata, sizeof(*pdata));
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Clean Queue Function                        /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSQueueClean(BRTOS_Queue *pont_event)
+{
+  return OSQueueReset((OS_QUEUE*)pont_event->OSEventPointer);
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Queue Pend Function                         /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSQueuePend (BRTOS_Queue *pont_event, INT8U* pdata, INT16U time_wait)
+{
+  OS_SR_SAVE_VAR
+  INT32U timeout;
+  ContextType *Task;
+  OS_QUEUE *cqueue;
+   
+  #if (ERROR_CHECK == 1)
+    /// Can not use Queue pend function from interrupt handling code
+    if(iNesting > 0)
+    {
       return(IRQ_PEND_ERR);
     }
     
@@ -372,30 +493,21 @@ INT8U OSQueuePend (BRTOS_Queue *pont_event, INT8U* pdata, INT16U time_wait)
     }
   #endif
   
+  cqueue = pont_event->OSEventPointer;
+  
   // BRTOS TRACE SUPPORT
-  #if (OSTRACE == 1) 
-      #if(OS_TRACE_BY_TASK == 1)
-      Update_OSTrace(currentTask, QUEUEPEND);
-      #else
-      Update_OSTrace(ContextTask[currentTask].Priority, QUEUEPEND);
-      #endif
-  #endif   
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_QUEUE_PEND, OS_TRACE_ADDR(pont_event));
+  #endif
     
   // Verify if there is data in the queue
   if(cqueue->OSQEntries > 0)
   {
-    // Verify for output pointer overflow
-    if (cqueue->OSQOut == cqueue->OSQEnd)
-      cqueue->OSQOut = cqueue->OSQStart;
-  
     // Copy data from queue
-    *pdata = *cqueue->OSQOut;
-  
-    // Increases output pointer
-    cqueue->OSQOut++;
+    OSQueueCopy(pdata, OSQueueOut(cqueue), sizeof(*pdata));
     
-    // Decreases queue entries
-    cqueue->OSQEntries--;
+    // Keeps the event group flag set while data is left
+    OS_EVENT_GROUP_REARM(pont_event, cqueue->OSQEntries > 0);
     
     // Exit Critical Section
     OSExitCritical();
@@ -412,14 +524,11 @@ INT8U OSQueuePend (BRTOS_Queue *pont_event, INT8U* pdata, INT16U time_wait)
   	
     Task = (ContextType*)&ContextTask[currentTask];
     
-    // Copy task priority to local scope
-    iPriority = Task->Priority;
-  
     // Increases the queue wait list counter
     pont_event->OSEventWait++;
     
     // Allocates the current task on the queue wait list
-    pont_event->OSEventWaitList = pont_event->OSEventWaitList | (PriorityMask[iPriority]);
+    OSEventWaitListInsert(pont_event, Task);
   
     // Task entered suspended state, waiting for queue post
     #if (VERBOSE == 1)
@@ -428,7 +537,7 @@ INT8U OSQueuePend (BRTOS_Queue *pont_event, INT8U* pdata, INT16U time_wait)
     #endif
 
     // Remove current task from the Ready List
-    OSReadyList = OSReadyList & ~(PriorityMask[iPriority]);
+    OSReadyListRemove(Task);
   
     // Set timeout overflow
     if (time_wait)
@@ -465,10 +574,10 @@ INT8U OSQueuePend (BRTOS_Queue *pont_event, INT8U* pdata, INT16U time_wait)
         if(Task->TimeToWait == EXIT_BY_TIMEOUT)
         {
             // Test if both timeout and post have occured before arrive here
-            if ((pont_event->OSEventWaitList & PriorityMask[iPriority]))
+            if (OSEventWaitListContains(pont_event, Task))
             {
               // Remove the task from the queue wait list
-              pont_event->OSEventWaitList = pont_event->OSEventWaitList & ~(PriorityMask[iPriority]);
+              OSEventWaitListRemove(pont_event, Task);
               
               // Decreases the queue wait list counter
               pont_event->OSEventWait--;
@@ -491,18 +600,19 @@ INT8U OSQueuePend (BRTOS_Queue *pont_event, INT8U* pdata, INT16U time_wait)
        
     }
     
-    // Verify for output pointer overflow
-    if (cqueue->OSQOut == cqueue->OSQEnd)
-      cqueue->OSQOut = cqueue->OSQStart;
-  
+    // The data may have been taken by a higher priority task
+    if (cqueue->OSQEntries == 0)
+    {
+      // Exit Critical Section
+      OSExitCritical();
+      return NO_ENTRY_AVAILABLE;
+    }
+    
     // Copy data from queue
-    *pdata = *cqueue->OSQOut;
-  
-    // Increases the output pointer
-    cqueue->OSQOut++;
+    OSQueueCopy(pdata, OSQueueOut(cqueue), sizeof(*pdata));
     
-    // Decreases queue entries
-    cqueue->OSQEntries--;
+    // Keeps the event group flag set while data is left
+    OS_EVENT_GROUP_REARM(pont_event, cqueue->OSQEntries > 0);
     
     // Exit Critical Section
     OSExitCritical();
@@ -529,10 +639,8 @@ INT8U OSQueuePost(BRTOS_Queue *pont_event, INT8U data)
 {
   OS_SR_SAVE_VAR
   INT8U iPriority = (INT8U)0;
-  #if (VERBOSE == 1)
   INT8U TaskSelect = 0;
-  #endif
-  OS_QUEUE *cqueue = pont_event->OSEventPointer;
+  OS_QUEUE *cqueue;
   
   #if (ERROR_CHECK == 1)    
     // Verifies if the pointer is NULL
@@ -561,26 +669,15 @@ INT8U OSQueuePost(BRTOS_Queue *pont_event, INT8U data)
     }
   #endif
      
+  cqueue = pont_event->OSEventPointer;
+  
   // BRTOS TRACE SUPPORT
-  #if (OSTRACE == 1)  
-    if(!iNesting){ 
-      #if(OS_TRACE_BY_TASK == 1)
-      Update_OSTrace(currentTask, QUEUEPOST);
-      #else
-      Update_OSTrace(ContextTask[currentTask].Priority, QUEUEPOST);
-      #endif
-    }else{
-      Update_OSTrace(0, QUEUEPOST);
-    }
-  #endif       
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_QUEUE_POST, OS_TRACE_ADDR(pont_event));
+  #endif
   
   // Checks for queue overflow
-  if (cqueue->OSQEntries < cqueue->OSQSize)
-  {  
-    // If no, increases the queue entries
-    cqueue->OSQEntries++;
-  }
-  else
+  if (cqueue->OSQEntries >= cqueue->OSQSize)
   { 
      // Exit Critical Section
      #if (NESTING_INT == 0)
@@ -592,35 +689,24 @@ INT8U OSQueuePost(BRTOS_Queue *pont_event, INT8U data)
      return BUFFER_UNDERRUN;
   }
   
-  // Verify for input pointer overflow
-  if (cqueue->OSQIn == cqueue->OSQEnd)
-    cqueue->OSQIn = cqueue->OSQStart;
-  
   // copy data into the queue
-  *cqueue->OSQIn = data;
-  
-  // increases the input pointer
-  cqueue->OSQIn++;
+  OSQueueCopy(OSQueueIn(cqueue), &data, sizeof(data));
   
   // See if any task is waiting for new data in the queue
   if (pont_event->OSEventWait != 0)
   {
-    // Selects the highest priority task
-    iPriority = SAScheduler(pont_event->OSEventWaitList);    
-
-    // Remove the selected task from the queue wait list
-    pont_event->OSEventWaitList = pont_event->OSEventWaitList & ~(PriorityMask[iPriority]);
+    // Selects the highest priority task and removes it from the queue wait list
+    TaskSelect = OSEventWaitListTake(pont_event, iPriority);
     
     // Decreases the queue wait list counter
     pont_event->OSEventWait--;
     
     // Put the selected task into Ready List
     #if (VERBOSE == 1)
-    TaskSelect = PriorityVector[iPriority];
     ContextTask[TaskSelect].State = READY;
     #endif
     
-    OSReadyList = OSReadyList | (PriorityMask[iPriority]);
+    OSReadyListInsert(&ContextTask[TaskSelect]);
     
     // If outside of an interrupt service routine, change context to the highest priority task
     // If inside of an interrupt, the interrupt itself will change the context to the highest priority task
@@ -640,6 +726,9 @@ INT8U OSQueuePost(BRTOS_Queue *pont_event, INT8U data)
   }
   else
   {
+    // Signal a task waiting for multiple events
+    OS_EVENT_GROUP_SIGNAL(pont_event);
+    
     // Exit Critical Section
     #if (NESTING_INT == 0)
     if (!iNesting)
@@ -655,58 +744,125 @@ INT8U OSQueuePost(BRTOS_Queue *pont_event, INT8U data)
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
-#endif
 
 
 
-#if (BRTOS_QUEUE_16_EN == 1)
+
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
-/////      Create Queue Function                       /////
+/////      Queue Bulk Transfer Internal Functions      /////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
-INT8U OSQueue16Create(OS_QUEUE_16 *cqueue, INT16U size)
+// Wakes up to count tasks waiting for the queue.
+// Must be called inside a critical section.
+static void OSQueueWakeUp(BRTOS_Queue *pont_event, INT16U count)
 {
-  OS_SR_SAVE_VAR
-
-  if (iNesting > 0) {                                // See if caller is an interrupt
-     return(IRQ_PEND_ERR);                           // Can't be create by interrupt
-  }
-    
-  // Enter critical Section
-  if (currentTask)
-     OSEnterCritical();
+  INT8U iPriority = (INT8U)0;
+  INT8U TaskSelect = 0;
   
-  // Fix the queue size to the OS_CPU_TYPE
-  if ((size*sizeof(INT16U)) % sizeof(OS_CPU_TYPE))
+  while((pont_event->OSEventWait != 0) && (count > 0))
   {
-    size = (INT16U)(size + 1);
+    // Selects the highest priority task and removes it from the queue wait list
+    TaskSelect = OSEventWaitListTake(pont_event, iPriority);
+    
+    // Decreases the queue wait list counter
+    pont_event->OSEventWait--;
+    
+    // Put the selected task into Ready List
+    #if (VERBOSE == 1)
+    ContextTask[TaskSelect].State = READY;
+    #endif
+    
+    OSReadyListInsert(&ContextTask[TaskSelect]);
+    
+    count--;
   }
+}
+
+
+// Blocks the current task until a queue post or timeout.
+// Must be called inside a critical section.
+static INT8U OSQueueWaitPost(BRTOS_Queue *pont_event, INT16U time_wait)
+{
+  OS_SR_SAVE_VAR
+  INT32U timeout;
+  ContextType *Task = (ContextType*)&ContextTask[currentTask];
+  
+  // Increases the queue wait list counter
+  pont_event->OSEventWait++;
+  
+  // Allocates the current task on the queue wait list
+  OSEventWaitListInsert(pont_event, Task);
+
+  // Task entered suspended state, waiting for queue post
+  #if (VERBOSE == 1)
+  Task->State = SUSPENDED;
+  Task->SuspendedType = QUEUE;
+  #endif
+
+  // Remove current task from the Ready List
+  OSReadyListRemove(Task);
+
+  // Set timeout overflow
+  if (time_wait)
+  {  
+    timeout = (INT32U)((INT32U)OSGetCount() + (INT32U)time_wait);
+    
+    if (timeout >= TICK_COUNT_OVERFLOW)
+    {
+      Task->TimeToWait = (INT16U)(timeout - TICK_COUNT_OVERFLOW);
+    }
+    else
+    {
+      Task->TimeToWait = (INT16U)timeout;
+    }
   
-  if ((iQueueAddress + ((size*sizeof(INT16U)) / sizeof(OS_CPU_TYPE))) > (QUEUE_HEAP_SIZE / sizeof(OS_CPU_TYPE)))
+    // Put task into delay list
+    IncludeTaskIntoDelayList();
+  } else
   {
-      // Exit critical Section
-      if (currentTask)
-         OSExitCritical();
-      
-       return NO_MEMORY;
+    Task->TimeToWait = NO_TIMEOUT;
   }
+
+  // Change Context - Returns on time overflow or queue post
+  ChangeContext();
   
-  // Configura dados de evento de lista
-  cqueue->OSQStart    = (INT16U *)&QUEUE_STACK[iQueueAddress];
-  iQueueAddress       = (INT16U)(iQueueAddress + ((size*sizeof(INT16U)) / sizeof(OS_CPU_TYPE)));
-  cqueue->OSQSize     = size;
-  cqueue->OSQEntries  = 0;
-  cqueue->OSQEnd      = cqueue->OSQStart + cqueue->OSQSize;
-  cqueue->OSQIn       = cqueue->OSQStart;
-  cqueue->OSQOut      = cqueue->OSQStart;
+  // Exit Critical Section
+  OSExitCritical();
+  // Enter Critical Section
+  OSEnterCritical();
   
-  // Exit critical Section
-  if (currentTask)
-     OSExitCritical();  
+  if (time_wait)
+  {    
+      // Verify if the reason of task wake up was queue timeout
+      if(Task->TimeToWait == EXIT_BY_TIMEOUT)
+      {
+          // Test if both timeout and post have occured before arrive here
+          if (OSEventWaitListContains(pont_event, Task))
+          {
+            // Remove the task from the queue wait list
+            OSEventWaitListRemove(pont_event, Task);
+            
+            // Decreases the queue wait list counter
+            pont_event->OSEventWait--;
+            
+            // Indicates queue timeout
+            return TIMEOUT;
+          }
+      }
+      else
+      {
+          // Remove the time to wait condition
+          Task->TimeToWait = NO_TIMEOUT;
+          
+          // Remove from delay list
+          RemoveFromDelayList();
+      }
+  }
   
-  return(ALLOC_EVENT_OK);
+  return OK;
 }
 
 ////////////////////////////////////////////////////////////
@@ -720,49 +876,114 @@ INT8U OSQueue16Create(OS_QUEUE_16 *cqueue, INT16U size)
 
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
-/////      Write Queue Function                        /////
+/////      Queue Pend Many Function                    /////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
-INT8U OSWQueue16(OS_QUEUE_16 *cqueue,INT16U data)
+INT8U OSQueuePendMany(BRTOS_Queue *pont_event, INT8U *pdata, INT16U size, INT16U *read, INT16U time_wait)
 {
   OS_SR_SAVE_VAR
+  INT16U i = 0;
+  OS_QUEUE *cqueue;
+  INT32U deadline = 0;
+  INT32U remaining;
   
+  *read = 0;
+   
+  #if (ERROR_CHECK == 1)
+    /// Can not use Queue pend function from interrupt handling code
+    if(iNesting > 0)
+    {
+      return(IRQ_PEND_ERR);
+    }
+    
+    // Verifies if the pointer is NULL
+    if(pont_event == NULL)
+    {
+      return(NULL_EVENT_POINTER);
+    }
+  #endif
+    
   // Enter Critical Section
-  #if (NESTING_INT == 0)
-  if (!iNesting)
+  OSEnterCritical();
+
+  #if (ERROR_CHECK == 1)
+    // Verifies if the event is allocated
+    if(pont_event->OSEventAllocated != TRUE)
+    {
+      // Exit Critical Section
+      OSExitCritical();
+      return(ERR_EVENT_NO_CREATED);
+    }
   #endif
-     OSEnterCritical();
   
-  if (cqueue->OSQEntries < cqueue->OSQSize)
-  {  
-    cqueue->OSQEntries++;
-  }
-  else
-  { 
-     // Exit Critical Section
-     #if (NESTING_INT == 0)
-     if (!iNesting)
-     #endif
-       OSExitCritical();
-       
-     return BUFFER_UNDERRUN;
-  }
+  cqueue = pont_event->OSEventPointer;
   
-  if (cqueue->OSQIn == cqueue->OSQEnd)
-    cqueue->OSQIn = cqueue->OSQStart;
+  // BRTOS TRACE SUPPORT
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_QUEUE_PEND, OS_TRACE_ADDR(pont_event));
+  #endif
   
-  *cqueue->OSQIn = data;
-  cqueue->OSQIn++;
+  // Wait until there is data in the queue. The data may have been
+  // taken by a higher priority task before this task runs again.
+  // The timeout covers the whole call, so each retry only waits for the
+  // time left until the deadline.
+  if ((time_wait != 0) && (time_wait != NO_TIMEOUT))
+  {
+    deadline = OSGetMonotonicCount() + (INT32U)time_wait;
+  }
   
-   // Exit Critical Section
-   #if (NESTING_INT == 0)
-   if (!iNesting)
-   #endif
+  while(cqueue->OSQEntries == 0)
+  {
+    // If no timeout is used and the queue is empty, exit the queue with an error
+    if (time_wait == NO_TIMEOUT)
+    {
+      // Exit Critical Section
+      OSExitCritical();
+      return EXIT_BY_NO_ENTRY_AVAILABLE;
+    }
+    
+    if (time_wait != 0)
+    {
+      remaining = deadline - OSGetMonotonicCount();
+      if ((INT32S)remaining <= 0)
+      {
+        // Exit Critical Section
+        OSExitCritical();
+        return TIMEOUT;
+      }
+      time_wait = (INT16U)remaining;
+    }
+    
+    if (OSQueueWaitPost(pont_event, time_wait) == TIMEOUT)
+    {
+      // Exit Critical Section
       OSExitCritical();
+      return TIMEOUT;
+    }
+  }
   
-  return WRITE_BUFFER_OK;
+  // Copy all available data, up to size bytes
+  while((i < size) && (cqueue->OSQEntries > 0))
+  {
+    // Verify for output pointer overflow
+    if (cqueue->OSQOut == cqueue->OSQEnd)
+      cqueue->OSQOut = cqueue->OSQStart;
+    
+    pdata[i] = *cqueue->OSQOut;
+    cqueue->OSQOut++;
+    cqueue->OSQEntries--;
+    i++;
+  }
+  
+  *read = i;
   
+  // Keeps the event group flag set while data is left
+  OS_EVENT_GROUP_REARM(pont_event, cqueue->OSQEntries > 0);
+  
+  // Exit Critical Section
+  OSExitCritical();
+  return READ_BUFFER_OK;
 }
 
 ////////////////////////////////////////////////////////////
@@ -776,145 +997,100 @@ INT8U OSWQueue16(OS_QUEUE_16 *cqueue,INT16U data)
 
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
-/////      Read Queue Function                         /////
+/////      Queue Post Many Function                    /////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
-INT8U OSRQueue16(OS_QUEUE_16 *cqueue, INT16U *pdata)
+INT8U OSQueuePostMany(BRTOS_Queue *pont_event, const INT8U *data, INT16U size, INT16U *written)
 {
   OS_SR_SAVE_VAR
-    
-  // Critical Section
+  INT16U i = 0;
+  OS_QUEUE *cqueue;
+  
+  *written = 0;
+  
+  #if (ERROR_CHECK == 1)    
+    // Verifies if the pointer is NULL
+    if(pont_event == NULL)
+    {
+      return(NULL_EVENT_POINTER);
+    }
+  #endif
+
+  // Enter Critical Section
   #if (NESTING_INT == 0)
   if (!iNesting)
   #endif
      OSEnterCritical();
+     
+  #if (ERROR_CHECK == 1)        
+    // Verifies if the event is allocated
+    if(pont_event->OSEventAllocated != TRUE)
+    {
+      // Exit Critical Section
+      #if (NESTING_INT == 0)
+      if (!iNesting)
+      #endif
+         OSExitCritical();
+      return(ERR_EVENT_NO_CREATED);
+    }
+  #endif
+     
+  cqueue = pont_event->OSEventPointer;
   
-  if(cqueue->OSQEntries > 0)
-  {
-      
-    if (cqueue->OSQOut == cqueue->OSQEnd)
-      cqueue->OSQOut = cqueue->OSQStart;
-  
-    *pdata = *cqueue->OSQOut;
+  // BRTOS TRACE SUPPORT
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_QUEUE_POST, OS_TRACE_ADDR(pont_event));
+  #endif
   
-    cqueue->OSQOut++;
-    cqueue->OSQEntries--;
+  // Copy data until the queue is full
+  while((i < size) && (cqueue->OSQEntries < cqueue->OSQSize))
+  {
+    // Verify for input pointer overflow
+    if (cqueue->OSQIn == cqueue->OSQEnd)
+      cqueue->OSQIn = cqueue->OSQStart;
     
-    // Exit Critical Section
-    #if (NESTING_INT == 0)
-    if (!iNesting)
-    #endif
-      OSExitCritical();
-      
-    return READ_BUFFER_OK;
+    *cqueue->OSQIn = data[i];
+    cqueue->OSQIn++;
+    cqueue->OSQEntries++;
+    i++;
   }
-  else
+  
+  *written = i;
+  
+  // Signal a task waiting for multiple events if there is more data than waiting tasks
+  if (i > pont_event->OSEventWait)
   {
-    // Exit Critical Section
-    #if (NESTING_INT == 0)
+    OS_EVENT_GROUP_SIGNAL(pont_event);
+  }
+  
+  // Wake up one waiting task for each new data
+  if ((i > 0) && (pont_event->OSEventWait != 0))
+  {
+    OSQueueWakeUp(pont_event, i);
+    
+    // If outside of an interrupt service routine, change context to the highest priority task
+    // If inside of an interrupt, the interrupt itself will change the context to the highest priority task
     if (!iNesting)
-    #endif
-      OSExitCritical();
-      
-    return NO_ENTRY_AVAILABLE;
+    {
+      // Verify if there is a higher priority task ready to run
+      ChangeContext();      
+    }
   }
-}
-
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-
-
-
-
 
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-/////      Clean Queue Function                        /////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-
-INT8U OSCleanQueue16(OS_QUEUE_16 *cqueue)
-{
-  OS_SR_SAVE_VAR
-  OS_QUEUE_16 *tmp_queue = cqueue;
-  
-  // Enter Critical Section
-  #if (NESTING_INT == 0)
-  if (!iNesting)
-  #endif
-     OSEnterCritical();
-  
-  cqueue->OSQEntries = 0;
-  
-  cqueue->OSQIn = tmp_queue->OSQStart;
-  cqueue->OSQOut = tmp_queue->OSQStart;
-  
   // Exit Critical Section
   #if (NESTING_INT == 0)
   if (!iNesting)
   #endif
-    OSExitCritical();  
-
-  return CLEAN_BUFFER_OK;
-}
-
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-
-#endif
-
-
-
-
-
-
-#if (BRTOS_QUEUE_32_EN == 1)
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-/////      Create Queue Function                       /////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-
-INT8U OSQueue32Create(OS_QUEUE_32 *cqueue, INT16U size)
-{
-  OS_SR_SAVE_VAR
-
-  if (iNesting > 0) {                                // See if caller is an interrupt
-     return(IRQ_PEND_ERR);                           // Can't be create by interrupt
-  }
-    
-  // Enter critical Section
-  if (currentTask)
-     OSEnterCritical();
+    OSExitCritical();
   
-  if ((iQueueAddress + ((size*sizeof(INT32U)) / sizeof(OS_CPU_TYPE))) > (QUEUE_HEAP_SIZE / sizeof(OS_CPU_TYPE)))
+  if (i < size)
   {
-      // Exit critical Section
-      if (currentTask)
-         OSExitCritical();
-      
-       return NO_MEMORY;
-  }  
-  
-  // Configura dados de evento de lista
-  cqueue->OSQStart    = (INT32U *)&QUEUE_STACK[iQueueAddress];
-  iQueueAddress       = (INT16U)(iQueueAddress + ((size*sizeof(INT32U)) / sizeof(OS_CPU_TYPE)));
-  cqueue->OSQSize     = size;
-  cqueue->OSQEntries  = 0;
-  cqueue->OSQEnd      = cqueue->OSQStart + cqueue->OSQSize;
-  cqueue->OSQIn       = cqueue->OSQStart;
-  cqueue->OSQOut      = cqueue->OSQStart;
-  
-  // Exit critical Section
-  if (currentTask)
-     OSExitCritical();  
+    // Indicates queue overflow
+    return BUFFER_UNDERRUN;
+  }
   
-  return(ALLOC_EVENT_OK);
+  return WRITE_BUFFER_OK;
 }
 
 ////////////////////////////////////////////////////////////
@@ -928,105 +1104,155 @@ INT8U OSQueue32Create(OS_QUEUE_32 *cqueue, INT16U size)
 
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
-/////      Write Queue Function                        /////
+/////      Queue Reserve / Commit Functions            /////
+/////                                                  /////
+/////      Zero copy write for a single producer       /////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
-INT8U OSWQueue32(OS_QUEUE_32 *cqueue,INT32U data)
+INT8U OSQueueReserve(BRTOS_Queue *pont_event, INT8U **region, INT16U *size)
 {
   OS_SR_SAVE_VAR
+  INT16U in;
+  INT16U free_space;
+  OS_QUEUE *cqueue;
   
+  #if (ERROR_CHECK == 1)    
+    // Verifies if the pointer is NULL
+    if(pont_event == NULL)
+    {
+      return(NULL_EVENT_POINTER);
+    }
+  #endif
+
   // Enter Critical Section
   #if (NESTING_INT == 0)
   if (!iNesting)
   #endif
      OSEnterCritical();
   
-  if (cqueue->OSQEntries < cqueue->OSQSize)
-  {  
-    cqueue->OSQEntries++;
-  }
-  else
-  { 
-     // Exit Critical Section
-     #if (NESTING_INT == 0)
-     if (!iNesting)
-     #endif
-       OSExitCritical();
-       
-     return BUFFER_UNDERRUN;
-  }
+  #if (ERROR_CHECK == 1)        
+    // Verifies if the event is allocated
+    if(pont_event->OSEventAllocated != TRUE)
+    {
+      // Exit Critical Section
+      #if (NESTING_INT == 0)
+      if (!iNesting)
+      #endif
+         OSExitCritical();
+      return(ERR_EVENT_NO_CREATED);
+    }
+  #endif
   
+  cqueue = pont_event->OSEventPointer;
+  
+  // Verify for input pointer overflow
   if (cqueue->OSQIn == cqueue->OSQEnd)
     cqueue->OSQIn = cqueue->OSQStart;
   
-  *cqueue->OSQIn = data;
-  cqueue->OSQIn++;
+  in = (INT16U)(cqueue->OSQIn - cqueue->OSQStart);
+  free_space = (INT16U)(cqueue->OSQSize - cqueue->OSQEntries);
   
-   // Exit Critical Section
-   #if (NESTING_INT == 0)
-   if (!iNesting)
-   #endif
-      OSExitCritical();
+  // The contiguous region ends at the end of the queue buffer
+  if (free_space > (INT16U)(cqueue->OSQSize - in))
+  {
+    free_space = (INT16U)(cqueue->OSQSize - in);
+  }
   
-  return WRITE_BUFFER_OK;
+  *region = cqueue->OSQIn;
+  *size = free_space;
+  
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+    OSExitCritical();
+  
+  if (free_space == 0)
+  {
+    return BUFFER_UNDERRUN;
+  }
   
+  return WRITE_BUFFER_OK;
 }
 
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-
-
-
 
-
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-/////      Read Queue Function                         /////
-////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////
-
-INT8U OSRQueue32(OS_QUEUE_32 *cqueue, INT32U *pdata)
+INT8U OSQueueCommit(BRTOS_Queue *pont_event, INT16U size)
 {
   OS_SR_SAVE_VAR
-    
-  // Critical Section
+  OS_QUEUE *cqueue;
+  
+  #if (ERROR_CHECK == 1)    
+    // Verifies if the pointer is NULL
+    if(pont_event == NULL)
+    {
+      return(NULL_EVENT_POINTER);
+    }
+  #endif
+
+  // Enter Critical Section
   #if (NESTING_INT == 0)
   if (!iNesting)
   #endif
      OSEnterCritical();
   
-  if(cqueue->OSQEntries > 0)
-  {
-      
-    if (cqueue->OSQOut == cqueue->OSQEnd)
-      cqueue->OSQOut = cqueue->OSQStart;
+  #if (ERROR_CHECK == 1)        
+    // Verifies if the event is allocated
+    if(pont_event->OSEventAllocated != TRUE)
+    {
+      // Exit Critical Section
+      #if (NESTING_INT == 0)
+      if (!iNesting)
+      #endif
+         OSExitCritical();
+      return(ERR_EVENT_NO_CREATED);
+    }
+  #endif
   
-    *pdata = *cqueue->OSQOut;
+  cqueue = pont_event->OSEventPointer;
   
-    cqueue->OSQOut++;
-    cqueue->OSQEntries--;
-    
+  // The committed data must fit in the contiguous region
+  if ((size > (INT16U)(cqueue->OSQSize - cqueue->OSQEntries)) ||
+      (size > (INT16U)(cqueue->OSQEnd - cqueue->OSQIn)))
+  {
     // Exit Critical Section
     #if (NESTING_INT == 0)
     if (!iNesting)
     #endif
       OSExitCritical();
-      
-    return READ_BUFFER_OK;
+    return BUFFER_UNDERRUN;
   }
-  else
+  
+  cqueue->OSQIn += size;
+  cqueue->OSQEntries = (INT16U)(cqueue->OSQEntries + size);
+  
+  // Signal a task waiting for multiple events if there is more data than waiting tasks
+  if (size > pont_event->OSEventWait)
   {
-    // Exit Critical Section
-    #if (NESTING_INT == 0)
+    OS_EVENT_GROUP_SIGNAL(pont_event);
+  }
+  
+  // Wake up one waiting task for each new data
+  if ((size > 0) && (pont_event->OSEventWait != 0))
+  {
+    OSQueueWakeUp(pont_event, size);
+    
+    // If outside of an interrupt service routine, change context to the highest priority task
+    // If inside of an interrupt, the interrupt itself will change the context to the highest priority task
     if (!iNesting)
-    #endif
-      OSExitCritical();
-      
-    return NO_ENTRY_AVAILABLE;
+    {
+      // Verify if there is a higher priority task ready to run
+      ChangeContext();      
+    }
   }
+  
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+    OSExitCritical();
+  
+  return WRITE_BUFFER_OK;
 }
 
 ////////////////////////////////////////////////////////////
@@ -1040,33 +1266,253 @@ INT8U OSRQueue32(OS_QUEUE_32 *cqueue, INT32U *pdata)
 
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
-/////      Clean Queue Function                        /////
+/////      Queue Peek / Consume Functions              /////
+/////                                                  /////
+/////      Zero copy read for a single consumer        /////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 
-INT8U OSCleanQueue32(OS_QUEUE_32 *cqueue)
+INT8U OSQueuePeek(BRTOS_Queue *pont_event, INT8U **region, INT16U *size)
 {
   OS_SR_SAVE_VAR
-  OS_QUEUE_32 *tmp_queue = cqueue;
+  INT16U out;
+  INT16U entries;
+  OS_QUEUE *cqueue;
   
+  #if (ERROR_CHECK == 1)    
+    // Verifies if the pointer is NULL
+    if(pont_event == NULL)
+    {
+      return(NULL_EVENT_POINTER);
+    }
+  #endif
+
   // Enter Critical Section
   #if (NESTING_INT == 0)
   if (!iNesting)
   #endif
      OSEnterCritical();
   
-  cqueue->OSQEntries = 0;
+  #if (ERROR_CHECK == 1)        
+    // Verifies if the event is allocated
+    if(pont_event->OSEventAllocated != TRUE)
+    {
+      // Exit Critical Section
+      #if (NESTING_INT == 0)
+      if (!iNesting)
+      #endif
+         OSExitCritical();
+      return(ERR_EVENT_NO_CREATED);
+    }
+  #endif
+  
+  cqueue = pont_event->OSEventPointer;
+  
+  // Verify for output pointer overflow
+  if (cqueue->OSQOut == cqueue->OSQEnd)
+    cqueue->OSQOut = cqueue->OSQStart;
+  
+  out = (INT16U)(cqueue->OSQOut - cqueue->OSQStart);
+  entries = cqueue->OSQEntries;
   
-  cqueue->OSQIn = tmp_queue->OSQStart;
-  cqueue->OSQOut = tmp_queue->OSQStart;
+  // The contiguous region ends at the end of the queue buffer
+  if (entries > (INT16U)(cqueue->OSQSize - out))
+  {
+    entries = (INT16U)(cqueue->OSQSize - out);
+  }
+  
+  *region = cqueue->OSQOut;
+  *size = entries;
   
   // Exit Critical Section
   #if (NESTING_INT == 0)
   if (!iNesting)
   #endif
-    OSExitCritical();  
+    OSExitCritical();
+  
+  if (entries == 0)
+  {
+    return NO_ENTRY_AVAILABLE;
+  }
+  
+  return READ_BUFFER_OK;
+}
 
-  return CLEAN_BUFFER_OK;
+
+INT8U OSQueueConsume(BRTOS_Queue *pont_event, INT16U size)
+{
+  OS_SR_SAVE_VAR
+  OS_QUEUE *cqueue;
+  
+  #if (ERROR_CHECK == 1)    
+    // Verifies if the pointer is NULL
+    if(pont_event == NULL)
+    {
+      return(NULL_EVENT_POINTER);
+    }
+  #endif
+
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+  
+  #if (ERROR_CHECK == 1)        
+    // Verifies if the event is allocated
+    if(pont_event->OSEventAllocated != TRUE)
+    {
+      // Exit Critical Section
+      #if (NESTING_INT == 0)
+      if (!iNesting)
+      #endif
+         OSExitCritical();
+      return(ERR_EVENT_NO_CREATED);
+    }
+  #endif
+  
+  cqueue = pont_event->OSEventPointer;
+  
+  // The consumed data must be inside the contiguous region
+  if ((size > cqueue->OSQEntries) || (size > (INT16U)(cqueue->OSQEnd - cqueue->OSQOut)))
+  {
+    // Exit Critical Section
+    #if (NESTING_INT == 0)
+    if (!iNesting)
+    #endif
+      OSExitCritical();
+    return NO_ENTRY_AVAILABLE;
+  }
+  
+  cqueue->OSQOut += size;
+  cqueue->OSQEntries = (INT16U)(cqueue->OSQEntries - size);
+  
+  // Keeps the event group flag set while data is left
+  OS_EVENT_GROUP_REARM(pont_event, cqueue->OSQEntries > 0);
+  
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+    OSExitCritical();
+  
+  return READ_BUFFER_OK;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#endif
+
+
+
+#if (BRTOS_QUEUE_16_EN == 1)
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Queue 16 Functions                          /////
+/////                                                  /////
+/////      Share the generic queue implementation      /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSQueue16Create(OS_QUEUE_16 *cqueue, INT16U size)
+{
+  OS_SR_SAVE_VAR
+  INT8U ret;
+
+  if (iNesting > 0) {                                // See if caller is an interrupt
+     return(IRQ_PEND_ERR);                           // Can't be create by interrupt
+  }
+    
+  // Enter critical Section
+  if (currentTask)
+     OSEnterCritical();
+  
+  ret = OSQueueInit(cqueue, size, sizeof(INT16U));
+  
+  // Exit critical Section
+  if (currentTask)
+     OSExitCritical();  
+  
+  return ret;
+}
+
+
+INT8U OSWQueue16(OS_QUEUE_16 *cqueue,INT16U data)
+{
+  return OSQueueWrite(cqueue, &data, sizeof(data));
+}
+
+
+INT8U OSRQueue16(OS_QUEUE_16 *cqueue, INT16U *pdata)
+{
+  return OSQueueRead(cqueue, pdata, sizeof(*pdata));
+}
+
+
+INT8U OSCleanQueue16(OS_QUEUE_16 *cqueue)
+{
+  return OSQueueReset(cqueue);
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#endif
+
+
+
+#if (BRTOS_QUEUE_32_EN == 1)
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Queue 32 Functions                          /////
+/////                                                  /////
+/////      Share the generic queue implementation      /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSQueue32Create(OS_QUEUE_32 *cqueue, INT16U size)
+{
+  OS_SR_SAVE_VAR
+  INT8U ret;
+
+  if (iNesting > 0) {                                // See if caller is an interrupt
+     return(IRQ_PEND_ERR);                           // Can't be create by interrupt
+  }
+    
+  // Enter critical Section
+  if (currentTask)
+     OSEnterCritical();
+  
+  ret = OSQueueInit(cqueue, size, sizeof(INT32U));
+  
+  // Exit critical Section
+  if (currentTask)
+     OSExitCritical();  
+  
+  return ret;
+}
+
+
+INT8U OSWQueue32(OS_QUEUE_32 *cqueue,INT32U data)
+{
+  return OSQueueWrite(cqueue, &data, sizeof(data));
+}
+
+
+INT8U OSRQueue32(OS_QUEUE_32 *cqueue, INT32U *pdata)
+{
+  return OSQueueRead(cqueue, pdata, sizeof(*pdata));
+}
+
+
+INT8U OSCleanQueue32(OS_QUEUE_32 *cqueue)
+{
+  return OSQueueReset(cqueue);
 }
 
 ////////////////////////////////////////////////////////////
@@ -1077,6 +1523,7 @@ INT8U OSCleanQueue32(OS_QUEUE_32 *cqueue)
 #endif
 
 
+
 #if (BRTOS_DYNAMIC_QUEUE_ENABLED == 1)
 
 ///// Memory allocation definition tests
@@ -1168,19 +1615,16 @@ INT8U OSDQueueCreate(INT16U queue_length, OS_CPU_TYPE type_size, BRTOS_Queue **e
 	}
   
   // Configura dados de evento de lista
-  cqueue->OSQLength  = queue_length;
-  cqueue->OSQTSize   = (INT16U)type_size;
-  cqueue->OSQEntries = 0;
-  cqueue->OSQEnd     = cqueue->OSQStart + size_in_bytes;
-  cqueue->OSQIn      = cqueue->OSQStart;
-  cqueue->OSQOut     = cqueue->OSQStart;
+  OSQueueSetup(cqueue, cqueue->OSQStart, queue_length, (INT16U)type_size);
   
   // Aloca tipo de evento e dados do evento
+  pont_event->OSEventAllocated = TRUE;
   pont_event->OSEventPointer = cqueue;
   pont_event->OSEventWait = 0;
   
   
   pont_event->OSEventWaitList=0;
+  OS_EVENT_GROUP_INIT(pont_event);
   
   *event = pont_event;
   
@@ -1226,6 +1670,7 @@ INT8U OSDQueueDelete (BRTOS_Queue **event)
   pont_event->OSEventCount     = 0;                      
   pont_event->OSEventWait      = 0;
   pont_event->OSEventWaitList=0;
+  OS_EVENT_GROUP_UNLINK(pont_event);
   
   BRTOS_DEALLOC(pont_event);
   
@@ -1254,26 +1699,7 @@ INT8U OSDQueueDelete (BRTOS_Queue **event)
 
 INT8U OSDQueueClean(BRTOS_Queue *pont_event)
 {
-  OS_SR_SAVE_VAR
-  OS_DQUEUE *cqueue = pont_event->OSEventPointer;
-  
-  // Enter Critical Section
-  #if (NESTING_INT == 0)
-  if (!iNesting)
-  #endif
-     OSEnterCritical();
-  
-  cqueue->OSQEntries  = 0;
-  cqueue->OSQIn       = cqueue->OSQStart;
-  cqueue->OSQOut      = cqueue->OSQStart;
-  
-  // Exit Critical Section
-  #if (NESTING_INT == 0)
-  if (!iNesting)
-  #endif
-    OSExitCritical();  
-
-  return CLEAN_BUFFER_OK;
+  return OSQueueReset((OS_DQUEUE*)pont_event->OSEventPointer);
 }
 
 ////////////////////////////////////////////////////////////
@@ -1294,12 +1720,9 @@ INT8U OSDQueueClean(BRTOS_Queue *pont_event)
 INT8U OSDQueuePend (BRTOS_Queue *pont_event, void *pdata, INT16U time_wait)
 {
   OS_SR_SAVE_VAR
-  INT8U       iPriority = 0;
   INT32U      timeout;
-  INT16U      n;  
   ContextType *Task;
   OS_DQUEUE   *cqueue;
-  INT8U       *dst;  
    
   #if (ERROR_CHECK == 1)
     /// Can not use Queue pend function from interrupt handling code
@@ -1317,9 +1740,6 @@ INT8U OSDQueuePend (BRTOS_Queue *pont_event, void *pdata, INT16U time_wait)
     
   // Enter Critical Section
   OSEnterCritical();
-  cqueue  = pont_event->OSEventPointer;
-  n       = cqueue->OSQTSize;
-  dst     = (INT8U*)pdata;
 
   #if (ERROR_CHECK == 1)
     // Verifies if the event is allocated
@@ -1331,32 +1751,21 @@ INT8U OSDQueuePend (BRTOS_Queue *pont_event, void *pdata, INT16U time_wait)
     }
   #endif
   
+  cqueue = pont_event->OSEventPointer;
+  
   // BRTOS TRACE SUPPORT
-  #if (OSTRACE == 1) 
-      #if(OS_TRACE_BY_TASK == 1)
-      Update_OSTrace(currentTask, QUEUEPEND);
-      #else
-      Update_OSTrace(ContextTask[currentTask].Priority, QUEUEPEND);
-      #endif
-  #endif   
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_QUEUE_PEND, OS_TRACE_ADDR(pont_event));
+  #endif
     
   // Verify if there is data in the queue
   if(cqueue->OSQEntries > 0)
   {
-    // Verify for output pointer overflow
-    if (cqueue->OSQOut == cqueue->OSQEnd)
-      cqueue->OSQOut = cqueue->OSQStart;
-  
-    // Copy data from queue
-    while(n) 
-    {
-      // copy data and increase the input pointer
-      *dst++ = *cqueue->OSQOut++;
-      n--;
-    }
+    // Copy data from queue, the buffer of the caller may be unaligned
+    OSQueueCopyBytes((INT8U*)pdata, OSQueueOut(cqueue), cqueue->OSQTSize);
     
-    // Decreases queue entries
-    cqueue->OSQEntries--;
+    // Keeps the event group flag set while data is left
+    OS_EVENT_GROUP_REARM(pont_event, cqueue->OSQEntries > 0);
     
     // Exit Critical Section
     OSExitCritical();
@@ -1373,14 +1782,11 @@ INT8U OSDQueuePend (BRTOS_Queue *pont_event, void *pdata, INT16U time_wait)
   	
     Task = (ContextType*)&ContextTask[currentTask];
     
-    // Copy task priority to local scope
-    iPriority = Task->Priority;
-  
     // Increases the queue wait list counter
     pont_event->OSEventWait++;
     
     // Allocates the current task on the queue wait list
-    pont_event->OSEventWaitList = pont_event->OSEventWaitList | (PriorityMask[iPriority]);
+    OSEventWaitListInsert(pont_event, Task);
   
     // Task entered suspended state, waiting for queue post
     #if (VERBOSE == 1)
@@ -1389,7 +1795,7 @@ INT8U OSDQueuePend (BRTOS_Queue *pont_event, void *pdata, INT16U time_wait)
     #endif
 
     // Remove current task from the Ready List
-    OSReadyList = OSReadyList & ~(PriorityMask[iPriority]);
+    OSReadyListRemove(Task);
   
     // Set timeout overflow
     if (time_wait)
@@ -1426,10 +1832,10 @@ INT8U OSDQueuePend (BRTOS_Queue *pont_event, void *pdata, INT16U time_wait)
         if(Task->TimeToWait == EXIT_BY_TIMEOUT)
         {
             // Test if both timeout and post have occured before arrive here
-            if ((pont_event->OSEventWaitList & PriorityMask[iPriority]))
+            if (OSEventWaitListContains(pont_event, Task))
             {
               // Remove the task from the queue wait list
-              pont_event->OSEventWaitList = pont_event->OSEventWaitList & ~(PriorityMask[iPriority]);
+              OSEventWaitListRemove(pont_event, Task);
               
               // Decreases the queue wait list counter
               pont_event->OSEventWait--;
@@ -1452,20 +1858,19 @@ INT8U OSDQueuePend (BRTOS_Queue *pont_event, void *pdata, INT16U time_wait)
        
     }
     
-    // Verify for output pointer overflow
-    if (cqueue->OSQOut == cqueue->OSQEnd)
-      cqueue->OSQOut = cqueue->OSQStart;
-  
-    // Copy data from queue
-    while(n) 
+    // The data may have been taken by a higher priority task
+    if (cqueue->OSQEntries == 0)
     {
-      // copy data and increase the input pointer
-      *dst++ = *cqueue->OSQOut++;
-      n--;
+      // Exit Critical Section
+      OSExitCritical();
+      return NO_ENTRY_AVAILABLE;
     }
     
-    // Decreases queue entries
-    cqueue->OSQEntries--;
+    // Copy data from queue, the buffer of the caller may be unaligned
+    OSQueueCopyBytes((INT8U*)pdata, OSQueueOut(cqueue), cqueue->OSQTSize);
+    
+    // Keeps the event group flag set while data is left
+    OS_EVENT_GROUP_REARM(pont_event, cqueue->OSQEntries > 0);
     
     // Exit Critical Section
     OSExitCritical();
@@ -1493,12 +1898,7 @@ INT8U OSDQueuePost(BRTOS_Queue *pont_event, void *pdata)
   OS_SR_SAVE_VAR
   INT8U iPriority = (INT8U)0;
   
-  #if (VERBOSE == 1)
   INT8U TaskSelect = 0;
-  #endif
-  
-  INT16U    n;
-  INT8U     *src;
   OS_DQUEUE *cqueue;
   
   #if (ERROR_CHECK == 1)    
@@ -1515,10 +1915,6 @@ INT8U OSDQueuePost(BRTOS_Queue *pont_event, void *pdata)
   #endif
      OSEnterCritical();
      
-  cqueue  = pont_event->OSEventPointer;
-  src     = (INT8U*)pdata;
-  n       = cqueue->OSQTSize;
-
   #if (ERROR_CHECK == 1)        
     // Verifies if the event is allocated
     if(pont_event->OSEventAllocated != TRUE)
@@ -1531,27 +1927,16 @@ INT8U OSDQueuePost(BRTOS_Queue *pont_event, void *pdata)
       return(ERR_EVENT_NO_CREATED);
     }
   #endif
+  
+  cqueue = pont_event->OSEventPointer;
      
   // BRTOS TRACE SUPPORT
-  #if (OSTRACE == 1)  
-    if(!iNesting){ 
-      #if(OS_TRACE_BY_TASK == 1)
-      Update_OSTrace(currentTask, QUEUEPOST);
-      #else
-      Update_OSTrace(ContextTask[currentTask].Priority, QUEUEPOST);
-      #endif
-    }else{
-      Update_OSTrace(0, QUEUEPOST);
-    }
-  #endif       
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_QUEUE_POST, OS_TRACE_ADDR(pont_event));
+  #endif
   
   // Checks for queue overflow
-  if (cqueue->OSQEntries < cqueue->OSQLength)
-  {  
-    // If no, increases the queue entries
-    cqueue->OSQEntries++;
-  }
-  else
+  if (cqueue->OSQEntries >= cqueue->OSQSize)
   { 
      // Exit Critical Section
      #if (NESTING_INT == 0)
@@ -1563,37 +1948,24 @@ INT8U OSDQueuePost(BRTOS_Queue *pont_event, void *pdata)
      return BUFFER_UNDERRUN;
   }
   
-  // Verify for input pointer overflow
-  if (cqueue->OSQIn == cqueue->OSQEnd)
-    cqueue->OSQIn = cqueue->OSQStart;
-  
-  // copy data into the queue
-  while(n) 
-  {
-    // copy data and increase the input pointer
-    *cqueue->OSQIn++ = *src++;
-    n--;
-  } 
+  // copy data into the queue, the data of the caller may be unaligned
+  OSQueueCopyBytes(OSQueueIn(cqueue), (const INT8U*)pdata, cqueue->OSQTSize);
   
   // See if any task is waiting for new data in the queue
   if (pont_event->OSEventWait != 0)
   {
-    // Selects the highest priority task
-    iPriority = SAScheduler(pont_event->OSEventWaitList);    
-
-    // Remove the selected task from the queue wait list
-    pont_event->OSEventWaitList = pont_event->OSEventWaitList & ~(PriorityMask[iPriority]);
+    // Selects the highest priority task and removes it from the queue wait list
+    TaskSelect = OSEventWaitListTake(pont_event, iPriority);
     
     // Decreases the queue wait list counter
     pont_event->OSEventWait--;
     
     // Put the selected task into Ready List
     #if (VERBOSE == 1)
-    TaskSelect = PriorityVector[iPriority];
     ContextTask[TaskSelect].State = READY;
     #endif
     
-    OSReadyList = OSReadyList | (PriorityMask[iPriority]);
+    OSReadyListInsert(&ContextTask[TaskSelect]);
     
     // If outside of an interrupt service routine, change context to the highest priority task
     // If inside of an interrupt, the interrupt itself will change the context to the highest priority task
@@ -1613,6 +1985,9 @@ INT8U OSDQueuePost(BRTOS_Queue *pont_event, void *pdata)
   }
   else
   {
+    // Signal a task waiting for multiple events
+    OS_EVENT_GROUP_SIGNAL(pont_event);
+    
     // Exit Critical Section
     #if (NESTING_INT == 0)
     if (!iNesting)
@@ -1632,3 +2007,555 @@ INT8U OSDQueuePost(BRTOS_Queue *pont_event, void *pdata)
 #endif
 
 
+
+
+
+#if (BRTOS_MSG_QUEUE_EN == 1)
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Create Message Pool Function                /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+// Each block holds the header followed by the message data
+#define OS_MSG_BLOCK_BYTES(size)    ((INT32U)sizeof(OS_MSG_HEADER) + (INT32U)(size))
+
+INT8U OSMsgPoolCreate(INT16U blocks, INT16U block_size, BRTOS_MsgPool **pool)
+{
+  OS_SR_SAVE_VAR
+  INT8U          err;
+  INT32U         size_in_bytes;
+  BRTOS_MsgPool  *mpool;
+  INT8U          *memory;
+  
+  if (iNesting > 0) {                                // See if caller is an interrupt
+     return(IRQ_PEND_ERR);                           // Can't be create by interrupt
+  }
+  
+  if ((blocks == 0) || (block_size == 0) || (OS_MSG_BLOCK_BYTES(block_size) > (0xFFFF - sizeof(void*))))
+  {
+    return(INVALID_PARAMETERS);
+  }
+  
+  // The heap may return memory aligned to less than a pointer
+  size_in_bytes = OS_MEM_POOL_BYTES(blocks, OS_MSG_BLOCK_BYTES(block_size)) + sizeof(void*) - 1;
+  if (size_in_bytes > 0xFFFF)
+  {
+    return(INVALID_PARAMETERS);
+  }
+  
+  // Enter critical Section
+  if (currentTask)
+     OSEnterCritical();
+  
+  // Allocate the pool handler
+  mpool = (BRTOS_MsgPool*)BRTOS_ALLOC(sizeof(BRTOS_MsgPool));
+  if (mpool == NULL)
+  {
+    // Exit critical Section
+    if (currentTask)
+       OSExitCritical();
+    
+    return(NO_AVAILABLE_MEMORY);
+  }
+  
+  // Allocate the message blocks in the heap
+  mpool->OSMsgMemory = BRTOS_ALLOC((INT16U)size_in_bytes);
+  if (mpool->OSMsgMemory == NULL)
+  {
+    // Deallocate pool handler
+    BRTOS_DEALLOC(mpool);
+    
+    // Exit critical Section
+    if (currentTask)
+       OSExitCritical();
+    
+    return(NO_AVAILABLE_MEMORY);
+  }
+  
+  memory = (INT8U*)mpool->OSMsgMemory;
+  memory += (sizeof(void*) - ((unsigned long)memory & (sizeof(void*) - 1))) & (sizeof(void*) - 1);
+  
+  err = OSMemPoolCreate(memory, blocks, (INT16U)OS_MSG_BLOCK_BYTES(block_size), &mpool->OSMsgMemPool);
+  if (err != ALLOC_EVENT_OK)
+  {
+    BRTOS_DEALLOC(mpool->OSMsgMemory);
+    BRTOS_DEALLOC(mpool);
+    
+    // Exit critical Section
+    if (currentTask)
+       OSExitCritical();
+    
+    return(err);
+  }
+  
+  *pool = mpool;
+  
+  // Exit critical Section
+  if (currentTask)
+     OSExitCritical();
+  
+  return(ALLOC_EVENT_OK);
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Delete Message Pool Function                /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSMsgPoolDelete(BRTOS_MsgPool **pool)
+{
+  OS_SR_SAVE_VAR
+  BRTOS_MsgPool *mpool = *pool;
+  INT8U         err;
+  
+  if (iNesting > 0) {                                // See if caller is an interrupt
+      return(IRQ_PEND_ERR);                          // Can't be delete by interrupt
+  }
+  
+  // Enter Critical Section
+  OSEnterCritical();
+  
+  // All blocks must have been returned to the pool
+  err = OSMemPoolDelete(&mpool->OSMsgMemPool);
+  if (err != DELETE_EVENT_OK)
+  {
+    // Exit Critical Section
+    OSExitCritical();
+    return(err);
+  }
+  
+  BRTOS_DEALLOC(mpool->OSMsgMemory);
+  BRTOS_DEALLOC(mpool);
+  
+  *pool = NULL;
+  
+  // Exit Critical Section
+  OSExitCritical();
+  
+  return(DELETE_EVENT_OK);
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Message Alloc / Free Functions              /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+void *OSMsgAlloc(BRTOS_MsgPool *pool)
+{
+  OS_MSG_HEADER *block;
+  
+  block = (OS_MSG_HEADER*)OSMemGet(pool->OSMsgMemPool);
+  if (block == NULL)
+  {
+    return NULL;
+  }
+  
+  // The message data follows the block header
+  block->OSMsgPool = pool->OSMsgMemPool;
+  return (void*)(block + 1);
+}
+
+
+INT8U OSMsgFree(void *msg)
+{
+  OS_MSG_HEADER *block;
+  
+  if (msg == NULL)
+  {
+    return(NULL_EVENT_POINTER);
+  }
+  
+  block = ((OS_MSG_HEADER*)msg) - 1;
+  
+  return OSMemPut(block->OSMsgPool, (void*)block);
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Message Queue Functions                     /////
+/////                                                  /////
+/////      Dynamic queues of message pointers          /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSMsgQueueCreate(INT16U queue_length, BRTOS_Queue **event)
+{
+  return OSDQueueCreate(queue_length, sizeof(void*), event);
+}
+
+
+INT8U OSMsgQueueDelete(BRTOS_Queue **event)
+{
+  void *msg;
+  
+  // Return the messages still in the queue to their pools
+  while(OSDQueuePend(*event, &msg, NO_TIMEOUT) == READ_BUFFER_OK)
+  {
+    (void)OSMsgFree(msg);
+  }
+  
+  return OSDQueueDelete(event);
+}
+
+
+INT8U OSMsgQueuePost(BRTOS_Queue *pont_event, void *msg)
+{
+  // Only the message pointer is written in the queue
+  return OSDQueuePost(pont_event, &msg);
+}
+
+
+INT8U OSMsgQueuePend(BRTOS_Queue *pont_event, void **msg, INT16U time_wait)
+{
+  return OSDQueuePend(pont_event, msg, time_wait);
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#endif
+
+
+
+#if (BRTOS_SPSC_QUEUE_EN == 1)
+
+///// Memory allocation definition tests
+#ifndef BRTOS_ALLOC
+	#error("You must define the BRTOS memory allocation method in BRTOSConfig.h file !!!")
+#endif
+
+#ifndef BRTOS_DEALLOC
+	#error("You must define the BRTOS memory deallocation method in BRTOSConfig.h file !!!")
+#endif
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Create SPSC Queue Function                  /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSSPSCQueueCreate(INT16U queue_length, OS_CPU_TYPE type_size, BRTOS_SPSC_Queue **queue)
+{
+  OS_SR_SAVE_VAR
+  INT32U            size_in_bytes = 0;
+  BRTOS_SPSC_Queue  *cqueue       = NULL;
+  
+  if (iNesting > 0) {                                // See if caller is an interrupt
+     return(IRQ_PEND_ERR);                           // Can't be create by interrupt
+  }
+  
+  // One slot is always left empty to tell a full queue from an empty one,
+  // and the number of slots must fit in the native word
+  if ((queue_length == 0) || (type_size == 0) ||
+      ((INT32U)(OS_CPU_TYPE)(queue_length + 1) != ((INT32U)queue_length + 1)))
+  {
+    return(INVALID_PARAMETERS);
+  }
+  
+  size_in_bytes = ((INT32U)queue_length + 1) * (INT32U)type_size;
+  if (size_in_bytes > 0xFFFF)
+  {
+    return(INVALID_PARAMETERS);
+  }
+  
+  // Enter critical Section
+  if (currentTask)
+     OSEnterCritical();
+  
+  // Allocate the queue handler
+  cqueue = (BRTOS_SPSC_Queue*)BRTOS_ALLOC(sizeof(BRTOS_SPSC_Queue));
+  if (cqueue == NULL)
+  {
+    // Exit critical Section
+    if (currentTask)
+       OSExitCritical();
+    
+    return(NO_AVAILABLE_MEMORY);
+  }
+  
+  // Allocate the queue in the heap
+  cqueue->OSQStart = (volatile INT8U*)BRTOS_ALLOC((INT16U)size_in_bytes);
+  if (cqueue->OSQStart == NULL)
+  {
+    // Deallocate queue handler
+    BRTOS_DEALLOC(cqueue);
+    
+    // Exit critical Section
+    if (currentTask)
+       OSExitCritical();
+    
+    return(NO_AVAILABLE_MEMORY);
+  }
+  
+  // Exit critical Section
+  if (currentTask)
+     OSExitCritical();
+  
+  // Signal used only when the consumer is blocked
+  if (OSSemBinaryCreate(0, &cqueue->OSQSignal) != ALLOC_EVENT_OK)
+  {
+    BRTOS_DEALLOC((void*)cqueue->OSQStart);
+    BRTOS_DEALLOC(cqueue);
+    return(NO_AVAILABLE_EVENT);
+  }
+  
+  cqueue->OSQTSize   = (INT16U)type_size;
+  cqueue->OSQSlots   = (OS_CPU_TYPE)(queue_length + 1);
+  cqueue->OSQIn      = 0;
+  cqueue->OSQOut     = 0;
+  cqueue->OSQWaitSeq   = 0;
+  cqueue->OSQSignalSeq = 0;
+  
+  *queue = cqueue;
+  
+  return(ALLOC_EVENT_OK);
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Delete SPSC Queue Function                  /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSSPSCQueueDelete(BRTOS_SPSC_Queue **queue)
+{
+  OS_SR_SAVE_VAR
+  BRTOS_SPSC_Queue *cqueue = *queue;
+  
+  if (iNesting > 0) {                                // See if caller is an interrupt
+      return(IRQ_PEND_ERR);                          // Can't be delete by interrupt
+  }
+  
+  (void)OSSemDelete(&cqueue->OSQSignal);
+  
+  // Enter Critical Section
+  OSEnterCritical();
+  
+  BRTOS_DEALLOC((void*)cqueue->OSQStart);
+  BRTOS_DEALLOC(cqueue);
+  
+  *queue = NULL;
+  
+  // Exit Critical Section
+  OSExitCritical();
+  
+  return(DELETE_EVENT_OK);
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      SPSC Queue Pend Function                    /////
+/////                                                  /////
+/////      Only the consumer writes OSQOut             /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSSPSCQueuePend(BRTOS_SPSC_Queue *queue, void *pdata, INT16U time_wait)
+{
+  OS_CPU_TYPE     out;
+  INT16U          n;
+  INT8U           *dst;
+  volatile INT8U  *src;
+  INT32U          deadline = 0;
+  INT32U          remaining;
+  
+  #if (ERROR_CHECK == 1)
+    /// Can not use Queue pend function from interrupt handling code
+    if(iNesting > 0)
+    {
+      return(IRQ_PEND_ERR);
+    }
+  #endif
+  
+  // The timeout covers the whole call, a retry only waits for the time left
+  if ((time_wait != 0) && (time_wait != NO_TIMEOUT))
+  {
+    deadline = OSGetMonotonicCount() + (INT32U)time_wait;
+  }
+  
+  for(;;)
+  {
+    out = queue->OSQOut;
+    
+    // Verify if there is data in the queue
+    if (out != queue->OSQIn)
+    {
+      // The data must be read before the index is seen by the producer
+      OS_MEMORY_BARRIER();
+      
+      src = queue->OSQStart + ((INT32U)out * queue->OSQTSize);
+      dst = (INT8U*)pdata;
+      n   = queue->OSQTSize;
+      
+      // Copy data from queue
+      while(n)
+      {
+        *dst++ = *src++;
+        n--;
+      }
+      
+      OS_MEMORY_BARRIER();
+      
+      // Release the slot
+      out++;
+      if (out == queue->OSQSlots) out = 0;
+      queue->OSQOut = out;
+      
+      return READ_BUFFER_OK;
+    }
+    
+    // If no timeout is used and the queue is empty, exit the queue with an error
+    if (time_wait == NO_TIMEOUT)
+    {
+      return EXIT_BY_NO_ENTRY_AVAILABLE;
+    }
+    
+    if (time_wait != 0)
+    {
+      remaining = deadline - OSGetMonotonicCount();
+      if ((INT32S)remaining <= 0)
+      {
+        return TIMEOUT;
+      }
+      time_wait = (INT16U)remaining;
+    }
+    
+    // Ask the producer to signal the next post and verify again,
+    // since a post may have occurred before the request was seen
+    queue->OSQWaitSeq++;
+    OS_MEMORY_BARRIER();
+    
+    if (out != queue->OSQIn)
+    {
+      continue;
+    }
+    
+    // A request left by a timeout is answered by the next post, so the
+    // semaphore may hold a stale post and the queue is always verified
+    // again after it returns
+    (void)OSSemPend(queue->OSQSignal, time_wait);
+  }
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      SPSC Queue Post Function                    /////
+/////                                                  /////
+/////      Only the producer writes OSQIn              /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSSPSCQueuePost(BRTOS_SPSC_Queue *queue, const void *pdata)
+{
+  OS_CPU_TYPE     in;
+  OS_CPU_TYPE     next;
+  OS_CPU_TYPE     seq;
+  INT16U          n;
+  const INT8U     *src;
+  volatile INT8U  *dst;
+  
+  in   = queue->OSQIn;
+  next = (OS_CPU_TYPE)(in + 1);
+  if (next == queue->OSQSlots) next = 0;
+  
+  // Verify if the queue is full
+  if (next == queue->OSQOut)
+  {
+    return BUFFER_UNDERRUN;
+  }
+  
+  // The slot must be released by the consumer before it is written
+  OS_MEMORY_BARRIER();
+  
+  dst = queue->OSQStart + ((INT32U)in * queue->OSQTSize);
+  src = (const INT8U*)pdata;
+  n   = queue->OSQTSize;
+  
+  // Copy data to queue
+  while(n)
+  {
+    *dst++ = *src++;
+    n--;
+  }
+  
+  // The data must be written before the index is seen by the consumer
+  OS_MEMORY_BARRIER();
+  queue->OSQIn = next;
+  OS_MEMORY_BARRIER();
+  
+  // Only signal the consumer if it asked for a signal
+  seq = queue->OSQWaitSeq;
+  if (seq != queue->OSQSignalSeq)
+  {
+    queue->OSQSignalSeq = seq;
+    (void)OSSemPost(queue->OSQSignal);
+  }
+  
+  return WRITE_BUFFER_OK;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#endif
@@ -131,6 +131,7 @@ INT8U OSSemCreate (INT8U cnt, BRTOS_Sem **event)
   pont_event->Binary = FALSE;
 #endif
   pont_event->OSEventWaitList=0;
+  OS_EVENT_GROUP_INIT(pont_event);
 
   *event = pont_event;
 
@@ -207,6 +208,7 @@ INT8U OSSemBinaryCreate (INT8U bit, BRTOS_Sem **event)
   pont_event->OSEventWait  = 0;
   pont_event->Binary = TRUE;
   pont_event->OSEventWaitList=0;
+  OS_EVENT_GROUP_INIT(pont_event);
   
   *event = pont_event;
   
@@ -251,6 +253,7 @@ INT8U OSSemDelete (BRTOS_Sem **event)
   pont_event->OSEventWait      = 0;
   
   pont_event->OSEventWaitList=0;
+  OS_EVENT_GROUP_UNLINK(pont_event);
   
   *event = NULL;
   
@@ -269,6 +272,114 @@ INT8U OSSemDelete (BRTOS_Sem **event)
 
 
 
+#if (BRTOS_SEM_FAST_EN == 1)
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Semaphore Fast Path Functions               /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+// Count and wait counter of a semaphore, as swapped by OS_CPU_CAS16
+typedef union
+{
+  INT16U Word;
+  INT8U  Byte[2];                                   // [0] count, [1] wait counter
+} OS_SEM_STATE;
+
+// Takes a count without the critical section. Fails when the count is zero and
+// the pend must go through the critical section, where the task may block, or
+// when an event group is linked
+static INT8U OSSemFastPend(BRTOS_Sem *pont_event)
+{
+  OS_SEM_STATE state;
+  INT16U       expected;
+
+  #if (ERROR_CHECK == 1)
+    // Deleted semaphores get the error from the critical section path
+    if (pont_event->OSEventAllocated != TRUE)
+    {
+      return FALSE;
+    }
+  #endif
+
+  // The event group flag is set again by the critical section path
+  #if (BRTOS_EVENT_GROUP_EN == 1)
+    if (pont_event->OSEventGroup != NULL)
+    {
+      return FALSE;
+    }
+  #endif
+
+  do
+  {
+    state.Word = pont_event->OSEventState;
+    if (state.Byte[0] == 0)
+    {
+      return FALSE;
+    }
+    expected = state.Word;
+    state.Byte[0]--;
+  } while (OS_CPU_CAS16(&pont_event->OSEventState, expected, state.Word) == FALSE);
+
+  return TRUE;
+}
+
+// Gives a count without the critical section. Fails when a task must be woken,
+// an event group must be signaled or the count would overflow
+static INT8U OSSemFastPost(BRTOS_Sem *pont_event)
+{
+  OS_SEM_STATE state;
+  INT16U       expected;
+
+  #if (ERROR_CHECK == 1)
+    // Deleted semaphores get the error from the critical section path
+    if (pont_event->OSEventAllocated != TRUE)
+    {
+      return FALSE;
+    }
+  #endif
+
+  // A link made by a task that preempts this post acts as if it came after the post
+  #if (BRTOS_EVENT_GROUP_EN == 1)
+    if (pont_event->OSEventGroup != NULL)
+    {
+      return FALSE;
+    }
+  #endif
+
+  do
+  {
+    state.Word = pont_event->OSEventState;
+    if ((state.Byte[1] != 0) || (state.Byte[0] == 255))
+    {
+      return FALSE;
+    }
+    expected = state.Word;
+    #if (BRTOS_BINARY_SEM_EN == 1)
+    if (pont_event->Binary == TRUE)
+    {
+      state.Byte[0] = TRUE;
+    }
+    else
+    #endif
+    {
+      state.Byte[0]++;
+    }
+  } while (OS_CPU_CAS16(&pont_event->OSEventState, expected, state.Word) == FALSE);
+
+  return TRUE;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+#endif
+
+
+
+
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 /////      Semaphore Pend Function                     /////
@@ -278,7 +389,6 @@ INT8U OSSemDelete (BRTOS_Sem **event)
 INT8U OSSemPend (BRTOS_Sem *pont_event, INT16U time_wait)
 {
   OS_SR_SAVE_VAR
-  INT8U  iPriority = 0;
   INT32U timeout;
   ContextType *Task;
   
@@ -295,6 +405,14 @@ INT8U OSSemPend (BRTOS_Sem *pont_event, INT16U time_wait)
       return(NULL_EVENT_POINTER);
     }
   #endif
+
+  #if (BRTOS_SEM_FAST_EN == 1)
+    // Available count, no need to touch the wait list
+    if (OSSemFastPend(pont_event) == TRUE)
+    {
+      return OK;
+    }
+  #endif
     
   // Enter Critical Section
   OSEnterCritical();
@@ -310,13 +428,9 @@ INT8U OSSemPend (BRTOS_Sem *pont_event, INT16U time_wait)
   #endif
   
   // BRTOS TRACE SUPPORT
-  #if (OSTRACE == 1)     
-      #if(OS_TRACE_BY_TASK == 1)
-      Update_OSTrace(currentTask, SEMPEND);
-      #else
-      Update_OSTrace(ContextTask[currentTask].Priority, SEMPEND);
-      #endif
-  #endif    
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_SEM_PEND, OS_TRACE_ADDR(pont_event));
+  #endif
 
   // Verify if there was a post
   if (pont_event->OSEventCount > 0)
@@ -324,6 +438,9 @@ INT8U OSSemPend (BRTOS_Sem *pont_event, INT16U time_wait)
     // Decreases semaphore count
     pont_event->OSEventCount--;
     
+    // Keeps the event group flag set while counts are left
+    OS_EVENT_GROUP_REARM(pont_event, pont_event->OSEventCount > 0);
+    
     // Exit Critical Section
     OSExitCritical();
     return OK;
@@ -338,13 +455,11 @@ INT8U OSSemPend (BRTOS_Sem *pont_event, INT16U time_wait)
  
   Task = (ContextType*)&ContextTask[currentTask];
     
-  // Copy task priority to local scope
-  iPriority = Task->Priority;
   // Increases the semaphore wait list counter
   pont_event->OSEventWait++;
   
   // Allocates the current task on the semaphore wait list
-  pont_event->OSEventWaitList = pont_event->OSEventWaitList | (PriorityMask[iPriority]);
+  OSEventWaitListInsert(pont_event, Task);
   
   // Task entered suspended state, waiting for semaphore post
   #if (VERBOSE == 1)
@@ -353,7 +468,7 @@ INT8U OSSemPend (BRTOS_Sem *pont_event, INT16U time_wait)
   #endif
   
   // Remove current task from the Ready List
-  OSReadyList = OSReadyList & ~(PriorityMask[iPriority]);
+  OSReadyListRemove(Task);
   
   // Set timeout overflow
   if (time_wait)
@@ -396,10 +511,10 @@ INT8U OSSemPend (BRTOS_Sem *pont_event, INT16U time_wait)
       if(Task->TimeToWait == EXIT_BY_TIMEOUT)
       {
           // Test if both timeout and post have occured before arrive here
-          if ((pont_event->OSEventWaitList & PriorityMask[iPriority]))
+          if (OSEventWaitListContains(pont_event, Task))
           {
             // Remove the task from the queue wait list
-            pont_event->OSEventWaitList = pont_event->OSEventWaitList & ~(PriorityMask[iPriority]);
+            OSEventWaitListRemove(pont_event, Task);
             
             // Decreases the queue wait list counter
             pont_event->OSEventWait--;
@@ -446,9 +561,7 @@ INT8U OSSemPost(BRTOS_Sem *pont_event)
 {
   OS_SR_SAVE_VAR  
   INT8U iPriority = (INT8U)0;
-  #if (VERBOSE == 1)
   INT8U TaskSelect = 0;
-  #endif
   
   #if (ERROR_CHECK == 1)    
     // Verifies if the pointer is NULL
@@ -458,6 +571,14 @@ INT8U OSSemPost(BRTOS_Sem *pont_event)
     }
   #endif
 
+  #if (BRTOS_SEM_FAST_EN == 1)
+    // Nobody waits, the count is given without the critical section
+    if (OSSemFastPost(pont_event) == TRUE)
+    {
+      return OK;
+    }
+  #endif
+
   // Enter Critical Section
   #if (NESTING_INT == 0)
   if (!iNesting)
@@ -478,37 +599,25 @@ INT8U OSSemPost(BRTOS_Sem *pont_event)
   #endif
      
   // BRTOS TRACE SUPPORT
-  #if (OSTRACE == 1)  
-    if(!iNesting){ 
-      #if(OS_TRACE_BY_TASK == 1)
-      Update_OSTrace(currentTask, SEMPOST);
-      #else
-      Update_OSTrace(ContextTask[currentTask].Priority, SEMPOST);
-      #endif
-    }else{
-      Update_OSTrace(0, SEMPOST);
-    }
-  #endif      
+  #if (OSTRACE == 1)
+  OSTraceWrite(OS_TRACE_SEM_POST, OS_TRACE_ADDR(pont_event));
+  #endif
   
   // See if any task is waiting for semaphore
   if (pont_event->OSEventWait != 0)
   {
-    // Selects the highest priority task
-    iPriority = SAScheduler(pont_event->OSEventWaitList);    
-
-    // Remove the selected task from the semaphore wait list
-    pont_event->OSEventWaitList = pont_event->OSEventWaitList & ~(PriorityMask[iPriority]);
+    // Selects the highest priority task and removes it from the semaphore wait list
+    TaskSelect = OSEventWaitListTake(pont_event, iPriority);
     
     // Decreases the semaphore wait list counter
     pont_event->OSEventWait--;
     
     // Put the selected task into Ready List
     #if (VERBOSE == 1)
-    TaskSelect = PriorityVector[iPriority];
     ContextTask[TaskSelect].State = READY;
     #endif
     
-    OSReadyList = OSReadyList | (PriorityMask[iPriority]);
+    OSReadyListInsert(&ContextTask[TaskSelect]);
     
     // If outside of an interrupt service routine, change context to the highest priority task
     // If inside of an interrupt, the interrupt itself will change the context to the highest priority task
@@ -542,6 +651,9 @@ INT8U OSSemPost(BRTOS_Sem *pont_event)
 #else
 	pont_event->OSEventCount++;
 #endif
+    
+    // Signal a task waiting for multiple events
+    OS_EVENT_GROUP_SIGNAL(pont_event);
                          
     // Exit Critical Section
     #if (NESTING_INT == 0)
@@ -43,51 +43,208 @@
 /* private data */
 static struct {
     BRTOS_TIMER_T   mem[BRTOS_MAX_TIMER]; /* array of callback structs */            
-    BRTOS_TMR_T*    current;              /* keep current timer list */ 
-    BRTOS_TMR_T*    future;               /* keep future timer list   */
+    BRTOS_TMR_T     heap[TIMER_CLASSES];  /* running timers of each class, earliest deadline first */ 
     INT8U           handling_task;        /* caller Task ID */          
+#if (BRTOS_TMR_LATENCY_EN == 1)
+    OS_TIMER_LATENCY latency[TIMER_CLASSES];
+#endif
 } BRTOS_TIMER_VECTOR;
 
+/* heap of the timer class */
+#define TIMER_LIST(p)  (&BRTOS_TIMER_VECTOR.heap[(p)->tclass])
 
-/* soft timer lists: memory allocation */
-static BRTOS_TMR_T BRTOS_TMR_PING,BRTOS_TMR_PONG;    /* Timer lists */
 
 /* local functions */
-/* Binary heap of timers */
-#define PAI(i)    (INT8U)(i>>1)
-#define LEFT(i)   (INT8U)(i<<1)
-#define RIGHT(i)  (INT8U)((i<<1) + 1)
+/* Binary heap of timers, every move updates the timer heap_index */
+#define PAI(i)    (TIMER_IDX)((i)>>1)
+#define LEFT(i)   (TIMER_IDX)((i)<<1)
+#define RIGHT(i)  (TIMER_IDX)(((i)<<1) + 1)
 
-static void Subir (BRTOS_TIMER* timers,INT8U i) {
-     while (i > 1 && timers[PAI(i)]->timeout > timers[i]->timeout)
+static void Subir (BRTOS_TMR_T* list, TIMER_IDX i)
+{
+     BRTOS_TIMER p = list->timers[i];
+     
+     while (i > 1 && TIMER_BEFORE(p->deadline, list->timers[PAI(i)]->deadline))
      {
-         void* tmp = timers[PAI(i)];
-         timers[PAI(i)] = timers[i];
-         timers[i] = tmp;
+         list->timers[i] = list->timers[PAI(i)];
+         list->timers[i]->heap_index = i;
          i=PAI(i);
      }
+     list->timers[i] = p;
+     p->heap_index = i;
 }
 
-static void Descer (BRTOS_TIMER* timers,INT8U i, INT8U n) 
+static void Descer (BRTOS_TMR_T* list, TIMER_IDX i)
 {
-  INT8U son;
-  do{    
-    if (RIGHT(i) <= n && timers[RIGHT(i)]->timeout < timers[LEFT(i)]->timeout)
+  TIMER_IDX son;
+  BRTOS_TIMER p = list->timers[i];
+  
+  for(;;)
+  {
+    son = LEFT(i);
+    if (son > list->count) break;
+    if (son < list->count && TIMER_BEFORE(list->timers[son+1]->deadline, list->timers[son]->deadline))
     {
-       son = RIGHT(i);
+       son++;
     }
-    else 
-	{
-		son = LEFT(i);
-	}
-    if (son <= n  && timers[son]->timeout < timers[i]->timeout)
-    {
-       void* tmp = timers[son];
-       timers[son] = timers[i];
-       timers[i] = tmp;
-       i=son;     
-    }else break;
-  }while(1);
+    if (!TIMER_BEFORE(list->timers[son]->deadline, p->deadline)) break;
+    list->timers[i] = list->timers[son];
+    list->timers[i]->heap_index = i;
+    i = son;
+  }
+  list->timers[i] = p;
+  p->heap_index = i;
+}
+
+static void BRTOS_TimerInsert(BRTOS_TIMER p)
+{
+  BRTOS_TMR_T* list = TIMER_LIST(p);
+  
+  list->timers[++list->count] = p; // insert in the end
+  Subir (list, list->count);       // order it
+}
+
+static void BRTOS_TimerRemove(BRTOS_TIMER p)
+{
+  BRTOS_TMR_T* list = TIMER_LIST(p);
+  TIMER_IDX    i = p->heap_index;
+  BRTOS_TIMER  last;
+  
+  if (i == 0) return;  // not queued
+  
+  last = list->timers[list->count];
+  list->timers[list->count] = NULL;
+  list->count--;
+  p->heap_index = 0;
+  
+  if (i <= list->count)
+  {
+    // move the last timer into the hole and restore the heap order
+    list->timers[i] = last;
+    last->heap_index = i;
+    Subir (list, i);
+    Descer (list, last->heap_index);
+  }
+}
+
+/* Converts the remaining time of a deadline into a 16 bits tick count
+   of the delay list. Must be called inside a critical section. */
+static INT16U BRTOS_TimerWakeTick(TIMER_DEADLINE deadline)
+{
+  INT32U left = (INT32U)(deadline - OSGetMonotonicCount());
+  INT32U wake;
+  
+  if (TIMER_BEFORE(deadline, OSGetMonotonicCount()) || (left == 0)) left = 1;
+  if (left > TIMER_MAX_COUNTER) left = TIMER_MAX_COUNTER;
+  
+  wake = (INT32U)OSGetCount() + left;
+  if (wake >= TICK_COUNT_OVERFLOW) wake -= TICK_COUNT_OVERFLOW;
+  
+  return (INT16U)wake;
+}
+
+/* Wakes the timer task earlier if "p" became the first timer to expire.
+   Must be called inside a critical section. */
+static void BRTOS_TimerWakeUpdate(BRTOS_TIMER p)
+{
+  if(currentTask && (p->heap_index == 1) && (p->tclass == TIMER_DEFERRED))
+  {
+    OSDelayListUpdate(&ContextTask[BRTOS_TIMER_VECTOR.handling_task], BRTOS_TimerWakeTick(p->deadline));
+  }
+}
+
+#if (BRTOS_TMR_LATENCY_EN == 1)
+/* Accounts the callback latency into the histogram of the timer class.
+   Must be called inside a critical section. */
+static void BRTOS_TimerLatency(INT8U tclass, INT32U late)
+{
+  OS_TIMER_LATENCY *latency = &BRTOS_TIMER_VECTOR.latency[tclass];
+  INT8U bucket = 0;
+  
+  if (late > latency->max) latency->max = late;
+  
+  while ((late > 0) && (bucket < (TIMER_LATENCY_BUCKETS - 1)))
+  {
+    bucket++;
+    late >>= 1;
+  }
+  latency->hist[bucket]++;
+}
+#endif
+
+/* Runs the callbacks of all the timers of "list" expired up to now.
+   Used by the timer task (deferred class) and by the tick interrupt (immediate class). */
+static void BRTOS_TimerExpire(BRTOS_TMR_T *list)
+{
+  
+  OS_SR_SAVE_VAR
+  BRTOS_TIMER    p;
+  TIMER_CNT      repeat;
+  TIMER_DEADLINE now;
+  TIMER_DEADLINE deadline;
+  
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+  
+  // all the timers expired up to this tick are fired in the same batch
+  now = OSGetMonotonicCount();
+  
+  while((list->count > 0) && !TIMER_BEFORE(now, list->timers[1]->deadline))
+  {  
+      // some timer has expired
+      p = list->timers[1];
+      BRTOS_TimerRemove(p);
+      p->state = TIMER_FIRING;
+      
+      #if (BRTOS_TMR_LATENCY_EN == 1)
+      BRTOS_TimerLatency(p->tclass, (INT32U)(OSGetMonotonicCount() - p->deadline));
+      #endif
+      
+      #if (OSTRACE == 1)
+      OSTraceWrite(OS_TRACE_TIMER_FIRE, OS_TRACE_ADDR(p->func_cb));
+      #endif
+      
+      #if (NESTING_INT == 0)
+      if (!iNesting)
+      #endif
+         OSExitCritical();
+      
+      repeat = (TIMER_CNT)((p)->func_cb()); /* callback */
+      
+      #if (NESTING_INT == 0)
+      if (!iNesting)
+      #endif
+         OSEnterCritical();
+      
+      // the callback or a higher priority task may have restarted,
+      // stopped or deleted the timer meanwhile
+      if (p->state == TIMER_FIRING)
+      {
+        if (repeat > 0)
+        { /* needs to repeat after "repeat" time ? */
+            // keeps the period free of drift, unless the timer is late
+            deadline = p->deadline + repeat;
+            if (!TIMER_BEFORE(now, deadline))
+            {
+              deadline = now + repeat;
+            }
+            p->deadline = deadline;
+            p->state = TIMER_RUNNING;
+            BRTOS_TimerInsert(p);
+        } 
+        else
+        {
+            p->state = TIMER_STOPPED;
+        }             
+      }
+  }
+  
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSExitCritical();
 }
 
 /* private functions */
@@ -95,37 +252,62 @@ static void BRTOS_TimerTaskInit(void)
 {
   
   OS_SR_SAVE_VAR 
-  INT8U i; 
+  TIMER_IDX i; 
+  INT8U     c;
   
   if (currentTask)
     OSEnterCritical();
         
-    BRTOS_TIMER_VECTOR.current = &BRTOS_TMR_PING;
-    BRTOS_TIMER_VECTOR.future  = &BRTOS_TMR_PONG;
-    
-    for(i=0;i<BRTOS_MAX_TIMER;i++)
-    {           
-      BRTOS_TIMER_VECTOR.mem[i].state = TIMER_NOT_USED;
-      BRTOS_TIMER_VECTOR.mem[i].func_cb = NULL;
-      BRTOS_TIMER_VECTOR.mem[i].timeout = 0;  
-    }  
+  for(c=0;c<TIMER_CLASSES;c++)
+  {
+    BRTOS_TIMER_VECTOR.heap[c].count = 0;
+    for(i=0;i<=BRTOS_MAX_TIMER;i++)
+    {
+      BRTOS_TIMER_VECTOR.heap[c].timers[i] = NULL;
+    }
+  }
+  
+  for(i=0;i<BRTOS_MAX_TIMER;i++)
+  {           
+    BRTOS_TIMER_VECTOR.mem[i].state = TIMER_NOT_USED;
+    BRTOS_TIMER_VECTOR.mem[i].func_cb = NULL;
+    BRTOS_TIMER_VECTOR.mem[i].deadline = 0;  
+    BRTOS_TIMER_VECTOR.mem[i].heap_index = 0;  
+    BRTOS_TIMER_VECTOR.mem[i].tclass = TIMER_DEFERRED;  
+  }  
     
   if (currentTask)
      OSExitCritical();
 
 }
 
-static void BRTOS_TimerTaskSleep(TIMER_CNT next_time_to_wake)
+static void BRTOS_TimerTaskSleep(void)
 {
   
   OS_SR_SAVE_VAR
   
   ContextType *Task = (ContextType*)&ContextTask[currentTask];      
-  
-  Task->TimeToWait = next_time_to_wake;
+  BRTOS_TMR_T *list = &BRTOS_TIMER_VECTOR.heap[TIMER_DEFERRED];
   
   OSEnterCritical();
   
+  // The wake time is computed here, so a timer started after the last
+  // expiration batch is never lost
+  if (list->count > 0)
+  {
+    if (!TIMER_BEFORE(OSGetMonotonicCount(), list->timers[1]->deadline))
+    {
+      // a timer has already expired, run a new batch
+      OSExitCritical();
+      return;
+    }
+    Task->TimeToWait = BRTOS_TimerWakeTick(list->timers[1]->deadline);
+  }
+  else
+  {
+    Task->TimeToWait = BRTOS_TimerWakeTick(OSGetMonotonicCount() + TIMER_MAX_COUNTER);
+  }
+  
   // Put task into delay list
   IncludeTaskIntoDelayList();
   
@@ -134,10 +316,10 @@ static void BRTOS_TimerTaskSleep(TIMER_CNT next_time_to_wake)
     Task->SuspendedType = DELAY;
   #endif
   
-  OSReadyList = OSReadyList & ~(PriorityMask[Task->Priority]);
+  OSReadyListRemove(Task);
   
   // Change context
-  // Return to task when occur delay overflow
+  // Return to task when the first timer expires or at most after TIMER_MAX_COUNTER ticks
   ChangeContext();
   
   OSExitCritical();
@@ -152,118 +334,47 @@ void BRTOSTimerTask(void)
 #endif
 {
      
-     OS_SR_SAVE_VAR
-     BRTOS_TIMER p;
-     TIMER_CNT   tickcount;
-     TIMER_CNT   repeat;
-     INT32U      timeout;
-     TIMER_CNT   next_time_to_wake;      /* tick count of next timer */
-     BRTOS_TMR_T *list, *list_tmp;          
-     
      #if (TASK_WITH_PARAMETERS == 1)
 	 (void)param;
 	 #endif
      
      BRTOS_TIMER_VECTOR.handling_task = currentTask;
-     
-     list = BRTOS_TIMER_VECTOR.current;
-
-     p=list->timers[1];
-     if(p!= NULL)
-     {      
-       next_time_to_wake = p->timeout;
-     }
-     else
-     {
-       next_time_to_wake = TIMER_MAX_COUNTER;    
-     }
   
      for(;;)
      {
      
-        BRTOS_TimerTaskSleep(next_time_to_wake);
-
-        tickcount = OSGetTickCount();               
-
-timer_loop:         
-        list = BRTOS_TIMER_VECTOR.current;
-        p=list->timers[1];
-
-        while(p!= NULL && p->timeout <= tickcount)
-        {  
-            // some timer has expired
-            if((p)->func_cb != NULL) 
-            {                            
-              repeat = (TIMER_CNT)((p)->func_cb()); /* callback */
-              
-              OSEnterCritical(); 
-                           
-              if (repeat > 0)
-              { /* needs to repeat after "repeat" time ? */
-                  timeout = (INT32U)((INT32U)tickcount + (INT32U)repeat);                  
-                  if (timeout >= TICK_COUNT_OVERFLOW)
-                  {
-                    p->timeout = (TIMER_CNT)(timeout - TICK_COUNT_OVERFLOW);                                 
-                    list_tmp = BRTOS_TIMER_VECTOR.future; // add into future list
-                    list_tmp->timers[++list_tmp->count] = p; // insert in the end
-                    Subir(list_tmp->timers,list_tmp->count);                                      
-                    list->timers[1]=list->timers[list->count]; // remove from current list
-                    list->timers[list->count] = NULL;
-                    list->count--;                    
-                  }
-                  else
-                  {
-                    p->timeout = (TIMER_CNT)timeout;                  
-                  }                  
-               } 
-               else
-               {
-                  p->timeout = 0;  
-                  p->state = TIMER_NOT_ALLOCATED; 
-                  p->func_cb = NULL;                                  
-                  list->timers[1]=list->timers[list->count]; // remove from current list
-                  list->timers[list->count] = NULL;
-                  list->count--;                
-               }             
-             }
-             
-             Descer (list->timers, 1, list->count); // order it                         
-             p=list->timers[1];                           
-             OSExitCritical();                           
-        }
-                
-        if(tickcount == TIMER_MAX_COUNTER)
-        {
-          if(p==NULL)
-          {            
-            /* time to switch lists */
-            void* tmp = BRTOS_TIMER_VECTOR.current;                               
-            BRTOS_TIMER_VECTOR.current = BRTOS_TIMER_VECTOR.future;
-            BRTOS_TIMER_VECTOR.future = tmp; 
-            list = BRTOS_TIMER_VECTOR.current;
-            p=list->timers[1];
-          }
-          else
-          {
-            /* there is a delayed timer */
-            tickcount++;
-            goto timer_loop;            
-          }
-        }
-        
-        /* if any timer waiting, set task to wake */
-        if(p!= NULL)
-        {
-            next_time_to_wake = p->timeout;
-        }
-        else
-        {              
-            next_time_to_wake = TIMER_MAX_COUNTER;
-        }
+        BRTOS_TimerTaskSleep();
+
+        BRTOS_TimerExpire(&BRTOS_TIMER_VECTOR.heap[TIMER_DEFERRED]);
      }
   
 }
 
+#if (BRTOS_TMR_IMMEDIATE_EN == 1)
+/* Immediate timers, called by the tick interrupt */
+void OSTimerTickHandler(void)
+{
+  BRTOS_TimerExpire(&BRTOS_TIMER_VECTOR.heap[TIMER_IMMEDIATE]);
+}
+
+/* Ticks until the next immediate timer, for the tickless idle mode.
+   Called inside a critical section. */
+INT16U OSTimerNextImmediate(void)
+{
+  BRTOS_TMR_T *list = &BRTOS_TIMER_VECTOR.heap[TIMER_IMMEDIATE];
+  INT32U left;
+  
+  if (list->count == 0) return TIMER_MAX_COUNTER;
+  
+  if (!TIMER_BEFORE(OSGetMonotonicCount(), list->timers[1]->deadline)) return 0;
+  
+  left = (INT32U)(list->timers[1]->deadline - OSGetMonotonicCount());
+  if (left > TIMER_MAX_COUNTER) left = TIMER_MAX_COUNTER;
+  
+  return (INT16U)left;
+}
+#endif
+
 /* Public functions */
 
 /**
@@ -295,23 +406,20 @@ void OSTimerInit(INT16U timertask_stacksize, INT8U prio){
    must be called before any call to the other public timer functions.
   \param *cbp  soft timer pointer
   \param cb    callback function
-  \param time_wait soft timer expiration time
+  \param time_wait soft timer expiration time. If "0", the timer is created stopped
   \return success (OK) or error codes 
   \return OK success
   \return NULL_EVENT_POINTER
   \return NO_AVAILABLE_EVENT
-  \return ERR_EVENT_NO_CREATED
 */
 
-INT8U OSTimerSet (BRTOS_TIMER *cbp, FCN_CALLBACK cb, TIMER_CNT time_wait)
+static INT8U BRTOS_TimerSet (BRTOS_TIMER *cbp, FCN_CALLBACK cb, TIMER_CNT time_wait, INT8U tclass)
 {
     
     OS_SR_SAVE_VAR
     
-    INT8U i;     
+    TIMER_IDX i;     
     BRTOS_TIMER p;
-    INT32U timeout;
-    BRTOS_TMR_T* list;
     
     if((cb == NULL) || (cbp == NULL)) return NULL_EVENT_POINTER;    /* return error code */        
     
@@ -331,15 +439,6 @@ INT8U OSTimerSet (BRTOS_TIMER *cbp, FCN_CALLBACK cb, TIMER_CNT time_wait)
         // Return error code
         return(NO_AVAILABLE_EVENT);
       }
-      if(BRTOS_TIMER_VECTOR.mem[i].state == TIMER_NOT_ALLOCATED){
-        
-        // Exit critical Section
-        if (currentTask)
-           OSExitCritical();
-        
-        // Return error code
-        return(ERR_EVENT_NO_CREATED);
-      }
       
       if(BRTOS_TIMER_VECTOR.mem[i].state == TIMER_NOT_USED)
       {        
@@ -350,40 +449,18 @@ INT8U OSTimerSet (BRTOS_TIMER *cbp, FCN_CALLBACK cb, TIMER_CNT time_wait)
     
     p->state = TIMER_STOPPED;
     p->func_cb = cb;  // store callback function
+    p->heap_index = 0;
+    p->tclass = tclass;
     
        
     if(time_wait > 0)
     {      
-    
-      timeout = (INT32U)((INT32U)OSGetCount() + (INT32U)time_wait);
-      
-      if (timeout >= TICK_COUNT_OVERFLOW)
-      {
-        p->timeout = (INT16U)(timeout - TICK_COUNT_OVERFLOW);
-        list = BRTOS_TIMER_VECTOR.future;   // add into future list
-        list->timers[++list->count] = p; // insert in the end                            
-        Subir (list->timers, list->count); // order it 
-      }
-      else
-      {
-        p->timeout = (INT16U)timeout;
-        list = BRTOS_TIMER_VECTOR.current;  // add into current list
-        list->timers[++list->count] = p; // insert in the end                            
-        Subir (list->timers, list->count); // order it 
-        
-        // may need to change wake time of timer task
-        if(currentTask)
-        {          
-          if(p->timeout == (list->timers[1])->timeout)
-          {
-            ContextTask[BRTOS_TIMER_VECTOR.handling_task].TimeToWait = p->timeout;
-          }
-        }
-                         
-      }      
-              
+      p->deadline = OSGetMonotonicCount() + time_wait;
       p->state = TIMER_RUNNING;      
-                                            
+      BRTOS_TimerInsert(p);
+      
+      // may need to change wake time of timer task
+      BRTOS_TimerWakeUpdate(p);
     }
     
     *cbp = p;  
@@ -394,6 +471,29 @@ INT8U OSTimerSet (BRTOS_TIMER *cbp, FCN_CALLBACK cb, TIMER_CNT time_wait)
     return OK;
 }
 
+INT8U OSTimerSet (BRTOS_TIMER *cbp, FCN_CALLBACK cb, TIMER_CNT time_wait)
+{
+    return BRTOS_TimerSet(cbp, cb, time_wait, TIMER_DEFERRED);
+}
+
+#if (BRTOS_TMR_IMMEDIATE_EN == 1)
+/**
+  \fn INT8U OSTimerSetImmediate (BRTOS_TIMER *cbp, FCN_CALLBACK cb, TIMER_CNT time_wait) 
+  \brief public function to create and start a soft timer whose callback
+   runs from the tick interrupt. The callback must be ISR safe.
+  \param *cbp  soft timer pointer
+  \param cb    callback function
+  \param time_wait soft timer expiration time. If "0", the timer is created stopped
+  \return OK success
+  \return NULL_EVENT_POINTER
+  \return NO_AVAILABLE_EVENT
+*/
+INT8U OSTimerSetImmediate (BRTOS_TIMER *cbp, FCN_CALLBACK cb, TIMER_CNT time_wait)
+{
+    return BRTOS_TimerSet(cbp, cb, time_wait, TIMER_IMMEDIATE);
+}
+#endif
+
 /**
   \fn TIMER_CNT BRTOS_TimerGet (BRTOS_TIMER p)
   \brief public function to get remaining time of a soft timer
@@ -404,8 +504,8 @@ TIMER_CNT OSTimerGet (BRTOS_TIMER p)
 {
      
      OS_SR_SAVE_VAR
-     TIMER_CNT timeout;
-     TIMER_CNT tickcount;
+     TIMER_CNT timeout = 0;
+     TIMER_DEADLINE tickcount;
      
      if((p!= NULL) && (p->state == TIMER_RUNNING))
      {
@@ -413,15 +513,11 @@ TIMER_CNT OSTimerGet (BRTOS_TIMER p)
         if (currentTask)
             OSEnterCritical();                      
              
-            tickcount =  OSGetCount();  
-            if(p->timeout >= tickcount)
-            {                
-                timeout = (TIMER_CNT)(p->timeout - tickcount);                   
-            }
-            else
-            {
-                timeout =  (TIMER_CNT)(TIMER_MAX_COUNTER - tickcount +  p->timeout + 1); 
-            }  
+        tickcount =  OSGetMonotonicCount();  
+        if(TIMER_BEFORE(tickcount, p->deadline))
+        {                
+            timeout = (TIMER_CNT)(p->deadline - tickcount);                   
+        }
                           
         if (currentTask)               
             OSExitCritical(); 
@@ -445,50 +541,22 @@ TIMER_CNT OSTimerGet (BRTOS_TIMER p)
 INT8U OSTimerStart (BRTOS_TIMER p, TIMER_CNT time_wait){
  
   OS_SR_SAVE_VAR
-  INT32U timeout;
-  BRTOS_TMR_T* list;
   
-  if(p!= NULL && time_wait != 0)
+  if(p!= NULL && time_wait != 0 && p->state != TIMER_NOT_USED)
   {
       
-      if(time_wait> TIMER_MAX_COUNTER) time_wait = TIMER_MAX_COUNTER;
-      
       if (currentTask)
           OSEnterCritical();      
-        
-      if(time_wait > 0)
-      {      
-    
-        timeout = (INT32U)((INT32U)OSGetCount() + (INT32U)time_wait);
-        
-        if (timeout >= TICK_COUNT_OVERFLOW)
-        {
-          p->timeout = (TIMER_CNT)(timeout - TICK_COUNT_OVERFLOW);
-          list = BRTOS_TIMER_VECTOR.future;   // add into future list
-          list->timers[++list->count] = p; // insert in the end                            
-          Subir (list->timers, list->count); // order it 
-        }
-        else
-        {
-          p->timeout = (TIMER_CNT)timeout;
-          list = BRTOS_TIMER_VECTOR.current;  // add into current list
-          list->timers[++list->count] = p; // insert in the end                            
-          Subir (list->timers, list->count); // order it 
-          
-          // may need to change wake time of timer task
-          if(currentTask)
-          {          
-            if(p->timeout == (list->timers[1])->timeout)
-            {
-              ContextTask[BRTOS_TIMER_VECTOR.handling_task].TimeToWait = p->timeout;
-            }
-          }
-                           
-        }      
-                
-        p->state = TIMER_RUNNING;     
-                                              
-      }                                       
+      
+      // restarting a running timer only moves it inside the heap
+      BRTOS_TimerRemove(p);
+      
+      p->deadline = OSGetMonotonicCount() + time_wait;
+      p->state = TIMER_RUNNING;     
+      BRTOS_TimerInsert(p);
+      
+      // may need to change wake time of timer task
+      BRTOS_TimerWakeUpdate(p);
              
       if (currentTask)               
           OSExitCritical();  
@@ -511,45 +579,19 @@ INT8U OSTimerStart (BRTOS_TIMER p, TIMER_CNT time_wait){
 INT8U OSTimerStop (BRTOS_TIMER p, INT8U del){
   
   OS_SR_SAVE_VAR
-  BRTOS_TMR_T* list;
-  INT8U pos_timer = 0;
   
   if(p != NULL)
   {
   
       if (currentTask)
           OSEnterCritical();
-     
-        
-        if(p->timeout >= OSGetCount())
-        {                
-           list = BRTOS_TIMER_VECTOR.current;  // remove from current list   
-        }
-        else
-        {
-           list = BRTOS_TIMER_VECTOR.future;   // remove from future list
-        }  
-        
-        /* search timer index */
-        p->state = TIMER_SEARCH;
-        for(pos_timer = 1; pos_timer <= list->count; pos_timer++)
-        {
-        	if(list->timers[pos_timer]->state == TIMER_SEARCH)
-        	{
-        		break;
-        	}
-        }
-        
-        p->timeout = 0;
-        Subir (list->timers, pos_timer); // order it 
-        list->timers[1]=list->timers[list->count]; // remove from current list
-        list->timers[list->count] = NULL;
-        list->count--; 
-        Descer (list->timers, 1, list->count); // order it
+      
+        // the stored heap index avoids searching the timer
+        BRTOS_TimerRemove(p);
         
         if(del > 0)
         {                     
-          p->state = TIMER_NOT_ALLOCATED; 
+          p->state = TIMER_NOT_USED; 
           p->func_cb = NULL; 
         }
         else
@@ -566,6 +608,34 @@ INT8U OSTimerStop (BRTOS_TIMER p, INT8U del){
 }
 
 
+#if (BRTOS_TMR_LATENCY_EN == 1)
+/**
+  \fn INT8U OSTimerGetLatency (INT8U tclass, OS_TIMER_LATENCY *latency)
+  \brief public function to get the callback latency histogram of a timer class
+  \param tclass   TIMER_DEFERRED or TIMER_IMMEDIATE
+  \param latency  copy of the histogram
+  \return OK success
+  \return NULL_EVENT_POINTER error code
+*/
+INT8U OSTimerGetLatency (INT8U tclass, OS_TIMER_LATENCY *latency)
+{
+  OS_SR_SAVE_VAR
+  
+  if ((latency == NULL) || (tclass >= TIMER_CLASSES)) return NULL_EVENT_POINTER;
+  
+  if (currentTask)
+      OSEnterCritical();
+  
+  *latency = BRTOS_TIMER_VECTOR.latency[tclass];
+  
+  if (currentTask)
+      OSExitCritical();
+  
+  return OK;
+}
+#endif
+
+
 #endif 
 #endif
 
@@ -0,0 +1,333 @@
+/**
+* \file workqueue.c
+* \brief BRTOS Work Queue functions
+*
+* Deferred interrupt work. An interrupt queues a function and its argument
+* in constant time and a worker task runs them, in batches, out of the
+* interrupt context.
+*
+**/
+/*********************************************************************************************************
+*                                               BRTOS
+*                                Brazilian Real-Time Operating System
+*                            Acronymous of Basic Real-Time Operating System
+*
+*
+*                                  Open Source RTOS under MIT License
+*
+*
+*
+*                                       OS Work Queue functions
+*
+*
+*   Revision: 1.0
+*
+*********************************************************************************************************/
+
+#include "BRTOS.h"
+
+#if (PROCESSOR == COLDFIRE_V1 && __CWCC__)
+#pragma warn_implicitconv off
+#endif
+
+#if (BRTOS_WORKQ_EN == 1)
+
+/* private data */
+static struct {
+    OS_WORK_ITEM    items[BRTOS_WORKQ_SIZE];  /* circular buffer of work items */
+    INT16U          out;                      /* oldest work item */
+    INT16U          count;                    /* waiting work items */
+    INT8U           task;                     /* worker task number, set when the worker starts */
+    INT8U           sleeping;                 /* worker task out of the ready list, waiting for work */
+    OS_WORKQ_STATS  stats;
+} OSWorkQueue;
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Worker Task                                 /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#if (TASK_WITH_PARAMETERS == 1)
+static void OSWorkQueueTask(void *param)
+#else
+static void OSWorkQueueTask(void)
+#endif
+{
+  OS_SR_SAVE_VAR
+  OS_WORK_ITEM batch[BRTOS_WORKQ_BATCH];
+  INT16U       n, i;
+  OS_TIMESTAMP_TYPE now;
+  INT32U       latency;
+  ContextType  *Task = (ContextType*)&ContextTask[currentTask];
+
+  #if (TASK_WITH_PARAMETERS == 1)
+  (void)param;
+  #endif
+
+  // The submissions wake up this task
+  OSWorkQueue.task = currentTask;
+
+  for (;;)
+  {
+    // Enter Critical Section
+    OSEnterCritical();
+
+    // Sleep until a work item is submitted
+    while (OSWorkQueue.count == 0)
+    {
+      OSWorkQueue.sleeping = TRUE;
+
+      #if (VERBOSE == 1)
+      Task->State = SUSPENDED;
+      Task->SuspendedType = WORK_QUEUE;
+      #endif
+
+      // Remove the worker task from the Ready List
+      OSReadyListRemove(Task);
+
+      // Change Context - Returns on a submission
+      ChangeContext();
+
+      // Exit Critical Section
+      OSExitCritical();
+      // Enter Critical Section
+      OSEnterCritical();
+    }
+
+    // Take a batch, which frees its slots for the interrupts
+    n = OSWorkQueue.count;
+    if (n > BRTOS_WORKQ_BATCH)
+    {
+      n = BRTOS_WORKQ_BATCH;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+      batch[i] = OSWorkQueue.items[OSWorkQueue.out];
+      OSWorkQueue.out++;
+      if (OSWorkQueue.out >= BRTOS_WORKQ_SIZE)
+      {
+        OSWorkQueue.out = 0;
+      }
+    }
+    OSWorkQueue.count = (INT16U)(OSWorkQueue.count - n);
+
+    // Latency of each item, from its submission to this batch
+    now = OS_TIMESTAMP();
+    for (i = 0; i < n; i++)
+    {
+      latency = OS_TIMESTAMP_SPAN(now - batch[i].Stamp);
+      OSWorkQueue.stats.LastLatency = latency;
+      OSWorkQueue.stats.TotalLatency += latency;
+      if (latency > OSWorkQueue.stats.MaxLatency)
+      {
+        OSWorkQueue.stats.MaxLatency = latency;
+      }
+    }
+    OSWorkQueue.stats.Executed += n;
+    OSWorkQueue.stats.Batches++;
+    if (n > OSWorkQueue.stats.MaxBatch)
+    {
+      OSWorkQueue.stats.MaxBatch = n;
+    }
+
+    // Exit Critical Section
+    OSExitCritical();
+
+    for (i = 0; i < n; i++)
+    {
+      batch[i].Func(batch[i].Arg);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Work Queue Init Function                    /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSWorkQueueInit(INT16U stack_size, INT8U priority)
+{
+  OS_SR_SAVE_VAR
+
+  if (iNesting > 0) {                                // See if caller is an interrupt
+     return(IRQ_PEND_ERR);                           // Can't be init by interrupt
+  }
+
+  // Enter critical Section
+  if (currentTask)
+     OSEnterCritical();
+
+  // Work items submitted before the init stay queued
+  OSWorkQueue.sleeping = FALSE;
+
+  // Exit critical Section
+  if (currentTask)
+     OSExitCritical();
+
+  #if (TASK_WITH_PARAMETERS == 1)
+  return InstallTask(&OSWorkQueueTask, "BRTOS Work Queue", stack_size, priority, NULL, NULL);
+  #else
+  return InstallTask(&OSWorkQueueTask, "BRTOS Work Queue", stack_size, priority, NULL);
+  #endif
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Work Submit Function                        /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSWorkSubmit(OS_WORK_FUNC func, void *arg)
+{
+  OS_SR_SAVE_VAR
+  INT16U in;
+
+  #if (ERROR_CHECK == 1)
+    // Verifies if the function pointer is NULL
+    if (func == NULL)
+    {
+      return(INVALID_PARAMETERS);
+    }
+  #endif
+
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+
+  if (OSWorkQueue.count >= BRTOS_WORKQ_SIZE)
+  {
+    OSWorkQueue.stats.Overruns++;
+
+    // Exit Critical Section
+    #if (NESTING_INT == 0)
+    if (!iNesting)
+    #endif
+       OSExitCritical();
+
+    return ERR_WORKQ_FULL;
+  }
+
+  in = (INT16U)(OSWorkQueue.out + OSWorkQueue.count);
+  if (in >= BRTOS_WORKQ_SIZE)
+  {
+    in = (INT16U)(in - BRTOS_WORKQ_SIZE);
+  }
+
+  OSWorkQueue.items[in].Func  = func;
+  OSWorkQueue.items[in].Arg   = arg;
+  OSWorkQueue.items[in].Stamp = OS_TIMESTAMP();
+  OSWorkQueue.count++;
+
+  OSWorkQueue.stats.Submitted++;
+  if (OSWorkQueue.count > OSWorkQueue.stats.MaxPending)
+  {
+    OSWorkQueue.stats.MaxPending = OSWorkQueue.count;
+  }
+
+  // Wake up the worker task
+  if (OSWorkQueue.sleeping == TRUE)
+  {
+    OSWorkQueue.sleeping = FALSE;
+
+    #if (VERBOSE == 1)
+    ContextTask[OSWorkQueue.task].State = READY;
+    #endif
+
+    OSReadyListInsert(&ContextTask[OSWorkQueue.task]);
+
+    // If outside of an interrupt service routine, change context to the highest priority task
+    // If inside of an interrupt, the interrupt itself will change the context to the highest priority task
+    if (!iNesting)
+    {
+      // Verify if there is a higher priority task ready to run
+      ChangeContext();
+    }
+  }
+
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSExitCritical();
+
+  return OK;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Work Queue Query Function                   /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT8U OSWorkQueueQuery(OS_WORKQ_STATS *stats, INT8U reset)
+{
+  OS_SR_SAVE_VAR
+
+  // Enter Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSEnterCritical();
+
+  *stats = OSWorkQueue.stats;
+  stats->Pending = OSWorkQueue.count;
+
+  if (reset == TRUE)
+  {
+    OSWorkQueue.stats.Submitted    = 0;
+    OSWorkQueue.stats.Overruns     = 0;
+    OSWorkQueue.stats.Executed     = 0;
+    OSWorkQueue.stats.Batches      = 0;
+    OSWorkQueue.stats.MaxPending   = OSWorkQueue.count;
+    OSWorkQueue.stats.MaxBatch     = 0;
+    OSWorkQueue.stats.LastLatency  = 0;
+    OSWorkQueue.stats.MaxLatency   = 0;
+    OSWorkQueue.stats.TotalLatency = 0;
+  }
+
+  // Exit Critical Section
+  #if (NESTING_INT == 0)
+  if (!iNesting)
+  #endif
+     OSExitCritical();
+
+  return OK;
+}
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+#endif
@@ -44,3 +44,4 @@
 #define ARM_CM0   		9u
 #define ARM_Cortex_M4F  10u
 #define ARM_CM4F   		10u
+#define POSIX_HOST      11u
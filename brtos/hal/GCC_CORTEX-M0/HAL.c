@@ -79,6 +79,141 @@ void OSRTCSetup(void)
 
 
 
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      OS Timestamp                                /////
+/////                                                  /////
+/////      Tick count plus the elapsed SysTick clocks  /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#if (OS_TASK_RUNTIME_EN == 1) || (OSTRACE == 1) || (BRTOS_MUTEX_STATS_EN == 1) || (BRTOS_WORKQ_EN == 1)
+INT64U OSCPUTimestamp(void)
+{
+	INT32U module = configCPU_CLOCK_HZ / (INT32U)configTICK_RATE_HZ;
+	INT32U ticks  = OSGetMonotonicCount();
+	INT32U cycles = (module - 1u) - *(NVIC_SYSTICK_VAL);
+	
+	// The counter was reloaded but the tick was not processed yet
+	if (*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+	{
+		cycles = (module - 1u) - *(NVIC_SYSTICK_VAL);
+		ticks++;
+	}
+	
+	return ((INT64U)ticks * module) + cycles;
+}
+#endif
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      OS Tickless Sleep                           /////
+/////                                                  /////
+/////      Called with interrupts disabled             /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#if (TICKLESS_IDLE_EN == 1)
+INT16U OSTicklessSleep(INT16U ticks)
+{
+	INT32U module = configCPU_CLOCK_HZ / (INT32U)configTICK_RATE_HZ;
+	INT32U ctrl;
+	INT32U current;
+	INT32U reload;
+	INT32U cycles;
+	INT16U elapsed;
+	
+	// Do not sleep if a tick is already pending
+	if (*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+	{
+		return 0;
+	}
+	
+	if ((INT32U)ticks > (NVIC_SYSTICK_MAX / module))
+	{
+		ticks = (INT16U)(NVIC_SYSTICK_MAX / module);
+	}
+	
+	// Stop the tick timer and keep the cycles left to the next tick boundary
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT;
+	current = *(NVIC_SYSTICK_VAL);
+	reload  = current + (module * (INT32U)(ticks - 1u));
+	
+	*(NVIC_SYSTICK_LOAD) = reload - 1u;
+	*(NVIC_SYSTICK_VAL)  = 0;
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+	
+	// Wake up by the tick timer or by any other interrupt
+	OS_Wait;
+	
+	// Reading the control register clears the count flag
+	ctrl = *(NVIC_SYSTICK_CTRL);
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT;
+	
+	if (ctrl & NVIC_SYSTICK_COUNTFLAG)
+	{
+		// Whole period elapsed. The kernel accounts the ticks, so
+		// the pending tick interrupt must be discarded
+		elapsed = ticks;
+		*(NVIC_INT_CTRL_B) = NVIC_PENDSTCLR;
+		cycles  = module;
+	}
+	else
+	{
+		// Wake up by other interrupt. Accounts the whole ticks elapsed
+		// and completes the current tick period
+		cycles = (reload - 1u) - *(NVIC_SYSTICK_VAL);
+		if (cycles < current)
+		{
+			elapsed = 0;
+			cycles  = current - cycles;
+		}
+		else
+		{
+			cycles -= current;
+			elapsed = (INT16U)(1u + (cycles / module));
+			cycles  = module - (cycles % module);
+		}
+		
+		// A reload of 0 would never count, that tick is accounted now
+		if (cycles < 2u)
+		{
+			elapsed++;
+			cycles += module;
+		}
+	}
+	
+	// Restart the tick timer with the rest of the period, programmed while it is stopped
+	*(NVIC_SYSTICK_LOAD) = cycles - 1u;
+	*(NVIC_SYSTICK_VAL)  = 0;
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+	
+	// The normal period is set once the counter took the rest of the period,
+	// it is used from the next reload on
+	while (*(NVIC_SYSTICK_VAL) == 0)
+	{
+	}
+	*(NVIC_SYSTICK_LOAD) = module - 1u;
+	
+	return elapsed;
+}
+#endif
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
@@ -90,22 +225,16 @@ void TickTimer(void)
   // Entrada de interrup��o
   // ************************
   
+  // BRTOS TRACE SUPPORT
+  #if (OSTRACE == 1) && (OS_TRACE_TICK_EN == 1)
+  OS_TRACE_ISR_ENTER_HOOK(OS_TRACE_IRQ_TICK);
+  #endif
+  
   // Interrupt handling
   TICKTIMER_INT_HANDLER;
 
   OSIncCounter();
   
-  // BRTOS TRACE SUPPORT
-  #if (OSTRACE == 1) 
-      #if(OS_TICK_SHOW == 1) 
-          #if(OS_TRACE_BY_TASK == 1)
-          Update_OSTrace(0, ISR_TICK);
-          #else
-          Update_OSTrace(configMAX_TASK_INSTALL - 1, ISR_TICK);
-          #endif         
-      #endif       
-  #endif  
-
   #if (NESTING_INT == 1)
   OS_ENABLE_NESTING();
   #endif   
@@ -115,6 +244,11 @@ void TickTimer(void)
   // ************************
   OS_TICK_HANDLER();
   
+  // BRTOS TRACE SUPPORT
+  #if (OSTRACE == 1) && (OS_TRACE_TICK_EN == 1)
+  OS_TRACE_ISR_EXIT_HOOK(OS_TRACE_IRQ_TICK);
+  #endif
+  
   // ************************
   // Interrupt Exit
   // ************************
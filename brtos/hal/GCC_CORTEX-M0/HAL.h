@@ -104,10 +104,15 @@ extern INT32U SPvalue;
 #define NVIC_SYSTICK_CLK        		0x00000004
 #define NVIC_SYSTICK_INT        		0x00000002
 #define NVIC_SYSTICK_ENABLE     		0x00000001
+#define NVIC_SYSTICK_COUNTFLAG  		0x00010000
+#define NVIC_SYSTICK_MAX        		0x00FFFFFF					// SysTick is a 24 bits timer
+#define NVIC_PENDSTSET      			0x04000000         			// SysTick exception is pending
+#define NVIC_PENDSTCLR      			0x02000000         			// Value to clear a pending SysTick exception
 
 // ARM Cortex-Mx registers
 #define NVIC_SYSTICK_CTRL       		( ( volatile unsigned long *) 0xe000e010 )
 #define NVIC_SYSTICK_LOAD       		( ( volatile unsigned long *) 0xe000e014 )
+#define NVIC_SYSTICK_VAL       			( ( volatile unsigned long *) 0xe000e018 )
 #define NVIC_INT_CTRL_B           		( ( volatile unsigned long *) 0xe000ed04 )
 #define FPU_FPCCR						( ( volatile unsigned long *) 0xE000EF34 )
 #define NVIC_SYSPRI3					( ( volatile unsigned long *) 0xe000ed20 )
@@ -206,6 +211,18 @@ void TickTimerSetup(void);
 *********************************************************************************************/
 void OSRTCSetup(void);
 
+/*****************************************************************************************//**
+* \fn INT64U OSCPUTimestamp(void)
+* \brief High resolution timestamp, in CPU clocks, built from the tick count and SysTick.
+*  Used by the task runtime accounting, the trace, the mutex statistics and the work queue latency. Must be called with the tick interrupt masked.
+*  It is 64 bits wide because 32 bits of CPU clocks wrap around in about 89 s at 48 MHz, shorter than many blocking times.
+* \return current timestamp
+*********************************************************************************************/
+INT64U OSCPUTimestamp(void);
+#define OS_TIMESTAMP()      OSCPUTimestamp()
+#define OS_TIMESTAMP_HZ     configCPU_CLOCK_HZ
+#define OS_TIMESTAMP_TYPE   INT64U
+
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
@@ -377,4 +377,30 @@ __asm volatile   ("CLZ %1,%1      \n\t"		\
 				  : "r" (READY_LIST_VAR));	\
 return priority
 
+
+/*****************************************************************************************//**
+* \fn INT8U OSCPUCompareAndSwap16(volatile INT16U *addr, INT16U expected, INT16U desired)
+* \brief Atomic compare and swap of a 16 bits word, used by the semaphore fast path.
+*  Any exception entry or return clears the exclusive monitor, so the store fails
+*  if an interrupt or a context switch happened after the load.
+* \param addr     Word to be updated, 16 bits aligned
+* \param expected Value the word must hold
+* \param desired  New value of the word
+* \return TRUE if the word was updated, FALSE if it changed or the store failed
+*********************************************************************************************/
+__attribute__((always_inline)) static inline INT8U OSCPUCompareAndSwap16(volatile INT16U *addr, INT16U expected, INT16U desired)
+{
+  INT32U value, fail;
+
+  __asm volatile ("LDREXH %0, [%1]" : "=r" (value) : "r" (addr) : "memory");
+  if (value != expected)
+  {
+    __asm volatile ("CLREX" ::: "memory");
+    return 0;
+  }
+  __asm volatile ("STREXH %0, %2, [%1]" : "=&r" (fail) : "r" (addr), "r" (desired) : "memory");
+  return (fail == 0);
+}
+#define OS_CPU_CAS16(addr, expected, desired)   OSCPUCompareAndSwap16(addr, expected, desired)
+
 #endif
@@ -0,0 +1,645 @@
+/**
+* \file HAL.c
+* \brief BRTOS Hardware Abstraction Layer Functions.
+*
+* This file contain the functions that are processor dependant.
+*
+*
+**/
+
+/*********************************************************************************************************
+*                                               BRTOS
+*                                Brazilian Real-Time Operating System
+*                            Acronymous of Basic Real-Time Operating System
+*
+*                              
+*                                  Open Source RTOS under MIT License
+*
+*
+*
+*                                   OS HAL Functions to POSIX hosts
+*
+*
+*********************************************************************************************************/
+
+#define _XOPEN_SOURCE 700
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <ucontext.h>
+
+#include "BRTOS.h"
+
+#if (BRTOS_DYNAMIC_TASKS_ENABLED != 1)
+  #error "The POSIX port needs the dynamic tasks (BRTOS_DYNAMIC_TASKS_ENABLED)"
+#endif
+
+
+INT64U SPvalue;                               ///< Not used by this port, kept for the kernel
+
+
+/// Host context of a task
+typedef struct
+{
+  ucontext_t  context;
+  void        (*task)(void*);
+  void        *parameters;
+  void        *stack;                         ///< Host stack, reused by the next task installed in this slot
+} OS_POSIX_TASK;
+
+static OS_POSIX_TASK OSPosixTask[NUMBER_OF_TASKS];
+
+/// The task stack pointer of the kernel holds the host context of the task
+#define TASK_CONTEXT(id)   ((OS_POSIX_TASK*)(ContextTask[id].StackPoint))
+
+/// Virtual interrupt flag. Interrupts are disabled until the first task starts
+static volatile sig_atomic_t OSPosixIntDisabled = 1;
+
+/// Ticks received and not yet handled, more than one if the host delayed the signals
+static volatile INT32U OSPosixTickPending = 0;
+
+/// Tick timer
+static timer_t OSPosixTimer;
+
+/// Tick timer signals received, to check the tick suppression of the tickless idle
+volatile INT32U OSPosixTickSignals = 0;
+
+/// Virtual interrupt lines raised and not yet handled, one bit per line
+static volatile INT32U OSPosixIRQPending = 0;
+static OS_POSIX_IRQ_HANDLER OSPosixIRQHandler[OS_POSIX_IRQ_LINES];
+
+#define COMPILER_BARRIER()   __atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+static void OSPosixTick(void);
+static void OSPosixIRQ(void);
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      OS Virtual Interrupt Flag                   /////
+/////                                                  /////
+/////      A tick signal received with the interrupts  /////
+/////      disabled is kept pending until they are     /////
+/////      enabled again                               /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+INT32U OS_CPU_SR_Save(void)
+{
+	INT32U sr = (INT32U)OSPosixIntDisabled;
+	
+	OSPosixIntDisabled = 1;
+	COMPILER_BARRIER();
+	return sr;
+}
+
+
+void OS_CPU_SR_Restore(INT32U SR)
+{
+	COMPILER_BARRIER();
+	if (SR == 0)
+	{
+		OSPosixEnableInt();
+	}
+}
+
+
+void OSPosixDisableInt(void)
+{
+	OSPosixIntDisabled = 1;
+	COMPILER_BARRIER();
+}
+
+
+void OSPosixEnableInt(void)
+{
+	COMPILER_BARRIER();
+	OSPosixIntDisabled = 0;
+	COMPILER_BARRIER();
+	
+	// Runs the tick and the lines received while the interrupts were disabled
+	while (OSPosixTickPending || OSPosixIRQPending)
+	{
+		OSPosixIntDisabled = 1;
+		COMPILER_BARRIER();
+		if (OSPosixTickPending)
+		{
+			(void)__atomic_fetch_sub(&OSPosixTickPending, 1, __ATOMIC_SEQ_CST);
+			OSPosixTick();
+		}
+		if (OSPosixIRQPending)
+		{
+			OSPosixIRQ();
+		}
+		COMPILER_BARRIER();
+		OSPosixIntDisabled = 0;
+		COMPILER_BARRIER();
+	}
+}
+
+
+void OSPosixWait(void)
+{
+	// Sleeps until the next signal
+	(void)pause();
+}
+
+
+void CriticalDecNesting(void)
+{
+	UserEnterCritical();
+	iNesting--;
+}
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      OS Tick Timer Setup                         /////
+/////                                                  /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+static void TickTimer(int sig)
+{
+	int overrun;
+	
+	(void)sig;
+	
+	OSPosixTickSignals++;
+	
+	// The expirations of the timer while its signal was still pending are
+	// merged in one signal, they are counted as ticks instead of being lost
+	overrun = timer_getoverrun(OSPosixTimer);
+	(void)__atomic_fetch_add(&OSPosixTickPending, (INT32U)(1 + ((overrun > 0) ? overrun : 0)), __ATOMIC_SEQ_CST);
+	
+	if (OSPosixIntDisabled)
+	{
+		return;
+	}
+	
+	OSPosixEnableInt();
+}
+
+
+void TickTimerSetup(void)
+{
+	struct sigaction action;
+	struct sigevent event;
+	struct itimerspec timer;
+	
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = TickTimer;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	(void)sigaction(SIGALRM, &action, NULL);
+	
+	memset(&event, 0, sizeof(event));
+	event.sigev_notify = SIGEV_SIGNAL;
+	event.sigev_signo  = SIGALRM;
+	(void)timer_create(CLOCK_MONOTONIC, &event, &OSPosixTimer);
+	
+	timer.it_interval.tv_sec  = 0;
+	timer.it_interval.tv_nsec = 1000000000L / configTICK_RATE_HZ;
+	timer.it_value = timer.it_interval;
+	(void)timer_settime(OSPosixTimer, 0, &timer, NULL);
+}
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      OS Tickless Sleep                           /////
+/////                                                  /////
+/////      Called with interrupts disabled             /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#if (TICKLESS_IDLE_EN == 1)
+INT16U OSTicklessSleep(INT16U ticks)
+{
+	INT64U period = 1000000000u / configTICK_RATE_HZ;
+	INT64U current;
+	INT64U left;
+	INT64U periods;
+	struct itimerspec timer;
+	sigset_t wake;
+	sigset_t old;
+	
+	// Do not sleep if a tick or a line is already pending
+	if (OSPosixTickPending || OSPosixIRQPending)
+	{
+		return 0;
+	}
+	
+	// The signals are blocked from the test of the pending flags to the sleep
+	sigemptyset(&wake);
+	sigaddset(&wake, SIGALRM);
+	sigaddset(&wake, OS_POSIX_IRQ_SIGNAL);
+	(void)sigprocmask(SIG_BLOCK, &wake, &old);
+	
+	// Time left to the next tick boundary
+	(void)timer_gettime(OSPosixTimer, &timer);
+	current = ((INT64U)timer.it_value.tv_sec * 1000000000u) + (INT64U)timer.it_value.tv_nsec;
+	if ((current == 0) || OSPosixTickPending)
+	{
+		(void)sigprocmask(SIG_SETMASK, &old, NULL);
+		return 0;
+	}
+	
+	// The timer expires at the last tick boundary of the sleep and then
+	// goes on with the periodic tick, which is taken as a normal tick
+	left = current + (period * (INT64U)(ticks - 1u));
+	timer.it_value.tv_sec  = (time_t)(left / 1000000000u);
+	timer.it_value.tv_nsec = (long)(left % 1000000000u);
+	timer.it_interval.tv_sec  = 0;
+	timer.it_interval.tv_nsec = (long)period;
+	(void)timer_settime(OSPosixTimer, 0, &timer, NULL);
+	
+	// Wake up by the tick timer or by a virtual interrupt line
+	while (!OSPosixTickPending && !OSPosixIRQPending)
+	{
+		(void)sigsuspend(&old);
+	}
+	
+	// Tick boundaries not reached yet. If the timer has expired, it already
+	// holds the next periodic tick and its pending signal is the last tick
+	(void)timer_gettime(OSPosixTimer, &timer);
+	left = ((INT64U)timer.it_value.tv_sec * 1000000000u) + (INT64U)timer.it_value.tv_nsec;
+	periods = (left + period - 1u) / period;
+	if (periods > ticks)
+	{
+		periods = ticks;
+	}
+	
+	// Completes the current tick period
+	if (periods > 1u)
+	{
+		left -= period * (periods - 1u);
+		timer.it_value.tv_sec  = (time_t)(left / 1000000000u);
+		timer.it_value.tv_nsec = (long)(left % 1000000000u);
+		(void)timer_settime(OSPosixTimer, 0, &timer, NULL);
+	}
+	
+	(void)sigprocmask(SIG_SETMASK, &old, NULL);
+	
+	// Whole ticks elapsed, the tick left pending is processed when the
+	// interrupts are enabled again
+	return (INT16U)(ticks - periods);
+}
+#endif
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      OS Virtual Interrupt Lines                  /////
+/////                                                  /////
+/////      Host timers and devices raise a line from   /////
+/////      a signal handler or another host thread,    /////
+/////      its handler runs as an interrupt of the     /////
+/////      kernel thread                               /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+static void IRQSignal(int sig)
+{
+	(void)sig;
+	
+	if (OSPosixIntDisabled)
+	{
+		// Handled when the interrupts are enabled again
+		return;
+	}
+	
+	OSPosixIntDisabled = 1;
+	COMPILER_BARRIER();
+	if (OSPosixIRQPending)
+	{
+		OSPosixIRQ();
+	}
+	COMPILER_BARRIER();
+	OSPosixIntDisabled = 0;
+}
+
+
+void OSPosixIRQInstall(INT8U line, OS_POSIX_IRQ_HANDLER handler)
+{
+	struct sigaction action;
+	
+	if (line >= OS_POSIX_IRQ_LINES)
+	{
+		return;
+	}
+	
+	OSPosixIRQHandler[line] = handler;
+	
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = IRQSignal;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	(void)sigaction(OS_POSIX_IRQ_SIGNAL, &action, NULL);
+}
+
+
+void OSPosixIRQRaise(INT8U line)
+{
+	if (line >= OS_POSIX_IRQ_LINES)
+	{
+		return;
+	}
+	
+	(void)__atomic_fetch_or(&OSPosixIRQPending, (INT32U)1 << line, __ATOMIC_SEQ_CST);
+	
+	// Only the kernel thread takes the signal, the other host threads block it
+	(void)kill(getpid(), OS_POSIX_IRQ_SIGNAL);
+}
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      OS RTC Setup                                /////
+/////                                                  /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+void OSRTCSetup(void)
+{  
+ 
+}
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      OS Timestamp                                /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#if (OS_TASK_RUNTIME_EN == 1) || (OSTRACE == 1) || (BRTOS_MUTEX_STATS_EN == 1) || (BRTOS_WORKQ_EN == 1)
+INT64U OSCPUTimestamp(void)
+{
+	struct timespec ts;
+	
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((INT64U)ts.tv_sec * 1000000u) + ((INT64U)ts.tv_nsec / 1000u);
+}
+#endif
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Tick interrupt, with interrupts disabled    /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+static void OSPosixTick(void)
+{
+  // ************************
+  // Interrupt entry
+  // ************************
+  iNesting++;
+  
+  // BRTOS TRACE SUPPORT
+  #if (OSTRACE == 1) && (OS_TRACE_TICK_EN == 1)
+  OS_TRACE_ISR_ENTER_HOOK(OS_TRACE_IRQ_TICK);
+  #endif
+  
+  // Interrupt handling
+  TICKTIMER_INT_HANDLER;
+
+  OSIncCounter();
+    
+  // ************************
+  // Handler code for the tick
+  // ************************
+  OS_TICK_HANDLER();
+  
+  // BRTOS TRACE SUPPORT
+  #if (OSTRACE == 1) && (OS_TRACE_TICK_EN == 1)
+  OS_TRACE_ISR_EXIT_HOOK(OS_TRACE_IRQ_TICK);
+  #endif
+  
+  // ************************
+  // Interrupt Exit
+  // ************************
+  iNesting--;
+  SwitchContext();
+  // ************************
+}
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Virtual interrupt, with interrupts disabled /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+static void OSPosixIRQ(void)
+{
+  INT32U pending;
+  INT8U  line;
+  
+  // ************************
+  // Interrupt entry
+  // ************************
+  iNesting++;
+  
+  // Lines raised while the handlers run are taken in the next pass
+  pending = __atomic_exchange_n(&OSPosixIRQPending, 0, __ATOMIC_SEQ_CST);
+  
+  for (line = 0; line < OS_POSIX_IRQ_LINES; line++)
+  {
+    if ((pending & ((INT32U)1 << line)) && (OSPosixIRQHandler[line] != NULL))
+    {
+      OSPosixIRQHandler[line]();
+    }
+  }
+  
+  // ************************
+  // Interrupt Exit
+  // ************************
+  iNesting--;
+  SwitchContext();
+  // ************************
+}
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////   Switch Context                                 /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+/************************************************************//**
+* \fn void SwitchContext(void)
+* \brief Switch context routine (Internal kernel function).
+*  Called with the interrupts disabled.
+****************************************************************/
+void SwitchContext(void)
+{
+  OS_POSIX_TASK *from = TASK_CONTEXT(currentTask);
+  
+  SelectedTask = OSSchedule();
+  if (currentTask != SelectedTask)
+  {
+    currentTask = SelectedTask;
+    
+    if (from == NULL)
+    {
+      // The current task was uninstalled, its context is discarded
+      (void)setcontext(&TASK_CONTEXT(currentTask)->context);
+    }
+    (void)swapcontext(&from->context, &TASK_CONTEXT(currentTask)->context);
+  }
+}
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+void BTOSStartFirstTask(void)
+{
+	(void)setcontext(&TASK_CONTEXT(currentTask)->context);
+}
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////  Task Installation Function                      /////
+/////                                                  /////
+/////  Parameters:                                     /////
+/////  Function pointer, task priority and task name   /////
+/////                                                  /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+static void OSPosixTaskEntry(void)
+{
+	OS_POSIX_TASK *task = TASK_CONTEXT(currentTask);
+	
+	// Tasks start with the interrupts enabled
+	OSPosixEnableInt();
+	
+	task->task(task->parameters);
+	
+	// A task must not return. If it does, it is uninstalled
+	(void)OSUninstallTask(currentTask);
+	for(;;)
+	{
+		OS_Wait;
+	}
+}
+
+
+#if (TASK_WITH_PARAMETERS == 1)
+  OS_CPU_TYPE CreateDVirtualStack(void(*FctPtr)(void*), OS_CPU_TYPE stk, void *parameters)
+#else
+  OS_CPU_TYPE CreateDVirtualStack(void(*FctPtr)(void), OS_CPU_TYPE stk)
+#endif
+{  
+	OS_POSIX_TASK *task = NULL;
+	INT8U i, j;
+	
+	(void)stk;
+	
+	// Search a host context not used by any installed task
+	for (i = 0; (i < NUMBER_OF_TASKS) && (task == NULL); i++)
+	{
+		task = &OSPosixTask[i];
+		for (j = 1; j <= NUMBER_OF_TASKS; j++)
+		{
+			if (TASK_CONTEXT(j) == task)
+			{
+				task = NULL;
+				break;
+			}
+		}
+	}
+	
+	if (task == NULL)
+	{
+		return 0;
+	}
+	
+	if (task->stack == NULL)
+	{
+		task->stack = malloc(POSIX_TASK_STACK_SIZE);
+		if (task->stack == NULL)
+		{
+			return 0;
+		}
+	}
+	
+	#if (TASK_WITH_PARAMETERS == 1)
+	task->task = FctPtr;
+	task->parameters = parameters;
+	#else
+	task->task = (void(*)(void*))FctPtr;
+	task->parameters = NULL;
+	#endif
+	
+	(void)getcontext(&task->context);
+	task->context.uc_stack.ss_sp = task->stack;
+	task->context.uc_stack.ss_size = POSIX_TASK_STACK_SIZE;
+	task->context.uc_link = NULL;
+	sigemptyset(&task->context.uc_sigmask);
+	makecontext(&task->context, OSPosixTaskEntry, 0);
+    
+	return (OS_CPU_TYPE)task;
+}
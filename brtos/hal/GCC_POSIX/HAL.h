@@ -0,0 +1,259 @@
+/**
+* \file HAL.h
+* \brief BRTOS Hardware Abstraction Layer defines
+*
+* This file contain the defines that are processor dependant.
+*
+*
+**/
+
+/*********************************************************************************************************
+*                                               BRTOS
+*                                Brazilian Real-Time Operating System
+*                            Acronymous of Basic Real-Time Operating System
+*
+*                              
+*                                  Open Source RTOS under MIT License
+*
+*
+*
+*                                     OS HAL Header to POSIX hosts
+*
+*   Hosted simulation port. Each task runs in its own ucontext on a host stack,
+*   the tick timer is a periodic SIGALRM (timer_create) and the interrupts are
+*   disabled by a virtual interrupt flag, so the critical sections do not
+*   need any system call. Requires BRTOS_DYNAMIC_TASKS_ENABLED.
+*
+*********************************************************************************************************/
+
+#ifndef OS_HAL_H
+#define OS_HAL_H
+
+#include "OS_types.h"
+
+/// Supported processors
+#define COLDFIRE_V1     1u
+#define HCS08           2u
+#define MSP430          3u
+#define ATMEGA          4u
+#define PIC18           5u
+#define RX600           6u
+#define ARM_Cortex_M3   7u
+#define ARM_Cortex_M4   8u
+#define ARM_Cortex_M0   9u
+#define ARM_Cortex_M4F  10u
+#define POSIX_HOST      11u
+
+
+/// Define the used processor
+#define PROCESSOR 		POSIX_HOST
+
+/// Define the CPU type (must hold a host pointer)
+#define OS_CPU_TYPE 	INT64U
+
+/// Define MCU FPU hardware support
+#define FPU_SUPPORT			0
+
+/// Define if the optimized scheduler will be used
+#define OPTIMIZED_SCHEDULER 0
+
+/// Define if InstallTask function will support parameters
+#define TASK_WITH_PARAMETERS 1
+
+/// Define if 32 bits register for tick timer will be used
+#define TICK_TIMER_32BITS   1
+
+/// Define if nesting interrupt is active
+/// The tick signal is never nested, it is kept pending while its handler runs
+#define NESTING_INT 0
+
+/// Define the Reset Watchdog macro
+#define RESET_WATCHDOG()
+
+/// Define if its necessary to save status register / interrupt info
+#define OS_SR_SAVE_VAR INT32U CPU_SR = 0;
+
+/// Define stack growth direction
+#define STACK_GROWTH 0            /// 1 -> down; 0-> up
+
+/// Define CPU Stack Pointer Size
+#define SP_SIZE 64
+
+/// Host stack of each task, in bytes. The stack size given to InstallTask
+/// is still allocated from the BRTOS heap, but the task runs on this stack
+#ifndef POSIX_TASK_STACK_SIZE
+#define POSIX_TASK_STACK_SIZE   (64*1024)
+#endif
+
+extern INT8U iNesting;
+extern INT64U SPvalue;
+
+
+#define _PSP_SWAP2BYTE(n)   __builtin_bswap16(n)
+#define _PSP_SWAP4BYTE(n)   __builtin_bswap32(n)
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Port Defines                                /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+
+INT32U OS_CPU_SR_Save(void);
+#define  OSEnterCritical() (CPU_SR = OS_CPU_SR_Save())	 // Disable interrupts
+void OS_CPU_SR_Restore(INT32U);
+#define  OSExitCritical()  (OS_CPU_SR_Restore(CPU_SR))	 // Enable interrupts
+
+void OSPosixDisableInt(void);
+void OSPosixEnableInt(void);
+void OSPosixWait(void);
+
+/// Defines the disable interrupts command of the choosen microcontroller
+#define UserEnterCritical() OSPosixDisableInt()
+/// Defines the enable interrupts command of the choosen microcontroller
+#define UserExitCritical()  OSPosixEnableInt()
+
+/// Defines the low power command of the choosen microcontroller
+#define OS_Wait OSPosixWait();
+
+/// Defines the tick timer interrupt handler code (clear flag) of the choosen microcontroller
+#define TICKTIMER_INT_HANDLER
+
+
+// Not used, the context is saved into the host task context
+#define NUMBER_MIN_OF_STACKED_BYTES 64
+
+
+
+
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+/////      Functions Prototypes                        /////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+/*****************************************************************************************//**
+* \fn void SwitchContext(void)
+* \brief Switch to the highest priority ready task, if it is not the current one
+*  (Internal kernel function).
+* \return NONE
+*********************************************************************************************/
+void SwitchContext(void);
+
+#define ChangeContext()		SwitchContext()
+
+// The tick handler switches the context when it returns
+#define OS_INT_EXIT_EXT()
+
+#define OS_ENABLE_NESTING()
+
+
+#if (TASK_WITH_PARAMETERS == 1)
+  void CreateVirtualStack(void(*FctPtr)(void*), INT16U NUMBER_OF_STACKED_BYTES, void *parameters);
+#else
+  void CreateVirtualStack(void(*FctPtr)(void), INT16U NUMBER_OF_STACKED_BYTES);
+#endif
+
+#if (TASK_WITH_PARAMETERS == 1)
+  OS_CPU_TYPE CreateDVirtualStack(void(*FctPtr)(void*), OS_CPU_TYPE stk, void *parameters);
+#else
+  OS_CPU_TYPE CreateDVirtualStack(void(*FctPtr)(void), OS_CPU_TYPE stk);
+#endif
+
+/*****************************************************************************************//**
+* \fn void TickTimerSetup(void)
+* \brief Tick timer clock setup
+* \return NONE
+*********************************************************************************************/
+void TickTimerSetup(void);
+
+/// Tick timer signals received. With the tickless idle, the idle periods take one signal only
+extern volatile INT32U OSPosixTickSignals;
+
+/// Virtual interrupt lines of the host, all delivered by one signal to the kernel thread
+#define OS_POSIX_IRQ_LINES      8
+#define OS_POSIX_IRQ_SIGNAL     SIGUSR1
+
+typedef void (*OS_POSIX_IRQ_HANDLER)(void);
+
+/*****************************************************************************************//**
+* \fn void OSPosixIRQInstall(INT8U line, OS_POSIX_IRQ_HANDLER handler)
+* \brief Installs the handler of a virtual interrupt line. The handler runs as an
+*  interrupt: with the interrupts disabled and iNesting incremented, so it may post
+*  to the kernel services, and the context is switched when it returns.
+* \param line    Virtual interrupt line, 0 to OS_POSIX_IRQ_LINES - 1
+* \param handler Interrupt handler
+* \return NONE
+*********************************************************************************************/
+void OSPosixIRQInstall(INT8U line, OS_POSIX_IRQ_HANDLER handler);
+
+/*****************************************************************************************//**
+* \fn void OSPosixIRQRaise(INT8U line)
+* \brief Raises a virtual interrupt line. May be called from a signal handler or from
+*  another host thread, which must block OS_POSIX_IRQ_SIGNAL and SIGALRM. A line raised
+*  with the interrupts disabled is handled when they are enabled again.
+* \param line Virtual interrupt line
+* \return NONE
+*********************************************************************************************/
+void OSPosixIRQRaise(INT8U line);
+
+/*****************************************************************************************//**
+* \fn void OSRTCSetup(void)
+* \brief Real time clock setup
+* \return NONE
+*********************************************************************************************/
+void OSRTCSetup(void);
+
+/*****************************************************************************************//**
+* \fn INT64U OSCPUTimestamp(void)
+* \brief High resolution timestamp, in microseconds of the host monotonic clock.
+*  Used by the task runtime accounting, the trace, the mutex statistics and the work queue latency.
+* \return current timestamp
+*********************************************************************************************/
+INT64U OSCPUTimestamp(void);
+#define OS_TIMESTAMP()      OSCPUTimestamp()
+#define OS_TIMESTAMP_HZ     1000000u
+#define OS_TIMESTAMP_TYPE   INT64U
+
+/*****************************************************************************************//**
+* \fn INT8U OSCPUCompareAndSwap16(volatile INT16U *addr, INT16U expected, INT16U desired)
+* \brief Atomic compare and swap of a 16 bits word, used by the semaphore fast path.
+*  All the tasks run on one host thread, so the swap only has to be atomic against the
+*  tick signal: as on the single core targets, no bus lock is needed.
+* \param addr     Word to be updated
+* \param expected Value the word must hold
+* \param desired  New value of the word
+* \return TRUE if the word was updated, FALSE if it holds another value
+*********************************************************************************************/
+static inline INT8U OSCPUCompareAndSwap16(volatile INT16U *addr, INT16U expected, INT16U desired)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  INT8U swapped;
+
+  // One instruction, a signal is taken before or after it
+  __asm volatile ("cmpxchgw %3, %1" : "=@ccz" (swapped), "+m" (*addr), "+a" (expected) : "r" (desired) : "memory");
+  return swapped;
+#else
+  return (INT8U)__atomic_compare_exchange_n(addr, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+#define OS_CPU_CAS16(addr, expected, desired)   OSCPUCompareAndSwap16(addr, expected, desired)
+
+/*****************************************************************************************//**
+* \fn void BTOSStartFirstTask(void)
+* \brief Start the first task, never returns
+* \return NONE
+*********************************************************************************************/
+void BTOSStartFirstTask(void);
+
+void CriticalDecNesting(void);
+
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+
+#endif
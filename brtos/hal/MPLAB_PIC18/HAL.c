@@ -240,15 +240,9 @@ void TickTimerHandler(void)
     OSIncCounter();
 	  
 	  // BRTOS TRACE SUPPORT
-	  #if (OSTRACE == 1) 
-	      #if(OS_TICK_SHOW == 1) 
-	          #if(OS_TRACE_BY_TASK == 1)
-	          Update_OSTrace(0, ISR_TICK);
-	          #else
-	          Update_OSTrace(configMAX_TASK_INSTALL - 1, ISR_TICK);
-	          #endif         
-	      #endif       
-	  #endif  
+	  #if (OSTRACE == 1) && (OS_TRACE_TICK_EN == 1)
+	  OS_TRACE_ISR_ENTER_HOOK(OS_TRACE_IRQ_TICK);
+	  #endif
 	
 	  #if (NESTING_INT == 1)
 	  OS_ENABLE_NESTING();
@@ -259,6 +253,11 @@ void TickTimerHandler(void)
 	  // ************************
 	  OS_TICK_HANDLER();
 	  
+	  // BRTOS TRACE SUPPORT
+	  #if (OSTRACE == 1) && (OS_TRACE_TICK_EN == 1)
+	  OS_TRACE_ISR_EXIT_HOOK(OS_TRACE_IRQ_TICK);
+	  #endif
+	  
 	  // ************************
 	  // Interrupt Exit
 	  // ************************
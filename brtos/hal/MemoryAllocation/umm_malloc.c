@@ -494,7 +494,7 @@
 
 #ifndef UMM_MALLOC_CFG__DONT_BUILD
 
-#ifndef UMM_FIRST_FIT
+#if !defined UMM_FIRST_FIT && !defined UMM_SEGREGATED_FIT
 #  ifndef UMM_BEST_FIT
 #    define UMM_BEST_FIT
 #  endif
@@ -546,6 +546,20 @@ const unsigned short int umm_numblocks = (sizeof(umm_heap) / sizeof(umm_block));
 #define UMM_PFREE(b)  (UMM_BLOCK(b).body.free.prev)
 #define UMM_DATA(b)   (UMM_BLOCK(b).body.data)
 
+// ----------------------------------------------------------------------------
+// Allocation statistics, kept by umm_malloc() and umm_free()
+
+static unsigned short int umm_used_blocks = 0;
+static unsigned short int umm_peak_blocks = 0;
+
+#define UMM_ACCOUNT_MALLOC(blocks)                     \
+   umm_used_blocks += (blocks);                        \
+   if( umm_used_blocks > umm_peak_blocks )             \
+      umm_peak_blocks = umm_used_blocks
+
+#define UMM_ACCOUNT_FREE(blocks)                       \
+   umm_used_blocks -= (blocks)
+
 // ----------------------------------------------------------------------------
 // One of the coolest things about this little library is that it's VERY
 // easy to get debug information about the memory heap by simply iterating
@@ -567,6 +581,10 @@ void *umm_info( void *ptr, int force ) {
    OS_SR_SAVE_VAR
    unsigned short int blockNo = 0;
 
+   // There is no heap dump in this port, so there is nothing to force
+   //
+   (void)force;
+
    // Protect the critical section...
    //
    UMM_CRITICAL_ENTRY();
@@ -592,6 +610,9 @@ void *umm_info( void *ptr, int force ) {
          ++heapInfo.freeEntries;
          heapInfo.freeBlocks += (UMM_NBLOCK(blockNo) & UMM_BLOCKNO_MASK )-blockNo;
 
+         if( heapInfo.maxFreeContiguousBlocks < (UMM_NBLOCK(blockNo) & UMM_BLOCKNO_MASK )-blockNo )
+            heapInfo.maxFreeContiguousBlocks = (UMM_NBLOCK(blockNo) & UMM_BLOCKNO_MASK )-blockNo;
+
          // Does this block address match the ptr we may be trying to free?
 
          if( ptr == &UMM_BLOCK(blockNo) ) {
@@ -616,6 +637,9 @@ void *umm_info( void *ptr, int force ) {
    heapInfo.freeBlocks  += UMM_NUMBLOCKS-blockNo;
    heapInfo.totalBlocks += UMM_NUMBLOCKS-blockNo;
 
+   if( heapInfo.maxFreeContiguousBlocks < UMM_NUMBLOCKS-blockNo )
+      heapInfo.maxFreeContiguousBlocks = UMM_NUMBLOCKS-blockNo;
+
    // Release the critical section...
    //
    UMM_CRITICAL_EXIT();
@@ -633,6 +657,15 @@ unsigned int OSGetFreeHeapSize(void){
 	return heapInfo.freeBlocks * sizeof(umm_block);
 }
 
+unsigned int OSGetPeakHeapSize(void){
+	return umm_peak_blocks * sizeof(umm_block);
+}
+
+unsigned int OSGetMaxFreeHeapBlock(void){
+	umm_info( NULL, 0);
+	return heapInfo.maxFreeContiguousBlocks * sizeof(umm_block);
+}
+
 // ----------------------------------------------------------------------------
 
 static unsigned short int umm_blocks( size_t size ) {
@@ -668,6 +701,9 @@ static void umm_make_new_block( unsigned short int c,
    UMM_NBLOCK(c)                                = (c+blocks) | freemask;
 }
 
+#if !defined UMM_SEGREGATED_FIT
+// The single free list of the first and best fit policies
+
 // ----------------------------------------------------------------------------
 
 static void umm_disconnect_from_free_list( unsigned short int c ) {
@@ -711,6 +747,327 @@ static unsigned short int umm_assimilate_down( unsigned short int c, unsigned sh
 
    return( UMM_PBLOCK(c) );
 }
+#endif
+
+#if defined UMM_SEGREGATED_FIT
+// ----------------------------------------------------------------------------
+// Segregated fit
+//
+// The free blocks are kept in one list per size class instead of a single
+// list. The classes follow the two level scheme of TLSF: the first level is
+// the power of two of the block count and the second level splits it in
+// UMM_SL_COUNT linear steps. A bitmap of the non empty lists tells in
+// constant time the first class whose blocks are all big enough for a
+// request, so malloc() and free() never walk a list.
+//
+// The heap chain, the block format and the free block indicator are the same
+// of the other policies, so umm_info() works unchanged. The last block of
+// the chain (with a next index of 0) is the never allocated end of the heap.
+// It is not kept in a class list: freed blocks next to it are merged into it,
+// and new blocks are carved from it when no class list can serve a request.
+// ----------------------------------------------------------------------------
+
+#define UMM_SL_SHIFT   (2)
+#define UMM_SL_COUNT   (1 << UMM_SL_SHIFT)
+#define UMM_FL_COUNT   (15 - UMM_SL_SHIFT + 1)
+
+static unsigned short int umm_fl_bitmap = 0;
+static unsigned char      umm_sl_bitmap[UMM_FL_COUNT];
+static unsigned short int umm_bins[UMM_FL_COUNT][UMM_SL_COUNT];
+static unsigned short int umm_end = 0;
+
+// Index of the highest bit set of a non zero value
+
+static int umm_fls( unsigned short int x ) {
+#if defined(__GNUC__)
+   return( (int)(sizeof(unsigned int)*8 - 1) - __builtin_clz( x ) );
+#else
+   int n = 0;
+
+   while( x >>= 1 )
+      ++n;
+
+   return( n );
+#endif
+}
+
+// Index of the lowest bit set of a non zero value
+
+static int umm_ffs( unsigned short int x ) {
+#if defined(__GNUC__)
+   return( __builtin_ctz( x ) );
+#else
+   int n = 0;
+
+   while( !(x & 1) ) {
+      x >>= 1;
+      ++n;
+   }
+
+   return( n );
+#endif
+}
+
+// Size class of a free block of the given number of blocks
+
+static void umm_mapping( unsigned short int blocks, int *fl, int *sl ) {
+   int f;
+
+   if( blocks < UMM_SL_COUNT ) {
+      *fl = 0;
+      *sl = blocks;
+   } else {
+      f   = umm_fls( blocks );
+      *fl = f - UMM_SL_SHIFT + 1;
+      *sl = (blocks >> (f - UMM_SL_SHIFT)) & (UMM_SL_COUNT - 1);
+   }
+}
+
+static void umm_bin_insert( unsigned short int c ) {
+   int fl, sl;
+
+   umm_mapping( (UMM_NBLOCK(c) & UMM_BLOCKNO_MASK) - c, &fl, &sl );
+
+   UMM_NFREE(c) = umm_bins[fl][sl];
+   UMM_PFREE(c) = 0;
+   if( umm_bins[fl][sl] )
+      UMM_PFREE(umm_bins[fl][sl]) = c;
+   umm_bins[fl][sl] = c;
+
+   umm_fl_bitmap     |= (unsigned short int)(1 << fl);
+   umm_sl_bitmap[fl] |= (unsigned char)(1 << sl);
+
+   UMM_NBLOCK(c) |= UMM_FREELIST_MASK;
+}
+
+static void umm_bin_remove( unsigned short int c ) {
+   int fl, sl;
+
+   UMM_NBLOCK(c) &= (~UMM_FREELIST_MASK);
+
+   umm_mapping( UMM_NBLOCK(c) - c, &fl, &sl );
+
+   if( UMM_PFREE(c) )
+      UMM_NFREE(UMM_PFREE(c)) = UMM_NFREE(c);
+   else
+      umm_bins[fl][sl] = UMM_NFREE(c);
+
+   if( UMM_NFREE(c) )
+      UMM_PFREE(UMM_NFREE(c)) = UMM_PFREE(c);
+
+   if( 0 == umm_bins[fl][sl] ) {
+      umm_sl_bitmap[fl] &= (unsigned char)~(1 << sl);
+      if( 0 == umm_sl_bitmap[fl] )
+         umm_fl_bitmap &= (unsigned short int)~(1 << fl);
+   }
+}
+
+// First free block of a class whose blocks all hold the request, 0 if none
+
+static unsigned short int umm_bin_search( unsigned short int blocks ) {
+   unsigned int round;
+   unsigned int map;
+   int fl, sl;
+
+   // Round the request up to the next class boundary
+
+   round = blocks;
+   if( round >= UMM_SL_COUNT )
+      round += (1u << (umm_fls( blocks ) - UMM_SL_SHIFT)) - 1;
+
+   if( round > UMM_BLOCKNO_MASK )
+      return( 0 );
+
+   umm_mapping( (unsigned short int)round, &fl, &sl );
+
+   map = umm_sl_bitmap[fl] & (~0u << sl);
+   if( 0 == map ) {
+      map = umm_fl_bitmap & (~0u << (fl + 1));
+      if( 0 == map )
+         return( 0 );
+
+      fl  = umm_ffs( (unsigned short int)map );
+      map = umm_sl_bitmap[fl];
+   }
+   sl = umm_ffs( (unsigned short int)map );
+
+   return( umm_bins[fl][sl] );
+}
+
+// ----------------------------------------------------------------------------
+
+void umm_free( void *ptr ) {
+   OS_SR_SAVE_VAR
+   unsigned short int c;
+   unsigned short int n;
+
+   if( (void *)0 == ptr ) {
+      return;
+   }
+
+   UMM_TRACE_FREE( ptr );
+
+   UMM_CRITICAL_ENTRY();
+
+   c = ((char *)ptr-(char *)(&(umm_heap[0])))/sizeof(umm_block);
+
+   UMM_ACCOUNT_FREE( UMM_NBLOCK(c) - c );
+
+   // Assimilate the next block if it is free
+
+   n = UMM_NBLOCK(c);
+   if( UMM_NBLOCK(n) & UMM_FREELIST_MASK ) {
+      umm_bin_remove( n );
+      UMM_NBLOCK(c)             = UMM_NBLOCK(n);
+      UMM_PBLOCK(UMM_NBLOCK(c)) = c;
+   }
+
+   // Then assimilate with the previous block if it is free
+
+   n = UMM_PBLOCK(c);
+   if( UMM_NBLOCK(n) & UMM_FREELIST_MASK ) {
+      umm_bin_remove( n );
+      UMM_NBLOCK(n)             = UMM_NBLOCK(c);
+      UMM_PBLOCK(UMM_NBLOCK(n)) = n;
+      c = n;
+   }
+
+   // A block followed by the end of the heap becomes the new end
+
+   if( UMM_NBLOCK(c) == umm_end ) {
+      UMM_NBLOCK(c) = 0;
+      umm_end       = c;
+   } else {
+      umm_bin_insert( c );
+   }
+
+   UMM_CRITICAL_EXIT();
+}
+
+// ----------------------------------------------------------------------------
+
+void *umm_malloc( size_t size ) {
+   OS_SR_SAVE_VAR
+   unsigned short int blocks;
+   unsigned short int blockSize;
+   unsigned short int cf;
+
+   if( 0 == size ) {
+      return( (void *)NULL );
+   }
+
+   // Requests bigger than the block index can address are never served
+
+   if( size > (size_t)UMM_BLOCKNO_MASK * sizeof(umm_block) ) {
+      UMM_TRACE_MALLOC( NULL, size );
+      return( (void *)NULL );
+   }
+
+   UMM_CRITICAL_ENTRY();
+
+   blocks = umm_blocks( size );
+
+   // The first block of the heap is the end of the heap until the first
+   // allocation, this assumes that the BSS is set to 0 on startup
+
+   if( 0 == umm_end ) {
+      UMM_NBLOCK(0) = 1;
+      UMM_PBLOCK(1) = 0;
+      UMM_NBLOCK(1) = 0;
+      umm_end       = 1;
+   }
+
+   cf = umm_bin_search( blocks );
+
+   if( cf ) {
+      umm_bin_remove( cf );
+
+      blockSize = UMM_NBLOCK(cf) - cf;
+
+      // Split off the excess, the rest goes back to the class lists
+
+      if( blockSize > blocks ) {
+         umm_make_new_block( cf, blocks, 0 );
+         umm_bin_insert( cf+blocks );
+      }
+   } else {
+      // Carve the block from the end of the heap, keeping a new end block
+
+      cf = umm_end;
+
+      if( UMM_NUMBLOCKS <= cf+blocks+1 ) {
+         UMM_CRITICAL_EXIT();
+
+         UMM_TRACE_MALLOC( NULL, size );
+         return( (void *)NULL );
+      }
+
+      UMM_NBLOCK(cf)        = cf+blocks;
+      UMM_PBLOCK(cf+blocks) = cf;
+      UMM_NBLOCK(cf+blocks) = 0;
+      umm_end               = cf+blocks;
+   }
+
+   UMM_ACCOUNT_MALLOC( blocks );
+
+   UMM_CRITICAL_EXIT();
+
+   UMM_TRACE_MALLOC( (void *)&UMM_DATA(cf), size );
+   return( (void *)&UMM_DATA(cf) );
+}
+
+#ifdef UMM_INTEGRITY_CHECK
+// ----------------------------------------------------------------------------
+// Walks the heap chain and the class lists, returns 0 if they are consistent
+
+int umm_integrity_check( void ) {
+   unsigned short int b;
+   unsigned short int free_chain = 0;
+   unsigned short int free_bins  = 0;
+   int fl, sl, f, s;
+
+   if( 0 == umm_end )
+      return( 0 );
+
+   for( b = UMM_NBLOCK(0); b != umm_end; b = UMM_NBLOCK(b) & UMM_BLOCKNO_MASK ) {
+      if( (UMM_NBLOCK(b) & UMM_BLOCKNO_MASK) <= b )
+         return( 1 );
+      if( UMM_PBLOCK(UMM_NBLOCK(b) & UMM_BLOCKNO_MASK) != b )
+         return( 2 );
+      if( UMM_NBLOCK(b) & UMM_FREELIST_MASK ) {
+         // Free blocks are always merged with their free neighbours
+         if( (UMM_NBLOCK(UMM_NBLOCK(b) & UMM_BLOCKNO_MASK) & UMM_FREELIST_MASK) ||
+             ((UMM_NBLOCK(b) & UMM_BLOCKNO_MASK) == umm_end) )
+            return( 3 );
+         ++free_chain;
+      }
+   }
+
+   if( UMM_NBLOCK(umm_end) != 0 )
+      return( 4 );
+
+   for( fl = 0; fl < UMM_FL_COUNT; ++fl ) {
+      for( sl = 0; sl < UMM_SL_COUNT; ++sl ) {
+         if( (umm_bins[fl][sl] != 0) != ((umm_sl_bitmap[fl] >> sl) & 1) )
+            return( 5 );
+         for( b = umm_bins[fl][sl]; b; b = UMM_NFREE(b) ) {
+            if( !(UMM_NBLOCK(b) & UMM_FREELIST_MASK) )
+               return( 6 );
+            umm_mapping( (UMM_NBLOCK(b) & UMM_BLOCKNO_MASK) - b, &f, &s );
+            if( (f != fl) || (s != sl) )
+               return( 7 );
+            ++free_bins;
+         }
+      }
+      if( (umm_sl_bitmap[fl] != 0) != ((umm_fl_bitmap >> fl) & 1) )
+         return( 8 );
+   }
+
+   return( (free_chain == free_bins) ? 0 : 9 );
+}
+#endif
+
+#else
 
 // ----------------------------------------------------------------------------
 
@@ -733,16 +1090,20 @@ void umm_free( void *ptr ) {
    // NOTE:  See the new umm_info() function that you can use to see if a ptr is
    //        on the free list!
 
+   UMM_TRACE_FREE( ptr );
+
    // Protect the critical section...
    //
    UMM_CRITICAL_ENTRY();
 
    // Figure out which block we're in. Note the use of truncated division...
 
-   c = ((int)ptr-(int)(&(umm_heap[0])))/sizeof(umm_block);
+   c = ((char *)ptr-(char *)(&(umm_heap[0])))/sizeof(umm_block);
 
    //DBG_LOG_DEBUG( "Freeing block %6i\n", c );
 
+   UMM_ACCOUNT_FREE( UMM_NBLOCK(c) - c );
+
    // Now let's assimilate this block with the next one if possible.
 
    umm_assimilate_up( c );
@@ -894,6 +1255,7 @@ void *umm_malloc( size_t size ) {
          //
          UMM_CRITICAL_EXIT();
 
+         UMM_TRACE_MALLOC( NULL, size );
          return( (void *)NULL );
       }
 
@@ -918,13 +1280,17 @@ void *umm_malloc( size_t size ) {
       UMM_PBLOCK(cf+blocks)    = cf;
    }
 
+   UMM_ACCOUNT_MALLOC( blocks );
+
    // Release the critical section...
    //
    UMM_CRITICAL_EXIT();
 
+   UMM_TRACE_MALLOC( (void *)&UMM_DATA(cf), size );
    return( (void *)&UMM_DATA(cf) );
 }
 
+#endif // UMM_SEGREGATED_FIT
 
 
 #endif
@@ -20,6 +20,8 @@ typedef struct UMM_HEAP_INFO_t {
    unsigned short int totalBlocks; 
    unsigned short int usedBlocks; 
    unsigned short int freeBlocks; 
+
+   unsigned short int maxFreeContiguousBlocks;
 }
 UMM_HEAP_INFO;
 
@@ -37,6 +39,12 @@ void umm_free( void *ptr );
 
 unsigned int OSGetFreeHeapSize( void );
 unsigned int OSGetUsedHeapSize( void );
+unsigned int OSGetPeakHeapSize( void );
+unsigned int OSGetMaxFreeHeapBlock( void );
+
+#ifdef UMM_INTEGRITY_CHECK
+int umm_integrity_check( void );
+#endif
 
 
 // ----------------------------------------------------------------------------
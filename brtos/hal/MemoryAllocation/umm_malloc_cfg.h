@@ -39,6 +39,16 @@
 // Set this if you want to use a first-fit algorithm for allocating new
 // blocks
 //
+// -D UMM_SEGREGATED_FIT
+//
+// Set this if you want to keep the free blocks in lists by size class, with
+// malloc() and free() taking a bounded time whatever the heap fragmentation
+//
+// -D UMM_INTEGRITY_CHECK
+//
+// Set this if you want umm_integrity_check(), which walks the heap and
+// the free lists of UMM_SEGREGATED_FIT looking for corruption
+//
 // -D UMM_DBG_LOG_LEVEL=n
 //
 // Set n to a value from 0 to 6 depending on how verbose you want the debug
@@ -65,9 +75,13 @@
 
 // ----------------------------------------------------------------------------
 // Size of the heap in bytes
+#ifndef UMM_MALLOC_CFG__HEAP_SIZE
 #define UMM_MALLOC_CFG__HEAP_SIZE DYNAMIC_HEAP_SIZE
+#endif
 
+#if !defined(UMM_BEST_FIT) && !defined(UMM_SEGREGATED_FIT)
 #define UMM_FIRST_FIT			  1
+#endif
 
 // ----------------------------------------------------------------------------
 // A couple of macros to make packing structures less compiler dependent
@@ -88,8 +102,27 @@
 // NOTE WELL that these macros MUST be allowed to nest, because umm_free() is
 // called from within umm_malloc()
 
+#ifndef UMM_CRITICAL_ENTRY
 #define UMM_CRITICAL_ENTRY() OSEnterCritical()
 #define UMM_CRITICAL_EXIT() OSExitCritical()
+#endif
+
+// ----------------------------------------------------------------------------
+// Hooks called after each allocation and before each release, outside of the
+// critical section. A failed allocation is reported with a NULL pointer.
+// Printing them as below gives a trace that tools/umm-replay can replay on
+// the host with each allocation policy:
+//
+// #define UMM_TRACE_MALLOC(ptr, size) printf("m %p %u\n", (ptr), (unsigned)(size))
+// #define UMM_TRACE_FREE(ptr)         printf("f %p\n", (ptr))
+
+#ifndef UMM_TRACE_MALLOC
+#define UMM_TRACE_MALLOC(ptr, size)
+#endif
+
+#ifndef UMM_TRACE_FREE
+#define UMM_TRACE_FREE(ptr)
+#endif
 
 
 
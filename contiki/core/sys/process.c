@@ -44,6 +44,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "sys/process.h"
 #include "sys/arg.h"
@@ -63,22 +64,36 @@ struct event_data {
   process_event_t ev;
   process_data_t data;
   struct process *p;
+#if PROCESS_CONF_STATS
+  unsigned long stamp;
+#endif /* PROCESS_CONF_STATS */
 };
 
-static process_num_events_t nevents, fevent;
-static struct event_data events[PROCESS_CONF_NUMEVENTS];
+/*
+ * Event queue and poll flag of each partition.
+ */
+struct partition {
+  process_num_events_t nevents, fevent;
+  struct event_data events[PROCESS_CONF_NUMEVENTS];
+  volatile unsigned char poll_requested;
+#if PROCESS_CONF_STATS
+  unsigned long poll_stamp;
+  struct process_partition_stats stats;
+#endif /* PROCESS_CONF_STATS */
+};
+
+static struct partition partitions[PROCESS_PARTITIONS];
 
 #if PROCESS_CONF_STATS
 process_num_events_t process_maxevents;
 #endif
 
-static volatile unsigned char poll_requested;
-
 #define PROCESS_STATE_NONE        0
 #define PROCESS_STATE_RUNNING     1
 #define PROCESS_STATE_CALLED      2
 
 static void call_process(struct process *p, process_event_t ev, process_data_t data);
+static void call_process_synch(struct process *p, process_event_t ev, process_data_t data);
 
 #define DEBUG 0
 #if DEBUG
@@ -88,6 +103,45 @@ static void call_process(struct process *p, process_event_t ev, process_data_t d
 #define PRINTF(...)
 #endif
 
+/* Platform hooks run around each dispatch of a process, e.g. for tracing */
+#ifndef PROCESS_CONF_CALL_HOOK
+#define PROCESS_CONF_CALL_HOOK(p, ev)
+#endif /* PROCESS_CONF_CALL_HOOK */
+
+#ifndef PROCESS_CONF_RETURN_HOOK
+#define PROCESS_CONF_RETURN_HOOK(p, ev)
+#endif /* PROCESS_CONF_RETURN_HOOK */
+
+/*
+ * Platform hooks for the partitions run by several threads: the lock
+ * protects the process list and makes a post to several partitions
+ * atomic, it is not held while a process runs, except for the exit
+ * handlers, and may be taken again by its holder. The critical section
+ * protects the event queues from the interrupts and the threads that
+ * post to them, and the signal wakes the thread of a partition after a
+ * post or a poll request. PROCESS_CONF_CRITICAL_DECL is a declaration
+ * with its semicolon.
+ */
+#ifndef PROCESS_CONF_LOCK
+#define PROCESS_CONF_LOCK()
+#define PROCESS_CONF_UNLOCK()
+#endif /* PROCESS_CONF_LOCK */
+
+#ifndef PROCESS_CONF_CRITICAL_DECL
+#define PROCESS_CONF_CRITICAL_DECL
+#define PROCESS_CONF_ENTER_CRITICAL()
+#define PROCESS_CONF_EXIT_CRITICAL()
+#endif /* PROCESS_CONF_CRITICAL_DECL */
+
+#ifndef PROCESS_CONF_SIGNAL
+#define PROCESS_CONF_SIGNAL(partition)
+#endif /* PROCESS_CONF_SIGNAL */
+
+/* Free running time of the dispatch latencies */
+#ifndef PROCESS_CONF_TIMESTAMP
+#define PROCESS_CONF_TIMESTAMP() 0
+#endif /* PROCESS_CONF_TIMESTAMP */
+
 /*---------------------------------------------------------------------------*/
 process_event_t
 process_alloc_event(void)
@@ -100,12 +154,15 @@ process_start(struct process *p, process_data_t data)
 {
   struct process *q;
 
+  PROCESS_CONF_LOCK();
+
   /* First make sure that we don't try to start a process that is
      already running. */
   for(q = process_list; q != p && q != NULL; q = q->next);
 
   /* If we found the process on the process list, we bail out. */
   if(q == p) {
+    PROCESS_CONF_UNLOCK();
     return;
   }
   /* Put on the procs list.*/
@@ -114,6 +171,8 @@ process_start(struct process *p, process_data_t data)
   p->state = PROCESS_STATE_RUNNING;
   PT_INIT(&p->pt);
 
+  PROCESS_CONF_UNLOCK();
+
   PRINTF("process: starting '%s'\n", PROCESS_NAME_STRING(p));
 
   /* Post a synchronous initialization event to the process. */
@@ -128,10 +187,23 @@ exit_process(struct process *p, struct process *fromprocess)
 
   PRINTF("process: exit_process '%s'\n", PROCESS_NAME_STRING(p));
 
+#if PROCESS_PARTITIONS > 1
+  /* A process of another partition exits in the thread of its partition,
+     which may be in one of its handlers */
+  if(fromprocess != NULL &&
+     PROCESS_PARTITION(p) != PROCESS_PARTITION(fromprocess)) {
+    process_post(p, PROCESS_EVENT_EXIT, NULL);
+    return;
+  }
+#endif /* PROCESS_PARTITIONS > 1 */
+
+  PROCESS_CONF_LOCK();
+
   /* Make sure the process is in the process list before we try to
      exit it. */
   for(q = process_list; q != p && q != NULL; q = q->next);
   if(q == NULL) {
+    PROCESS_CONF_UNLOCK();
     return;
   }
 
@@ -146,7 +218,7 @@ exit_process(struct process *p, struct process *fromprocess)
      */
     for(q = process_list; q != NULL; q = q->next) {
       if(p != q) {
-	call_process(q, PROCESS_EVENT_EXITED, (process_data_t)p);
+	call_process_synch(q, PROCESS_EVENT_EXITED, (process_data_t)p);
       }
     }
 
@@ -169,11 +241,14 @@ exit_process(struct process *p, struct process *fromprocess)
   }
 
   process_current = old_current;
+
+  PROCESS_CONF_UNLOCK();
 }
 /*---------------------------------------------------------------------------*/
 static void
 call_process(struct process *p, process_event_t ev, process_data_t data)
 {
+  struct process *caller = process_current;
   int ret;
 
 #if DEBUG
@@ -187,7 +262,9 @@ call_process(struct process *p, process_event_t ev, process_data_t data)
     PRINTF("process: calling process '%s' with event %d\n", PROCESS_NAME_STRING(p), ev);
     process_current = p;
     p->state = PROCESS_STATE_CALLED;
+    PROCESS_CONF_CALL_HOOK(p, ev);
     ret = p->thread(&p->pt, ev, data);
+    PROCESS_CONF_RETURN_HOOK(p, ev);
     if(ret == PT_EXITED ||
        ret == PT_ENDED ||
        ev == PROCESS_EVENT_EXIT) {
@@ -196,6 +273,29 @@ call_process(struct process *p, process_event_t ev, process_data_t data)
       p->state = PROCESS_STATE_RUNNING;
     }
   }
+
+  /* The thread of another partition may have been preempted in a handler */
+  process_current = caller;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Call a process from a handler, or before the partitions run. A
+ * process of another partition gets the event through the queue of its
+ * partition instead, as the thread of that partition may be in one of
+ * its handlers.
+ */
+static void
+call_process_synch(struct process *p, process_event_t ev, process_data_t data)
+{
+#if PROCESS_PARTITIONS > 1
+  if(process_current != NULL &&
+     PROCESS_PARTITION(p) != PROCESS_PARTITION(process_current)) {
+    process_post(p, ev, data);
+    return;
+  }
+#endif /* PROCESS_PARTITIONS > 1 */
+
+  call_process(p, ev, data);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -207,9 +307,13 @@ process_exit(struct process *p)
 void
 process_init(void)
 {
+  unsigned char i;
+
   lastevent = PROCESS_EVENT_MAX;
 
-  nevents = fevent = 0;
+  for(i = 0; i < PROCESS_PARTITIONS; i++) {
+    memset(&partitions[i], 0, sizeof(partitions[i]));
+  }
 #if PROCESS_CONF_STATS
   process_maxevents = 0;
 #endif /* PROCESS_CONF_STATS */
@@ -217,24 +321,55 @@ process_init(void)
   process_current = process_list = NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_CONF_STATS
+/*
+ * Account the time from a post or a poll request to the dispatch, called
+ * in the critical section.
+ */
+static void
+account_latency(struct partition *q, unsigned long stamp)
+{
+  unsigned long latency = (unsigned long)PROCESS_CONF_TIMESTAMP() - stamp;
+
+  q->stats.last_latency = latency;
+  q->stats.total_latency += latency;
+  if(latency > q->stats.max_latency) {
+    q->stats.max_latency = latency;
+  }
+}
+#endif /* PROCESS_CONF_STATS */
+/*---------------------------------------------------------------------------*/
 /*
  * Call each process' poll handler.
  */
 /*---------------------------------------------------------------------------*/
 static void
-do_poll(void)
+do_poll(struct partition *q, unsigned char partition)
 {
   struct process *p;
+  PROCESS_CONF_CRITICAL_DECL
+
+  PROCESS_CONF_ENTER_CRITICAL();
+  q->poll_requested = 0;
+#if PROCESS_CONF_STATS
+  q->stats.polls++;
+  account_latency(q, q->poll_stamp);
+#endif /* PROCESS_CONF_STATS */
+  PROCESS_CONF_EXIT_CRITICAL();
 
-  poll_requested = 0;
-  /* Call the processes that needs to be polled. */
+  /* Call the processes that needs to be polled, the lock is only held
+     while walking the list. */
+  PROCESS_CONF_LOCK();
   for(p = process_list; p != NULL; p = p->next) {
-    if(p->needspoll) {
+    if(p->needspoll && PROCESS_PARTITION(p) == partition) {
       p->state = PROCESS_STATE_RUNNING;
       p->needspoll = 0;
+      PROCESS_CONF_UNLOCK();
       call_process(p, PROCESS_EVENT_POLL, NULL);
+      PROCESS_CONF_LOCK();
     }
   }
+  PROCESS_CONF_UNLOCK();
 }
 /*---------------------------------------------------------------------------*/
 /*
@@ -243,12 +378,14 @@ do_poll(void)
  */
 /*---------------------------------------------------------------------------*/
 static void
-do_event(void)
+do_event(struct partition *q, unsigned char partition)
 {
-  static process_event_t ev;
-  static process_data_t data;
-  static struct process *receiver;
-  static struct process *p;
+  process_event_t ev = 0;
+  process_data_t data = NULL;
+  struct process *receiver = NULL;
+  struct process *p;
+  unsigned char taken = 0;
+  PROCESS_CONF_CRITICAL_DECL
   
   /*
    * If there are any events in the queue, take the first one and walk
@@ -258,31 +395,52 @@ do_event(void)
    * call the poll handlers inbetween.
    */
 
-  if(nevents > 0) {
+  PROCESS_CONF_ENTER_CRITICAL();
+  if(q->nevents > 0) {
     
     /* There are events that we should deliver. */
-    ev = events[fevent].ev;
+    ev = q->events[q->fevent].ev;
     
-    data = events[fevent].data;
-    receiver = events[fevent].p;
+    data = q->events[q->fevent].data;
+    receiver = q->events[q->fevent].p;
+
+#if PROCESS_CONF_STATS
+    q->stats.events++;
+    account_latency(q, q->events[q->fevent].stamp);
+#endif /* PROCESS_CONF_STATS */
 
     /* Since we have seen the new event, we move pointer upwards
        and decrease the number of events. */
-    fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
-    --nevents;
+    q->fevent = (q->fevent + 1) % PROCESS_CONF_NUMEVENTS;
+    --q->nevents;
+    taken = 1;
+  }
+  PROCESS_CONF_EXIT_CRITICAL();
 
+  if(taken) {
     /* If this is a broadcast event, we deliver it to all events, in
-       order of their priority. */
+       order of their priority. Each partition has its own copy of
+       the event. */
     if(receiver == PROCESS_BROADCAST) {
+      PROCESS_CONF_LOCK();
       for(p = process_list; p != NULL; p = p->next) {
 
+	if(PROCESS_PARTITION(p) != partition) {
+	  continue;
+	}
+
+	PROCESS_CONF_UNLOCK();
+
 	/* If we have been requested to poll a process, we do this in
 	   between processing the broadcast event. */
-	if(poll_requested) {
-	  do_poll();
+	if(q->poll_requested) {
+	  do_poll(q, partition);
 	}
 	call_process(p, ev, data);
+
+	PROCESS_CONF_LOCK();
       }
+      PROCESS_CONF_UNLOCK();
     } else {
       /* This is not a broadcast event, so we deliver it to the
 	 specified process. */
@@ -299,86 +457,205 @@ do_event(void)
 }
 /*---------------------------------------------------------------------------*/
 int
-process_run(void)
+process_run_partition(unsigned char partition)
 {
+  struct partition *q;
+  int n;
+
+  if(partition >= PROCESS_PARTITIONS) {
+    return 0;
+  }
+  q = &partitions[partition];
+
   /* Process poll events. */
-  if(poll_requested) {
-    do_poll();
+  if(q->poll_requested) {
+    do_poll(q, partition);
   }
 
   /* Process one event from the queue */
-  do_event();
+  do_event(q, partition);
+
+  n = q->nevents + q->poll_requested;
+
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+int
+process_run(void)
+{
+  unsigned char i;
+
+  /* The partition of highest priority that has work to do */
+  for(i = 0; i < PROCESS_PARTITIONS; i++) {
+    if(partitions[i].nevents + partitions[i].poll_requested > 0) {
+      process_run_partition(i);
+      break;
+    }
+  }
 
-  return nevents + poll_requested;
+  return process_nevents();
 }
 /*---------------------------------------------------------------------------*/
 int
 process_nevents(void)
 {
-  return nevents + poll_requested;
+  unsigned char i;
+  int n = 0;
+
+  for(i = 0; i < PROCESS_PARTITIONS; i++) {
+    n += partitions[i].nevents + partitions[i].poll_requested;
+  }
+
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Put an event in the queue of a partition.
+ */
+static int
+queue_event(struct partition *q, struct process *p, process_event_t ev, process_data_t data)
+{
+  process_num_events_t snum;
+  PROCESS_CONF_CRITICAL_DECL
+
+  PROCESS_CONF_ENTER_CRITICAL();
+
+  if(q->nevents == PROCESS_CONF_NUMEVENTS) {
+    PROCESS_CONF_EXIT_CRITICAL();
+    return PROCESS_ERR_FULL;
+  }
+  
+  snum = (process_num_events_t)(q->fevent + q->nevents) % PROCESS_CONF_NUMEVENTS;
+  q->events[snum].ev = ev;
+  q->events[snum].data = data;
+  q->events[snum].p = p;
+  ++q->nevents;
+
+#if PROCESS_CONF_STATS
+  q->events[snum].stamp = (unsigned long)PROCESS_CONF_TIMESTAMP();
+  if(q->nevents > q->stats.maxevents) {
+    q->stats.maxevents = q->nevents;
+  }
+  if(q->nevents > process_maxevents) {
+    process_maxevents = q->nevents;
+  }
+#endif /* PROCESS_CONF_STATS */
+
+  PROCESS_CONF_EXIT_CRITICAL();
+
+  return PROCESS_ERR_OK;
 }
 /*---------------------------------------------------------------------------*/
 int
 process_post(struct process *p, process_event_t ev, process_data_t data)
 {
-  static process_num_events_t snum;
+  unsigned char first, last, i;
+  int ret = PROCESS_ERR_OK;
 
   if(PROCESS_CURRENT() == NULL) {
-    PRINTF("process_post: NULL process posts event %d to process '%s', nevents %d\n",
-	   ev,PROCESS_NAME_STRING(p), nevents);
+    PRINTF("process_post: NULL process posts event %d to process '%s'\n",
+	   ev,PROCESS_NAME_STRING(p));
   } else {
-    PRINTF("process_post: Process '%s' posts event %d to process '%s', nevents %d\n",
+    PRINTF("process_post: Process '%s' posts event %d to process '%s'\n",
 	   PROCESS_NAME_STRING(PROCESS_CURRENT()), ev,
-	   p == PROCESS_BROADCAST? "<broadcast>": PROCESS_NAME_STRING(p), nevents);
+	   p == PROCESS_BROADCAST? "<broadcast>": PROCESS_NAME_STRING(p));
   }
-  
-  if(nevents == PROCESS_CONF_NUMEVENTS) {
+
+  /* A broadcast event goes to the queue of every partition */
+  if(p == PROCESS_BROADCAST) {
+    first = 0;
+    last = PROCESS_PARTITIONS - 1;
+  } else {
+    first = last = PROCESS_PARTITION(p);
+  }
+
+  PROCESS_CONF_LOCK();
+  for(i = first; i <= last; i++) {
+    if(queue_event(&partitions[i], p, ev, data) != PROCESS_ERR_OK) {
 #if DEBUG
-    if(p == PROCESS_BROADCAST) {
-      printf("soft panic: event queue is full when broadcast event %d was posted from %s\n", ev, PROCESS_NAME_STRING(process_current));
+      if(p == PROCESS_BROADCAST) {
+        printf("soft panic: event queue is full when broadcast event %d was posted from %s\n", ev, PROCESS_NAME_STRING(process_current));
+      } else {
+        printf("soft panic: event queue is full when event %d was posted to %s from %s\n", ev, PROCESS_NAME_STRING(p), PROCESS_NAME_STRING(process_current));
+      }
+#endif /* DEBUG */
+      ret = PROCESS_ERR_FULL;
     } else {
-      printf("soft panic: event queue is full when event %d was posted to %s from %s\n", ev, PROCESS_NAME_STRING(p), PROCESS_NAME_STRING(process_current));
+      PROCESS_CONF_SIGNAL(i);
     }
-#endif /* DEBUG */
-    return PROCESS_ERR_FULL;
   }
-  
-  snum = (process_num_events_t)(fevent + nevents) % PROCESS_CONF_NUMEVENTS;
-  events[snum].ev = ev;
-  events[snum].data = data;
-  events[snum].p = p;
-  ++nevents;
+  PROCESS_CONF_UNLOCK();
 
-#if PROCESS_CONF_STATS
-  if(nevents > process_maxevents) {
-    process_maxevents = nevents;
-  }
-#endif /* PROCESS_CONF_STATS */
-  
-  return PROCESS_ERR_OK;
+  return ret;
 }
 /*---------------------------------------------------------------------------*/
 void
 process_post_synch(struct process *p, process_event_t ev, process_data_t data)
 {
-  struct process *caller = process_current;
-
-  call_process(p, ev, data);
-  process_current = caller;
+  call_process_synch(p, ev, data);
 }
 /*---------------------------------------------------------------------------*/
 void
 process_poll(struct process *p)
 {
+  struct partition *q;
+  PROCESS_CONF_CRITICAL_DECL
+
   if(p != NULL) {
     if(p->state == PROCESS_STATE_RUNNING ||
        p->state == PROCESS_STATE_CALLED) {
+      q = &partitions[PROCESS_PARTITION(p)];
+
+      PROCESS_CONF_ENTER_CRITICAL();
       p->needspoll = 1;
-      poll_requested = 1;
+#if PROCESS_CONF_STATS
+      if(!q->poll_requested) {
+        q->poll_stamp = (unsigned long)PROCESS_CONF_TIMESTAMP();
+      }
+#endif /* PROCESS_CONF_STATS */
+      q->poll_requested = 1;
+      PROCESS_CONF_EXIT_CRITICAL();
+
+      PROCESS_CONF_SIGNAL(PROCESS_PARTITION(p));
     }
   }
 }
 /*---------------------------------------------------------------------------*/
+void
+process_set_partition(struct process *p, unsigned char partition)
+{
+#if PROCESS_PARTITIONS > 1
+  if(p != NULL && partition < PROCESS_PARTITIONS) {
+    p->partition = partition;
+  }
+#endif /* PROCESS_PARTITIONS > 1 */
+}
+/*---------------------------------------------------------------------------*/
+#if PROCESS_CONF_STATS
+void
+process_partition_stats(unsigned char partition,
+                        struct process_partition_stats *stats,
+                        int reset)
+{
+  struct partition *q;
+  PROCESS_CONF_CRITICAL_DECL
+
+  if(partition >= PROCESS_PARTITIONS) {
+    memset(stats, 0, sizeof(*stats));
+    return;
+  }
+  q = &partitions[partition];
+
+  PROCESS_CONF_ENTER_CRITICAL();
+  *stats = q->stats;
+  if(reset) {
+    memset(&q->stats, 0, sizeof(q->stats));
+    q->stats.maxevents = q->nevents;
+  }
+  PROCESS_CONF_EXIT_CRITICAL();
+}
+#endif /* PROCESS_CONF_STATS */
+/*---------------------------------------------------------------------------*/
 int
 process_is_running(struct process *p)
 {
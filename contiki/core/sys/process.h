@@ -88,6 +88,26 @@ typedef unsigned char process_num_events_t;
 #define PROCESS_CONF_NUMEVENTS 32
 #endif /* PROCESS_CONF_NUMEVENTS */
 
+/*
+ * Processes are grouped in partitions, each with its own event queue
+ * and poll flag, so that a platform can run each partition in a thread
+ * of its own. Partition 0 has the highest priority.
+ *
+ * The platform lock (PROCESS_CONF_LOCK) protects the process list and
+ * the posts, it is released while a handler runs, so the thread of a
+ * partition preempts a handler of a partition of lower priority. A
+ * process only runs in the thread of its partition: a synchronous event
+ * or an exit for a process of another partition goes through its event
+ * queue. The Contiki libraries are not reentrant, so processes of
+ * different partitions must not share them, or must take the lock
+ * around their calls.
+ */
+#ifdef PROCESS_CONF_PARTITIONS
+#define PROCESS_PARTITIONS PROCESS_CONF_PARTITIONS
+#else
+#define PROCESS_PARTITIONS 1
+#endif /* PROCESS_CONF_PARTITIONS */
+
 #define PROCESS_EVENT_NONE            0x80
 #define PROCESS_EVENT_INIT            0x81
 #define PROCESS_EVENT_POLL            0x82
@@ -323,8 +343,30 @@ struct process {
   PT_THREAD((* thread)(struct pt *, process_event_t, process_data_t));
   struct pt pt;
   unsigned char state, needspoll;
+#if PROCESS_PARTITIONS > 1
+  unsigned char partition;
+#endif /* PROCESS_PARTITIONS > 1 */
 };
 
+#if PROCESS_PARTITIONS > 1
+#define PROCESS_PARTITION(p) ((p)->partition)
+#else
+#define PROCESS_PARTITION(p) 0
+#endif /* PROCESS_PARTITIONS > 1 */
+
+#if PROCESS_CONF_STATS
+/**
+ * Dispatch statistics of a partition. The latencies go from the post
+ * of an event, or the first poll request, to the call of the process,
+ * in PROCESS_CONF_TIMESTAMP() units.
+ */
+struct process_partition_stats {
+  unsigned long events, polls;
+  unsigned long last_latency, max_latency, total_latency;
+  process_num_events_t maxevents;
+};
+#endif /* PROCESS_CONF_STATS */
+
 /**
  * \name Functions called from application programs
  * @{
@@ -373,6 +415,9 @@ CCIF int process_post(struct process *p, process_event_t ev, process_data_t data
  *
  * \param data A pointer to additional data that is posted together
  * with the event.
+ *
+ * With several partitions, an event for a process of another
+ * partition is posted to its queue instead.
  */
 CCIF void process_post_synch(struct process *p,
 			     process_event_t ev, process_data_t data);
@@ -383,7 +428,8 @@ CCIF void process_post_synch(struct process *p,
  *
  *             This function causes a process to exit. The process can
  *             either be the currently executing process, or another
- *             process that is currently running.
+ *             process that is currently running. A process of another
+ *             partition exits when its partition handles the exit event.
  *
  * \sa PROCESS_CURRENT()
  */
@@ -499,6 +545,45 @@ void process_init(void);
  */
 int process_run(void);
 
+/**
+ * Run a partition once - call its poll handlers and process one of its
+ * events.
+ *
+ * process_run() runs the first partition that has work to do. A
+ * platform that gives each partition a thread of its own calls this
+ * function from each thread instead, and no longer calls process_run(),
+ * as a partition must only run in one thread.
+ *
+ * \param partition The partition.
+ * \return The number of events and polls that are waiting in the
+ * partition.
+ */
+int process_run_partition(unsigned char partition);
+
+/**
+ * Move a process to a partition.
+ *
+ * Should be called before the process is started. Processes are in
+ * partition 0 unless moved.
+ *
+ * \param p The process.
+ * \param partition The partition, below PROCESS_PARTITIONS.
+ */
+void process_set_partition(struct process *p, unsigned char partition);
+
+#if PROCESS_CONF_STATS
+/**
+ * Read the dispatch statistics of a partition.
+ *
+ * \param partition The partition.
+ * \param stats Where the statistics are copied.
+ * \param reset Non-zero to clear the statistics after the copy.
+ */
+void process_partition_stats(unsigned char partition,
+                             struct process_partition_stats *stats,
+                             int reset);
+#endif /* PROCESS_CONF_STATS */
+
 
 /**
  * Check if a process is running.
@@ -43,6 +43,7 @@
 #define Help_HelpText_def "Help of commands"
 #define Ver_HelpText_def "BRTOS Version"
 #define Top_HelpText_def "BRTOS TOP"
+#define Stack_HelpText_def "Task stack peaks and recommended sizes"
 #define Rst_HelpText_def "CPU Reason of the Reset"
 #define Temp_HelpText_def "Show core temperature"
 #define SetGetTime_HelpText_def "Set/Get OS Date and Time"
@@ -71,6 +72,7 @@
 #define  Help_HelpText Help_HelpText_def
 #define  Ver_HelpText Ver_HelpText_def
 #define  Top_HelpText Top_HelpText_def
+#define  Stack_HelpText Stack_HelpText_def
 #define  Rst_HelpText Rst_HelpText_def
 #define  Temp_HelpText Temp_HelpText_def
 #define  SetGetTime_HelpText SetGetTime_HelpText_def
@@ -104,6 +106,7 @@ typedef enum
 
 const char Ver_HelpText_str[] PROGMEM = Ver_HelpText_def;
 const char Top_HelpText_str[] PROGMEM = Top_HelpText_def;
+const char Stack_HelpText_str[] PROGMEM = Stack_HelpText_def;
 const char Rst_HelpText_str[] PROGMEM = Rst_HelpText_def;
 const char Temp_HelpText_str[] PROGMEM = Temp_HelpText_def;
 const char SetGetTime_HelpText_str[] PROGMEM = SetGetTime_HelpText_def;
@@ -129,6 +132,7 @@ const char monitor_HelpText_str[] PROGMEM = monitor_HelpText_def;
 
 #define  Ver_HelpText Ver_HelpText_str
 #define  Top_HelpText Top_HelpText_str
+#define  Stack_HelpText Stack_HelpText_str
 #define  Rst_HelpText Rst_HelpText_str
 #define  Temp_HelpText Temp_HelpText_str
 #define  SetGetTime_HelpText SetGetTime_HelpText_str
@@ -179,22 +183,49 @@ CONST command_t ver_cmd =
 };
 
 // TOP Command (similar to the linux command)
+// The task list shows the processor usage of each task since the previous top when
+// OS_TASK_RUNTIME_EN is active
+#ifndef TOP_BUFFER_SIZE
+#define TOP_BUFFER_SIZE   OS_INFO_LIST_SIZE(NUMBER_OF_TASKS)
+#endif
+
+static CHAR8 top_buffer[TOP_BUFFER_SIZE];
+
 void term_cmd_top(char *param)
 {
   (void)*param;
   terminal_newline();
-#if 0
-  Transmite_CPU_Load(USE_USB);
-  Transmite_Uptime(USE_USB);
-  Transmite_RAM_Ocupada(USE_USB);
-  Transmite_Task_Stacks(USE_USB);
+#if (COMPUTES_CPU_LOAD == 1)
+  OSCPULoad(top_buffer);
+  printf_terminal(top_buffer);
 #endif
+  OSUptimeInfo(top_buffer);
+  printf_terminal(top_buffer);
+  OSAvailableMemory(top_buffer);
+  printf_terminal(top_buffer);
+  OSTaskList(top_buffer);
+  printf_terminal(top_buffer);
 }
 
 CONST command_t top_cmd = {
   "top", term_cmd_top, Top_HelpText
 };
 
+#if (OS_STACK_WATERMARK_EN == 1)
+// Stack Command, peak usage of the task stacks to size them
+void term_cmd_stack(char *param)
+{
+  (void)*param;
+  terminal_newline();
+  OSStackReport(top_buffer);
+  printf_terminal(top_buffer);
+}
+
+CONST command_t stack_cmd = {
+  "stack", term_cmd_stack, Stack_HelpText
+};
+#endif
+
 
 // Reason of Reset Command
 void term_cmd_rst(char *param)
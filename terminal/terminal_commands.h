@@ -41,6 +41,12 @@ extern CONST command_t ver_cmd;
 void term_cmd_top(char *param);
 extern CONST command_t top_cmd;
 
+// Stack Command
+#if (OS_STACK_WATERMARK_EN == 1)
+void term_cmd_stack(char *param);
+extern CONST command_t stack_cmd;
+#endif
+
 // Reason of Reset Command
 void term_cmd_rst(char *param);
 extern CONST command_t rst_cmd;
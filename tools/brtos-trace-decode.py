@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+"""Decodes a BRTOS binary trace (OSTRACE == 1) into Chrome/Perfetto trace JSON.
+
+The trace is the byte stream written by OSTraceDescribe and OSTraceRead, or
+the SLIP frames sent by OSTraceSendSLIP:
+
+    brtos-trace-decode.py --slip capture.bin -o trace.json
+    brtos-trace-decode.py --symbols <(arm-none-eabi-nm -S firmware.elf) capture.bin
+
+Open the result in https://ui.perfetto.dev or chrome://tracing. Objects,
+timer callbacks and Contiki processes are recorded by the 16 lower bits of
+their address and are named from the nm output given with --symbols.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+RECORD_SIZE = 8
+MAGIC = 0x5442
+VERSION = 1
+
+SLIP_END = 0xC0
+SLIP_ESC = 0xDB
+SLIP_ESC_END = 0xDC
+SLIP_ESC_ESC = 0xDD
+
+HEADER, TASK_NAME, LOST, SWITCH, DELAY = 0, 1, 2, 3, 4
+ISR_ENTER, ISR_EXIT, TIMER_FIRE, PROCESS_CALL, PROCESS_RETURN = 15, 16, 17, 18, 19
+USER = 32
+
+# instant events of the running task: name and kind of symbol of the argument
+OBJECT_EVENTS = {
+    5: ("sem pend", "data"),
+    6: ("sem post", "data"),
+    7: ("mutex pend", "data"),
+    8: ("mutex post", "data"),
+    9: ("mbox pend", "data"),
+    10: ("mbox post", "data"),
+    11: ("queue pend", "data"),
+    12: ("queue post", "data"),
+    13: ("event group pend", "data"),
+    14: ("event group post", "data"),
+    TIMER_FIRE: ("timer fire", "text"),
+}
+
+PID = 1
+ISR_TID = 1000
+PROCESS_TID = 2000
+
+
+def slip_frames(data):
+    """Splits a SLIP byte stream in frames."""
+    frame = bytearray()
+    escaped = False
+    for b in data:
+        if escaped:
+            frame.append(SLIP_END if b == SLIP_ESC_END else SLIP_ESC if b == SLIP_ESC_ESC else b)
+            escaped = False
+        elif b == SLIP_ESC:
+            escaped = True
+        elif b == SLIP_END:
+            if frame:
+                yield bytes(frame)
+            frame = bytearray()
+        else:
+            frame.append(b)
+    if frame:
+        yield bytes(frame)
+
+
+def find_header(data):
+    """Returns the offset of the first header record and the byte order."""
+    for off in range(0, len(data) - RECORD_SIZE + 1):
+        if data[off + 4] != HEADER or data[off + 5] != VERSION:
+            continue
+        for order in ("<", ">"):
+            if struct.unpack_from(order + "H", data, off + 6)[0] == MAGIC:
+                return off, order
+    return None, None
+
+
+class Symbols:
+    """Symbols of the firmware indexed by the 16 lower bits of the address."""
+
+    def __init__(self):
+        self.syms = {"data": [], "text": []}
+
+    def load(self, path):
+        with open(path) as f:
+            for line in f:
+                fields = line.split()
+                if len(fields) == 4:
+                    addr, size, kind, name = fields
+                    size = int(size, 16)
+                elif len(fields) == 3:
+                    addr, kind, name = fields
+                    size = 0
+                else:
+                    continue
+                try:
+                    addr = int(addr, 16)
+                except ValueError:
+                    continue
+                group = "text" if kind in "tTwW" else "data" if kind in "bBdDrRsSgG" else None
+                if group:
+                    self.syms[group].append((addr & 0xFFFF, size, name))
+        for group in self.syms.values():
+            group.sort()
+
+    def name(self, value, group):
+        # a symbol known to hold the value, else the nearest one below it
+        best = None
+        nearest = None
+        for low, size, name in self.syms[group]:
+            if low > value:
+                break
+            if value < low + size:
+                best = (low, name)
+            nearest = (low, name)
+        if best is None:
+            best = nearest
+        if best is None:
+            return "0x%04x" % value
+        offset = value - best[0]
+        # thumb functions have the lower bit set
+        if offset == 0 or (group == "text" and offset == 1):
+            return best[1]
+        return "%s+%d" % (best[1], offset)
+
+
+class Decoder:
+    def __init__(self, symbols):
+        self.symbols = symbols
+        self.order = None
+        self.hz = None
+        self.names = {}
+        self.events = []
+        self.last_ts = None
+        self.wraps = 0
+        self.running = None
+        self.isr_depth = {}
+        self.processes = 0
+        self.lost = 0
+
+    def time_us(self, raw):
+        # timestamps are 32 bits, the trace is kept in order
+        if self.last_ts is not None and raw < self.last_ts:
+            self.wraps += 1
+        self.last_ts = raw
+        return ((self.wraps << 32) + raw) * 1e6 / self.hz
+
+    def task_name(self, task):
+        return self.names.get(task, "task %d" % task)
+
+    def emit(self, **event):
+        event.setdefault("pid", PID)
+        self.events.append(event)
+
+    def switch(self, ts, task):
+        if self.running is not None:
+            prev, start = self.running
+            self.emit(name=self.task_name(prev), ph="X", tid=prev, ts=start, dur=ts - start)
+        self.running = (task, ts)
+
+    def decode(self, data):
+        off, order = find_header(data)
+        if off is None:
+            raise SystemExit("no trace header found, the stream must start with OSTraceDescribe")
+        self.order = order
+        fmt = order + "IBBH"
+        while off + RECORD_SIZE <= len(data):
+            raw, event, task, arg = struct.unpack_from(fmt, data, off)
+            off += RECORD_SIZE
+            if event == HEADER:
+                if arg == MAGIC:
+                    self.hz = raw
+                continue
+            if event == TASK_NAME:
+                name = data[off:off + arg * RECORD_SIZE].split(b"\0")[0]
+                self.names[task] = name.decode("latin-1")
+                off += arg * RECORD_SIZE
+                continue
+            self.record(raw, event, task, arg)
+        self.finish()
+
+    def record(self, raw, event, task, arg):
+        ts = self.time_us(raw)
+        if event == SWITCH:
+            self.switch(ts, task)
+        elif event == LOST:
+            self.lost += arg
+            self.emit(name="lost %d records" % arg, ph="i", s="g", tid=0, ts=ts)
+        elif event == DELAY:
+            self.emit(name="delay", ph="i", s="t", tid=task, ts=ts, args={"ticks": arg})
+        elif event in OBJECT_EVENTS:
+            name, group = OBJECT_EVENTS[event]
+            self.emit(name=name, ph="i", s="t", tid=task, ts=ts,
+                      args={"object": self.symbols.name(arg, group)})
+        elif event in (ISR_ENTER, ISR_EXIT):
+            tid = ISR_TID + arg
+            depth = self.isr_depth.get(arg, 0)
+            if event == ISR_ENTER:
+                self.isr_depth[arg] = depth + 1
+                self.emit(name="IRQ %d" % arg, ph="B", tid=tid, ts=ts)
+            elif depth > 0:
+                self.isr_depth[arg] = depth - 1
+                self.emit(name="IRQ %d" % arg, ph="E", tid=tid, ts=ts)
+        elif event in (PROCESS_CALL, PROCESS_RETURN):
+            if event == PROCESS_CALL:
+                self.processes += 1
+                self.emit(name=self.symbols.name(arg, "data"), ph="B", tid=PROCESS_TID, ts=ts,
+                          args={"task": self.task_name(task)})
+            elif self.processes > 0:
+                self.processes -= 1
+                self.emit(name=self.symbols.name(arg, "data"), ph="E", tid=PROCESS_TID, ts=ts)
+        else:
+            name = "user %d" % event if event >= USER else "event %d" % event
+            self.emit(name=name, ph="i", s="t", tid=task, ts=ts, args={"arg": arg})
+
+    def finish(self):
+        if self.running is not None and self.last_ts is not None:
+            self.switch(((self.wraps << 32) + self.last_ts) * 1e6 / self.hz, self.running[0])
+            self.running = None
+        meta = [dict(name="process_name", ph="M", pid=PID, args={"name": "BRTOS"})]
+        tids = sorted({e["tid"] for e in self.events} | set(self.names))
+        for tid in tids:
+            if tid >= PROCESS_TID:
+                name = "Contiki processes"
+            elif tid >= ISR_TID:
+                name = "IRQ %d" % (tid - ISR_TID)
+            else:
+                name = self.task_name(tid)
+            meta.append(dict(name="thread_name", ph="M", pid=PID, tid=tid, args={"name": name}))
+        self.events = meta + self.events
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", nargs="?", help="trace capture, standard input if omitted")
+    parser.add_argument("-o", "--output", help="JSON output, standard output if omitted")
+    parser.add_argument("--slip", action="store_true", help="input is made of SLIP frames")
+    parser.add_argument("--symbols", help="nm output of the firmware, preferably with -S")
+    args = parser.parse_args()
+
+    if args.input:
+        with open(args.input, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    if args.slip:
+        # frames not made of whole records belong to other traffic of the link
+        data = b"".join(f for f in slip_frames(data) if len(f) % RECORD_SIZE == 0)
+
+    symbols = Symbols()
+    if args.symbols:
+        symbols.load(args.symbols)
+
+    decoder = Decoder(symbols)
+    decoder.decode(data)
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    json.dump({"traceEvents": decoder.events, "displayTimeUnit": "ns"}, out)
+    out.write("\n")
+    if args.output:
+        out.close()
+    if decoder.lost:
+        sys.stderr.write("%d records lost, drain the trace more often or increase OS_TRACE_SIZE\n" % decoder.lost)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,252 @@
+/*
+ * umm-replay - runs an allocation workload on umm_malloc and reports the time
+ * taken by each call, the failed allocations and the heap fragmentation.
+ *
+ *   umm-replay-<policy> [-v] trace.log      replays a trace of a node
+ *   umm-replay-<policy> -s seed [-n ops]    random workload
+ *
+ * A trace is the output of the UMM_TRACE_MALLOC and UMM_TRACE_FREE hooks
+ * given as example in umm_malloc_cfg.h, one call per line:
+ *
+ *   m <pointer> <size>
+ *   f <pointer>
+ *
+ * The pointers of the node are only used to pair each release with its
+ * allocation, so lines of other output mixed in the capture are skipped.
+ * Every allocated block is filled with a pattern that is checked when the
+ * block is released, which catches blocks given twice by the allocator.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "umm_malloc.h"
+
+#define SLOTS        4096               // live blocks kept by the workload
+#define FUZZ_LIVE    256                // live blocks of the random workload
+
+#if defined UMM_SEGREGATED_FIT
+#define POLICY       "segregated fit"
+#elif defined UMM_BEST_FIT
+#define POLICY       "best fit"
+#else
+#define POLICY       "first fit"
+#endif
+
+typedef struct {
+   unsigned long  node;                 // pointer on the node, 0 if free
+   unsigned char *ptr;
+   size_t         size;
+   unsigned char  fill;
+} slot_t;
+
+typedef struct {
+   unsigned long calls;
+   unsigned long long total_ns;
+   unsigned long max_ns;
+} timing_t;
+
+static slot_t   slots[SLOTS];
+static timing_t t_malloc, t_free;
+static unsigned long failed, corrupted, unmatched;
+static int verbose;
+
+static unsigned long long now_ns(void) {
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void account(timing_t *t, unsigned long long start) {
+   unsigned long ns = (unsigned long)(now_ns() - start);
+
+   t->calls++;
+   t->total_ns += ns;
+   if (ns > t->max_ns)
+      t->max_ns = ns;
+}
+
+static void check_heap(unsigned long op) {
+#ifdef UMM_INTEGRITY_CHECK
+   int err = umm_integrity_check();
+
+   if (err) {
+      fprintf(stderr, "heap corrupted after operation %lu (check %d)\n", op, err);
+      exit(2);
+   }
+#else
+   (void)op;
+#endif
+}
+
+static void do_malloc(slot_t *s, unsigned long node, size_t size) {
+   unsigned long long start = now_ns();
+   unsigned char *p = umm_malloc(size);
+
+   account(&t_malloc, start);
+
+   if (p == NULL) {
+      failed++;
+      if (verbose)
+         printf("failed %zu bytes, %u free, largest %u\n", size,
+                OSGetFreeHeapSize(), OSGetMaxFreeHeapBlock());
+      return;
+   }
+
+   s->node = node;
+   s->ptr  = p;
+   s->size = size;
+   s->fill = (unsigned char)(node * 131 + size);
+   memset(p, s->fill, size);
+}
+
+static void do_free(slot_t *s) {
+   unsigned long long start;
+   size_t i;
+
+   for (i = 0; i < s->size; i++) {
+      if (s->ptr[i] != s->fill) {
+         corrupted++;
+         break;
+      }
+   }
+
+   start = now_ns();
+   umm_free(s->ptr);
+   account(&t_free, start);
+
+   s->node = 0;
+}
+
+// Slot of a node pointer, or the free slot where it goes
+static slot_t *lookup(unsigned long node) {
+   unsigned long i = (node >> 2) % SLOTS;
+   unsigned long n;
+
+   for (n = 0; n < SLOTS; n++, i = (i + 1) % SLOTS) {
+      if (slots[i].node == node || slots[i].node == 0)
+         return &slots[i];
+   }
+   return NULL;
+}
+
+static int replay(FILE *f) {
+   char line[256];
+   unsigned long node, size, op = 0;
+   slot_t *s;
+
+   while (fgets(line, sizeof(line), f)) {
+      if (sscanf(line, "m %lx %lu", &node, &size) == 2) {
+         // allocations that failed on the node are attempted again here
+         s = lookup(node);
+         if (s == NULL) {
+            fprintf(stderr, "more than %d live blocks\n", SLOTS);
+            return 1;
+         }
+         if (s->node == node && node != 0)
+            do_free(s);
+         do_malloc(s, node ? node : ~0ul, size);
+         if (node == 0 && s->node)
+            do_free(s);
+      } else if (sscanf(line, "f %lx", &node) == 1) {
+         if (node == 0)
+            continue;
+         s = lookup(node);
+         if (s == NULL || s->node != node) {
+            unmatched++;
+            continue;
+         }
+         do_free(s);
+      } else {
+         continue;
+      }
+      check_heap(++op);
+   }
+   return 0;
+}
+
+static size_t fuzz_size(void) {
+   int r = rand() % 100;
+
+   // mostly small control blocks, some buffers and a few stacks
+   if (r < 70)
+      return 1 + rand() % 64;
+   if (r < 95)
+      return 64 + rand() % 448;
+   return 512 + rand() % 1536;
+}
+
+static void fuzz(unsigned long ops) {
+   unsigned long op;
+   slot_t *s;
+
+   for (op = 1; op <= ops; op++) {
+      s = &slots[rand() % FUZZ_LIVE];
+      if (s->node)
+         do_free(s);
+      else
+         do_malloc(s, op, fuzz_size());
+      check_heap(op);
+   }
+}
+
+static void report(const char *name, const timing_t *t) {
+   printf("  %-6s %9lu calls %7.1f ns avg %7lu ns max\n", name, t->calls,
+          t->calls ? (double)t->total_ns / t->calls : 0.0, t->max_ns);
+}
+
+int main(int argc, char **argv) {
+   unsigned long ops = 1000000;
+   const char *trace = NULL;
+   int seed = -1;
+   unsigned int free_bytes, largest;
+   FILE *f;
+   int i;
+
+   for (i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "-v") == 0)
+         verbose = 1;
+      else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+         seed = atoi(argv[++i]);
+      else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+         ops = strtoul(argv[++i], NULL, 0);
+      else if (argv[i][0] != '-' && trace == NULL)
+         trace = argv[i];
+      else {
+         fprintf(stderr, "usage: %s [-v] trace.log | -s seed [-n ops]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   if (trace != NULL) {
+      f = strcmp(trace, "-") ? fopen(trace, "r") : stdin;
+      if (f == NULL) {
+         perror(trace);
+         return 1;
+      }
+      if (replay(f))
+         return 1;
+   } else {
+      srand(seed < 0 ? 1 : seed);
+      fuzz(ops);
+   }
+
+   free_bytes = OSGetFreeHeapSize();
+   largest = OSGetMaxFreeHeapBlock();
+
+   printf("%s, %u bytes heap\n", POLICY, (unsigned int)UMM_MALLOC_CFG__HEAP_SIZE);
+   report("malloc", &t_malloc);
+   report("free", &t_free);
+   printf("  failed allocations %lu, corrupted blocks %lu, unmatched frees %lu\n",
+          failed, corrupted, unmatched);
+   printf("  peak used %u bytes, in use %u, free %u, largest free %u (%u%% fragmented)\n",
+          OSGetPeakHeapSize(), OSGetUsedHeapSize(), free_bytes, largest,
+          free_bytes ? 100 - (largest * 100) / free_bytes : 0);
+
+   return corrupted ? 2 : 0;
+}